@@ -0,0 +1,160 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/batch.h"
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+using ResponseHandler = std::function<void(StatusOr<internal::HttpResponse>)>;
+
+Status AsStatus(StatusOr<internal::HttpResponse> response) {
+  if (!response.ok()) {
+    return std::move(response).status();
+  }
+  if (response->status_code >= 300) {
+    return internal::AsStatus(*response);
+  }
+  return Status();
+}
+
+template <typename Parser>
+auto CheckedFromString(StatusOr<internal::HttpResponse> response)
+    -> decltype(Parser::FromString(response->payload)) {
+  if (!response.ok()) {
+    return std::move(response).status();
+  }
+  if (response->status_code >= 300) {
+    return internal::AsStatus(*response);
+  }
+  return Parser::FromString(response->payload);
+}
+
+/// Creates a promise and a handler to satisfy it with a `Status`.
+std::pair<future<Status>, ResponseHandler> MakeStatusHandler() {
+  auto p = std::make_shared<promise<Status>>();
+  auto f = p->get_future();
+  return {std::move(f), [p](StatusOr<internal::HttpResponse> response) {
+            p->set_value(AsStatus(std::move(response)));
+          }};
+}
+
+/// Creates a promise and a handler to satisfy it with a parsed value.
+template <typename Parser, typename T>
+std::pair<future<StatusOr<T>>, ResponseHandler> MakeParsingHandler() {
+  auto p = std::make_shared<promise<StatusOr<T>>>();
+  auto f = p->get_future();
+  return {std::move(f), [p](StatusOr<internal::HttpResponse> response) {
+            p->set_value(CheckedFromString<Parser>(std::move(response)));
+          }};
+}
+}  // namespace
+
+Batch::Batch(std::shared_ptr<internal::RawClient> client)
+    : client_(std::move(client)) {}
+
+Batch::~Batch() {
+  for (auto& handler : handlers_) {
+    handler(Status(StatusCode::kCancelled,
+                   "batch destroyed before the operation was executed"));
+  }
+}
+
+Status Batch::Execute() {
+  auto batches = std::move(batches_);
+  auto handlers = std::move(handlers_);
+  batches_.clear();
+  handlers_.clear();
+
+  Status status;
+  std::size_t offset = 0;
+  for (auto const& batch : batches) {
+    auto response = client_->ExecuteBatch(batch);
+    if (!response && status.ok()) {
+      status = response.status();
+    }
+    for (std::size_t i = 0; i != batch.size(); ++i) {
+      auto& handler = handlers[offset + i];
+      if (!response) {
+        handler(response.status());
+        continue;
+      }
+      handler(std::move(response->responses[i]));
+    }
+    offset += batch.size();
+  }
+  return status;
+}
+
+template <typename Request>
+void Batch::Enqueue(Request const& request, ResponseHandler handler) {
+  if (batches_.empty() ||
+      batches_.back().size() >= internal::kMaximumBatchSize) {
+    batches_.emplace_back();
+  }
+  batches_.back().AddRequest(request);
+  handlers_.push_back(std::move(handler));
+}
+
+future<Status> Batch::AddRequest(internal::DeleteObjectRequest const& request) {
+  auto h = MakeStatusHandler();
+  Enqueue(request, std::move(h.second));
+  return std::move(h.first);
+}
+
+future<StatusOr<ObjectMetadata>> Batch::AddRequest(
+    internal::PatchObjectRequest const& request) {
+  auto h = MakeParsingHandler<internal::ObjectMetadataParser, ObjectMetadata>();
+  Enqueue(request, std::move(h.second));
+  return std::move(h.first);
+}
+
+future<StatusOr<ObjectAccessControl>> Batch::AddRequest(
+    internal::CreateObjectAclRequest const& request) {
+  auto h = MakeParsingHandler<internal::ObjectAccessControlParser,
+                              ObjectAccessControl>();
+  Enqueue(request, std::move(h.second));
+  return std::move(h.first);
+}
+
+future<Status> Batch::AddRequest(
+    internal::DeleteObjectAclRequest const& request) {
+  auto h = MakeStatusHandler();
+  Enqueue(request, std::move(h.second));
+  return std::move(h.first);
+}
+
+future<StatusOr<ObjectAccessControl>> Batch::AddRequest(
+    internal::UpdateObjectAclRequest const& request) {
+  auto h = MakeParsingHandler<internal::ObjectAccessControlParser,
+                              ObjectAccessControl>();
+  Enqueue(request, std::move(h.second));
+  return std::move(h.first);
+}
+
+future<StatusOr<ObjectAccessControl>> Batch::AddRequest(
+    internal::PatchObjectAclRequest const& request) {
+  auto h = MakeParsingHandler<internal::ObjectAccessControlParser,
+                              ObjectAccessControl>();
+  Enqueue(request, std::move(h.second));
+  return std::move(h.first);
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,248 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BATCH_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BATCH_H
+
+#include "google/cloud/future.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include "google/cloud/storage/internal/batch_request.h"
+#include "google/cloud/storage/internal/raw_client.h"
+#include "google/cloud/storage/object_access_control.h"
+#include "google/cloud/storage/object_metadata.h"
+#include "google/cloud/storage/version.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * Collects object operations and sends them using the JSON API batch endpoint.
+ *
+ * Deleting, patching, or changing the ACL of many small objects is dominated by
+ * the cost of making one HTTP request per object. A `Batch` collects these
+ * operations, and `Execute()` sends them in `multipart/mixed` requests, each
+ * one containing up to 100 operations.
+ *
+ * Each member function returns a `future<>` that becomes satisfied when
+ * `Execute()` runs. The operations are independent: the service may run them
+ * in any order, and a failure in one operation does not affect the others.
+ *
+ * @par Retries
+ * The client retries a batch request only if the request as a whole fails, and
+ * only if all its operations are idempotent. Operations that fail within a
+ * batch are reported through their futures and are not retried.
+ *
+ * @par Example
+ * @code
+ * namespace gcs = google::cloud::storage;
+ * gcs::Batch batch = client.CreateBatch();
+ * std::vector<google::cloud::future<google::cloud::Status>> results;
+ * for (auto const& name : object_names) {
+ *   results.push_back(batch.DeleteObject(bucket_name, name));
+ * }
+ * google::cloud::Status status = batch.Execute();
+ * for (auto& r : results) {
+ *   google::cloud::Status deleted = r.get();
+ *   if (!deleted.ok()) std::cerr << deleted << "\n";
+ * }
+ * @endcode
+ *
+ * @see https://cloud.google.com/storage/docs/json_api/v1/how-tos/batch
+ */
+class Batch {
+ public:
+  explicit Batch(std::shared_ptr<internal::RawClient> client);
+  /// Satisfies the futures for any operations not sent by `Execute()`.
+  ~Batch();
+
+  Batch(Batch&&) = default;
+  Batch(Batch const&) = delete;
+  Batch& operator=(Batch const&) = delete;
+  Batch& operator=(Batch&&) = delete;
+
+  /// The number of operations waiting for `Execute()`.
+  std::size_t size() const { return handlers_.size(); }
+
+  /**
+   * Sends all the pending operations.
+   *
+   * The operations are sent in groups of up to 100, one batch request per
+   * group. The futures returned by the other member functions are satisfied
+   * before this function returns.
+   *
+   * @return the first error for a batch request as a whole, an OK status if
+   *     all the batch requests were sent. The status for each operation is
+   *     reported in its future.
+   */
+  Status Execute();
+
+  /**
+   * Adds an operation to delete an object.
+   *
+   * @param bucket_name the name of the bucket that contains the object.
+   * @param object_name the name of the object to be deleted.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include `Generation`,
+   *     `IfGenerationMatch`, `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+   *     `IfMetagenerationNotMatch`, and `UserProject`.
+   */
+  template <typename... Options>
+  future<Status> DeleteObject(std::string const& bucket_name,
+                              std::string const& object_name,
+                              Options&&... options) {
+    internal::DeleteObjectRequest request(bucket_name, object_name);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return AddRequest(request);
+  }
+
+  /**
+   * Adds an operation to patch the metadata of an object.
+   *
+   * @param bucket_name the bucket that contains the object to be updated.
+   * @param object_name the object to be updated.
+   * @param builder the set of updates to perform in the Object metadata.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include `Generation`,
+   *     `IfGenerationMatch`, `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+   *     `IfMetagenerationNotMatch`, `PredefinedAcl`,
+   *     `Projection`, and `UserProject`.
+   */
+  template <typename... Options>
+  future<StatusOr<ObjectMetadata>> PatchObject(
+      std::string bucket_name, std::string object_name,
+      ObjectMetadataPatchBuilder const& builder, Options&&... options) {
+    internal::PatchObjectRequest request(std::move(bucket_name),
+                                         std::move(object_name), builder);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return AddRequest(request);
+  }
+
+  /**
+   * Adds an operation to create a new entry in an object ACL.
+   *
+   * @param bucket_name the name of the bucket that contains the object.
+   * @param object_name the name of the object.
+   * @param entity the name of the entity added to the ACL.
+   * @param role the role of the entity.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include `Generation`, and `UserProject`.
+   */
+  template <typename... Options>
+  future<StatusOr<ObjectAccessControl>> CreateObjectAcl(
+      std::string const& bucket_name, std::string const& object_name,
+      std::string const& entity, std::string const& role,
+      Options&&... options) {
+    internal::CreateObjectAclRequest request(bucket_name, object_name, entity,
+                                             role);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return AddRequest(request);
+  }
+
+  /**
+   * Adds an operation to delete an entry in an object ACL.
+   *
+   * @param bucket_name the name of the bucket that contains the object.
+   * @param object_name the name of the object.
+   * @param entity the name of the entity removed from the ACL.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include `Generation`, and `UserProject`.
+   */
+  template <typename... Options>
+  future<Status> DeleteObjectAcl(std::string const& bucket_name,
+                                 std::string const& object_name,
+                                 std::string const& entity,
+                                 Options&&... options) {
+    internal::DeleteObjectAclRequest request(bucket_name, object_name, entity);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return AddRequest(request);
+  }
+
+  /**
+   * Adds an operation to update an entry in an object ACL.
+   *
+   * @param bucket_name the name of the bucket that contains the object.
+   * @param object_name the name of the object.
+   * @param acl the new ACL value. Note that only the writable values of the ACL
+   *   will be modified by the server.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include `Generation`, and `UserProject`.
+   */
+  template <typename... Options>
+  future<StatusOr<ObjectAccessControl>> UpdateObjectAcl(
+      std::string const& bucket_name, std::string const& object_name,
+      ObjectAccessControl const& acl, Options&&... options) {
+    internal::UpdateObjectAclRequest request(bucket_name, object_name,
+                                             acl.entity(), acl.role());
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return AddRequest(request);
+  }
+
+  /**
+   * Adds an operation to patch an entry in an object ACL.
+   *
+   * @param bucket_name the name of the bucket that contains the object.
+   * @param object_name the name of the object.
+   * @param entity the identifier for the user, group, service account, or
+   *     predefined set of actors holding the permission.
+   * @param builder a builder ready to create the patch.
+   * @param options a list of optional query parameters and/or request
+   *     headers. Valid types for this operation include `Generation`,
+   *     `UserProject`, `IfMatchEtag`, and `IfNoneMatchEtag`.
+   */
+  template <typename... Options>
+  future<StatusOr<ObjectAccessControl>> PatchObjectAcl(
+      std::string const& bucket_name, std::string const& object_name,
+      std::string const& entity, ObjectAccessControlPatchBuilder const& builder,
+      Options&&... options) {
+    internal::PatchObjectAclRequest request(bucket_name, object_name, entity,
+                                            builder);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return AddRequest(request);
+  }
+
+ private:
+  using ResponseHandler =
+      std::function<void(StatusOr<internal::HttpResponse>)>;
+
+  future<Status> AddRequest(internal::DeleteObjectRequest const& request);
+  future<StatusOr<ObjectMetadata>> AddRequest(
+      internal::PatchObjectRequest const& request);
+  future<StatusOr<ObjectAccessControl>> AddRequest(
+      internal::CreateObjectAclRequest const& request);
+  future<Status> AddRequest(internal::DeleteObjectAclRequest const& request);
+  future<StatusOr<ObjectAccessControl>> AddRequest(
+      internal::UpdateObjectAclRequest const& request);
+  future<StatusOr<ObjectAccessControl>> AddRequest(
+      internal::PatchObjectAclRequest const& request);
+
+  template <typename Request>
+  void Enqueue(Request const& request, ResponseHandler handler);
+
+  std::shared_ptr<internal::RawClient> client_;
+  std::vector<internal::BatchRequest> batches_;
+  std::vector<ResponseHandler> handlers_;
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BATCH_H
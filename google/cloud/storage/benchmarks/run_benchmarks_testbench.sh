@@ -115,6 +115,7 @@ run_example ./storage_throughput_vs_cpu_benchmark \
       --maximum-object-size=32KiB \
       --minimum-chunk-size=16KiB \
       --maximum-chunk-size=32KiB \
+      --upload-chunking=compare \
       --duration=1s
 
 run_example_usage ./storage_parallel_uploads_benchmark \
@@ -130,6 +131,15 @@ run_example ./storage_parallel_uploads_benchmark \
       --thread-count=1 \
       --duration=1s
 
+run_example_usage ./storage_parallel_delete_benchmark \
+      --help --description
+run_example ./storage_parallel_delete_benchmark \
+      "--project-id=${GOOGLE_CLOUD_PROJECT}" \
+      "--region=${FAKE_REGION}" \
+      --object-count=20 \
+      --thread-count=2 \
+      --concurrency=4
+
 if [[ "${EXIT_STATUS}" = "0" ]]; then
   TESTBENCH_DUMP_LOG=no
 fi
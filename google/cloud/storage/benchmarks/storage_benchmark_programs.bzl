@@ -18,9 +18,14 @@
 
 storage_benchmark_programs = [
     "storage_file_transfer_benchmark.cc",
+    "storage_hash_validator_benchmark.cc",
+    "storage_json_parser_benchmark.cc",
     "storage_latency_benchmark.cc",
+    "storage_parallel_delete_benchmark.cc",
     "storage_parallel_uploads_benchmark.cc",
+    "storage_prefetch_benchmark.cc",
     "storage_shard_throughput_benchmark.cc",
+    "storage_signed_url_benchmark.cc",
     "storage_throughput_benchmark.cc",
     "storage_throughput_vs_cpu_benchmark.cc",
 ]
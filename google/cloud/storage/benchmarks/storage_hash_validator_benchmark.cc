@@ -0,0 +1,224 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/build_info.h"
+#include "google/cloud/internal/format_time_point.h"
+#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/storage/benchmarks/benchmark_utils.h"
+#include "google/cloud/storage/internal/hash_validator.h"
+#include "google/cloud/storage/internal/hash_validator_impl.h"
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+namespace gcs = google::cloud::storage;
+namespace gcs_bm = google::cloud::storage_benchmarks;
+using gcs::internal::HashValidator;
+
+char const kDescription[] = R"""(
+A microbenchmark for the hash validators in the Google Cloud Storage C++ client
+library.
+
+Uploads and downloads compute the MD5 hash and CRC32C checksum of the data as it
+is transferred, and this work runs in the same thread that performs the I/O.
+This program measures how fast each combination of validators can process data,
+without any network effects.
+
+The program creates a buffer of random data, then for each combination of
+validators (no validation, only CRC32C, only MD5, and both), it feeds the
+complete buffer to a new validator in calls to `Update()` of a configurable
+size. The combination with both validators is measured twice: once as the
+library creates it, and once running each validator over the complete chunk in
+sequence, which is useful as a baseline.
+
+The program repeats the measurements several times and prints the elapsed
+time, CPU time, and throughput (in GB/s) for each iteration.
+)""";
+
+struct Options {
+  std::int64_t buffer_size = 256 * gcs_bm::kMiB;
+  std::int64_t update_size = 2 * gcs_bm::kMiB;
+  int iteration_count = 10;
+};
+
+struct Experiment {
+  std::string name;
+  std::function<void(std::string const&, std::int64_t)> run;
+};
+
+void UpdateInChunks(HashValidator& validator, std::string const& data,
+                    std::int64_t update_size) {
+  auto const size = static_cast<std::int64_t>(data.size());
+  for (std::int64_t offset = 0; offset < size; offset += update_size) {
+    auto n = (std::min)(update_size, size - offset);
+    validator.Update(data.data() + offset, static_cast<std::size_t>(n));
+  }
+}
+
+std::vector<Experiment> MakeExperiments();
+
+google::cloud::StatusOr<Options> ParseArgs(int argc, char* argv[]);
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  google::cloud::StatusOr<Options> options = ParseArgs(argc, argv);
+  if (!options) {
+    std::cerr << options.status() << "\n";
+    return 1;
+  }
+
+  google::cloud::internal::DefaultPRNG generator =
+      google::cloud::internal::MakeDefaultPRNG();
+  auto const data = gcs_bm::MakeRandomData(
+      generator, static_cast<std::size_t>(options->buffer_size));
+
+  std::string notes = google::cloud::storage::version_string() + ";" +
+                      google::cloud::internal::compiler() + ";" +
+                      google::cloud::internal::compiler_flags();
+  std::transform(notes.begin(), notes.end(), notes.begin(),
+                 [](char c) { return c == '\n' ? ';' : c; });
+
+  std::cout << "# Start time: "
+            << google::cloud::internal::FormatRfc3339(
+                   std::chrono::system_clock::now())
+            << "\n# Buffer Size: " << options->buffer_size
+            << "\n# Update Size: " << options->update_size
+            << "\n# Iteration Count: " << options->iteration_count
+            << "\n# Buffer Size (MiB): " << options->buffer_size / gcs_bm::kMiB
+            << "\n# Update Size (KiB): " << options->update_size / gcs_bm::kKiB
+            << "\n# Build info: " << notes << "\n";
+  // Make this immediately visible in the console, helps with debugging.
+  std::cout << std::flush;
+
+  std::cout << "Validator,BufferSize,UpdateSize,ElapsedTimeUs,CpuTimeUs,GBps\n";
+  auto const experiments = MakeExperiments();
+  for (int i = 0; i != options->iteration_count; ++i) {
+    for (auto const& experiment : experiments) {
+      gcs_bm::SimpleTimer timer;
+      timer.Start();
+      experiment.run(data, options->update_size);
+      timer.Stop();
+      auto const elapsed_us = timer.elapsed_time().count();
+      // Bytes per microsecond is MB/s, divide by 1000 to report GB/s.
+      auto const gbps = elapsed_us == 0
+                            ? 0.0
+                            : static_cast<double>(data.size()) /
+                                  static_cast<double>(elapsed_us) / 1000.0;
+      std::cout << experiment.name << ',' << data.size() << ','
+                << options->update_size << ',' << elapsed_us << ','
+                << timer.cpu_time().count() << ',' << std::fixed
+                << std::setprecision(3) << gbps << std::defaultfloat << "\n";
+    }
+    std::cout << std::flush;
+  }
+  std::cout << "# DONE\n" << std::flush;
+
+  return 0;
+}
+
+namespace {
+std::vector<Experiment> MakeExperiments() {
+  auto create = [](bool disable_md5, bool disable_crc32c) {
+    return [disable_md5, disable_crc32c](std::string const& data,
+                                         std::int64_t update_size) {
+      auto validator =
+          gcs::internal::CreateHashValidator(disable_md5, disable_crc32c);
+      UpdateInChunks(*validator, data, update_size);
+      (void)std::move(*validator).Finish();
+    };
+  };
+
+  return {
+      {"null", create(true, true)},
+      {"crc32c", create(true, false)},
+      {"md5", create(false, true)},
+      {"md5+crc32c", create(false, false)},
+      {"md5+crc32c/sequential",
+       [](std::string const& data, std::int64_t update_size) {
+         gcs::internal::Crc32cHashValidator crc32c;
+         gcs::internal::MD5HashValidator md5;
+         auto const size = static_cast<std::int64_t>(data.size());
+         for (std::int64_t offset = 0; offset < size; offset += update_size) {
+           auto n = static_cast<std::size_t>(
+               (std::min)(update_size, size - offset));
+           crc32c.Update(data.data() + offset, n);
+           md5.Update(data.data() + offset, n);
+         }
+         (void)std::move(crc32c).Finish();
+         (void)std::move(md5).Finish();
+       }},
+  };
+}
+
+google::cloud::StatusOr<Options> ParseArgs(int argc, char* argv[]) {
+  Options options;
+  bool wants_help = false;
+  bool wants_description = false;
+  std::vector<gcs_bm::OptionDescriptor> desc{
+      {"--help", "print usage information",
+       [&wants_help](std::string const&) { wants_help = true; }},
+      {"--description", "print benchmark description",
+       [&wants_description](std::string const&) { wants_description = true; }},
+      {"--buffer-size", "the amount of data hashed in each iteration",
+       [&options](std::string const& val) {
+         options.buffer_size = gcs_bm::ParseSize(val);
+       }},
+      {"--update-size", "the amount of data passed to each Update() call",
+       [&options](std::string const& val) {
+         options.update_size = gcs_bm::ParseSize(val);
+       }},
+      {"--iteration-count", "the number of times each validator is measured",
+       [&options](std::string const& val) {
+         options.iteration_count = std::stoi(val);
+       }},
+  };
+  auto usage = gcs_bm::BuildUsage(desc, argv[0]);
+
+  auto unparsed = gcs_bm::OptionsParse(desc, {argv, argv + argc});
+  if (wants_help) {
+    std::cout << usage << "\n";
+  }
+
+  if (wants_description) {
+    std::cout << kDescription << "\n";
+  }
+
+  if (unparsed.size() > 1) {
+    std::ostringstream os;
+    os << "Unknown arguments or options\n" << usage << "\n";
+    return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(os).str()};
+  }
+
+  if (options.buffer_size <= 0) {
+    std::ostringstream os;
+    os << "Invalid buffer size (" << options.buffer_size << ")";
+    return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(os).str()};
+  }
+  if (options.update_size <= 0) {
+    std::ostringstream os;
+    os << "Invalid update size (" << options.update_size << ")";
+    return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(os).str()};
+  }
+
+  return options;
+}
+
+}  // namespace
@@ -0,0 +1,265 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/build_info.h"
+#include "google/cloud/internal/format_time_point.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/storage/benchmarks/benchmark_utils.h"
+#include "google/cloud/storage/internal/nljson.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+namespace {
+namespace gcs = google::cloud::storage;
+namespace gcs_bm = google::cloud::storage_benchmarks;
+using gcs::internal::ListObjectsResponse;
+
+char const kDescription[] = R"""(
+A microbenchmark for the JSON parsers in the Google Cloud Storage C++ client
+library.
+
+The library parses the responses for `Objects: list` using a streaming (SAX)
+parser, which fills the `ObjectMetadata` fields as the payload is tokenized. The
+alternative is to build a complete JSON DOM for each page and then copy each
+field into the `ObjectMetadata` objects. This program compares both approaches.
+
+The program uses the payloads in the files given via `--payload-file`, these
+should be recorded responses for `Objects: list`. If no files are given, the
+program generates a payload with `--object-count` objects, with the same fields
+as the responses from the service.
+
+The program parses each payload several times with each parser, and prints the
+elapsed time, CPU time, throughput (in MB/s), and parsed objects per second for
+each iteration.
+)""";
+
+struct Options {
+  std::vector<std::string> payload_files;
+  int object_count = 1000;
+  int repeat_count = 100;
+  int iteration_count = 10;
+};
+
+struct Experiment {
+  std::string name;
+  std::function<ListObjectsResponse(std::string const&)> parse;
+};
+
+std::string MakePayload(google::cloud::internal::DefaultPRNG& generator,
+                        int object_count);
+
+google::cloud::StatusOr<Options> ParseArgs(int argc, char* argv[]);
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  google::cloud::StatusOr<Options> options = ParseArgs(argc, argv);
+  if (!options) {
+    std::cerr << options.status() << "\n";
+    return 1;
+  }
+
+  std::vector<std::string> payloads;
+  for (auto const& filename : options->payload_files) {
+    std::ifstream is(filename, std::ios::binary);
+    if (!is.is_open()) {
+      std::cerr << "Cannot open payload file " << filename << "\n";
+      return 1;
+    }
+    payloads.emplace_back(std::istreambuf_iterator<char>{is},
+                          std::istreambuf_iterator<char>{});
+  }
+  if (payloads.empty()) {
+    google::cloud::internal::DefaultPRNG generator =
+        google::cloud::internal::MakeDefaultPRNG();
+    payloads.push_back(MakePayload(generator, options->object_count));
+  }
+
+  std::size_t payload_size = 0;
+  for (auto const& p : payloads) {
+    payload_size += p.size();
+  }
+
+  std::string notes = google::cloud::storage::version_string() + ";" +
+                      google::cloud::internal::compiler() + ";" +
+                      google::cloud::internal::compiler_flags();
+  std::transform(notes.begin(), notes.end(), notes.begin(),
+                 [](char c) { return c == '\n' ? ';' : c; });
+
+  std::cout << "# Start time: "
+            << google::cloud::internal::FormatRfc3339(
+                   std::chrono::system_clock::now())
+            << "\n# Payload Count: " << payloads.size()
+            << "\n# Payload Size: " << payload_size
+            << "\n# Repeat Count: " << options->repeat_count
+            << "\n# Iteration Count: " << options->iteration_count
+            << "\n# Build info: " << notes << "\n";
+  // Make this immediately visible in the console, helps with debugging.
+  std::cout << std::flush;
+
+  std::vector<Experiment> const experiments{
+      {"DOM",
+       [](std::string const& payload) {
+         return ListObjectsResponse::FromJson(
+                    gcs::internal::nl::json::parse(payload))
+             .value();
+       }},
+      {"SAX",
+       [](std::string const& payload) {
+         return ListObjectsResponse::FromHttpResponse(payload).value();
+       }},
+  };
+
+  std::cout << "Parser,PayloadSize,ObjectCount,ElapsedTimeUs,CpuTimeUs,MBps,"
+               "ObjectsPerSecond\n";
+  for (int i = 0; i != options->iteration_count; ++i) {
+    for (auto const& experiment : experiments) {
+      std::size_t object_count = 0;
+      gcs_bm::SimpleTimer timer;
+      timer.Start();
+      for (int r = 0; r != options->repeat_count; ++r) {
+        for (auto const& p : payloads) {
+          object_count += experiment.parse(p).items.size();
+        }
+      }
+      timer.Stop();
+      auto const elapsed_us = timer.elapsed_time().count();
+      auto const bytes = payload_size * options->repeat_count;
+      // Bytes per microsecond is MB/s.
+      auto const mbps = elapsed_us == 0 ? 0.0
+                                        : static_cast<double>(bytes) /
+                                              static_cast<double>(elapsed_us);
+      auto const objects_per_second =
+          elapsed_us == 0 ? 0.0
+                          : static_cast<double>(object_count) * 1000000.0 /
+                                static_cast<double>(elapsed_us);
+      std::cout << experiment.name << ',' << bytes << ',' << object_count
+                << ',' << elapsed_us << ',' << timer.cpu_time().count() << ','
+                << std::fixed << std::setprecision(3) << mbps << ','
+                << objects_per_second << std::defaultfloat << "\n";
+    }
+    std::cout << std::flush;
+  }
+  std::cout << "# DONE\n" << std::flush;
+
+  return 0;
+}
+
+namespace {
+std::string MakePayload(google::cloud::internal::DefaultPRNG& generator,
+                        int object_count) {
+  using gcs::internal::nl::json;
+  std::string const bucket = "bucket-name";
+  auto const timestamp = google::cloud::internal::FormatRfc3339(
+      std::chrono::system_clock::now());
+  json items = json::array();
+  for (int i = 0; i != object_count; ++i) {
+    auto const name = "prefix/" + gcs_bm::MakeRandomObjectName(generator);
+    auto const generation = std::to_string(1600000000000000 + i);
+    auto const self_link =
+        "https://www.googleapis.com/storage/v1/b/" + bucket + "/o/" + name;
+    items.push_back(json{
+        {"kind", "storage#object"},
+        {"id", bucket + "/" + name + "/" + generation},
+        {"selfLink", self_link},
+        {"mediaLink", self_link + "?generation=" + generation + "&alt=media"},
+        {"name", name},
+        {"bucket", bucket},
+        {"generation", generation},
+        {"metageneration", "1"},
+        {"contentType", "application/octet-stream"},
+        {"storageClass", "STANDARD"},
+        {"size", std::to_string(1024 * (i + 1))},
+        {"md5Hash", "1B2M2Y8AsgTpgAmY7PhCfg=="},
+        {"crc32c", "AAAAAA=="},
+        {"etag", "CIDC7Y+s5OsCEAE="},
+        {"timeCreated", timestamp},
+        {"updated", timestamp},
+        {"timeStorageClassUpdated", timestamp},
+        {"metadata", json{{"owner", "benchmark"}}},
+    });
+  }
+  return json{{"kind", "storage#objects"},
+              {"nextPageToken", "CgRuZXh0"},
+              {"items", std::move(items)}}
+      .dump();
+}
+
+google::cloud::StatusOr<Options> ParseArgs(int argc, char* argv[]) {
+  Options options;
+  bool wants_help = false;
+  bool wants_description = false;
+  std::vector<gcs_bm::OptionDescriptor> desc{
+      {"--help", "print usage information",
+       [&wants_help](std::string const&) { wants_help = true; }},
+      {"--description", "print benchmark description",
+       [&wants_description](std::string const&) { wants_description = true; }},
+      {"--payload-file",
+       "a file with a recorded `Objects: list` response, can be repeated",
+       [&options](std::string const& val) {
+         options.payload_files.push_back(val);
+       }},
+      {"--object-count", "the number of objects in the generated payload",
+       [&options](std::string const& val) {
+         options.object_count = std::stoi(val);
+       }},
+      {"--repeat-count", "the number of times each payload is parsed",
+       [&options](std::string const& val) {
+         options.repeat_count = std::stoi(val);
+       }},
+      {"--iteration-count", "the number of times each parser is measured",
+       [&options](std::string const& val) {
+         options.iteration_count = std::stoi(val);
+       }},
+  };
+  auto usage = gcs_bm::BuildUsage(desc, argv[0]);
+
+  auto unparsed = gcs_bm::OptionsParse(desc, {argv, argv + argc});
+  if (wants_help) {
+    std::cout << usage << "\n";
+  }
+
+  if (wants_description) {
+    std::cout << kDescription << "\n";
+  }
+
+  if (unparsed.size() > 1) {
+    std::ostringstream os;
+    os << "Unknown arguments or options\n" << usage << "\n";
+    return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(os).str()};
+  }
+
+  if (options.object_count <= 0) {
+    std::ostringstream os;
+    os << "Invalid object count (" << options.object_count << ")";
+    return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(os).str()};
+  }
+  if (options.repeat_count <= 0) {
+    std::ostringstream os;
+    os << "Invalid repeat count (" << options.repeat_count << ")";
+    return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(os).str()};
+  }
+
+  return options;
+}
+
+}  // namespace
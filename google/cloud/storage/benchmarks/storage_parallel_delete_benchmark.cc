@@ -0,0 +1,324 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/build_info.h"
+#include "google/cloud/internal/format_time_point.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/storage/benchmarks/benchmark_utils.h"
+#include "google/cloud/storage/client.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+namespace gcs = google::cloud::storage;
+namespace gcs_bm = google::cloud::storage_benchmarks;
+
+char const kDescription[] = R"""(
+A benchmark for deleting all the objects with a given prefix.
+
+This program measures the rate, in objects per second, at which the Google Cloud
+Storage C++ client library can delete all the objects that match a prefix. It
+compares `DeleteByPrefix()`, which deletes one object at a time, against
+`ParallelDeleteByPrefix()`, both with and without batch requests.
+
+The program first creates a GCS bucket that will contain all the objects used
+by that run of the program. The name of this bucket is selected at random, so
+multiple copies of the program can run simultaneously. The bucket is deleted at
+the end of the run of this program.
+
+For each iteration and each deletion mode, the program:
+
+- Creates a number of small objects, configurable via the command line, using a
+  randomly selected prefix. The objects are created using multiple threads.
+- Deletes all the objects with that prefix using the deletion mode, and captures
+  the elapsed time.
+
+The program prints the elapsed time and the deletion rate for each iteration.
+)""";
+
+using google::cloud::Status;
+using google::cloud::StatusCode;
+using google::cloud::StatusOr;
+
+struct Options {
+  std::string project_id;
+  std::string region;
+  std::string bucket_prefix = "parallel-delete-bm-";
+  int object_count = 1000;
+  int thread_count = 16;
+  int concurrency = 16;
+  int iteration_count = 1;
+  bool run_serial = true;
+  bool run_parallel = true;
+  bool run_batch = true;
+};
+
+enum class DeleteMode { kSerial, kParallel, kBatch };
+
+char const* ToString(DeleteMode mode) {
+  switch (mode) {
+    case DeleteMode::kSerial:
+      return "Serial";
+    case DeleteMode::kParallel:
+      return "Parallel";
+    case DeleteMode::kBatch:
+      return "Batch";
+  }
+  return "";
+}
+
+Status CreateObjects(gcs::Client client, std::string const& bucket_name,
+                     std::string const& prefix, int object_count,
+                     int thread_count) {
+  std::atomic<int> next(0);
+  auto worker = [&client, &bucket_name, &prefix, &next, object_count] {
+    for (int i = next++; i < object_count; i = next++) {
+      auto object = client.InsertObject(bucket_name,
+                                        prefix + "/" + std::to_string(i), "x");
+      if (!object) {
+        return object.status();
+      }
+    }
+    return Status();
+  };
+  std::vector<std::future<Status>> workers;
+  for (int i = 0; i != thread_count; ++i) {
+    workers.push_back(std::async(std::launch::async, worker));
+  }
+  Status status;
+  for (auto& w : workers) {
+    auto s = w.get();
+    if (!s.ok()) {
+      status = std::move(s);
+    }
+  }
+  return status;
+}
+
+StatusOr<std::int64_t> DeleteObjects(gcs::Client client, DeleteMode mode,
+                                     std::string const& bucket_name,
+                                     std::string const& prefix,
+                                     int concurrency) {
+  if (mode == DeleteMode::kSerial) {
+    std::int64_t count = 0;
+    for (auto const& o : client.ListObjects(bucket_name, gcs::Prefix(prefix))) {
+      if (o) {
+        ++count;
+      }
+    }
+    auto status = gcs::DeleteByPrefix(client, bucket_name, prefix);
+    if (!status.ok()) {
+      return status;
+    }
+    return count;
+  }
+  auto result = gcs::ParallelDeleteByPrefix(client, bucket_name, prefix,
+                                            concurrency,
+                                            mode == DeleteMode::kBatch);
+  if (!result.list_status.ok()) {
+    return result.list_status;
+  }
+  if (!result.failures.empty()) {
+    return result.failures.front().status;
+  }
+  return result.deleted_count;
+}
+
+google::cloud::StatusOr<Options> ParseArgs(int argc, char* argv[]) {
+  Options options;
+  bool wants_help = false;
+  bool wants_description = false;
+  std::vector<gcs_bm::OptionDescriptor> desc{
+      {"--help", "print usage information",
+       [&wants_help](std::string const&) { wants_help = true; }},
+      {"--description", "print benchmark description",
+       [&wants_description](std::string const&) { wants_description = true; }},
+      {"--project-id", "use the given project id for the benchmark",
+       [&options](std::string const& val) { options.project_id = val; }},
+      {"--bucket-prefix", "use the given prefix for created temporary bucket",
+       [&options](std::string const& val) { options.bucket_prefix = val; }},
+      {"--region", "use the given region for the benchmark",
+       [&options](std::string const& val) { options.region = val; }},
+      {"--object-count", "the number of objects deleted in each iteration",
+       [&options](std::string const& val) {
+         options.object_count = std::stoi(val);
+       }},
+      {"--thread-count", "the number of threads used to create the objects",
+       [&options](std::string const& val) {
+         options.thread_count = std::stoi(val);
+       }},
+      {"--concurrency", "the concurrency for ParallelDeleteByPrefix()",
+       [&options](std::string const& val) {
+         options.concurrency = std::stoi(val);
+       }},
+      {"--iteration-count", "the number of iterations for each mode",
+       [&options](std::string const& val) {
+         options.iteration_count = std::stoi(val);
+       }},
+      {"--run-serial", "measure DeleteByPrefix()",
+       [&options](std::string const& val) {
+         options.run_serial = gcs_bm::ParseBoolean(val).value_or(true);
+       }},
+      {"--run-parallel", "measure ParallelDeleteByPrefix() without batches",
+       [&options](std::string const& val) {
+         options.run_parallel = gcs_bm::ParseBoolean(val).value_or(true);
+       }},
+      {"--run-batch", "measure ParallelDeleteByPrefix() with batches",
+       [&options](std::string const& val) {
+         options.run_batch = gcs_bm::ParseBoolean(val).value_or(true);
+       }},
+  };
+  auto usage = gcs_bm::BuildUsage(desc, argv[0]);
+
+  auto unparsed = gcs_bm::OptionsParse(desc, {argv, argv + argc});
+  if (wants_help) {
+    std::cout << usage << "\n";
+  }
+
+  if (wants_description) {
+    std::cout << kDescription << "\n";
+  }
+
+  if (unparsed.size() > 2) {
+    std::ostringstream os;
+    os << "Unknown arguments or options\n" << usage << "\n";
+    return Status{StatusCode::kInvalidArgument, std::move(os).str()};
+  }
+  if (unparsed.size() == 2) {
+    options.region = unparsed[1];
+  }
+  if (options.region.empty()) {
+    std::ostringstream os;
+    os << "Missing value for --region option" << usage << "\n";
+    return Status{StatusCode::kInvalidArgument, std::move(os).str()};
+  }
+  if (options.object_count <= 0 || options.thread_count <= 0 ||
+      options.concurrency <= 0) {
+    std::ostringstream os;
+    os << "The object count, thread count and concurrency must be positive";
+    return Status{StatusCode::kInvalidArgument, std::move(os).str()};
+  }
+
+  return options;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  google::cloud::StatusOr<Options> options = ParseArgs(argc, argv);
+  if (!options) {
+    std::cerr << options.status() << "\n";
+    return 1;
+  }
+
+  google::cloud::StatusOr<gcs::ClientOptions> client_options =
+      gcs::ClientOptions::CreateDefaultClientOptions();
+  if (!client_options) {
+    std::cerr << "Could not create ClientOptions, status="
+              << client_options.status() << "\n";
+    return 1;
+  }
+  if (!options->project_id.empty()) {
+    client_options->set_project_id(options->project_id);
+  }
+  gcs::Client client(*std::move(client_options));
+
+  google::cloud::internal::DefaultPRNG generator =
+      google::cloud::internal::MakeDefaultPRNG();
+
+  auto bucket_name =
+      gcs_bm::MakeRandomBucketName(generator, options->bucket_prefix);
+  auto meta =
+      client
+          .CreateBucket(bucket_name,
+                        gcs::BucketMetadata()
+                            .set_storage_class(gcs::storage_class::Standard())
+                            .set_location(options->region),
+                        gcs::PredefinedAcl("private"),
+                        gcs::PredefinedDefaultObjectAcl("projectPrivate"),
+                        gcs::Projection("full"))
+          .value();
+
+  std::cout << "# Running test on bucket: " << meta.name() << "\n";
+  std::string notes = google::cloud::storage::version_string() + ";" +
+                      google::cloud::internal::compiler() + ";" +
+                      google::cloud::internal::compiler_flags();
+  std::transform(notes.begin(), notes.end(), notes.begin(),
+                 [](char c) { return c == '\n' ? ';' : c; });
+  std::cout << "# Start time: "
+            << google::cloud::internal::FormatRfc3339(
+                   std::chrono::system_clock::now())
+            << "\n# Region: " << options->region
+            << "\n# Object Count: " << options->object_count
+            << "\n# Thread Count: " << options->thread_count
+            << "\n# Concurrency: " << options->concurrency
+            << "\n# Iteration Count: " << options->iteration_count
+            << "\n# Build info: " << notes
+            << "\nMode,ObjectCount,Concurrency,ElapsedMs,ObjectsPerSecond\n";
+
+  std::vector<DeleteMode> modes;
+  if (options->run_serial) {
+    modes.push_back(DeleteMode::kSerial);
+  }
+  if (options->run_parallel) {
+    modes.push_back(DeleteMode::kParallel);
+  }
+  if (options->run_batch) {
+    modes.push_back(DeleteMode::kBatch);
+  }
+
+  int exit_status = 0;
+  for (int i = 0; i != options->iteration_count; ++i) {
+    for (auto mode : modes) {
+      auto const prefix = gcs::CreateRandomPrefixName("delete-bm-");
+      auto status =
+          CreateObjects(client, bucket_name, prefix, options->object_count,
+                        options->thread_count);
+      if (!status.ok()) {
+        std::cout << "# Error creating objects, status=" << status << "\n";
+        exit_status = 1;
+        break;
+      }
+      auto start = std::chrono::steady_clock::now();
+      auto count = DeleteObjects(client, mode, bucket_name, prefix,
+                                 options->concurrency);
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - start);
+      if (!count) {
+        std::cout << "# Error deleting objects, mode=" << ToString(mode)
+                  << ", status=" << count.status() << "\n";
+        exit_status = 1;
+        continue;
+      }
+      auto const elapsed_ms = std::max<std::int64_t>(elapsed.count(), 1);
+      auto const rate = static_cast<double>(*count) * 1000.0 /
+                        static_cast<double>(elapsed_ms);
+      std::cout << ToString(mode) << ',' << *count << ','
+                << options->concurrency << ',' << elapsed.count() << ','
+                << std::fixed << std::setprecision(2) << rate << std::endl;
+    }
+  }
+
+  gcs_bm::DeleteAllObjects(client, bucket_name, options->thread_count);
+  auto status = client.DeleteBucket(bucket_name);
+  if (!status.ok()) {
+    std::cerr << "# Error deleting bucket, status=" << status << "\n";
+    return 1;
+  }
+  return exit_status;
+}
@@ -0,0 +1,252 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/build_info.h"
+#include "google/cloud/internal/format_time_point.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/storage/benchmarks/benchmark_utils.h"
+#include "google/cloud/storage/client.h"
+#include <iomanip>
+#include <sstream>
+
+namespace {
+namespace gcs = google::cloud::storage;
+namespace gcs_bm = google::cloud::storage_benchmarks;
+
+char const kDescription[] = R"""(
+A benchmark for the download prefetch support in the Google Cloud Storage C++
+client library.
+
+Applications that perform CPU-heavy work on each block of data they download
+leave the connection idle while they process each block, unless the library
+reads ahead. This program measures the effect of the
+`ClientOptions::download_prefetch_depth()` setting for such applications.
+
+The program creates a bucket, in a region configured via the command line, and
+uploads a single object of a configurable size. Then it repeatedly downloads
+the object, reading it in blocks, and spinning the CPU for a configurable
+amount of time after each block to simulate the application work. Each
+iteration downloads the object once for every prefetch depth between 0
+(disabled) and a configurable maximum, doubling the depth each time.
+
+The program reports the prefetch depth, the elapsed time, the CPU time, and the
+effective throughput (in MiB/s) for each download. The object and the bucket
+are deleted at the end of the run.
+)""";
+
+struct Options {
+  std::string project_id;
+  std::string region;
+  std::int64_t object_size = 128 * gcs_bm::kMiB;
+  std::int64_t block_size = 1 * gcs_bm::kMiB;
+  std::chrono::microseconds work_per_block = std::chrono::milliseconds(2);
+  std::size_t maximum_depth = 8;
+  int iteration_count = 5;
+};
+
+void SimulateWork(std::chrono::microseconds duration) {
+  auto const deadline = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < deadline) {
+    // Spin, this simulates CPU-heavy processing of the block.
+  }
+}
+
+google::cloud::StatusOr<Options> ParseArgs(int argc, char* argv[]);
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  google::cloud::StatusOr<Options> options = ParseArgs(argc, argv);
+  if (!options) {
+    std::cerr << options.status() << "\n";
+    return 1;
+  }
+
+  google::cloud::StatusOr<gcs::ClientOptions> client_options =
+      gcs::ClientOptions::CreateDefaultClientOptions();
+  if (!client_options) {
+    std::cerr << "Could not create ClientOptions, status="
+              << client_options.status() << "\n";
+    return 1;
+  }
+  if (!options->project_id.empty()) {
+    client_options->set_project_id(options->project_id);
+  }
+  client_options->SetDownloadBufferSize(options->block_size);
+  gcs::Client client(*client_options);
+
+  google::cloud::internal::DefaultPRNG generator =
+      google::cloud::internal::MakeDefaultPRNG();
+
+  auto bucket_name = gcs_bm::MakeRandomBucketName(generator, "bm-prefetch-");
+  auto meta =
+      client
+          .CreateBucket(bucket_name,
+                        gcs::BucketMetadata()
+                            .set_storage_class(gcs::storage_class::Standard())
+                            .set_location(options->region),
+                        gcs::PredefinedAcl("private"),
+                        gcs::PredefinedDefaultObjectAcl("projectPrivate"),
+                        gcs::Projection("full"))
+          .value();
+  std::cout << "# Running test on bucket: " << meta.name() << "\n";
+  std::string notes = google::cloud::storage::version_string() + ";" +
+                      google::cloud::internal::compiler() + ";" +
+                      google::cloud::internal::compiler_flags();
+  std::transform(notes.begin(), notes.end(), notes.begin(),
+                 [](char c) { return c == '\n' ? ';' : c; });
+
+  std::cout << "# Start time: "
+            << google::cloud::internal::FormatRfc3339(
+                   std::chrono::system_clock::now())
+            << "\n# Region: " << options->region
+            << "\n# Object Size: " << options->object_size
+            << "\n# Block Size: " << options->block_size
+            << "\n# Work per Block (us): " << options->work_per_block.count()
+            << "\n# Maximum Depth: " << options->maximum_depth
+            << "\n# Iteration Count: " << options->iteration_count
+            << "\n# Object Size (MiB): " << options->object_size / gcs_bm::kMiB
+            << "\n# Block Size (KiB): " << options->block_size / gcs_bm::kKiB
+            << "\n# Build info: " << notes << "\n";
+  // Make this immediately visible in the console, helps with debugging.
+  std::cout << std::flush;
+
+  auto const object_name = gcs_bm::MakeRandomObjectName(generator);
+  auto object = client.InsertObject(
+      bucket_name, object_name,
+      gcs_bm::MakeRandomData(generator, options->object_size));
+  if (!object) {
+    std::cerr << "# Error creating object, status=" << object.status() << "\n";
+    return 1;
+  }
+
+  std::vector<char> buffer(options->block_size);
+  std::cout << "Depth,ObjectSize,BlockSize,WorkPerBlockUs,ElapsedTimeUs,"
+               "CpuTimeUs,MiBs,Status\n";
+  for (int i = 0; i != options->iteration_count; ++i) {
+    for (std::size_t depth = 0; depth <= options->maximum_depth;
+         depth = depth == 0 ? 1 : 2 * depth) {
+      auto reader_options = *client_options;
+      reader_options.set_download_prefetch_depth(depth);
+      gcs::Client reader(std::move(reader_options));
+      gcs_bm::SimpleTimer timer;
+      timer.Start();
+      auto stream = reader.ReadObject(bucket_name, object_name,
+                                      gcs::Generation(object->generation()));
+      std::int64_t total = 0;
+      while (!stream.eof() && !stream.bad()) {
+        stream.read(buffer.data(), buffer.size());
+        total += stream.gcount();
+        SimulateWork(options->work_per_block);
+      }
+      timer.Stop();
+      auto const elapsed_us = timer.elapsed_time().count();
+      auto const mibs =
+          elapsed_us == 0 ? 0.0
+                          : static_cast<double>(total) / gcs_bm::kMiB /
+                                (static_cast<double>(elapsed_us) / 1000000.0);
+      std::cout << depth << ',' << total << ',' << options->block_size << ','
+                << options->work_per_block.count() << ',' << elapsed_us << ','
+                << timer.cpu_time().count() << ',' << std::fixed
+                << std::setprecision(2) << mibs << std::defaultfloat << ','
+                << stream.status().code() << "\n"
+                << std::flush;
+    }
+  }
+
+  (void)client.DeleteObject(bucket_name, object_name,
+                            gcs::Generation(object->generation()));
+  auto status = client.DeleteBucket(bucket_name);
+  if (!status.ok()) {
+    std::cerr << "# Error deleting bucket, status=" << status << "\n";
+    return 1;
+  }
+  std::cout << "# DONE\n" << std::flush;
+
+  return 0;
+}
+
+namespace {
+google::cloud::StatusOr<Options> ParseArgs(int argc, char* argv[]) {
+  Options options;
+  bool wants_help = false;
+  bool wants_description = false;
+  std::vector<gcs_bm::OptionDescriptor> desc{
+      {"--help", "print usage information",
+       [&wants_help](std::string const&) { wants_help = true; }},
+      {"--description", "print benchmark description",
+       [&wants_description](std::string const&) { wants_description = true; }},
+      {"--project-id", "use the given project id for the benchmark",
+       [&options](std::string const& val) { options.project_id = val; }},
+      {"--region", "use the given region for the benchmark",
+       [&options](std::string const& val) { options.region = val; }},
+      {"--object-size", "the size of the object downloaded in the test",
+       [&options](std::string const& val) {
+         options.object_size = gcs_bm::ParseSize(val);
+       }},
+      {"--block-size", "the size of each block read by the application",
+       [&options](std::string const& val) {
+         options.block_size = gcs_bm::ParseSize(val);
+       }},
+      {"--work-per-block-us",
+       "the CPU time (in microseconds) spent processing each block",
+       [&options](std::string const& val) {
+         options.work_per_block = std::chrono::microseconds(std::stol(val));
+       }},
+      {"--maximum-depth", "the maximum prefetch depth used in the test",
+       [&options](std::string const& val) {
+         options.maximum_depth = std::stoul(val);
+       }},
+      {"--iteration-count", "the number of downloads for each prefetch depth",
+       [&options](std::string const& val) {
+         options.iteration_count = std::stoi(val);
+       }},
+  };
+  auto usage = gcs_bm::BuildUsage(desc, argv[0]);
+
+  auto unparsed = gcs_bm::OptionsParse(desc, {argv, argv + argc});
+  if (wants_help) {
+    std::cout << usage << "\n";
+  }
+
+  if (wants_description) {
+    std::cout << kDescription << "\n";
+  }
+
+  if (unparsed.size() > 2) {
+    std::ostringstream os;
+    os << "Unknown arguments or options\n" << usage << "\n";
+    return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(os).str()};
+  }
+  if (unparsed.size() == 2) {
+    options.region = unparsed[1];
+  }
+  if (options.region.empty()) {
+    std::ostringstream os;
+    os << "Missing value for --region option" << usage << "\n";
+    return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(os).str()};
+  }
+  if (options.block_size <= 0) {
+    std::ostringstream os;
+    os << "Invalid block size (" << options.block_size << ")";
+    return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(os).str()};
+  }
+
+  return options;
+}
+
+}  // namespace
@@ -56,6 +56,7 @@ this loop until a prescribed *time* has elapsed:
   object to upload.
 - Select a random chunk size, between two values configured in the command line,
   the data is uploaded in chunks of this size.
+- Select how the client library sizes the upload requests, see below.
 - Upload an object of the selected size, choosing the name of the object at
   random.
 - Once the object is fully uploaded, the program captures the object size, the
@@ -72,6 +73,13 @@ The loop stops when any of the following conditions are met:
 - The test has obtained at least a prescribed "minimum number of samples" *and*
   the test has been running for more than a prescribed "duration".
 
+The `--upload-chunking` option controls the size of the upload requests. With
+`fixed` (the default) each request uploads `upload_buffer_size()` bytes, with
+`adaptive` the client library adapts the request size to the measured
+throughput and latency, and with `compare` each iteration randomly picks one of
+the two modes, so both can be compared under the same conditions. The program
+reports the mode and the last request size used in each upload.
+
 Once the threads finish running their loops the program prints the captured
 performance data. The bucket is deleted after the program terminates.
 
@@ -91,6 +99,7 @@ struct Options {
   std::int64_t maximum_chunk_size = 4096 * gcs_bm::kKiB;
   long minimum_sample_count = 0;
   long maximum_sample_count = std::numeric_limits<long>::max();
+  std::string upload_chunking = "fixed";
 };
 
 enum OpType { OP_UPLOAD, OP_DOWNLOAD };
@@ -101,6 +110,8 @@ struct IterationResult {
   std::uint64_t buffer_size;
   bool crc_enabled;
   bool md5_enabled;
+  bool adaptive_chunking;
+  std::uint64_t upload_chunk_size;
   std::chrono::microseconds elapsed_time;
   std::chrono::microseconds cpu_time;
   google::cloud::StatusCode status;
@@ -173,7 +184,9 @@ int main(int argc, char* argv[]) {
             << "\n# Min Chunk Size (KiB): "
             << options->minimum_chunk_size / gcs_bm::kKiB
             << "\n# Max Chunk Size (KiB): "
-            << options->maximum_chunk_size / gcs_bm::kKiB << std::boolalpha
+            << options->maximum_chunk_size / gcs_bm::kKiB
+            << "\n# Upload Chunking: " << options->upload_chunking
+            << std::boolalpha
             << "\n# Build info: " << notes << "\n";
   // Make this immediately visible in the console, helps with debugging.
   std::cout << std::flush;
@@ -231,6 +244,8 @@ std::ostream& operator<<(std::ostream& os, IterationResult const& rhs) {
             << rhs.crc_enabled << ',' << rhs.md5_enabled << ','
             << rhs.elapsed_time.count() << ',' << rhs.cpu_time.count() << ','
             << rhs.status << ',' << rhs.progress << ','
+            << (rhs.adaptive_chunking ? "ADAPTIVE" : "FIXED") << ','
+            << rhs.upload_chunk_size << ','
             << google::cloud::storage::version_string();
 }
 
@@ -255,7 +270,9 @@ TestResults RunThread(Options const& options, std::string const& bucket_name) {
   }
   std::uint64_t upload_buffer_size = client_options->upload_buffer_size();
   std::uint64_t download_buffer_size = client_options->download_buffer_size();
-  gcs::Client client(*std::move(client_options));
+  gcs::Client fixed_client(*client_options);
+  gcs::Client adaptive_client(
+      client_options->set_enable_adaptive_upload_buffer_size(true));
 
   std::uniform_int_distribution<std::uint64_t> size_generator(
       options.minimum_object_size, options.maximum_object_size);
@@ -264,6 +281,7 @@ TestResults RunThread(Options const& options, std::string const& bucket_name) {
 
   std::bernoulli_distribution crc_generator;
   std::bernoulli_distribution md5_generator;
+  std::bernoulli_distribution adaptive_generator;
 
   auto deadline = std::chrono::steady_clock::now() + options.duration;
 
@@ -287,6 +305,10 @@ TestResults RunThread(Options const& options, std::string const& bucket_name) {
     auto chunk_size = chunk_generator(generator);
     bool enable_crc = crc_generator(generator);
     bool enable_md5 = md5_generator(generator);
+    bool adaptive = options.upload_chunking == "adaptive" ||
+                    (options.upload_chunking == "compare" &&
+                     adaptive_generator(generator));
+    auto& client = adaptive ? adaptive_client : fixed_client;
 
     gcs_bm::ProgressReporter progress;
     timer.Start();
@@ -302,6 +324,7 @@ TestResults RunThread(Options const& options, std::string const& bucket_name) {
       writer.write(contents.data() + offset, len);
       progress.Advance(offset);
     }
+    auto const upload_chunk_size = writer.upload_chunk_size();
     writer.Close();
     progress.Advance(object_size);
     timer.Stop();
@@ -309,8 +332,9 @@ TestResults RunThread(Options const& options, std::string const& bucket_name) {
     auto object_metadata = writer.metadata();
     results.emplace_back(IterationResult{
         OP_UPLOAD, object_size, chunk_size, download_buffer_size, enable_crc,
-        enable_md5, timer.elapsed_time(), timer.cpu_time(),
-        object_metadata.status().code(), progress.GetAccumulatedProgress()});
+        enable_md5, adaptive, upload_chunk_size, timer.elapsed_time(),
+        timer.cpu_time(), object_metadata.status().code(),
+        progress.GetAccumulatedProgress()});
 
     if (!object_metadata) {
       continue;
@@ -331,8 +355,9 @@ TestResults RunThread(Options const& options, std::string const& bucket_name) {
     timer.Stop();
     results.emplace_back(IterationResult{
         OP_DOWNLOAD, object_size, chunk_size, upload_buffer_size, enable_crc,
-        enable_md5, timer.elapsed_time(), timer.cpu_time(),
-        reader.status().code(), progress.GetAccumulatedProgress()});
+        enable_md5, adaptive, upload_chunk_size, timer.elapsed_time(),
+        timer.cpu_time(), reader.status().code(),
+        progress.GetAccumulatedProgress()});
 
     auto status =
         client.DeleteObject(object_metadata->bucket(), object_metadata->name(),
@@ -394,6 +419,10 @@ google::cloud::StatusOr<Options> ParseArgs(int argc, char* argv[]) {
        [&options](std::string const& val) {
          options.maximum_sample_count = std::stol(val);
        }},
+      {"--upload-chunking",
+       "size the upload requests using a 'fixed' or 'adaptive' size, or"
+       " 'compare' both",
+       [&options](std::string const& val) { options.upload_chunking = val; }},
   };
   auto usage = gcs_bm::BuildUsage(desc, argv[0]);
 
@@ -436,6 +465,15 @@ google::cloud::StatusOr<Options> ParseArgs(int argc, char* argv[]) {
     return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
                                  std::move(os).str()};
   }
+  if (options.upload_chunking != "fixed" &&
+      options.upload_chunking != "adaptive" &&
+      options.upload_chunking != "compare") {
+    std::ostringstream os;
+    os << "Invalid value for --upload-chunking (" << options.upload_chunking
+       << "), expected fixed, adaptive, or compare";
+    return google::cloud::Status{google::cloud::StatusCode::kInvalidArgument,
+                                 std::move(os).str()};
+  }
   if (options.minimum_sample_count > options.maximum_sample_count) {
     std::ostringstream os;
     os << "Invalid range for sample range [" << options.minimum_sample_count
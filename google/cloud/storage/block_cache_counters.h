@@ -0,0 +1,48 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BLOCK_CACHE_COUNTERS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BLOCK_CACHE_COUNTERS_H
+
+#include "google/cloud/storage/version.h"
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * The counters for the client-side block cache, used for monitoring.
+ *
+ * @see `Client::block_cache_counters()`
+ */
+struct BlockCacheCounters {
+  /// The number of lookups served from memory.
+  std::uint64_t hits = 0;
+  /// The number of lookups served from the spill directory.
+  std::uint64_t spill_hits = 0;
+  /// The number of lookups that required a download.
+  std::uint64_t misses = 0;
+  /// The number of lookups that waited for a download started by another one.
+  std::uint64_t coalesced = 0;
+  /// The number of blocks dropped (from memory or disk) to stay within bounds.
+  std::uint64_t evictions = 0;
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BLOCK_CACHE_COUNTERS_H
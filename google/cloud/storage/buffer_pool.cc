@@ -0,0 +1,246 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/buffer_pool.h"
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+// Smaller buffers are rounded up to this size.
+constexpr std::size_t kMinimumSizeClass = 4 * 1024;
+}  // namespace
+
+struct BufferPoolState {
+  BufferPoolState(std::size_t m, std::chrono::milliseconds w)
+      : max_bytes(m), max_wait(w) {}
+
+  std::size_t const max_bytes;
+  std::chrono::milliseconds const max_wait;
+
+  mutable std::mutex mu;
+  std::condition_variable cv;
+  // The released buffers, indexed by their size class.
+  std::map<std::size_t, std::vector<std::unique_ptr<char[]>>> free;
+  BufferPoolStats stats{0,
+                        0,
+                        0,
+                        0,
+                        0,
+                        0,
+                        0,
+                        std::chrono::microseconds(0),
+                        std::chrono::microseconds(0)};
+};
+
+std::size_t BufferPoolSizeClass(std::size_t size) {
+  if (size <= kMinimumSizeClass) {
+    return kMinimumSizeClass;
+  }
+  // Find the power of two `p` such that `p < size <= 2 * p`, and round `size`
+  // up to a multiple of `p / 4`, this wastes at most 25% of each buffer.
+  std::size_t p = kMinimumSizeClass;
+  while (2 * p < size) {
+    p *= 2;
+  }
+  auto const step = p / 4;
+  return (size + step - 1) / step * step;
+}
+
+StatusOr<PooledBuffer> AcquireBuffer(std::shared_ptr<BufferPool> const& pool,
+                                     std::size_t size) {
+  if (!pool) {
+    return PooledBuffer(size);
+  }
+  return pool->Acquire(size);
+}
+
+StatusOr<PooledBuffer> TryAcquireBuffer(
+    std::shared_ptr<BufferPool> const& pool, std::size_t size) {
+  if (!pool) {
+    return PooledBuffer(size);
+  }
+  return pool->TryAcquire(size);
+}
+
+}  // namespace internal
+
+PooledBuffer::PooledBuffer(std::size_t size)
+    : data_(size == 0 ? nullptr : new char[size]),
+      size_(size),
+      capacity_(size) {}
+
+PooledBuffer::PooledBuffer(std::shared_ptr<internal::BufferPoolState> pool,
+                           std::unique_ptr<char[]> data, std::size_t size,
+                           std::size_t capacity)
+    : pool_(std::move(pool)),
+      data_(std::move(data)),
+      size_(size),
+      capacity_(capacity) {}
+
+PooledBuffer::PooledBuffer(PooledBuffer&& rhs) noexcept
+    : pool_(std::move(rhs.pool_)),
+      data_(std::move(rhs.data_)),
+      size_(rhs.size_),
+      capacity_(rhs.capacity_) {
+  rhs.size_ = 0;
+  rhs.capacity_ = 0;
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& rhs) noexcept {
+  if (this == &rhs) {
+    return *this;
+  }
+  Release();
+  pool_ = std::move(rhs.pool_);
+  data_ = std::move(rhs.data_);
+  size_ = rhs.size_;
+  capacity_ = rhs.capacity_;
+  rhs.size_ = 0;
+  rhs.capacity_ = 0;
+  return *this;
+}
+
+void PooledBuffer::Release() {
+  auto pool = std::move(pool_);
+  size_ = 0;
+  if (!pool || !data_) {
+    data_.reset();
+    capacity_ = 0;
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lk(pool->mu);
+    pool->stats.bytes_in_use -= capacity_;
+    pool->stats.bytes_cached += capacity_;
+    pool->free[capacity_].push_back(std::move(data_));
+  }
+  capacity_ = 0;
+  pool->cv.notify_all();
+}
+
+BufferPool::BufferPool(std::size_t max_bytes,
+                       std::chrono::milliseconds max_wait)
+    : state_(std::make_shared<internal::BufferPoolState>(max_bytes,
+                                                         max_wait)) {}
+
+std::size_t BufferPool::max_bytes() const { return state_->max_bytes; }
+
+StatusOr<PooledBuffer> BufferPool::Acquire(std::size_t size) {
+  return AcquireImpl(size, true);
+}
+
+StatusOr<PooledBuffer> BufferPool::TryAcquire(std::size_t size) {
+  return AcquireImpl(size, false);
+}
+
+BufferPoolStats BufferPool::stats() const {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  return state_->stats;
+}
+
+StatusOr<PooledBuffer> BufferPool::AcquireImpl(std::size_t size, bool wait) {
+  if (size == 0) {
+    return PooledBuffer();
+  }
+  auto const capacity = internal::BufferPoolSizeClass(size);
+  auto& s = *state_;
+  // Declared before the lock, so the evicted buffers are freed after the lock
+  // is released.
+  std::vector<std::unique_ptr<char[]>> evicted;
+  std::unique_lock<std::mutex> lk(s.mu);
+  auto const start = std::chrono::steady_clock::now();
+  auto const deadline = start + s.max_wait;
+  auto record_wait = [&s, start] {
+    auto const elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    ++s.stats.waits;
+    s.stats.total_wait_time += elapsed;
+    s.stats.max_wait_time = (std::max)(s.stats.max_wait_time, elapsed);
+  };
+  auto exhausted = [&s, capacity] {
+    ++s.stats.rejections;
+    return Status(StatusCode::kResourceExhausted,
+                  "BufferPool cannot allocate " + std::to_string(capacity) +
+                      " bytes, bytes_in_use=" +
+                      std::to_string(s.stats.bytes_in_use) +
+                      ", max_bytes=" + std::to_string(s.max_bytes));
+  };
+  auto fits = [&s, capacity] {
+    return s.stats.bytes_in_use + s.stats.bytes_cached + capacity <=
+           s.max_bytes;
+  };
+  if (capacity > s.max_bytes) {
+    return exhausted();
+  }
+
+  bool waited = false;
+  std::unique_ptr<char[]> data;
+  for (;;) {
+    auto f = s.free.find(capacity);
+    if (f != s.free.end() && !f->second.empty()) {
+      data = std::move(f->second.back());
+      f->second.pop_back();
+      s.stats.bytes_cached -= capacity;
+      ++s.stats.reuses;
+      break;
+    }
+    // Free released buffers of other size classes, largest first, until the
+    // new buffer fits in the budget.
+    for (auto i = s.free.rbegin(); i != s.free.rend() && !fits(); ++i) {
+      while (!i->second.empty() && !fits()) {
+        evicted.push_back(std::move(i->second.back()));
+        i->second.pop_back();
+        s.stats.bytes_cached -= i->first;
+      }
+    }
+    if (fits()) {
+      break;
+    }
+    if (!wait || std::chrono::steady_clock::now() >= deadline) {
+      if (waited) {
+        record_wait();
+      }
+      return exhausted();
+    }
+    waited = true;
+    s.cv.wait_until(lk, deadline);
+  }
+  if (waited) {
+    record_wait();
+  }
+  s.stats.bytes_in_use += capacity;
+  s.stats.peak_bytes = (std::max)(
+      s.stats.peak_bytes, s.stats.bytes_in_use + s.stats.bytes_cached);
+  if (!data) {
+    ++s.stats.allocations;
+    // The budget is already reserved, allocate without holding the lock.
+    lk.unlock();
+    data.reset(new char[capacity]);
+  }
+  return PooledBuffer(state_, std::move(data), size, capacity);
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
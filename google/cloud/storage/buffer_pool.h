@@ -0,0 +1,185 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BUFFER_POOL_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BUFFER_POOL_H
+
+#include "google/cloud/status_or.h"
+#include "google/cloud/storage/version.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+struct BufferPoolState;
+}  // namespace internal
+
+/// The counters maintained by a `BufferPool`.
+struct BufferPoolStats {
+  /// The bytes in buffers currently used by streams.
+  std::size_t bytes_in_use;
+  /// The bytes in released buffers kept for reuse.
+  std::size_t bytes_cached;
+  /// The largest value of `bytes_in_use + bytes_cached` so far.
+  std::size_t peak_bytes;
+  /// The number of buffers allocated from the heap.
+  std::int64_t allocations;
+  /// The number of requests served with a previously released buffer.
+  std::int64_t reuses;
+  /// The number of requests that waited for other streams to release memory.
+  std::int64_t waits;
+  /// The number of requests that failed because the budget was exhausted.
+  std::int64_t rejections;
+  /// The total time spent waiting for memory.
+  std::chrono::microseconds total_wait_time;
+  /// The longest time spent waiting for memory by a single request.
+  std::chrono::microseconds max_wait_time;
+};
+
+/**
+ * A buffer obtained from a `BufferPool`.
+ *
+ * The memory is returned to the pool when the buffer is destroyed. Buffers
+ * are move-only. The contents of a new buffer are not initialized.
+ */
+class PooledBuffer {
+ public:
+  /// Creates an empty buffer.
+  PooledBuffer() = default;
+
+  /// Allocates a buffer of @p size bytes outside any pool.
+  explicit PooledBuffer(std::size_t size);
+
+  ~PooledBuffer() { Release(); }
+
+  PooledBuffer(PooledBuffer&& rhs) noexcept;
+  PooledBuffer& operator=(PooledBuffer&& rhs) noexcept;
+
+  PooledBuffer(PooledBuffer const&) = delete;
+  PooledBuffer& operator=(PooledBuffer const&) = delete;
+
+  char* data() const { return data_.get(); }
+  std::size_t size() const { return size_; }
+
+ private:
+  friend class BufferPool;
+  PooledBuffer(std::shared_ptr<internal::BufferPoolState> pool,
+               std::unique_ptr<char[]> data, std::size_t size,
+               std::size_t capacity);
+
+  void Release();
+
+  std::shared_ptr<internal::BufferPoolState> pool_;
+  std::unique_ptr<char[]> data_;
+  std::size_t size_ = 0;
+  std::size_t capacity_ = 0;
+};
+
+/**
+ * Limits the memory used by the transfer buffers of all the streams.
+ *
+ * By default each `ObjectReadStream` and `ObjectWriteStream` allocates its
+ * own buffer, and the memory used by an application with many concurrent
+ * uploads and downloads grows with the number of streams. With a
+ * `BufferPool` the streams obtain their buffers from the pool, which keeps
+ * the total below a budget, and reuses released buffers instead of returning
+ * them to the heap.
+ *
+ * Buffer sizes are rounded up to a size class, with four classes per power of
+ * two, so buffers released by one stream can be reused by streams with
+ * similar buffer sizes. Released buffers count towards the budget; they are
+ * freed when needed to make room for buffers of a different size class.
+ *
+ * When the budget is exhausted `Acquire()` waits for other streams to
+ * release their buffers, up to a configurable time. If no memory is released
+ * in that time, or if the pool is configured not to wait, the request fails
+ * with `StatusCode::kResourceExhausted`. `ObjectReadStream` and
+ * `ObjectWriteStream` objects that cannot obtain a buffer are created in an
+ * error state.
+ *
+ * Copies of a `BufferPool` share the budget, buffers, and counters. Use the
+ * same pool with multiple `Client` objects to limit the memory used by all
+ * of them.
+ *
+ * @par Example
+ * @code
+ * namespace gcs = google::cloud::storage;
+ * auto pool = std::make_shared<gcs::BufferPool>(
+ *     256 * 1024 * 1024, std::chrono::seconds(10));
+ * auto options = gcs::ClientOptions::CreateDefaultClientOptions().value();
+ * gcs::Client client(std::move(options.set_buffer_pool(pool)));
+ * // ... use the client ...
+ * std::cout << "waits: " << pool->stats().waits << "\n";
+ * @endcode
+ */
+class BufferPool {
+ public:
+  /**
+   * Creates a new pool.
+   *
+   * @param max_bytes the maximum number of bytes used by the buffers in the
+   *     pool, including the buffers kept for reuse.
+   * @param max_wait how long `Acquire()` waits for memory when the budget is
+   *     exhausted. With the default value `Acquire()` fails immediately.
+   */
+  explicit BufferPool(
+      std::size_t max_bytes,
+      std::chrono::milliseconds max_wait = std::chrono::milliseconds(0));
+
+  /// Returns the budget.
+  std::size_t max_bytes() const;
+
+  /**
+   * Returns a buffer of at least @p size bytes.
+   *
+   * Waits up to the configured time if the budget is exhausted.
+   */
+  StatusOr<PooledBuffer> Acquire(std::size_t size);
+
+  /// Returns a buffer of at least @p size bytes without waiting.
+  StatusOr<PooledBuffer> TryAcquire(std::size_t size);
+
+  /// Returns a snapshot of the counters.
+  BufferPoolStats stats() const;
+
+ private:
+  StatusOr<PooledBuffer> AcquireImpl(std::size_t size, bool wait);
+
+  std::shared_ptr<internal::BufferPoolState> state_;
+};
+
+namespace internal {
+/// Returns a buffer from @p pool, or a new buffer if @p pool is null.
+StatusOr<PooledBuffer> AcquireBuffer(std::shared_ptr<BufferPool> const& pool,
+                                     std::size_t size);
+
+/// Like `AcquireBuffer()`, but does not wait if the budget is exhausted.
+StatusOr<PooledBuffer> TryAcquireBuffer(
+    std::shared_ptr<BufferPool> const& pool, std::size_t size);
+
+/// Returns the size class used for buffers of @p size bytes.
+std::size_t BufferPoolSizeClass(std::size_t size);
+}  // namespace internal
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_BUFFER_POOL_H
@@ -0,0 +1,178 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/buffer_pool.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ms = std::chrono::milliseconds;
+constexpr std::size_t kKiB = 1024;
+
+/// @test Verify that buffer sizes are rounded up to a size class.
+TEST(BufferPoolTest, SizeClass) {
+  EXPECT_EQ(4 * kKiB, internal::BufferPoolSizeClass(1));
+  EXPECT_EQ(4 * kKiB, internal::BufferPoolSizeClass(4 * kKiB));
+  EXPECT_EQ(5 * kKiB, internal::BufferPoolSizeClass(4 * kKiB + 1));
+  EXPECT_EQ(128 * kKiB, internal::BufferPoolSizeClass(128 * kKiB));
+  EXPECT_EQ(160 * kKiB, internal::BufferPoolSizeClass(128 * kKiB + 1));
+  EXPECT_EQ(5 * kKiB * kKiB, internal::BufferPoolSizeClass(5 * kKiB * kKiB));
+  EXPECT_EQ(8 * kKiB * kKiB,
+            internal::BufferPoolSizeClass(7 * kKiB * kKiB + 1));
+}
+
+/// @test Verify that released buffers are reused.
+TEST(BufferPoolTest, ReusesBuffers) {
+  BufferPool tested(1024 * kKiB);
+  char* data = nullptr;
+  {
+    auto buffer = tested.Acquire(100 * kKiB);
+    ASSERT_STATUS_OK(buffer);
+    EXPECT_EQ(100 * kKiB, buffer->size());
+    data = buffer->data();
+    auto stats = tested.stats();
+    EXPECT_EQ(112 * kKiB, stats.bytes_in_use);
+    EXPECT_EQ(0, stats.bytes_cached);
+  }
+  auto stats = tested.stats();
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(112 * kKiB, stats.bytes_cached);
+
+  // A different size in the same class reuses the buffer.
+  auto buffer = tested.Acquire(110 * kKiB);
+  ASSERT_STATUS_OK(buffer);
+  EXPECT_EQ(data, buffer->data());
+  stats = tested.stats();
+  EXPECT_EQ(112 * kKiB, stats.bytes_in_use);
+  EXPECT_EQ(0, stats.bytes_cached);
+  EXPECT_EQ(112 * kKiB, stats.peak_bytes);
+  EXPECT_EQ(1, stats.allocations);
+  EXPECT_EQ(1, stats.reuses);
+}
+
+/// @test Verify that requests fail immediately when the budget is exhausted.
+TEST(BufferPoolTest, FailFast) {
+  BufferPool tested(256 * kKiB);
+  auto b1 = tested.Acquire(128 * kKiB);
+  ASSERT_STATUS_OK(b1);
+  auto b2 = tested.Acquire(128 * kKiB);
+  ASSERT_STATUS_OK(b2);
+  auto b3 = tested.Acquire(128 * kKiB);
+  ASSERT_FALSE(b3.ok());
+  EXPECT_EQ(StatusCode::kResourceExhausted, b3.status().code());
+
+  // Buffers larger than the budget are always rejected.
+  auto b4 = tested.Acquire(512 * kKiB);
+  ASSERT_FALSE(b4.ok());
+  EXPECT_EQ(StatusCode::kResourceExhausted, b4.status().code());
+
+  auto stats = tested.stats();
+  EXPECT_EQ(2, stats.rejections);
+  EXPECT_EQ(0, stats.waits);
+}
+
+/// @test Verify that cached buffers are freed to make room for other sizes.
+TEST(BufferPoolTest, EvictsCachedBuffers) {
+  BufferPool tested(256 * kKiB);
+  {
+    auto b1 = tested.Acquire(128 * kKiB);
+    ASSERT_STATUS_OK(b1);
+    auto b2 = tested.Acquire(64 * kKiB);
+    ASSERT_STATUS_OK(b2);
+  }
+  EXPECT_EQ(192 * kKiB, tested.stats().bytes_cached);
+
+  auto buffer = tested.Acquire(256 * kKiB);
+  ASSERT_STATUS_OK(buffer);
+  auto stats = tested.stats();
+  EXPECT_EQ(256 * kKiB, stats.bytes_in_use);
+  EXPECT_EQ(0, stats.bytes_cached);
+  EXPECT_EQ(3, stats.allocations);
+}
+
+/// @test Verify that `Acquire()` waits for other buffers to be released.
+TEST(BufferPoolTest, WaitsForRelease) {
+  BufferPool tested(128 * kKiB, ms(60000));
+  auto b1 = tested.Acquire(128 * kKiB);
+  ASSERT_STATUS_OK(b1);
+
+  // TryAcquire() never waits.
+  auto b2 = tested.TryAcquire(128 * kKiB);
+  EXPECT_EQ(StatusCode::kResourceExhausted, b2.status().code());
+
+  PooledBuffer released = *std::move(b1);
+  std::thread t([&released] {
+    std::this_thread::sleep_for(ms(20));
+    released = PooledBuffer();
+  });
+  auto b3 = tested.Acquire(128 * kKiB);
+  t.join();
+  ASSERT_STATUS_OK(b3);
+
+  auto stats = tested.stats();
+  EXPECT_EQ(1, stats.waits);
+  EXPECT_EQ(1, stats.reuses);
+  EXPECT_LT(0, stats.max_wait_time.count());
+  EXPECT_EQ(stats.max_wait_time, stats.total_wait_time);
+}
+
+/// @test Verify that `Acquire()` fails if no memory is released in time.
+TEST(BufferPoolTest, WaitTimesOut) {
+  BufferPool tested(128 * kKiB, ms(10));
+  auto b1 = tested.Acquire(128 * kKiB);
+  ASSERT_STATUS_OK(b1);
+  auto b2 = tested.Acquire(4 * kKiB);
+  ASSERT_FALSE(b2.ok());
+  EXPECT_EQ(StatusCode::kResourceExhausted, b2.status().code());
+
+  auto stats = tested.stats();
+  EXPECT_EQ(1, stats.waits);
+  EXPECT_EQ(1, stats.rejections);
+  EXPECT_LE(ms(10), stats.max_wait_time);
+}
+
+/// @test Verify that copies of a pool share the budget and counters.
+TEST(BufferPoolTest, CopiesShareState) {
+  BufferPool tested(128 * kKiB);
+  BufferPool copy = tested;
+  auto b1 = copy.Acquire(128 * kKiB);
+  ASSERT_STATUS_OK(b1);
+  EXPECT_FALSE(tested.Acquire(4 * kKiB).ok());
+  EXPECT_EQ(1, tested.stats().allocations);
+  EXPECT_EQ(1, copy.stats().rejections);
+}
+
+/// @test Verify that buffers outside any pool work.
+TEST(BufferPoolTest, Unpooled) {
+  auto buffer = internal::AcquireBuffer({}, 100);
+  ASSERT_STATUS_OK(buffer);
+  EXPECT_EQ(100, buffer->size());
+  EXPECT_NE(nullptr, buffer->data());
+
+  PooledBuffer empty;
+  EXPECT_EQ(0, empty.size());
+  EXPECT_EQ(nullptr, empty.data());
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
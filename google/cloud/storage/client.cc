@@ -16,12 +16,19 @@
 #include "google/cloud/internal/filesystem.h"
 #include "google/cloud/internal/make_unique.h"
 #include "google/cloud/log.h"
+#include "google/cloud/storage/internal/adaptive_chunk_size.h"
 #include "google/cloud/storage/internal/curl_client.h"
 #include "google/cloud/storage/internal/curl_handle.h"
 #include "google/cloud/storage/internal/openssl_util.h"
+#include "google/cloud/storage/internal/pipelined_resumable_upload_session.h"
+#include "google/cloud/storage/internal/prefetch_object_read_source.h"
 #include "google/cloud/storage/oauth2/service_account_credentials.h"
 #include <openssl/md5.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <mutex>
 #include <thread>
 
 namespace google {
@@ -38,6 +45,47 @@ std::shared_ptr<internal::RawClient> Client::CreateDefaultInternalClient(
   return internal::CurlClient::Create(std::move(options));
 }
 
+namespace {
+/// Find the decorator of type `T` in the stack created by `Client::Decorate()`
+template <typename T>
+std::shared_ptr<T> FindDecorator(std::shared_ptr<internal::RawClient> client) {
+  while (client) {
+    if (auto found = std::dynamic_pointer_cast<T>(client)) {
+      return found;
+    }
+    if (auto c = std::dynamic_pointer_cast<internal::MetadataCacheClient>(
+            client)) {
+      client = c->client();
+    } else if (auto c =
+                   std::dynamic_pointer_cast<internal::RetryClient>(client)) {
+      client = c->client();
+    } else if (auto c = std::dynamic_pointer_cast<internal::BlockCacheClient>(
+                   client)) {
+      client = c->client();
+    } else {
+      break;
+    }
+  }
+  return nullptr;
+}
+}  // namespace
+
+BlockCacheCounters Client::block_cache_counters() const {
+  auto cache = FindDecorator<internal::BlockCacheClient>(raw_client_);
+  if (!cache) {
+    return {};
+  }
+  return cache->cache()->counters();
+}
+
+MetadataCacheCounters Client::metadata_cache_counters() const {
+  auto cache = FindDecorator<internal::MetadataCacheClient>(raw_client_);
+  if (!cache) {
+    return {};
+  }
+  return cache->counters();
+}
+
 StatusOr<Client> Client::CreateDefaultClient() {
   auto opts = ClientOptions::CreateDefaultClientOptions();
   if (!opts) {
@@ -56,9 +104,17 @@ ObjectReadStream Client::ReadObjectImpl(
     error_stream.setstate(std::ios::badbit | std::ios::eofbit);
     return error_stream;
   }
+  std::unique_ptr<internal::ObjectReadSource> reader = *std::move(source);
+  auto const& options = raw_client_->client_options();
+  if (options.download_prefetch_depth() != 0) {
+    reader = google::cloud::internal::make_unique<
+        internal::PrefetchObjectReadSource>(std::move(reader),
+                                            options.download_prefetch_depth(),
+                                            options.download_buffer_size());
+  }
   auto stream = ObjectReadStream(
       google::cloud::internal::make_unique<internal::ObjectReadStreambuf>(
-          request, *std::move(source)));
+          request, std::move(reader), options.buffer_pool()));
   (void)stream.peek();
 #if !GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
   // Without exceptions the streambuf cannot report errors, so we have to
@@ -85,11 +141,29 @@ ObjectWriteStream Client::WriteObjectImpl(
     error_stream.Close();
     return error_stream;
   }
+  std::unique_ptr<internal::ResumableUploadSession> upload_session =
+      *std::move(session);
+  auto const& options = raw_client_->client_options();
+  if (options.upload_pipeline_depth() != 0) {
+    upload_session = google::cloud::internal::make_unique<
+        internal::PipelinedResumableUploadSession>(
+        std::move(upload_session), options.upload_pipeline_depth());
+  }
+  // With pipelining the chunks are committed in the background, the stream
+  // cannot time the uploads to adapt the chunk size.
+  std::unique_ptr<internal::AdaptiveChunkSize> chunk_size;
+  if (options.enable_adaptive_upload_buffer_size() &&
+      options.upload_pipeline_depth() == 0) {
+    chunk_size =
+        google::cloud::internal::make_unique<internal::AdaptiveChunkSize>(
+            options.upload_buffer_size(), options.minimum_upload_buffer_size(),
+            options.maximum_upload_buffer_size());
+  }
   return ObjectWriteStream(
       google::cloud::internal::make_unique<internal::ObjectWriteStreambuf>(
-          *std::move(session),
-          raw_client_->client_options().upload_buffer_size(),
-          internal::CreateHashValidator(request)));
+          std::move(upload_session), options.upload_buffer_size(),
+          internal::CreateHashValidator(request), std::move(chunk_size),
+          options.buffer_pool()));
 }
 
 bool Client::UseSimpleUpload(std::string const& file_name) const {
@@ -103,17 +177,9 @@ bool Client::UseSimpleUpload(std::string const& file_name) const {
 
 StatusOr<ObjectMetadata> Client::UploadFileSimple(
     std::string const& file_name, internal::InsertObjectMediaRequest request) {
-  std::ifstream is(file_name, std::ios::binary);
-  if (!is.is_open()) {
-    std::ostringstream os;
-    os << __func__ << "(" << request << ", " << file_name
-       << "): cannot open upload file source";
-    return Status(StatusCode::kNotFound, std::move(os).str());
-  }
-
-  std::string payload(std::istreambuf_iterator<char>{is}, {});
-  request.set_contents(std::move(payload));
-
+  // Let the transport stream (and hash) the file, instead of loading it in
+  // memory.
+  request.set_contents_file(file_name);
   return raw_client_->InsertObjectMedia(request);
 }
 
@@ -297,26 +363,77 @@ StatusOr<std::string> Client::SignUrlV2(
 
 StatusOr<std::string> Client::SignUrlV4(internal::V4SignUrlRequest request) {
   request.AddMissingRequiredHeaders();
-  SigningAccount const& signing_account = request.signing_account();
-  auto signing_email = SigningEmail(signing_account);
+  auto signing_email = SigningEmail(request.signing_account());
+  internal::CurlHandle curl;
+  std::string buffer;
+  return SignUrlV4Impl(request, signing_email, curl, buffer);
+}
+
+std::vector<StatusOr<std::string>> Client::SignUrlsV4(
+    internal::V4SignUrlRequest request, std::vector<std::string> object_names,
+    std::size_t concurrency) {
+  request.AddMissingRequiredHeaders();
+  auto const signing_email = SigningEmail(request.signing_account());
+
+  std::vector<StatusOr<std::string>> results(object_names.size());
+  std::atomic<std::size_t> next(0);
+  auto worker = [&] {
+    // Each worker modifies its own copy of the request, and reuses the same
+    // handle and buffer for all the URLs it signs.
+    auto r = request;
+    internal::CurlHandle curl;
+    std::string buffer;
+    for (auto i = next++; i < object_names.size(); i = next++) {
+      r.set_object_name(std::move(object_names[i]));
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+      // An exception escaping a worker thread would terminate the program,
+      // report it as the result for this URL.
+      try {
+        results[i] = SignUrlV4Impl(r, signing_email, curl, buffer);
+      } catch (std::exception const& ex) {
+        results[i] = Status(StatusCode::kUnknown, ex.what());
+      } catch (...) {
+        results[i] = Status(StatusCode::kUnknown,
+                            "unknown exception while signing the URL");
+      }
+#else
+      results[i] = SignUrlV4Impl(r, signing_email, curl, buffer);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    }
+  };
+  auto const worker_count = (std::min)((std::max)(concurrency, std::size_t{1}),
+                                       object_names.size());
+  std::vector<std::thread> workers;
+  for (std::size_t i = 1; i < worker_count; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : workers) {
+    t.join();
+  }
+  return results;
+}
 
-  auto string_to_sign = request.StringToSign(signing_email);
-  auto signed_blob = SignBlobImpl(signing_account, string_to_sign);
+StatusOr<std::string> Client::SignUrlV4Impl(
+    internal::V4SignUrlRequest const& request, std::string const& signing_email,
+    internal::CurlHandle& curl, std::string& buffer) {
+  auto string_to_sign = request.StringToSign(signing_email, curl, buffer);
+  auto signed_blob = SignBlobImpl(request.signing_account(), string_to_sign);
   if (!signed_blob) {
     return signed_blob.status();
   }
 
-  std::string signature = internal::HexEncode(signed_blob->signed_blob);
-  internal::CurlHandle curl;
-  std::ostringstream os;
-  os << "https://storage.googleapis.com/" << request.bucket_name();
+  std::string result = "https://storage.googleapis.com/";
+  result += request.bucket_name();
   for (auto& part : request.ObjectNameParts()) {
-    os << '/' << curl.MakeEscapedString(part).get();
+    result += '/';
+    result += curl.MakeEscapedString(part).get();
   }
-  os << "?" << request.CanonicalQueryString(signing_email)
-     << "&X-Goog-Signature=" << signature;
-
-  return std::move(os).str();
+  result += '?';
+  result += request.CanonicalQueryString(signing_email, curl);
+  result += "&X-Goog-Signature=";
+  result += internal::HexEncode(signed_blob->signed_blob);
+  return result;
 }
 
 StatusOr<PolicyDocumentResult> Client::SignPolicyDocument(
@@ -384,6 +501,165 @@ Status ScopedDeleter::ExecuteDelete() {
   return Status();
 }
 
+namespace {
+/// The state shared by the threads in `ParallelDeleteByPrefixImpl()`.
+class ParallelDeleteState {
+ public:
+  ParallelDeleteState(std::size_t concurrency, DeleteObjectFunction delete_one,
+                      DeleteObjectBatchFunction delete_batch)
+      : delete_one_(std::move(delete_one)),
+        delete_batch_(std::move(delete_batch)),
+        group_size_(delete_batch_ ? kMaximumBatchSize : 1),
+        // Keep enough groups queued to feed every worker twice, so the workers
+        // do not starve while the next page is listed.
+        max_queued_(2 * concurrency),
+        use_batch_(static_cast<bool>(delete_batch_)) {}
+
+  /// The number of objects deleted by each worker iteration.
+  std::size_t group_size() const { return group_size_; }
+
+  /// Queues @p objects for deletion, blocks while the queue is full.
+  void Push(std::vector<ObjectMetadata> objects) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return queue_.size() < max_queued_; });
+    queue_.push_back(std::move(objects));
+    lk.unlock();
+    cv_.notify_all();
+  }
+
+  /// Signals the workers that no more objects will be queued.
+  void ListingDone(Status status) {
+    std::unique_lock<std::mutex> lk(mu_);
+    listing_done_ = true;
+    result_.list_status = std::move(status);
+    lk.unlock();
+    cv_.notify_all();
+  }
+
+  /// The loop executed by each worker thread.
+  void Worker() {
+    for (auto objects = Pop(); !objects.empty(); objects = Pop()) {
+      if (objects.size() == 1 || !UseBatch()) {
+        DeleteOneByOne(objects);
+        continue;
+      }
+      auto statuses = delete_batch_(objects);
+      if (!statuses) {
+        auto const code = statuses.status().code();
+        if (code == StatusCode::kUnimplemented ||
+            code == StatusCode::kNotFound) {
+          // The service does not support batch requests, stop using them.
+          DisableBatch();
+          DeleteOneByOne(objects);
+          continue;
+        }
+        for (auto const& object : objects) {
+          Record(object, statuses.status());
+        }
+        continue;
+      }
+      for (std::size_t i = 0; i != objects.size(); ++i) {
+        Record(objects[i], i < statuses->size()
+                               ? (*statuses)[i]
+                               : Status(StatusCode::kUnknown,
+                                        "missing response in batch"));
+      }
+    }
+  }
+
+  DeleteByPrefixResult Result() && { return std::move(result_); }
+
+ private:
+  /// Returns the next group of objects to delete, empty when all are done.
+  std::vector<ObjectMetadata> Pop() {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return !queue_.empty() || listing_done_; });
+    if (queue_.empty()) {
+      return {};
+    }
+    auto objects = std::move(queue_.front());
+    queue_.pop_front();
+    lk.unlock();
+    cv_.notify_all();
+    return objects;
+  }
+
+  void DeleteOneByOne(std::vector<ObjectMetadata> const& objects) {
+    for (auto const& object : objects) {
+      Record(object, delete_one_(object));
+    }
+  }
+
+  void Record(ObjectMetadata const& object, Status status) {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (status.ok()) {
+      ++result_.deleted_count;
+      return;
+    }
+    result_.failures.push_back(DeleteByPrefixFailure{
+        object.name(), object.generation(), std::move(status)});
+  }
+
+  bool UseBatch() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return use_batch_;
+  }
+
+  void DisableBatch() {
+    std::lock_guard<std::mutex> lk(mu_);
+    use_batch_ = false;
+  }
+
+  DeleteObjectFunction delete_one_;
+  DeleteObjectBatchFunction delete_batch_;
+  std::size_t const group_size_;
+  std::size_t const max_queued_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool use_batch_;                                 // GUARDED_BY(mu_)
+  std::deque<std::vector<ObjectMetadata>> queue_;  // GUARDED_BY(mu_)
+  bool listing_done_ = false;                      // GUARDED_BY(mu_)
+  DeleteByPrefixResult result_;                    // GUARDED_BY(mu_)
+};
+}  // namespace
+
+DeleteByPrefixResult ParallelDeleteByPrefixImpl(
+    ListObjectsReader reader, std::size_t concurrency,
+    DeleteObjectFunction delete_one, DeleteObjectBatchFunction delete_batch) {
+  concurrency = std::max(concurrency, std::size_t{1});
+  ParallelDeleteState state(concurrency, std::move(delete_one),
+                            std::move(delete_batch));
+  std::vector<std::thread> workers;
+  workers.reserve(concurrency);
+  for (std::size_t i = 0; i != concurrency; ++i) {
+    workers.emplace_back([&state] { state.Worker(); });
+  }
+  // Listing happens in this thread, the library fetches the next page of
+  // results while the workers delete the groups already queued.
+  Status list_status;
+  std::vector<ObjectMetadata> group;
+  for (auto& object : reader) {
+    if (!object) {
+      list_status = std::move(object).status();
+      break;
+    }
+    group.push_back(*std::move(object));
+    if (group.size() == state.group_size()) {
+      state.Push(std::move(group));
+      group = {};
+    }
+  }
+  if (!group.empty()) {
+    state.Push(std::move(group));
+  }
+  state.ListingDone(std::move(list_status));
+  for (auto& t : workers) {
+    t.join();
+  }
+  return std::move(state).Result();
+}
+
 }  // namespace internal
 
 }  // namespace STORAGE_CLIENT_NS
@@ -15,12 +15,20 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_H
 
+#include "google/cloud/future.h"
 #include "google/cloud/internal/disjunction.h"
+#include "google/cloud/internal/make_unique.h"
 #include "google/cloud/internal/throw_delegate.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
+#include "google/cloud/storage/batch.h"
+#include "google/cloud/storage/block_cache_counters.h"
+#include "google/cloud/storage/hedging_policy.h"
 #include "google/cloud/storage/hmac_key_metadata.h"
+#include "google/cloud/storage/internal/block_cache_client.h"
 #include "google/cloud/storage/internal/logging_client.h"
+#include "google/cloud/storage/internal/metadata_cache_client.h"
+#include "google/cloud/storage/internal/parallel_list_objects.h"
 #include "google/cloud/storage/internal/parameter_pack_validation.h"
 #include "google/cloud/storage/internal/policy_document_request.h"
 #include "google/cloud/storage/internal/retry_client.h"
@@ -29,6 +37,7 @@
 #include "google/cloud/storage/list_buckets_reader.h"
 #include "google/cloud/storage/list_hmac_keys_reader.h"
 #include "google/cloud/storage/list_objects_reader.h"
+#include "google/cloud/storage/metadata_cache_counters.h"
 #include "google/cloud/storage/notification_event_type.h"
 #include "google/cloud/storage/notification_payload_format.h"
 #include "google/cloud/storage/oauth2/google_credentials.h"
@@ -37,6 +46,8 @@
 #include "google/cloud/storage/retry_policy.h"
 #include "google/cloud/storage/upload_options.h"
 #include "google/cloud/storage/version.h"
+#include <atomic>
+#include <future>
 #include <type_traits>
 
 namespace google {
@@ -179,6 +190,12 @@ class ResumableParallelUploadState;
  *
  * @see `AlwaysRetryIdempotencyPolicy` and `StrictIdempotencyPolicy` for
  * alternative idempotency policies.
+ *
+ * @see `HedgingPolicy` to send duplicate requests when idempotent reads are
+ * slow.
+ *
+ * @see `RetryBudget` and `CircuitBreakerPolicy` to limit retries across all
+ * the requests during an outage.
  */
 class Client {
  public:
@@ -247,6 +264,24 @@ class Client {
     return raw_client_;
   }
 
+  /**
+   * The counters for the client-side block cache.
+   *
+   * Returns all zeros if the cache is disabled.
+   *
+   * @see `ClientOptions::set_block_cache_size()` to enable the cache.
+   */
+  BlockCacheCounters block_cache_counters() const;
+
+  /**
+   * The counters for the client-side metadata cache.
+   *
+   * Returns all zeros if the cache is disabled.
+   *
+   * @see `ClientOptions::set_metadata_cache_ttl()` to enable the cache.
+   */
+  MetadataCacheCounters metadata_cache_counters() const;
+
   //@{
   /**
    * @name Bucket operations.
@@ -279,10 +314,12 @@ class Client {
     internal::ListBucketsRequest request(project_id);
     request.set_multiple_options(std::forward<Options>(options)...);
     auto client = raw_client_;
-    return ListBucketsReader(request,
-                             [client](internal::ListBucketsRequest const& r) {
-                               return client->ListBuckets(r);
-                             });
+    return ListBucketsReader(
+        request,
+        [client](internal::ListBucketsRequest const& r) {
+          return client->ListBuckets(r);
+        },
+        client->client_options().enable_list_prefetch());
   }
 
   /**
@@ -899,6 +936,41 @@ class Client {
     return raw_client_->InsertObjectMedia(request);
   }
 
+  /**
+   * Creates an object given its name and a reference to its contents.
+   *
+   * This overload does not copy the contents, they are sent directly from the
+   * application buffer. The buffer must remain valid until the function
+   * returns.
+   *
+   * @param bucket_name the name of the bucket that will contain the object.
+   * @param object_name the name of the object to be created.
+   * @param data the contents (media) for the new object.
+   * @param size the number of bytes in @p data.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include `ContentEncoding`,
+   *     `ContentType`, `Crc32cChecksumValue`, `DisableCrc32cChecksum`,
+   *     `DisableMD5Hash`, `EncryptionKey`, `IfGenerationMatch`,
+   *     `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+   *     `IfMetagenerationNotMatch`, `KmsKeyName`, `MD5HashValue`,
+   *     `PredefinedAcl`, `Projection`, `UserProject`, and `WithObjectMetadata`.
+   *
+   * @par Idempotency
+   * This operation is only idempotent if restricted by pre-conditions, in this
+   * case, `IfGenerationMatch`.
+   */
+  template <typename... Options>
+  StatusOr<ObjectMetadata> InsertObject(std::string const& bucket_name,
+                                        std::string const& object_name,
+                                        char const* data, std::size_t size,
+                                        Options&&... options) {
+    internal::InsertObjectMediaRequest request(bucket_name, object_name,
+                                               std::string{});
+    request.set_contents_view(data, size);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return raw_client_->InsertObjectMedia(request);
+  }
+
   /**
    * Copies an existing object.
    *
@@ -998,10 +1070,57 @@ class Client {
     internal::ListObjectsRequest request(bucket_name);
     request.set_multiple_options(std::forward<Options>(options)...);
     auto client = raw_client_;
-    return ListObjectsReader(request,
-                             [client](internal::ListObjectsRequest const& r) {
-                               return client->ListObjects(r);
-                             });
+    return ListObjectsReader(
+        request,
+        [client](internal::ListObjectsRequest const& r) {
+          return client->ListObjects(r);
+        },
+        client->client_options().enable_list_prefetch());
+  }
+
+  /**
+   * Lists the objects in a bucket, walking the pseudo-directories in parallel.
+   *
+   * `ListObjects()` fetches one page at a time, and each page depends on the
+   * token returned with the previous one, which makes listing buckets with
+   * hundreds of millions of objects very slow. This function lists the bucket
+   * using a delimiter (`/` unless the `Delimiter` option is provided), and
+   * lists each pseudo-directory found that way as a separate task. Up to
+   * @p concurrency tasks run at the same time.
+   *
+   * @p callback is invoked once for each object, from multiple threads and in
+   * no particular order, it must be thread-safe.
+   *
+   * @param bucket_name the name of the bucket to list.
+   * @param concurrency the maximum number of listing requests in flight.
+   * @param callback the function invoked with each object.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include `UserProject`, `Projection`,
+   *     `Prefix`, `Delimiter`, `MaxResults`, and `Versions`.
+   *
+   * @return the first error returned by the service, after an error no new
+   *     tasks are started and some objects may not be reported.
+   *
+   * @par Idempotency
+   * This is a read-only operation and is always idempotent.
+   */
+  template <typename... Options>
+  Status ParallelListObjects(std::string const& bucket_name,
+                             std::size_t concurrency,
+                             std::function<void(ObjectMetadata)> callback,
+                             Options&&... options) {
+    internal::ListObjectsRequest request(bucket_name);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    if (!request.HasOption<Delimiter>()) {
+      request.set_option(Delimiter("/"));
+    }
+    auto client = raw_client_;
+    return internal::ParallelListObjects(
+        request,
+        [client](internal::ListObjectsRequest const& r) {
+          return client->ListObjects(r);
+        },
+        concurrency, callback);
   }
 
   /**
@@ -1528,6 +1647,93 @@ class Client {
   }
   //@}
 
+  //@{
+  /**
+   * @name Asynchronous object operations
+   *
+   * These functions start the operation and return immediately, the returned
+   * future is satisfied when the operation completes. The transfers for all
+   * the asynchronous operations in the process share a single background
+   * thread, so applications can keep many operations in flight without
+   * dedicating a thread to each one. Failures are retried using the client's
+   * retry, backoff, and idempotency policies, the backoff between attempts does
+   * not block any thread.
+   *
+   * The futures are satisfied in the background thread. Continuations attached
+   * with `.then()` run in that thread, they should not block, and they should
+   * not wait on other futures returned by these functions.
+   */
+  /**
+   * Creates an object given its name and contents, asynchronously.
+   *
+   * @param bucket_name the name of the bucket that will contain the object.
+   * @param object_name the name of the object to be created.
+   * @param contents the contents (media) for the new object.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include the same types as
+   *     `InsertObject()`.
+   *
+   * @par Idempotency
+   * This operation is only idempotent if restricted by pre-conditions, in this
+   * case, `IfGenerationMatch`.
+   */
+  template <typename... Options>
+  future<StatusOr<ObjectMetadata>> AsyncInsertObject(
+      std::string const& bucket_name, std::string const& object_name,
+      std::string contents, Options&&... options) {
+    internal::InsertObjectMediaRequest request(bucket_name, object_name,
+                                               std::move(contents));
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return raw_client_->AsyncInsertObjectMedia(request);
+  }
+
+  /**
+   * Fetches the object metadata, asynchronously.
+   *
+   * @param bucket_name the bucket containing the object.
+   * @param object_name the object name.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include the same types as
+   *     `GetObjectMetadata()`.
+   *
+   * @par Idempotency
+   * This is a read-only operation and is always idempotent.
+   */
+  template <typename... Options>
+  future<StatusOr<ObjectMetadata>> AsyncGetObjectMetadata(
+      std::string const& bucket_name, std::string const& object_name,
+      Options&&... options) {
+    internal::GetObjectMetadataRequest request(bucket_name, object_name);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return raw_client_->AsyncGetObjectMetadata(request);
+  }
+
+  /**
+   * Reads the contents of an object into memory, asynchronously.
+   *
+   * Unlike `ReadObject()` the contents are not streamed, the future is
+   * satisfied once the full object (or range) is downloaded. Use this function
+   * for small objects, or for bounded ranges of large objects.
+   *
+   * @param bucket_name the name of the bucket that contains the object.
+   * @param object_name the name of the object to be read.
+   * @param options a list of optional query parameters and/or request headers.
+   *     Valid types for this operation include the same types as
+   *     `ReadObject()`.
+   *
+   * @par Idempotency
+   * This is a read-only operation and is always idempotent.
+   */
+  template <typename... Options>
+  future<StatusOr<std::string>> AsyncReadObject(std::string const& bucket_name,
+                                                std::string const& object_name,
+                                                Options&&... options) {
+    internal::ReadObjectRangeRequest request(bucket_name, object_name);
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return raw_client_->AsyncReadObject(request);
+  }
+  //@}
+
   //@{
   /**
    * @name Bucket Access Control List operations.
@@ -2072,6 +2278,18 @@ class Client {
   }
   //@}
 
+  /**
+   * Creates a batch to send many object operations in a few HTTP requests.
+   *
+   * Deleting, patching, or changing the ACL of many objects using one HTTP
+   * request per object is dominated by the per-request overhead. The returned
+   * `Batch` sends these operations to the batch endpoint, with up to 100
+   * operations in each HTTP request.
+   *
+   * @see `Batch` for more details and an example.
+   */
+  Batch CreateBatch() { return Batch(raw_client_); }
+
   //@{
   /**
    * @name Bucket Default Object Access Control List operations.
@@ -2468,10 +2686,12 @@ class Client {
     internal::ListHmacKeysRequest request(project_id);
     request.set_multiple_options(std::forward<Options>(options)...);
     auto client = raw_client_;
-    return ListHmacKeysReader(request,
-                              [client](internal::ListHmacKeysRequest const& r) {
-                                return client->ListHmacKeys(r);
-                              });
+    return ListHmacKeysReader(
+        request,
+        [client](internal::ListHmacKeysRequest const& r) {
+          return client->ListHmacKeys(r);
+        },
+        client->client_options().enable_list_prefetch());
   }
 
   /**
@@ -2764,6 +2984,40 @@ class Client {
     request.set_multiple_options(std::forward<Options>(options)...);
     return SignUrlV4(std::move(request));
   }
+
+  /**
+   * Create V4 signed URLs for many objects in the same bucket.
+   *
+   * This is equivalent to calling `CreateV4SignedUrl()` once for each element
+   * of @p object_names, with the same @p verb and @p options, but it is much
+   * faster when signing large numbers of URLs. The signatures are computed by
+   * up to @p concurrency threads, and the state needed to build each URL is
+   * created once and reused.
+   *
+   * All the URLs share the same timestamp, the value of `SignedUrlTimestamp`
+   * if present, or the time when this function is called.
+   *
+   * @param verb the operation allowed through the signed URLs.
+   * @param bucket_name the name of the bucket.
+   * @param object_names the names of the objects.
+   * @param concurrency the maximum number of threads used to sign the URLs.
+   * @param options a list of optional parameters for the signed URLs, with
+   *     the same semantics as in `CreateV4SignedUrl()`.
+   *
+   * @return the signed URLs, or the error signing each URL, in the same order
+   *     as @p object_names.
+   */
+  template <typename... Options>
+  std::vector<StatusOr<std::string>> CreateV4SignedUrls(
+      std::string verb, std::string bucket_name,
+      std::vector<std::string> object_names, std::size_t concurrency,
+      Options&&... options) {
+    internal::V4SignUrlRequest request(std::move(verb), std::move(bucket_name),
+                                       std::string{});
+    request.set_multiple_options(std::forward<Options>(options)...);
+    return SignUrlsV4(std::move(request), std::move(object_names),
+                      concurrency);
+  }
   //@}
 
   /**
@@ -2971,8 +3225,25 @@ class Client {
     if (client->client_options().enable_raw_client_tracing()) {
       client = std::make_shared<internal::LoggingClient>(std::move(client));
     }
-    auto retry = std::make_shared<internal::RetryClient>(
-        std::move(client), std::forward<Policies>(policies)...);
+    auto const& options = client->client_options();
+    if (options.block_cache_size() != 0) {
+      auto cache = std::make_shared<internal::ObjectBlockCache>(
+          options.block_cache_size(), options.block_cache_spill_directory(),
+          options.block_cache_spill_size());
+      client = std::make_shared<internal::BlockCacheClient>(
+          std::move(client), std::move(cache),
+          options.block_cache_block_size());
+    }
+    std::shared_ptr<internal::RawClient> retry =
+        std::make_shared<internal::RetryClient>(
+            std::move(client), std::forward<Policies>(policies)...);
+    if (options.metadata_cache_ttl().count() != 0) {
+      // Cache hits should not pay for the retry loop, so the metadata cache
+      // wraps the retry decorator.
+      return std::make_shared<internal::MetadataCacheClient>(
+          std::move(retry), options.metadata_cache_ttl(),
+          options.metadata_cache_max_entries());
+    }
     return retry;
   }
 
@@ -3046,6 +3317,14 @@ class Client {
 
   StatusOr<std::string> SignUrlV2(internal::V2SignUrlRequest const& request);
   StatusOr<std::string> SignUrlV4(internal::V4SignUrlRequest request);
+  std::vector<StatusOr<std::string>> SignUrlsV4(
+      internal::V4SignUrlRequest request, std::vector<std::string> object_names,
+      std::size_t concurrency);
+  /// Sign a URL for @p request, reusing @p curl and @p buffer.
+  StatusOr<std::string> SignUrlV4Impl(internal::V4SignUrlRequest const& request,
+                                      std::string const& signing_email,
+                                      internal::CurlHandle& curl,
+                                      std::string& buffer);
 
   StatusOr<PolicyDocumentResult> SignPolicyDocument(
       internal::PolicyDocumentRequest const& request);
@@ -3088,6 +3367,18 @@ struct DeleteApplyHelper {
   std::string object_name;
 };
 
+// Just a wrapper to allow for use in `google::cloud::internal::apply`.
+struct BatchDeleteApplyHelper {
+  template <typename... Options>
+  future<Status> operator()(Options... options) const {
+    return batch.DeleteObject(bucket_name, object_name, std::move(options)...);
+  }
+
+  Batch& batch;
+  std::string bucket_name;
+  std::string object_name;
+};
+
 // Just a wrapper to allow for using in `google::cloud::internal::apply`.
 struct InsertObjectApplyHelper {
   template <typename... Options>
@@ -3177,6 +3468,144 @@ Status DeleteByPrefix(Client& client, std::string const& bucket_name,
   return Status();
 }
 
+/// An object that `ParallelDeleteByPrefix()` could not delete.
+struct DeleteByPrefixFailure {
+  std::string object_name;
+  std::int64_t generation;
+  Status status;
+};
+
+/// The result of a `ParallelDeleteByPrefix()` operation.
+struct DeleteByPrefixResult {
+  /// The number of objects successfully deleted.
+  std::int64_t deleted_count = 0;
+  /// The objects that could not be deleted, in no particular order.
+  std::vector<DeleteByPrefixFailure> failures;
+  /// The error that stopped the listing of objects, if any.
+  Status list_status;
+
+  /// Returns true if all the objects were listed and deleted.
+  bool ok() const { return failures.empty() && list_status.ok(); }
+};
+
+namespace internal {
+/// Deletes a single object on behalf of `ParallelDeleteByPrefix()`.
+using DeleteObjectFunction = std::function<Status(ObjectMetadata const&)>;
+
+/**
+ * Deletes a group of objects using a single batch request.
+ *
+ * Returns the status of each deletion, or the error that prevented the batch
+ * from executing.
+ */
+using DeleteObjectBatchFunction = std::function<StatusOr<std::vector<Status>>(
+    std::vector<ObjectMetadata> const&)>;
+
+/**
+ * Implements `ParallelDeleteByPrefix()`.
+ *
+ * The calling thread iterates over @p reader and feeds the objects to
+ * @p concurrency worker threads. If @p delete_batch is not empty the workers
+ * delete groups of objects with it, otherwise they call @p delete_one for each
+ * object.
+ */
+DeleteByPrefixResult ParallelDeleteByPrefixImpl(
+    ListObjectsReader reader, std::size_t concurrency,
+    DeleteObjectFunction delete_one, DeleteObjectBatchFunction delete_batch);
+}  // namespace internal
+
+/**
+ * Delete objects whose names match a given prefix, using multiple threads.
+ *
+ * Contrary to `DeleteByPrefix()`, this function deletes up to @p concurrency
+ * objects (or batches of objects) at a time, and lists the next page of
+ * results while the current page is being deleted. Failures to delete an
+ * individual object do not stop the operation, they are returned in the
+ * `failures` field of the result.
+ *
+ * If @p use_batch is true the objects are deleted in groups of up to 100
+ * objects, each group sent as a single batch request. If the service does not
+ * support batch requests the function falls back to deleting one object at a
+ * time.
+ *
+ * Objects are deleted only if their generation has not changed since they were
+ * listed.
+ *
+ * @param client the client on which to perform the operation.
+ * @param bucket_name the name of the bucket that contains the objects.
+ * @param prefix the prefix of the objects to be deleted.
+ * @param concurrency the maximum number of deletions (or batches) in flight.
+ * @param use_batch if true, delete the objects using batch requests.
+ * @param options a list of optional query parameters and/or request headers.
+ *     Valid types for this operation include `QuotaUser`, `UserIp`,
+ *     `UserProject` and `Versions`.
+ */
+template <typename... Options>
+DeleteByPrefixResult ParallelDeleteByPrefix(Client& client,
+                                            std::string const& bucket_name,
+                                            std::string const& prefix,
+                                            std::size_t concurrency,
+                                            bool use_batch,
+                                            Options&&... options) {
+  using internal::NotAmong;
+  using internal::StaticTupleFilter;
+
+  auto all_options = std::tie(options...);
+
+  static_assert(
+      std::tuple_size<decltype(
+              StaticTupleFilter<
+                  NotAmong<QuotaUser, UserIp, UserProject, Versions>::TPred>(
+                  all_options))>::value == 0,
+      "This functions accepts only options of type QuotaUser, UserIp, "
+      "UserProject or Versions.");
+  // The worker threads finish before this function returns, it is safe for
+  // them to use references to the options.
+  auto delete_options =
+      StaticTupleFilter<NotAmong<Versions>::TPred>(all_options);
+  internal::DeleteObjectFunction delete_one =
+      [&client, &bucket_name, &delete_options](ObjectMetadata const& object) {
+        return google::cloud::internal::apply(
+            internal::DeleteApplyHelper{client, bucket_name, object.name()},
+            std::tuple_cat(
+                std::make_tuple(IfGenerationMatch(object.generation())),
+                delete_options));
+      };
+  internal::DeleteObjectBatchFunction delete_batch;
+  if (use_batch) {
+    delete_batch = [&client, &bucket_name, &delete_options](
+                       std::vector<ObjectMetadata> const& objects)
+        -> StatusOr<std::vector<Status>> {
+      auto batch = client.CreateBatch();
+      std::vector<future<Status>> pending;
+      pending.reserve(objects.size());
+      for (auto const& object : objects) {
+        pending.push_back(google::cloud::internal::apply(
+            internal::BatchDeleteApplyHelper{batch, bucket_name,
+                                             object.name()},
+            std::tuple_cat(
+                std::make_tuple(IfGenerationMatch(object.generation())),
+                delete_options)));
+      }
+      auto status = batch.Execute();
+      if (!status.ok()) {
+        return status;
+      }
+      std::vector<Status> result;
+      result.reserve(pending.size());
+      for (auto& p : pending) {
+        result.push_back(p.get());
+      }
+      return result;
+    };
+  }
+
+  return internal::ParallelDeleteByPrefixImpl(
+      client.ListObjects(bucket_name, Projection::NoAcl(), Prefix(prefix),
+                         options...),
+      concurrency, std::move(delete_one), std::move(delete_batch));
+}
+
 namespace internal {
 
 // Just a wrapper to allow for use in `google::cloud::internal::apply`.
@@ -3223,6 +3652,19 @@ class ScopedDeleter {
 
 }  // namespace internal
 
+/**
+ * A parameter type indicating the maximum number of concurrent
+ * `Client::ComposeObject` calls issued by `ComposeMany`.
+ */
+class MaxParallelCompositions {
+ public:
+  MaxParallelCompositions(std::size_t value) : value_(value) {}
+  std::size_t value() const { return value_; }
+
+ private:
+  std::size_t value_;
+};
+
 /**
  * Compose existing objects into a new object in the same bucket.
  *
@@ -3240,6 +3682,11 @@ class ScopedDeleter {
  * DeleteByPrefix()). We recommend using CreateRandomPrefixName() for selecting
  * a random prefix within a bucket.
  *
+ * The intermediate objects form a tree, the `Client::ComposeObject` calls for
+ * each level of the tree run concurrently, up to the limit set by the
+ * `MaxParallelCompositions` option. Intermediate objects that are no longer
+ * needed are deleted while the next level of the tree is composed.
+ *
  * @param client the client on which to perform the operations needed by this
  *     function
  * @param bucket_name the name of the bucket used for source object and
@@ -3255,8 +3702,8 @@ class ScopedDeleter {
  * @param options a list of optional query parameters and/or request headers.
  *     Valid types for this operation include `DestinationPredefinedAcl`,
  *     `EncryptionKey`, `IfGenerationMatch`, `IfMetagenerationMatch`
- *     `KmsKeyName`, `QuotaUser`, `UserIp`, `UserProject` and
- *     `WithObjectMetadata`.
+ *     `KmsKeyName`, `MaxParallelCompositions`, `QuotaUser`, `UserIp`,
+ *     `UserProject` and `WithObjectMetadata`.
  *
  * @par Idempotency
  * This operation is not idempotent. While each request performed by this
@@ -3276,6 +3723,7 @@ StatusOr<ObjectMetadata> ComposeMany(
   using internal::NotAmong;
   using internal::StaticTupleFilter;
   std::size_t const max_num_objects = 32;
+  std::size_t const default_parallel_compositions = 16;
 
   if (source_objects.empty()) {
     return Status(StatusCode::kInvalidArgument,
@@ -3289,22 +3737,33 @@ StatusOr<ObjectMetadata> ComposeMany(
       std::tuple_size<decltype(
               StaticTupleFilter<NotAmong<
                   DestinationPredefinedAcl, EncryptionKey, IfGenerationMatch,
-                  IfMetagenerationMatch, KmsKeyName, QuotaUser, UserIp,
-                  UserProject, WithObjectMetadata>::TPred>(
+                  IfMetagenerationMatch, KmsKeyName, MaxParallelCompositions,
+                  QuotaUser, UserIp, UserProject, WithObjectMetadata>::TPred>(
                   all_options))>::value == 0,
       "This functions accepts only options of type DestinationPredefinedAcl, "
       "EncryptionKey, IfGenerationMatch, IfMetagenerationMatch, KmsKeyName, "
-      "QuotaUser, UserIp, UserProject or WithObjectMetadata.");
-
-  internal::ScopedDeleter deleter(
-      [&](std::string const& object_name, std::int64_t generation) {
-        return google::cloud::internal::apply(
-            internal::DeleteApplyHelper{client, bucket_name, object_name},
-            std::tuple_cat(
-                std::make_tuple(IfGenerationMatch(generation)),
-                StaticTupleFilter<Among<QuotaUser, UserProject, UserIp>::TPred>(
-                    all_options)));
-      });
+      "MaxParallelCompositions, QuotaUser, UserIp, UserProject or "
+      "WithObjectMetadata.");
+
+  auto const max_parallel_compositions = std::max<std::size_t>(
+      internal::ExtractFirstOccurenceOfType<MaxParallelCompositions>(
+          all_options)
+          .value_or(default_parallel_compositions)
+          .value(),
+      1);
+  auto compose_options =
+      StaticTupleFilter<NotAmong<MaxParallelCompositions>::TPred>(all_options);
+
+  auto delete_object = [&](std::string const& object_name,
+                           std::int64_t generation) {
+    return google::cloud::internal::apply(
+        internal::DeleteApplyHelper{client, bucket_name, object_name},
+        std::tuple_cat(
+            std::make_tuple(IfGenerationMatch(generation)),
+            StaticTupleFilter<Among<QuotaUser, UserProject, UserIp>::TPred>(
+                all_options)));
+  };
+  internal::ScopedDeleter deleter(delete_object);
 
   auto lock = internal::LockPrefix(client, bucket_name, prefix, "",
                                    std::make_tuple(options...));
@@ -3329,27 +3788,43 @@ StatusOr<ObjectMetadata> ComposeMany(
     return sources;
   };
 
-  auto composer = [&](std::vector<ComposeSourceObject> compose_range,
-                      bool is_final) -> StatusOr<ObjectMetadata> {
-    if (is_final) {
-      return google::cloud::internal::apply(
-          internal::ComposeApplyHelper{client, bucket_name,
-                                       std::move(compose_range),
-                                       std::move(destination_object_name)},
-          std::tuple_cat(std::make_tuple(IfGenerationMatch(0)), all_options));
-    }
+  auto compose_final = [&](std::vector<ComposeSourceObject> compose_range) {
+    return google::cloud::internal::apply(
+        internal::ComposeApplyHelper{client, bucket_name,
+                                     std::move(compose_range),
+                                     std::move(destination_object_name)},
+        std::tuple_cat(std::make_tuple(IfGenerationMatch(0)),
+                       compose_options));
+  };
+
+  auto compose_tmp = [&](std::vector<ComposeSourceObject> compose_range,
+                         std::string tmp_object_name) {
     return google::cloud::internal::apply(
         internal::ComposeApplyHelper{client, bucket_name,
                                      std::move(compose_range),
-                                     tmpobject_name_gen()},
+                                     std::move(tmp_object_name)},
         StaticTupleFilter<
             NotAmong<IfGenerationMatch, IfMetagenerationMatch>::TPred>(
-            all_options));
+            compose_options));
   };
 
-  auto reduce = [&](std::vector<ComposeSourceObject> source_objects)
+  // Compose one level of the tree, the objects created are added to
+  // `level_deleter`.
+  auto reduce = [&](std::vector<ComposeSourceObject> source_objects,
+                    internal::ScopedDeleter& level_deleter)
       -> StatusOr<std::vector<ObjectMetadata>> {
-    std::vector<ObjectMetadata> objects;
+    if (source_objects.size() <= max_num_objects) {
+      auto object = compose_final(std::move(source_objects));
+      if (!object) {
+        return std::move(object).status();
+      }
+      return std::vector<ObjectMetadata>{*std::move(object)};
+    }
+
+    // The temporary object names are assigned before any request starts, so
+    // they do not depend on the order in which the requests complete.
+    std::vector<std::vector<ComposeSourceObject>> ranges;
+    std::vector<std::string> names;
     for (auto range_begin = source_objects.begin();
          range_begin != source_objects.end();) {
       std::size_t range_size = std::min<std::size_t>(
@@ -3357,30 +3832,93 @@ StatusOr<ObjectMetadata> ComposeMany(
       auto range_end = std::next(range_begin, range_size);
       std::vector<ComposeSourceObject> compose_range(range_size);
       std::move(range_begin, range_end, compose_range.begin());
+      ranges.push_back(std::move(compose_range));
+      names.push_back(tmpobject_name_gen());
+      range_begin = range_end;
+    }
 
-      bool const is_final_composition =
-          source_objects.size() <= max_num_objects;
-      auto object = composer(std::move(compose_range), is_final_composition);
-      if (!object) {
-        return std::move(object).status();
+    std::vector<StatusOr<ObjectMetadata>> results(ranges.size());
+    std::atomic<std::size_t> next_range(0);
+    auto worker = [&] {
+      for (auto i = next_range++; i < ranges.size(); i = next_range++) {
+        results[i] = compose_tmp(std::move(ranges[i]), std::move(names[i]));
       }
-      objects.push_back(*std::move(object));
-      if (!is_final_composition) {
-        deleter.Add(objects.back());
+    };
+    std::vector<std::future<void>> workers;
+    auto const worker_count =
+        std::min<std::size_t>(max_parallel_compositions, ranges.size());
+    for (std::size_t i = 1; i < worker_count; ++i) {
+      workers.push_back(std::async(std::launch::async, worker));
+    }
+    worker();
+    for (auto& w : workers) {
+      w.get();
+    }
+
+    // Every object created must be cleaned up, even if some compositions in
+    // this level failed.
+    Status status;
+    std::vector<ObjectMetadata> objects;
+    for (auto& r : results) {
+      if (!r) {
+        if (status.ok()) {
+          status = std::move(r).status();
+        }
+        continue;
       }
-      range_begin = range_end;
+      level_deleter.Add(*r);
+      objects.push_back(*std::move(r));
+    }
+    if (!status.ok()) {
+      return status;
     }
     return objects;
   };
 
+  // The intermediate objects of a level are deleted in the background once the
+  // next level is composed, unless that level is the last one with temporary
+  // objects, those remain in `deleter`. On errors the destructors of these
+  // variables wait for the pending deletions and then remove the remaining
+  // objects, the lock object is removed last.
+  std::vector<std::future<Status>> pending_deletions;
+  std::unique_ptr<internal::ScopedDeleter> consumed_level;
+
   StatusOr<ObjectMetadata> result;
   do {
-    StatusOr<std::vector<ObjectMetadata>> objects = reduce(source_objects);
+    auto const output_count =
+        (source_objects.size() + max_num_objects - 1) / max_num_objects;
+    std::unique_ptr<internal::ScopedDeleter> level_deleter;
+    if (output_count > max_num_objects) {
+      level_deleter = google::cloud::internal::make_unique<
+          internal::ScopedDeleter>(delete_object);
+    }
+    StatusOr<std::vector<ObjectMetadata>> objects =
+        reduce(source_objects, level_deleter ? *level_deleter : deleter);
     if (!objects) {
       return objects.status();
     }
+    if (consumed_level) {
+      pending_deletions.push_back(std::async(
+          std::launch::async,
+          [](std::unique_ptr<internal::ScopedDeleter> d) {
+            return d->ExecuteDelete();
+          },
+          std::move(consumed_level)));
+    }
+    consumed_level = std::move(level_deleter);
     if (objects->size() == 1) {
+      Status cleanup_status;
+      for (auto& d : pending_deletions) {
+        auto s = d.get();
+        if (!s.ok() && cleanup_status.ok()) {
+          cleanup_status = std::move(s);
+        }
+      }
+      pending_deletions.clear();
       if (!ignore_cleanup_failures) {
+        if (!cleanup_status.ok()) {
+          return cleanup_status;
+        }
         auto delete_status = deleter.ExecuteDelete();
         if (!delete_status.ok()) {
           return delete_status;
@@ -0,0 +1,166 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
+#include "google/cloud/storage/retry_policy.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::google::cloud::storage::testing::canonical_errors::TransientError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::ReturnRef;
+
+/**
+ * Test the Batch-related functions in storage::Client.
+ */
+class BatchTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mock = std::make_shared<testing::MockClient>();
+    EXPECT_CALL(*mock, client_options())
+        .WillRepeatedly(ReturnRef(client_options));
+    client.reset(new Client{
+        std::shared_ptr<internal::RawClient>(mock),
+        ExponentialBackoffPolicy(std::chrono::milliseconds(1),
+                                 std::chrono::milliseconds(1), 2.0)});
+  }
+  void TearDown() override {
+    client.reset();
+    mock.reset();
+  }
+
+  std::shared_ptr<testing::MockClient> mock;
+  std::unique_ptr<Client> client;
+  ClientOptions client_options =
+      ClientOptions(oauth2::CreateAnonymousCredentials());
+};
+
+/// Returns the same @p response for each sub-request.
+internal::BatchResponse MakeResponse(internal::BatchRequest const& request,
+                                     internal::HttpResponse const& response) {
+  internal::BatchResponse result;
+  result.responses.assign(request.size(), response);
+  return result;
+}
+
+TEST_F(BatchTest, SplitsLargeBatches) {
+  std::vector<std::size_t> sizes;
+  EXPECT_CALL(*mock, ExecuteBatch(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([&sizes](internal::BatchRequest const& r) {
+        sizes.push_back(r.size());
+        return make_status_or(MakeResponse(r, {204, "", {}}));
+      }));
+
+  auto batch = client->CreateBatch();
+  std::vector<future<Status>> results;
+  for (int i = 0; i != 150; ++i) {
+    results.push_back(
+        batch.DeleteObject("test-bucket", "object-" + std::to_string(i)));
+  }
+  EXPECT_EQ(150, batch.size());
+  ASSERT_STATUS_OK(batch.Execute());
+  EXPECT_EQ(0, batch.size());
+  EXPECT_EQ((std::vector<std::size_t>{100, 50}), sizes);
+  for (auto& r : results) {
+    EXPECT_STATUS_OK(r.get());
+  }
+}
+
+TEST_F(BatchTest, ParsesResults) {
+  EXPECT_CALL(*mock, ExecuteBatch(_))
+      .WillOnce(Invoke([](internal::BatchRequest const& r) {
+        EXPECT_EQ(3, r.size());
+        internal::BatchResponse response;
+        response.responses.emplace_back(internal::HttpResponse{
+            200, R"""({"bucket": "test-bucket", "name": "test-object"})""",
+            {}});
+        response.responses.emplace_back(internal::HttpResponse{
+            200, R"""({"entity": "user-a", "role": "READER"})""", {}});
+        response.responses.emplace_back(
+            internal::HttpResponse{404, "not found", {}});
+        return make_status_or(std::move(response));
+      }));
+
+  auto batch = client->CreateBatch();
+  auto patch = batch.PatchObject(
+      "test-bucket", "test-object",
+      ObjectMetadataPatchBuilder().SetContentType("text/plain"));
+  auto acl =
+      batch.CreateObjectAcl("test-bucket", "test-object", "user-a", "READER");
+  auto deleted = batch.DeleteObjectAcl("test-bucket", "test-object", "user-b");
+  ASSERT_STATUS_OK(batch.Execute());
+
+  auto metadata = patch.get();
+  ASSERT_STATUS_OK(metadata);
+  EXPECT_EQ("test-object", metadata->name());
+  auto entry = acl.get();
+  ASSERT_STATUS_OK(entry);
+  EXPECT_EQ("user-a", entry->entity());
+  EXPECT_EQ(StatusCode::kNotFound, deleted.get().code());
+}
+
+TEST_F(BatchTest, RetriesBatchFailures) {
+  EXPECT_CALL(*mock, ExecuteBatch(_))
+      .WillOnce(Invoke([](internal::BatchRequest const&) {
+        return StatusOr<internal::BatchResponse>(TransientError());
+      }))
+      .WillOnce(Invoke([](internal::BatchRequest const& r) {
+        return make_status_or(MakeResponse(r, {204, "", {}}));
+      }));
+
+  auto batch = client->CreateBatch();
+  auto deleted = batch.DeleteObject("test-bucket", "test-object");
+  ASSERT_STATUS_OK(batch.Execute());
+  EXPECT_STATUS_OK(deleted.get());
+}
+
+TEST_F(BatchTest, PermanentFailure) {
+  EXPECT_CALL(*mock, ExecuteBatch(_))
+      .WillOnce(Invoke([](internal::BatchRequest const&) {
+        return StatusOr<internal::BatchResponse>(PermanentError());
+      }));
+
+  auto batch = client->CreateBatch();
+  auto d0 = batch.DeleteObject("test-bucket", "object-0");
+  auto d1 = batch.DeleteObject("test-bucket", "object-1");
+  EXPECT_EQ(PermanentError().code(), batch.Execute().code());
+  EXPECT_EQ(PermanentError().code(), d0.get().code());
+  EXPECT_EQ(PermanentError().code(), d1.get().code());
+}
+
+TEST_F(BatchTest, DestructorCancels) {
+  EXPECT_CALL(*mock, ExecuteBatch(_)).Times(0);
+  future<Status> deleted;
+  {
+    auto batch = client->CreateBatch();
+    deleted = batch.DeleteObject("test-bucket", "test-object");
+  }
+  EXPECT_EQ(StatusCode::kCancelled, deleted.get().code());
+}
+
+}  // namespace
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
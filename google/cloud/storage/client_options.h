@@ -15,6 +15,7 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_OPTIONS_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_OPTIONS_H
 
+#include "google/cloud/storage/buffer_pool.h"
 #include "google/cloud/storage/oauth2/credentials.h"
 #include "google/cloud/storage/version.h"
 #include <memory>
@@ -182,6 +183,253 @@ class ClientOptions {
   }
   //@}
 
+  //@{
+  /**
+   * Control the number of background threads used to drive downloads.
+   *
+   * By default each download performs its I/O in the thread that reads from
+   * it, using its own set of libcurl resources. Applications with many
+   * concurrent downloads can set this to a small number, in which case these
+   * background threads perform the I/O for all the downloads created by the
+   * client, and the reading threads simply wait for data to arrive.
+   *
+   * The default value is 0, which disables the background threads.
+   */
+  std::size_t download_reactor_thread_count() const {
+    return download_reactor_thread_count_;
+  }
+  ClientOptions& set_download_reactor_thread_count(std::size_t v) {
+    download_reactor_thread_count_ = v;
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Control how many blocks each download reads ahead of the application.
+   *
+   * By default a download only requests more data from the service when the
+   * application has consumed all the data received so far, and the connection
+   * is idle while the application processes each block. With a non-zero value
+   * each `ObjectReadStream` uses a background thread to receive up to this
+   * many blocks of `download_buffer_size()` bytes before the application
+   * asks for them. This also bounds the memory used for the prefetched data,
+   * to `download_prefetch_depth() * download_buffer_size()` bytes per
+   * download.
+   *
+   * The default value is 0, which disables prefetching.
+   */
+  std::size_t download_prefetch_depth() const {
+    return download_prefetch_depth_;
+  }
+  ClientOptions& set_download_prefetch_depth(std::size_t v) {
+    download_prefetch_depth_ = v;
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Control how many chunks each upload sends in the background.
+   *
+   * By default an `ObjectWriteStream` uploads each chunk of
+   * `upload_buffer_size()` bytes as soon as it is full, and the application
+   * cannot write more data until the upload completes. With a non-zero value
+   * a background thread uploads the chunks, while the application fills the
+   * next buffer. Writes only block when this many chunks are already queued
+   * or being uploaded, so each upload uses up to
+   * `(upload_pipeline_depth() + 1) * upload_buffer_size()` bytes of memory.
+   *
+   * Errors are reported by the next write, or when the stream is closed. The
+   * `next_expected_byte()` and `resumable_session_id()` of a failed stream
+   * refer to the last data committed by the service, as usual.
+   *
+   * Pipelined uploads do not adapt their chunk size, the
+   * `enable_adaptive_upload_buffer_size()` option is ignored.
+   *
+   * The default value is 0, which disables pipelining.
+   */
+  std::size_t upload_pipeline_depth() const { return upload_pipeline_depth_; }
+  ClientOptions& set_upload_pipeline_depth(std::size_t v) {
+    upload_pipeline_depth_ = v;
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Adapt the size of the upload chunks to the observed network performance.
+   *
+   * By default `ObjectWriteStream` uploads chunks of `upload_buffer_size()`
+   * bytes. Small chunks waste round trips on fast networks, and large chunks
+   * waste memory on slow networks. When this option is enabled each stream
+   * starts with `upload_buffer_size()` bytes, estimates the throughput and
+   * latency of the previous chunks, and resizes its buffer so each request
+   * takes several round trips to complete. The chunk size is always a multiple
+   * of 256 KiB, between `minimum_upload_buffer_size()` and
+   * `maximum_upload_buffer_size()`.
+   *
+   * Use `ObjectWriteStream::upload_chunk_size()` to query the chunk size
+   * chosen by a stream. This option has no effect if `upload_pipeline_depth()`
+   * is not zero.
+   *
+   * The default value is `false`, the default bounds are 256 KiB and 64 MiB.
+   */
+  bool enable_adaptive_upload_buffer_size() const {
+    return enable_adaptive_upload_buffer_size_;
+  }
+  ClientOptions& set_enable_adaptive_upload_buffer_size(bool v) {
+    enable_adaptive_upload_buffer_size_ = v;
+    return *this;
+  }
+  std::size_t minimum_upload_buffer_size() const {
+    return minimum_upload_buffer_size_;
+  }
+  ClientOptions& set_minimum_upload_buffer_size(std::size_t v) {
+    minimum_upload_buffer_size_ = v;
+    return *this;
+  }
+  std::size_t maximum_upload_buffer_size() const {
+    return maximum_upload_buffer_size_;
+  }
+  ClientOptions& set_maximum_upload_buffer_size(std::size_t v) {
+    maximum_upload_buffer_size_ = v;
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Obtain the buffers of `ObjectReadStream` and `ObjectWriteStream` from a
+   * shared pool.
+   *
+   * The pool limits the memory used by the buffers of all the streams, and
+   * reuses the buffers of closed streams. Use the same pool with multiple
+   * clients to limit their combined memory usage. Streams that cannot obtain
+   * a buffer fail with `StatusCode::kResourceExhausted`.
+   *
+   * The default value is `nullptr`, where each stream allocates its own buffer.
+   *
+   * @see `BufferPool` for details.
+   */
+  std::shared_ptr<BufferPool> buffer_pool() const { return buffer_pool_; }
+  ClientOptions& set_buffer_pool(std::shared_ptr<BufferPool> v) {
+    buffer_pool_ = std::move(v);
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Control the client-side cache for ranged object reads.
+   *
+   * Applications that repeatedly read the same ranges of large objects (for
+   * example, the footers and index blocks of Parquet or SSTable files) can
+   * enable a cache of fixed-size blocks, keyed by bucket, object, generation,
+   * and block number. The cache is an LRU bounded to `block_cache_size()`
+   * bytes, and only serves reads using `ReadRange` or `ReadLast`. Reads
+   * pinned to a `Generation` are served without contacting the service, other
+   * reads first fetch the object metadata to find the current generation.
+   * Reads using customer-supplied encryption keys or pre-conditions are never
+   * cached.
+   *
+   * The default value for `block_cache_size()` is 0, which disables the
+   * cache.
+   */
+  std::size_t block_cache_size() const { return block_cache_size_; }
+  ClientOptions& set_block_cache_size(std::size_t v) {
+    block_cache_size_ = v;
+    return *this;
+  }
+
+  std::size_t block_cache_block_size() const {
+    return block_cache_block_size_;
+  }
+  ClientOptions& set_block_cache_block_size(std::size_t v) {
+    block_cache_block_size_ = v;
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Spill blocks evicted from the block cache to a local directory.
+   *
+   * When `block_cache_spill_directory()` is not empty, blocks evicted from
+   * the in-memory cache are saved to files in that directory, up to
+   * `block_cache_spill_size()` bytes, and moved back to memory when they are
+   * read again. The directory must exist. The files are removed when the
+   * cache is destroyed.
+   */
+  std::string const& block_cache_spill_directory() const {
+    return block_cache_spill_directory_;
+  }
+  ClientOptions& set_block_cache_spill_directory(std::string v) {
+    block_cache_spill_directory_ = std::move(v);
+    return *this;
+  }
+
+  std::size_t block_cache_spill_size() const { return block_cache_spill_size_; }
+  ClientOptions& set_block_cache_spill_size(std::size_t v) {
+    block_cache_spill_size_ = v;
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Control the client-side cache for object and bucket metadata.
+   *
+   * With a non-zero `metadata_cache_ttl()` the results of
+   * `Client::GetObjectMetadata()` and `Client::GetBucketMetadata()` are cached
+   * for that long, and concurrent identical requests share a single call to
+   * the service. Changes made through the same `Client` (and its copies)
+   * invalidate the affected entries, but changes made by other clients (or
+   * through resumable uploads) may go unnoticed until the entries expire.
+   *
+   * Each cache (objects and buckets) holds at most
+   * `metadata_cache_max_entries()` entries.
+   *
+   * The default value for `metadata_cache_ttl()` is 0, which disables the
+   * cache.
+   */
+  std::chrono::milliseconds metadata_cache_ttl() const {
+    return metadata_cache_ttl_;
+  }
+  ClientOptions& set_metadata_cache_ttl(std::chrono::milliseconds v) {
+    metadata_cache_ttl_ = v;
+    return *this;
+  }
+
+  std::size_t metadata_cache_max_entries() const {
+    return metadata_cache_max_entries_;
+  }
+  ClientOptions& set_metadata_cache_max_entries(std::size_t v) {
+    metadata_cache_max_entries_ = v;
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Fetch the next page of a listing while the current page is consumed.
+   *
+   * By default `ListObjectsReader`, `ListBucketsReader`, and
+   * `ListHmacKeysReader` request the next page of results only after the
+   * application has consumed every element of the current page. When this
+   * option is enabled each reader requests the next page in a background
+   * thread as soon as it receives the current one, so the application
+   * processes one page while the next one is in flight.
+   *
+   * The default value is `false`.
+   */
+  bool enable_list_prefetch() const { return enable_list_prefetch_; }
+  ClientOptions& set_enable_list_prefetch(bool v) {
+    enable_list_prefetch_ = v;
+    return *this;
+  }
+  //@}
+
  private:
   void SetupFromEnvironment();
 
@@ -203,6 +451,20 @@ class ClientOptions {
   std::size_t maximum_socket_recv_size_ = 0;
   std::size_t maximum_socket_send_size_ = 0;
   std::chrono::seconds download_stall_timeout_;
+  std::size_t download_reactor_thread_count_ = 0;
+  std::size_t download_prefetch_depth_ = 0;
+  std::size_t upload_pipeline_depth_ = 0;
+  bool enable_adaptive_upload_buffer_size_ = false;
+  std::size_t minimum_upload_buffer_size_ = 256 * 1024;
+  std::size_t maximum_upload_buffer_size_ = 64 * 1024 * 1024;
+  std::shared_ptr<BufferPool> buffer_pool_;
+  std::size_t block_cache_size_ = 0;
+  std::size_t block_cache_block_size_ = 1024 * 1024;
+  std::string block_cache_spill_directory_;
+  std::size_t block_cache_spill_size_ = 0;
+  std::chrono::milliseconds metadata_cache_ttl_{0};
+  std::size_t metadata_cache_max_entries_ = 10000;
+  bool enable_list_prefetch_ = false;
 };
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
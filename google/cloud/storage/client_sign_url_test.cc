@@ -259,6 +259,61 @@ TEST_F(CreateSignedUrlTest, V4SignPut) {
   EXPECT_EQ(expected, *actual);
 }
 
+/// @test Verify that CreateV4SignedUrls() produces the same URLs as
+/// CreateV4SignedUrl().
+TEST_F(CreateSignedUrlTest, V4SignBatch) {
+  auto creds = oauth2::CreateServiceAccountCredentialsFromJsonContents(
+      kJsonKeyfileContentsForV4);
+  ASSERT_STATUS_OK(creds);
+  Client client(*creds);
+
+  std::string const bucket_name = "test-bucket";
+  std::vector<std::string> const object_names{
+      "test-object", "path/to/object", "object with spaces", "test-object-1",
+      "test-object-2"};
+  auto const timestamp =
+      google::cloud::internal::ParseRfc3339("2019-02-01T09:00:00Z");
+  auto const valid_for = std::chrono::seconds(10);
+
+  auto actual = client.CreateV4SignedUrls(
+      "GET", bucket_name, object_names, 3, SignedUrlTimestamp(timestamp),
+      SignedUrlDuration(valid_for));
+  ASSERT_EQ(object_names.size(), actual.size());
+
+  for (std::size_t i = 0; i != object_names.size(); ++i) {
+    SCOPED_TRACE("Testing with object_name=" + object_names[i]);
+    auto expected = client.CreateV4SignedUrl(
+        "GET", bucket_name, object_names[i], SignedUrlTimestamp(timestamp),
+        SignedUrlDuration(valid_for));
+    ASSERT_STATUS_OK(expected);
+    ASSERT_STATUS_OK(actual[i]);
+    EXPECT_EQ(*expected, *actual[i]);
+  }
+
+  EXPECT_TRUE(client.CreateV4SignedUrls("GET", bucket_name, {}, 3).empty());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that CreateV4SignedUrls() reports exceptions from the workers.
+TEST_F(CreateSignedUrlTest, V4SignBatchException) {
+  EXPECT_CALL(*mock, SignBlob(_))
+      .WillRepeatedly(Invoke([](internal::SignBlobRequest const&)
+                                 -> StatusOr<internal::SignBlobResponse> {
+        throw std::runtime_error("test-message");
+      }));
+
+  std::vector<std::string> const object_names{"test-object-1", "test-object-2",
+                                              "test-object-3"};
+  auto actual =
+      client->CreateV4SignedUrls("GET", "test-bucket", object_names, 2);
+  ASSERT_EQ(object_names.size(), actual.size());
+  for (auto const& url : actual) {
+    EXPECT_EQ(StatusCode::kUnknown, url.status().code());
+    EXPECT_THAT(url.status().message(), HasSubstr("test-message"));
+  }
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
 /// @test Verify that CreateV4SignedUrl() uses the SignBlob API when needed.
 TEST_F(CreateSignedUrlTest, V4SignRemote) {
   auto creds = oauth2::CreateServiceAccountCredentialsFromJsonContents(
@@ -20,6 +20,7 @@
 #include "google/cloud/storage/testing/mock_client.h"
 #include "google/cloud/testing_util/assert_ok.h"
 #include <gmock/gmock.h>
+#include <atomic>
 
 namespace google {
 namespace cloud {
@@ -103,6 +104,57 @@ TEST_F(WriteObjectTest, WriteObject) {
   EXPECT_EQ(expected, actual);
 }
 
+/// @test Verify that pipelined uploads do not adapt the chunk size.
+TEST_F(WriteObjectTest, WriteObjectPipelinedFixedChunkSize) {
+  auto const quantum = internal::UploadChunkRequest::kChunkSizeQuantum;
+  client_options.SetUploadBufferSize(quantum)
+      .set_upload_pipeline_depth(2)
+      .set_enable_adaptive_upload_buffer_size(true);
+
+  std::atomic<std::uint64_t> next_byte(0);
+  StatusOr<internal::ResumableUploadResponse> initial_response(
+      internal::ResumableUploadResponse{
+          "fake-url", 0, {}, internal::ResumableUploadResponse::kInProgress,
+          {}});
+  EXPECT_CALL(*mock, CreateResumableSession(_))
+      .WillOnce(Invoke([&](internal::ResumableUploadRequest const&) {
+        auto mock = make_unique<testing::MockResumableUploadSession>();
+        using internal::ResumableUploadResponse;
+        EXPECT_CALL(*mock, done()).WillRepeatedly(Return(false));
+        EXPECT_CALL(*mock, next_expected_byte()).WillRepeatedly(Invoke([&] {
+          return next_byte.load();
+        }));
+        EXPECT_CALL(*mock, last_response())
+            .WillRepeatedly(ReturnRef(initial_response));
+        EXPECT_CALL(*mock, UploadChunk(_))
+            .WillRepeatedly(Invoke([&](std::string const& p) {
+              next_byte += p.size();
+              return make_status_or(ResumableUploadResponse{
+                  "fake-url", next_byte - 1, {},
+                  ResumableUploadResponse::kInProgress, {}});
+            }));
+        EXPECT_CALL(*mock, UploadFinalChunk(_, _))
+            .WillOnce(Return(make_status_or(
+                ResumableUploadResponse{"fake-url",
+                                        0,
+                                        ObjectMetadata(),
+                                        ResumableUploadResponse::kDone,
+                                        {}})));
+
+        return make_status_or(
+            std::unique_ptr<internal ::ResumableUploadSession>(
+                std::move(mock)));
+      }));
+
+  auto stream = client->WriteObject("test-bucket-name", "test-object-name");
+  std::string const payload(8 * quantum, '*');
+  stream.write(payload.data(), payload.size());
+  EXPECT_EQ(quantum, stream.upload_chunk_size());
+  stream.Close();
+  EXPECT_STATUS_OK(stream.metadata());
+  EXPECT_EQ(quantum, stream.upload_chunk_size());
+}
+
 TEST_F(WriteObjectTest, WriteObjectTooManyFailures) {
   Client client{std::shared_ptr<internal::RawClient>(mock),
                 LimitedErrorCountRetryPolicy(2),
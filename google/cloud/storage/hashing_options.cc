@@ -24,9 +24,13 @@ namespace cloud {
 namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 std::string ComputeMD5Hash(std::string const& payload) {
+  return ComputeMD5Hash(payload.data(), payload.size());
+}
+
+std::string ComputeMD5Hash(char const* payload, std::size_t size) {
   MD5_CTX md5;
   MD5_Init(&md5);
-  MD5_Update(&md5, payload.c_str(), payload.size());
+  MD5_Update(&md5, payload, size);
 
   std::string hash(MD5_DIGEST_LENGTH, ' ');
   MD5_Final(reinterpret_cast<unsigned char*>(&hash[0]), &md5);
@@ -34,8 +38,12 @@ std::string ComputeMD5Hash(std::string const& payload) {
 }
 
 std::string ComputeCrc32cChecksum(std::string const& payload) {
+  return ComputeCrc32cChecksum(payload.data(), payload.size());
+}
+
+std::string ComputeCrc32cChecksum(char const* payload, std::size_t size) {
   auto checksum = crc32c::Extend(
-      0, reinterpret_cast<std::uint8_t const*>(payload.data()), payload.size());
+      0, reinterpret_cast<std::uint8_t const*>(payload), size);
   std::string const hash = google::cloud::internal::EncodeBigEndian(checksum);
   return internal::Base64Encode(hash);
 }
@@ -17,6 +17,7 @@
 
 #include "google/cloud/storage/internal/complex_option.h"
 #include "google/cloud/storage/version.h"
+#include <cstddef>
 #include <string>
 
 namespace google {
@@ -45,6 +46,11 @@ struct MD5HashValue
  */
 std::string ComputeMD5Hash(std::string const& payload);
 
+/**
+ * Compute the MD5 Hash of a buffer in the format preferred by GCS.
+ */
+std::string ComputeMD5Hash(char const* payload, std::size_t size);
+
 /**
  * Disable MD5 Hashing computations.
  *
@@ -86,6 +92,11 @@ struct Crc32cChecksumValue
  */
 std::string ComputeCrc32cChecksum(std::string const& payload);
 
+/**
+ * Compute the CRC32C checksum of a buffer in the format preferred by GCS.
+ */
+std::string ComputeCrc32cChecksum(char const* payload, std::size_t size);
+
 /**
  * Disable MD5 Hashing computations.
  *
@@ -37,6 +37,13 @@ TEST(ComputeMD5HashTest, Simple) {
   EXPECT_EQ("nhB9nTcrtoJr2B01QqQZ1g==", actual);
 }
 
+TEST(ComputeMD5HashTest, Buffer) {
+  std::string const payload = "The quick brown fox jumps over the lazy dog";
+  EXPECT_EQ(ComputeMD5Hash(payload),
+            ComputeMD5Hash(payload.data(), payload.size()));
+  EXPECT_EQ(ComputeMD5Hash(""), ComputeMD5Hash(payload.data(), 0));
+}
+
 TEST(ComputeCrc32cChecksumTest, Empty) {
   std::string actual = ComputeCrc32cChecksum("");
   // Use this command to get the expected value:
@@ -53,6 +60,14 @@ TEST(ComputeCrc32cChecksumTest, Simple) {
   EXPECT_EQ("ImIEBA==", actual);
 }
 
+TEST(ComputeCrc32cChecksumTest, Buffer) {
+  std::string const payload = "The quick brown fox jumps over the lazy dog";
+  EXPECT_EQ(ComputeCrc32cChecksum(payload),
+            ComputeCrc32cChecksum(payload.data(), payload.size()));
+  EXPECT_EQ(ComputeCrc32cChecksum(""),
+            ComputeCrc32cChecksum(payload.data(), 0));
+}
+
 }  // namespace
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
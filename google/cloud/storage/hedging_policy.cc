@@ -0,0 +1,122 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/hedging_policy.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+// The number of recent latencies used to compute the percentile.
+constexpr std::size_t kMaxSamples = 1000;
+// The minimum number of latencies before the percentile is used.
+constexpr std::size_t kMinSamples = 100;
+// Recompute the percentile after this many new latencies.
+constexpr std::size_t kRecomputeInterval = 50;
+// The maximum number of hedges that can be sent in a burst.
+constexpr double kMaxBudget = 10.0;
+}  // namespace
+
+struct HedgingPolicy::State {
+  State(double p, std::chrono::milliseconds d, double r)
+      : percentile(std::min(std::max(p, 0.0), 100.0)),
+        max_hedge_ratio(std::max(r, 0.0)),
+        delay(d) {}
+
+  double const percentile;
+  double const max_hedge_ratio;
+
+  mutable std::mutex mu;
+  std::vector<std::chrono::milliseconds> samples;
+  std::size_t next_sample = 0;
+  std::size_t samples_since_recompute = 0;
+  std::chrono::milliseconds delay;
+  double budget = 0.0;
+  HedgingStats stats{0, 0, 0, 0};
+};
+
+HedgingPolicy::HedgingPolicy(double percentile,
+                             std::chrono::milliseconds initial_delay,
+                             double max_hedge_ratio)
+    : state_(std::make_shared<State>(percentile, initial_delay,
+                                     max_hedge_ratio)) {}
+
+HedgingStats HedgingPolicy::stats() const {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  return state_->stats;
+}
+
+std::chrono::milliseconds HedgingPolicy::HedgeDelay() const {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  return state_->delay;
+}
+
+void HedgingPolicy::OnRequest() {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  ++state_->stats.requests;
+  state_->budget =
+      std::min(kMaxBudget, state_->budget + state_->max_hedge_ratio);
+}
+
+bool HedgingPolicy::OnHedge() {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  if (state_->budget < 1.0) {
+    ++state_->stats.hedges_over_budget;
+    return false;
+  }
+  state_->budget -= 1.0;
+  ++state_->stats.hedges_sent;
+  return true;
+}
+
+void HedgingPolicy::OnHedgeWon() {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  ++state_->stats.hedges_won;
+}
+
+void HedgingPolicy::OnAttemptSuccess(std::chrono::milliseconds latency) {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  auto& s = *state_;
+  if (s.samples.size() < kMaxSamples) {
+    s.samples.push_back(latency);
+  } else {
+    s.samples[s.next_sample] = latency;
+    s.next_sample = (s.next_sample + 1) % kMaxSamples;
+  }
+  ++s.samples_since_recompute;
+  if (s.samples.size() < kMinSamples) {
+    return;
+  }
+  // Compute the percentile as soon as there are enough samples, and then
+  // periodically.
+  if (s.samples.size() != kMinSamples &&
+      s.samples_since_recompute < kRecomputeInterval) {
+    return;
+  }
+  s.samples_since_recompute = 0;
+  auto sorted = s.samples;
+  auto const index = static_cast<std::size_t>(
+      s.percentile / 100.0 * static_cast<double>(sorted.size() - 1));
+  std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+  s.delay = sorted[index];
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
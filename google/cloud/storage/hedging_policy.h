@@ -0,0 +1,125 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_HEDGING_POLICY_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_HEDGING_POLICY_H
+
+#include "google/cloud/storage/version.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/// The counters maintained by a `HedgingPolicy`.
+struct HedgingStats {
+  /// The number of requests eligible for hedging.
+  std::int64_t requests;
+  /// The number of duplicate requests sent.
+  std::int64_t hedges_sent;
+  /// The number of requests where the duplicate request completed first.
+  std::int64_t hedges_won;
+  /// The number of duplicate requests not sent because the budget was empty.
+  std::int64_t hedges_over_budget;
+};
+
+/**
+ * Controls when the client library sends duplicate ("hedged") requests.
+ *
+ * The tail latency of some operations is dominated by individual slow attempts
+ * rather than by errors. With this policy the library sends a second copy of
+ * a request if the first one has not completed after a delay, and uses
+ * whichever response arrives first. The delay is a percentile of the latency
+ * of recent attempts, for example, with the 95th percentile about 5% of the
+ * requests are duplicated.
+ *
+ * Only idempotent requests, as defined by the `IdempotencyPolicy`, are hedged.
+ * Currently `GetObjectMetadata()` and `ReadObject()` support hedging. Downloads
+ * start lazily, so for `ReadObject()` the library hedges the first read from
+ * the stream, and uses the winning download for the rest of the data. Once
+ * one request wins the other is cancelled. The latency samples are shared by
+ * both operations.
+ *
+ * Hedging increases the load on the service. To prevent it from amplifying
+ * load when the service is slow, duplicate requests consume a budget that is
+ * replenished by a fraction of each eligible request. Once the budget is
+ * exhausted requests are not duplicated until it is replenished.
+ *
+ * Copies of a `HedgingPolicy` share the latency samples, budget, and counters.
+ * Applications can keep a copy of the policy used to create a `Client` to
+ * examine the counters.
+ *
+ * @par Example
+ * @code
+ * namespace gcs = google::cloud::storage;
+ * gcs::HedgingPolicy hedging(95.0, std::chrono::milliseconds(100), 0.05);
+ * gcs::Client client(gcs::ClientOptions::CreateDefaultClientOptions().value(),
+ *                    hedging);
+ * // ... use the client ...
+ * std::cout << "hedges sent: " << hedging.stats().hedges_sent << "\n";
+ * @endcode
+ */
+class HedgingPolicy {
+ public:
+  /**
+   * Creates a new hedging policy.
+   *
+   * @param percentile send a duplicate request once an attempt takes longer
+   *     than this percentile of the recent latencies, for example `95.0`.
+   * @param initial_delay the delay before sending a duplicate request until
+   *     enough latencies have been observed to compute @p percentile.
+   * @param max_hedge_ratio the maximum number of duplicate requests, as a
+   *     fraction of the eligible requests, for example `0.05`.
+   */
+  HedgingPolicy(double percentile, std::chrono::milliseconds initial_delay,
+                double max_hedge_ratio);
+
+  /// Returns a snapshot of the counters.
+  HedgingStats stats() const;
+
+  //@{
+  /**
+   * @name Used by the client library to implement hedging.
+   *
+   * Applications should have no need to call these functions.
+   */
+  /// Returns how long to wait for an attempt before duplicating it.
+  std::chrono::milliseconds HedgeDelay() const;
+
+  /// Called for each eligible request, replenishes the budget.
+  void OnRequest();
+
+  /// Returns true, and consumes the budget, if a hedge can be sent.
+  bool OnHedge();
+
+  /// Called when a duplicate request completes before the original.
+  void OnHedgeWon();
+
+  /// Records the latency of a successful attempt.
+  void OnAttemptSuccess(std::chrono::milliseconds latency);
+  //@}
+
+ private:
+  struct State;
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_HEDGING_POLICY_H
@@ -0,0 +1,91 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/hedging_policy.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ms = std::chrono::milliseconds;
+
+/// @test Verify that hedges are limited by the budget.
+TEST(HedgingPolicyTest, Budget) {
+  HedgingPolicy tested(95.0, ms(10), 0.5);
+  tested.OnRequest();
+  EXPECT_FALSE(tested.OnHedge());
+  tested.OnRequest();
+  EXPECT_TRUE(tested.OnHedge());
+  EXPECT_FALSE(tested.OnHedge());
+
+  auto stats = tested.stats();
+  EXPECT_EQ(2, stats.requests);
+  EXPECT_EQ(1, stats.hedges_sent);
+  EXPECT_EQ(0, stats.hedges_won);
+  EXPECT_EQ(2, stats.hedges_over_budget);
+}
+
+/// @test Verify that the budget does not accumulate without bound.
+TEST(HedgingPolicyTest, BudgetIsCapped) {
+  HedgingPolicy tested(95.0, ms(10), 1.0);
+  for (int i = 0; i != 100; ++i) {
+    tested.OnRequest();
+  }
+  int sent = 0;
+  for (int i = 0; i != 100; ++i) {
+    if (tested.OnHedge()) {
+      ++sent;
+    }
+  }
+  EXPECT_EQ(10, sent);
+  EXPECT_EQ(10, tested.stats().hedges_sent);
+  EXPECT_EQ(90, tested.stats().hedges_over_budget);
+}
+
+/// @test Verify that the delay is computed from the observed latencies.
+TEST(HedgingPolicyTest, DelayFromPercentile) {
+  HedgingPolicy tested(95.0, ms(250), 0.05);
+  EXPECT_EQ(ms(250), tested.HedgeDelay());
+  for (int i = 1; i != 100; ++i) {
+    tested.OnAttemptSuccess(ms(i));
+  }
+  // Not enough samples to compute the percentile.
+  EXPECT_EQ(ms(250), tested.HedgeDelay());
+  tested.OnAttemptSuccess(ms(100));
+  EXPECT_EQ(ms(95), tested.HedgeDelay());
+}
+
+/// @test Verify that copies of the policy share their state.
+TEST(HedgingPolicyTest, CopiesShareState) {
+  HedgingPolicy tested(95.0, ms(10), 1.0);
+  HedgingPolicy copy = tested;
+  copy.OnRequest();
+  EXPECT_TRUE(copy.OnHedge());
+  copy.OnHedgeWon();
+
+  auto stats = tested.stats();
+  EXPECT_EQ(1, stats.requests);
+  EXPECT_EQ(1, stats.hedges_sent);
+  EXPECT_EQ(1, stats.hedges_won);
+  EXPECT_EQ(0, stats.hedges_over_budget);
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
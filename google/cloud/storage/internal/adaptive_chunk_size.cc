@@ -0,0 +1,101 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/adaptive_chunk_size.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+// Upload each chunk for at least this long, even on very low latency networks
+// this is long enough to amortize the cost of each request.
+auto constexpr kMinimumChunkSeconds = 0.5;
+// Make each chunk take this many round trips to upload, so the latency of the
+// request is about 10% of the total time.
+auto constexpr kRttMultiple = 10.0;
+// The weight of the new sample in the running estimates.
+auto constexpr kSmoothing = 0.5;
+
+double Smooth(double estimate, double sample) {
+  return estimate * (1 - kSmoothing) + sample * kSmoothing;
+}
+
+std::size_t RoundDownToQuantum(double size) {
+  auto constexpr kQuantum = UploadChunkRequest::kChunkSizeQuantum;
+  auto const n = static_cast<std::size_t>(size / kQuantum);
+  return (std::max)(n, std::size_t{1}) * kQuantum;
+}
+}  // namespace
+
+AdaptiveChunkSize::AdaptiveChunkSize(std::size_t initial_size,
+                                     std::size_t minimum_size,
+                                     std::size_t maximum_size)
+    : minimum_size_(UploadChunkRequest::RoundUpToQuantum(minimum_size)),
+      maximum_size_((std::max)(
+          minimum_size_, UploadChunkRequest::RoundUpToQuantum(maximum_size))),
+      chunk_size_((std::min)(
+          maximum_size_,
+          (std::max)(minimum_size_,
+                     UploadChunkRequest::RoundUpToQuantum(initial_size)))) {}
+
+std::chrono::microseconds AdaptiveChunkSize::rtt() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::duration<double>(rtt_));
+}
+
+std::size_t AdaptiveChunkSize::OnChunkUploaded(
+    std::size_t bytes, std::chrono::microseconds elapsed) {
+  auto const seconds = std::chrono::duration<double>(elapsed).count();
+  if (bytes == 0 || seconds <= 0) {
+    return chunk_size_;
+  }
+
+  // Two chunks of different sizes give an estimate for the fixed cost of each
+  // request, as the intercept of the line through both samples. Noisy samples
+  // may produce a negative slope, those are ignored.
+  if (last_bytes_ != 0 && last_bytes_ != bytes) {
+    auto const slope = (seconds - last_seconds_) /
+                       (static_cast<double>(bytes) - last_bytes_);
+    if (slope > 0) {
+      auto const sample = (std::max)(0.0, seconds - slope * bytes);
+      rtt_ = has_rtt_ ? Smooth(rtt_, sample) : sample;
+      has_rtt_ = true;
+    }
+  }
+  last_bytes_ = bytes;
+  last_seconds_ = seconds;
+
+  auto const transfer_seconds = seconds > rtt_ ? seconds - rtt_ : seconds;
+  auto const sample = static_cast<double>(bytes) / transfer_seconds;
+  throughput_ = throughput_ == 0 ? sample : Smooth(throughput_, sample);
+
+  auto const target_seconds =
+      (std::max)(kMinimumChunkSeconds, kRttMultiple * rtt_);
+  auto desired = throughput_ * target_seconds;
+  desired = (std::min)(desired, 2.0 * chunk_size_);
+  desired = (std::max)(desired, chunk_size_ / 2.0);
+  chunk_size_ = (std::min)(
+      maximum_size_, (std::max)(minimum_size_, RoundDownToQuantum(desired)));
+  return chunk_size_;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
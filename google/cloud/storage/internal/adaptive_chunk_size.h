@@ -0,0 +1,83 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_ADAPTIVE_CHUNK_SIZE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_ADAPTIVE_CHUNK_SIZE_H
+
+#include "google/cloud/storage/version.h"
+#include <chrono>
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Chooses the size of resumable upload chunks from the observed performance.
+ *
+ * Each chunk is uploaded in a separate request, so the time to upload a chunk
+ * of `n` bytes is approximately `rtt + n / throughput`. This class estimates
+ * both values from the previous chunks, and picks a chunk size large enough
+ * that the request latency is a small fraction of the upload time, without
+ * buffering more data than the network can upload in a short period.
+ *
+ * The chunk size is always a multiple of the upload quantum (256 KiB), within
+ * the configured bounds. It changes by at most a factor of 2 after each chunk,
+ * so a single slow (or fast) request has limited effect.
+ *
+ * This class is not thread-safe, each upload stream has its own instance.
+ */
+class AdaptiveChunkSize {
+ public:
+  AdaptiveChunkSize(std::size_t initial_size, std::size_t minimum_size,
+                    std::size_t maximum_size);
+
+  /// The size for the next chunk.
+  std::size_t chunk_size() const { return chunk_size_; }
+
+  /// The estimated upload throughput in bytes per second, 0 if unknown.
+  double throughput() const { return throughput_; }
+
+  /// The estimated latency of each upload request, 0 if unknown.
+  std::chrono::microseconds rtt() const;
+
+  /**
+   * Updates the estimates after a chunk is uploaded.
+   *
+   * @param bytes the size of the chunk.
+   * @param elapsed the time to upload the chunk.
+   * @return the size for the next chunk.
+   */
+  std::size_t OnChunkUploaded(std::size_t bytes,
+                              std::chrono::microseconds elapsed);
+
+ private:
+  std::size_t minimum_size_;
+  std::size_t maximum_size_;
+  std::size_t chunk_size_;
+  double throughput_ = 0;
+  double rtt_ = 0;
+  bool has_rtt_ = false;
+  std::size_t last_bytes_ = 0;
+  double last_seconds_ = 0;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_ADAPTIVE_CHUNK_SIZE_H
@@ -0,0 +1,110 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/adaptive_chunk_size.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+auto constexpr kQuantum = UploadChunkRequest::kChunkSizeQuantum;
+auto constexpr kMiB = 1024 * 1024;
+
+/// Simulate uploads over a link with the given throughput and latency.
+std::size_t Converge(AdaptiveChunkSize& tested, double bytes_per_second,
+                     std::chrono::microseconds rtt) {
+  for (int i = 0; i != 32; ++i) {
+    auto const bytes = tested.chunk_size();
+    auto const transfer = std::chrono::duration<double>(
+        static_cast<double>(bytes) / bytes_per_second);
+    tested.OnChunkUploaded(
+        bytes, rtt + std::chrono::duration_cast<std::chrono::microseconds>(
+                         transfer));
+  }
+  return tested.chunk_size();
+}
+
+TEST(AdaptiveChunkSizeTest, Bounds) {
+  AdaptiveChunkSize tested(3 * kQuantum + 1, kQuantum - 1, 8 * kQuantum + 1);
+  EXPECT_EQ(4 * kQuantum, tested.chunk_size());
+
+  AdaptiveChunkSize clamped(64 * kMiB, kQuantum, 8 * kQuantum);
+  EXPECT_EQ(8 * kQuantum, clamped.chunk_size());
+}
+
+TEST(AdaptiveChunkSizeTest, GrowsOnFastLinks) {
+  AdaptiveChunkSize tested(kQuantum, kQuantum, 256 * kMiB);
+  auto const size =
+      Converge(tested, 100.0 * kMiB, std::chrono::milliseconds(20));
+  // The chunks take about kMinimumChunkSeconds (0.5s) to upload.
+  EXPECT_NEAR(50 * kMiB, size, kQuantum);
+  EXPECT_EQ(0, size % kQuantum);
+  EXPECT_NEAR(100.0 * kMiB, tested.throughput(), kMiB);
+  EXPECT_NEAR(20000, tested.rtt().count(), 100);
+}
+
+TEST(AdaptiveChunkSizeTest, GrowsWithLatency) {
+  AdaptiveChunkSize tested(kQuantum, kQuantum, 256 * kMiB);
+  auto const size =
+      Converge(tested, 10.0 * kMiB, std::chrono::milliseconds(200));
+  // The chunks take about 10 round trips (2s) to upload.
+  EXPECT_NEAR(20 * kMiB, size, kQuantum);
+}
+
+TEST(AdaptiveChunkSizeTest, ShrinksOnSlowLinks) {
+  AdaptiveChunkSize tested(32 * kMiB, kQuantum, 256 * kMiB);
+  auto const size = Converge(tested, 1.0 * kMiB, std::chrono::milliseconds(10));
+  EXPECT_NEAR(kMiB / 2, size, kQuantum);
+}
+
+TEST(AdaptiveChunkSizeTest, RespectsBounds) {
+  AdaptiveChunkSize fast(kQuantum, kQuantum, 4 * kMiB);
+  EXPECT_EQ(4 * kMiB,
+            Converge(fast, 100.0 * kMiB, std::chrono::milliseconds(20)));
+
+  AdaptiveChunkSize slow(32 * kMiB, 2 * kMiB, 256 * kMiB);
+  EXPECT_EQ(2 * kMiB,
+            Converge(slow, 0.1 * kMiB, std::chrono::milliseconds(20)));
+}
+
+TEST(AdaptiveChunkSizeTest, LimitsChangeRate) {
+  AdaptiveChunkSize fast(4 * kMiB, kQuantum, 256 * kMiB);
+  EXPECT_EQ(8 * kMiB,
+            fast.OnChunkUploaded(4 * kMiB, std::chrono::milliseconds(1)));
+
+  AdaptiveChunkSize slow(8 * kMiB, kQuantum, 256 * kMiB);
+  EXPECT_EQ(4 * kMiB,
+            slow.OnChunkUploaded(8 * kMiB, std::chrono::seconds(100)));
+}
+
+TEST(AdaptiveChunkSizeTest, IgnoresEmptySamples) {
+  AdaptiveChunkSize tested(4 * kMiB, kQuantum, 256 * kMiB);
+  EXPECT_EQ(4 * kMiB, tested.OnChunkUploaded(0, std::chrono::seconds(1)));
+  EXPECT_EQ(4 * kMiB,
+            tested.OnChunkUploaded(kMiB, std::chrono::microseconds(0)));
+  EXPECT_EQ(0, tested.throughput());
+  EXPECT_EQ(0, tested.rtt().count());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,393 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/batch_request.h"
+#include "google/cloud/storage/idempotency_policy.h"
+#include "google/cloud/storage/internal/nljson.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+std::string const kContentIdPrefix = "item-";
+std::string const kResponseContentIdPrefix = "response-" + kContentIdPrefix;
+
+/// Splits @p text at the first empty line, accepting CRLF or LF line breaks.
+std::pair<std::string, std::string> SplitAtEmptyLine(std::string const& text) {
+  auto pos = text.find("\r\n\r\n");
+  if (pos != std::string::npos) {
+    return {text.substr(0, pos), text.substr(pos + 4)};
+  }
+  pos = text.find("\n\n");
+  if (pos != std::string::npos) {
+    return {text.substr(0, pos), text.substr(pos + 2)};
+  }
+  return {text, std::string{}};
+}
+
+std::string Trim(std::string const& s) {
+  auto is_space = [](char c) { return std::isspace(c) != 0; };
+  auto begin = std::find_if_not(s.begin(), s.end(), is_space);
+  auto end = std::find_if_not(s.rbegin(), s.rend(), is_space).base();
+  if (begin >= end) {
+    return std::string{};
+  }
+  return std::string(begin, end);
+}
+
+std::string ToLower(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(),
+                 [](char c) { return static_cast<char>(std::tolower(c)); });
+  return s;
+}
+
+/**
+ * Parses a block of headers, the header names are converted to lower case, as
+ * `CurlRequest` does for the headers in a HTTP response.
+ */
+std::multimap<std::string, std::string> ParseHeaders(std::string const& text) {
+  std::multimap<std::string, std::string> headers;
+  std::string::size_type start = 0;
+  while (start < text.size()) {
+    auto end = text.find('\n', start);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    auto line = text.substr(start, end - start);
+    start = end + 1;
+    auto colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    headers.emplace(ToLower(Trim(line.substr(0, colon))),
+                    Trim(line.substr(colon + 1)));
+  }
+  return headers;
+}
+
+StatusOr<std::string> ExtractBoundary(std::string const& content_type) {
+  auto const key = std::string("boundary=");
+  auto pos = ToLower(content_type).find(key);
+  if (pos == std::string::npos) {
+    return Status(StatusCode::kInternal,
+                  "batch response content-type has no boundary: " +
+                      content_type);
+  }
+  auto value = content_type.substr(pos + key.size());
+  value = Trim(value.substr(0, value.find(';')));
+  if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+    value = value.substr(1, value.size() - 2);
+  }
+  if (value.empty()) {
+    return Status(StatusCode::kInternal,
+                  "batch response content-type has an empty boundary: " +
+                      content_type);
+  }
+  return value;
+}
+
+StatusOr<HttpResponse> ParseEmbeddedResponse(std::string const& text) {
+  auto split = SplitAtEmptyLine(text);
+  auto const& head = split.first;
+  auto eol = head.find('\n');
+  auto status_line = Trim(head.substr(0, eol));
+  // The status line looks like `HTTP/1.1 200 OK`.
+  auto sp = status_line.find(' ');
+  if (status_line.compare(0, 5, "HTTP/") != 0 || sp == std::string::npos) {
+    return Status(StatusCode::kInternal,
+                  "invalid status line in batch response part: " +
+                      status_line);
+  }
+  char* end = nullptr;
+  auto code = std::strtol(status_line.c_str() + sp + 1, &end, 10);
+  if (end == status_line.c_str() + sp + 1) {
+    return Status(StatusCode::kInternal,
+                  "invalid status code in batch response part: " +
+                      status_line);
+  }
+  std::string headers;
+  if (eol != std::string::npos) {
+    headers = head.substr(eol + 1);
+  }
+  return HttpResponse{code, std::move(split.second), ParseHeaders(headers)};
+}
+
+/// Returns the index encoded in a response Content-ID, or -1 if not present.
+long ContentIdIndex(std::string content_id) {
+  if (!content_id.empty() && content_id.front() == '<') {
+    content_id = content_id.substr(1, content_id.find('>') - 1);
+  }
+  if (content_id.compare(0, kResponseContentIdPrefix.size(),
+                         kResponseContentIdPrefix) != 0) {
+    return -1;
+  }
+  auto digits = content_id.substr(kResponseContentIdPrefix.size());
+  if (digits.empty() ||
+      !std::all_of(digits.begin(), digits.end(),
+                   [](char c) { return std::isdigit(c) != 0; })) {
+    return -1;
+  }
+  return std::strtol(digits.c_str(), nullptr, 10);
+}
+}  // namespace
+
+BatchPartBuilder::BatchPartBuilder(std::string method, std::string path) {
+  part_.method = std::move(method);
+  part_.path = std::move(path);
+}
+
+BatchPart BatchPartBuilder::BuildPart(std::string payload) {
+  part_.payload = std::move(payload);
+  return std::move(part_);
+}
+
+BatchPartBuilder& BatchPartBuilder::AddHeader(std::string header) {
+  part_.headers.push_back(std::move(header));
+  return *this;
+}
+
+BatchPartBuilder& BatchPartBuilder::AddQueryParameter(
+    std::string const& key, std::string const& value) {
+  part_.path += query_parameter_separator_;
+  part_.path += EscapeString(key);
+  part_.path += '=';
+  part_.path += EscapeString(value);
+  query_parameter_separator_ = "&";
+  return *this;
+}
+
+std::string BatchPartBuilder::EscapeString(std::string const& s) {
+  static char const kHexDigits[] = "0123456789ABCDEF";
+  std::string result;
+  result.reserve(s.size());
+  for (char c : s) {
+    auto u = static_cast<unsigned char>(c);
+    if (std::isalnum(u) != 0 || c == '-' || c == '.' || c == '_' ||
+        c == '~') {
+      result.push_back(c);
+      continue;
+    }
+    result.push_back('%');
+    result.push_back(kHexDigits[u >> 4U]);
+    result.push_back(kHexDigits[u & 0xFU]);
+  }
+  return result;
+}
+
+template <typename Request>
+void BatchRequest::AddPart(Request const& request, BatchPartBuilder builder,
+                           std::string payload) {
+  request.AddOptionsToHttpRequest(builder);
+  auto part = builder.BuildPart(std::move(payload));
+  part.bucket_name = request.bucket_name();
+  part.object_name = request.object_name();
+  parts_.push_back(std::move(part));
+  idempotency_.emplace_back([request](IdempotencyPolicy const& policy) {
+    return policy.IsIdempotent(request);
+  });
+}
+
+void BatchRequest::AddRequest(DeleteObjectRequest const& request) {
+  BatchPartBuilder builder(
+      "DELETE", "/b/" + request.bucket_name() + "/o/" +
+                    BatchPartBuilder::EscapeString(request.object_name()));
+  AddPart(request, std::move(builder), std::string{});
+}
+
+void BatchRequest::AddRequest(PatchObjectRequest const& request) {
+  BatchPartBuilder builder(
+      "PATCH", "/b/" + request.bucket_name() + "/o/" +
+                   BatchPartBuilder::EscapeString(request.object_name()));
+  builder.AddHeader("Content-Type: application/json");
+  AddPart(request, std::move(builder), request.payload());
+}
+
+void BatchRequest::AddRequest(CreateObjectAclRequest const& request) {
+  BatchPartBuilder builder(
+      "POST", "/b/" + request.bucket_name() + "/o/" +
+                  BatchPartBuilder::EscapeString(request.object_name()) +
+                  "/acl");
+  builder.AddHeader("Content-Type: application/json");
+  nl::json object;
+  object["entity"] = request.entity();
+  object["role"] = request.role();
+  AddPart(request, std::move(builder), object.dump());
+}
+
+void BatchRequest::AddRequest(DeleteObjectAclRequest const& request) {
+  BatchPartBuilder builder(
+      "DELETE", "/b/" + request.bucket_name() + "/o/" +
+                    BatchPartBuilder::EscapeString(request.object_name()) +
+                    "/acl/" + BatchPartBuilder::EscapeString(request.entity()));
+  AddPart(request, std::move(builder), std::string{});
+}
+
+void BatchRequest::AddRequest(UpdateObjectAclRequest const& request) {
+  BatchPartBuilder builder(
+      "PUT", "/b/" + request.bucket_name() + "/o/" +
+                 BatchPartBuilder::EscapeString(request.object_name()) +
+                 "/acl/" + BatchPartBuilder::EscapeString(request.entity()));
+  builder.AddHeader("Content-Type: application/json");
+  nl::json object;
+  object["entity"] = request.entity();
+  object["role"] = request.role();
+  AddPart(request, std::move(builder), object.dump());
+}
+
+void BatchRequest::AddRequest(PatchObjectAclRequest const& request) {
+  BatchPartBuilder builder(
+      "PATCH", "/b/" + request.bucket_name() + "/o/" +
+                   BatchPartBuilder::EscapeString(request.object_name()) +
+                   "/acl/" + BatchPartBuilder::EscapeString(request.entity()));
+  builder.AddHeader("Content-Type: application/json");
+  AddPart(request, std::move(builder), request.payload());
+}
+
+bool BatchRequest::IsIdempotent(IdempotencyPolicy const& policy) const {
+  return std::all_of(
+      idempotency_.begin(), idempotency_.end(),
+      [&policy](std::function<bool(IdempotencyPolicy const&)> const& f) {
+        return f(policy);
+      });
+}
+
+std::ostream& operator<<(std::ostream& os, BatchRequest const& r) {
+  os << "BatchRequest={parts=[";
+  char const* sep = "";
+  for (auto const& part : r.parts()) {
+    os << sep << "{method=" << part.method << ", path=" << part.path
+       << ", payload=" << part.payload << "}";
+    sep = ", ";
+  }
+  return os << "]}";
+}
+
+std::string FormatBatchPart(BatchPart const& part,
+                            std::string const& path_prefix) {
+  std::string result =
+      part.method + " " + path_prefix + part.path + " HTTP/1.1\r\n";
+  for (auto const& header : part.headers) {
+    result += header;
+    result += "\r\n";
+  }
+  result += "\r\n";
+  result += part.payload;
+  return result;
+}
+
+std::string FormatBatchPayload(std::vector<std::string> const& parts,
+                               std::string const& boundary) {
+  std::string const crlf = "\r\n";
+  std::string const marker = "--" + boundary;
+  std::string result;
+  std::size_t index = 0;
+  for (auto const& part : parts) {
+    result += marker + crlf;
+    result += "Content-Type: application/http" + crlf;
+    result += "Content-Transfer-Encoding: binary" + crlf;
+    result += "Content-ID: <" + kContentIdPrefix + std::to_string(index++) +
+              ">" + crlf + crlf;
+    result += part + crlf;
+  }
+  result += marker + "--" + crlf;
+  return result;
+}
+
+StatusOr<BatchResponse> BatchResponse::FromHttpResponse(
+    HttpResponse const& response, std::size_t expected_parts) {
+  auto content_type = response.headers.find("content-type");
+  if (content_type == response.headers.end()) {
+    return Status(StatusCode::kInternal,
+                  "batch response is missing the content-type header");
+  }
+  auto boundary = ExtractBoundary(content_type->second);
+  if (!boundary) {
+    return std::move(boundary).status();
+  }
+  std::string const marker = "--" + *boundary;
+
+  BatchResponse result;
+  result.responses.assign(
+      expected_parts,
+      Status(StatusCode::kUnknown, "sub-request missing in batch response"));
+
+  auto const& payload = response.payload;
+  std::size_t position = 0;
+  for (auto pos = payload.find(marker); pos != std::string::npos;) {
+    auto start = pos + marker.size();
+    // The closing delimiter is the marker followed by `--`.
+    if (payload.compare(start, 2, "--") == 0) {
+      break;
+    }
+    auto end = payload.find(marker, start);
+    if (end == std::string::npos) {
+      break;
+    }
+    // Drop the line break after the marker and the one before the next marker.
+    auto body = payload.substr(start, end - start);
+    if (body.compare(0, 2, "\r\n") == 0) {
+      body.erase(0, 2);
+    } else if (body.compare(0, 1, "\n") == 0) {
+      body.erase(0, 1);
+    }
+    if (body.size() >= 2 && body.compare(body.size() - 2, 2, "\r\n") == 0) {
+      body.erase(body.size() - 2);
+    } else if (!body.empty() && body.back() == '\n') {
+      body.pop_back();
+    }
+
+    auto split = SplitAtEmptyLine(body);
+    auto part_headers = ParseHeaders(split.first);
+    auto index = static_cast<long>(position++);
+    auto content_id = part_headers.find("content-id");
+    if (content_id != part_headers.end()) {
+      auto i = ContentIdIndex(content_id->second);
+      if (i >= 0) {
+        index = i;
+      }
+    }
+    if (static_cast<std::size_t>(index) < expected_parts) {
+      result.responses[index] = ParseEmbeddedResponse(split.second);
+    }
+    pos = end;
+  }
+  return result;
+}
+
+std::ostream& operator<<(std::ostream& os, BatchResponse const& r) {
+  os << "BatchResponse={responses=[";
+  char const* sep = "";
+  for (auto const& response : r.responses) {
+    os << sep;
+    if (response) {
+      os << *response;
+    } else {
+      os << response.status();
+    }
+    sep = ", ";
+  }
+  return os << "]}";
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,240 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_BATCH_REQUEST_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_BATCH_REQUEST_H
+
+#include "google/cloud/status_or.h"
+#include "google/cloud/storage/internal/complex_option.h"
+#include "google/cloud/storage/internal/http_response.h"
+#include "google/cloud/storage/internal/object_acl_requests.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/storage/well_known_headers.h"
+#include "google/cloud/storage/well_known_parameters.h"
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+class IdempotencyPolicy;
+namespace internal {
+/// The maximum number of sub-requests accepted by the batch endpoint.
+constexpr std::size_t kMaximumBatchSize = 100;
+
+/**
+ * One of the sub-requests in a batch, formatted as an embedded HTTP request.
+ */
+struct BatchPart {
+  std::string bucket_name;
+  std::string object_name;
+  std::string method;
+  /// The path, relative to the JSON API endpoint, including any parameters.
+  std::string path;
+  std::vector<std::string> headers;
+  std::string payload;
+};
+
+/**
+ * Implements the Builder pattern for `BatchPart`.
+ *
+ * This class offers the same `AddOption()` overloads as `CurlRequestBuilder`,
+ * so the request classes can use `AddOptionsToHttpRequest()` to format their
+ * query parameters and headers in a batch part.
+ */
+class BatchPartBuilder {
+ public:
+  BatchPartBuilder(std::string method, std::string path);
+
+  /// Creates the part with the given payload, invalidates the builder.
+  BatchPart BuildPart(std::string payload);
+
+  /// Adds one of the well-known parameters as a query parameter
+  template <typename P>
+  BatchPartBuilder& AddOption(WellKnownParameter<P, std::string> const& p) {
+    if (p.has_value()) {
+      AddQueryParameter(p.parameter_name(), p.value());
+    }
+    return *this;
+  }
+
+  /// Adds one of the well-known parameters as a query parameter
+  template <typename P>
+  BatchPartBuilder& AddOption(WellKnownParameter<P, std::int64_t> const& p) {
+    if (p.has_value()) {
+      AddQueryParameter(p.parameter_name(), std::to_string(p.value()));
+    }
+    return *this;
+  }
+
+  /// Adds one of the well-known parameters as a query parameter
+  template <typename P>
+  BatchPartBuilder& AddOption(WellKnownParameter<P, bool> const& p) {
+    if (p.has_value()) {
+      AddQueryParameter(p.parameter_name(), p.value() ? "true" : "false");
+    }
+    return *this;
+  }
+
+  /// Adds one of the well-known headers to the part.
+  template <typename P>
+  BatchPartBuilder& AddOption(WellKnownHeader<P, std::string> const& p) {
+    if (p.has_value()) {
+      AddHeader(std::string(p.header_name()) + ": " + p.value());
+    }
+    return *this;
+  }
+
+  /// Adds a custom header to the part.
+  BatchPartBuilder& AddOption(CustomHeader const& p) {
+    if (p.has_value()) {
+      AddHeader(p.custom_header_name() + ": " + p.value());
+    }
+    return *this;
+  }
+
+  /// Adds one of the well-known encryption header groups to the part.
+  BatchPartBuilder& AddOption(EncryptionKey const& p) {
+    if (p.has_value()) {
+      AddHeader(std::string(p.prefix()) + "algorithm: " + p.value().algorithm);
+      AddHeader(std::string(p.prefix()) + "key: " + p.value().key);
+      AddHeader(std::string(p.prefix()) + "key-sha256: " + p.value().sha256);
+    }
+    return *this;
+  }
+
+  /// Adds one of the well-known encryption header groups to the part.
+  BatchPartBuilder& AddOption(SourceEncryptionKey const& p) {
+    if (p.has_value()) {
+      AddHeader(std::string(p.prefix()) + "Algorithm: " + p.value().algorithm);
+      AddHeader(std::string(p.prefix()) + "Key: " + p.value().key);
+      AddHeader(std::string(p.prefix()) + "Key-Sha256: " + p.value().sha256);
+    }
+    return *this;
+  }
+
+  /**
+   * Ignore complex options, these are managed explicitly in the requests that
+   * use them.
+   */
+  template <typename Option, typename T>
+  BatchPartBuilder& AddOption(ComplexOption<Option, T> const&) {
+    return *this;
+  }
+
+  /// Adds a header to the part.
+  BatchPartBuilder& AddHeader(std::string header);
+
+  /// Adds a query parameter to the part.
+  BatchPartBuilder& AddQueryParameter(std::string const& key,
+                                      std::string const& value);
+
+  /// URL-escapes a string, as required for object names and query parameters.
+  static std::string EscapeString(std::string const& s);
+
+ private:
+  BatchPart part_;
+  char const* query_parameter_separator_ = "?";
+};
+
+/**
+ * Represents a request to the JSON API batch endpoint.
+ *
+ * A batch request packs up to `kMaximumBatchSize` sub-requests in a single
+ * `multipart/mixed` HTTP request. Each sub-request is formatted from one of the
+ * existing request classes, including its query parameters and headers. The
+ * service executes the sub-requests independently, a failure in one of them
+ * does not affect the others.
+ *
+ * @see https://cloud.google.com/storage/docs/json_api/v1/how-tos/batch
+ */
+class BatchRequest {
+ public:
+  BatchRequest() = default;
+
+  std::size_t size() const { return parts_.size(); }
+  bool empty() const { return parts_.empty(); }
+  std::vector<BatchPart> const& parts() const { return parts_; }
+
+  //@{
+  /// @name Add a sub-request to the batch.
+  void AddRequest(DeleteObjectRequest const& request);
+  void AddRequest(PatchObjectRequest const& request);
+  void AddRequest(CreateObjectAclRequest const& request);
+  void AddRequest(DeleteObjectAclRequest const& request);
+  void AddRequest(UpdateObjectAclRequest const& request);
+  void AddRequest(PatchObjectAclRequest const& request);
+  //@}
+
+  /// Returns true if all the sub-requests are idempotent under @p policy.
+  bool IsIdempotent(IdempotencyPolicy const& policy) const;
+
+ private:
+  template <typename Request>
+  void AddPart(Request const& request, BatchPartBuilder builder,
+               std::string payload);
+
+  std::vector<BatchPart> parts_;
+  std::vector<std::function<bool(IdempotencyPolicy const&)>> idempotency_;
+};
+
+std::ostream& operator<<(std::ostream& os, BatchRequest const& r);
+
+/**
+ * Formats @p part as the body of an `application/http` MIME part.
+ *
+ * @param path_prefix the prefix for the part path, typically `/storage/v1`.
+ */
+std::string FormatBatchPart(BatchPart const& part,
+                            std::string const& path_prefix);
+
+/**
+ * Formats the body of a batch request.
+ *
+ * @param parts the formatted parts, as returned by `FormatBatchPart()`.
+ * @param boundary a string not found in any of the @p parts.
+ */
+std::string FormatBatchPayload(std::vector<std::string> const& parts,
+                               std::string const& boundary);
+
+/**
+ * Represents the response from the JSON API batch endpoint.
+ *
+ * The service returns a `multipart/mixed` response, where each part contains
+ * the embedded HTTP response for one of the sub-requests. The `responses`
+ * vector has one element per sub-request, in the same order as the
+ * `BatchRequest::parts()`. Sub-requests missing from the response are reported
+ * as errors.
+ */
+struct BatchResponse {
+  static StatusOr<BatchResponse> FromHttpResponse(HttpResponse const& response,
+                                                  std::size_t expected_parts);
+
+  std::vector<StatusOr<HttpResponse>> responses;
+};
+
+std::ostream& operator<<(std::ostream& os, BatchResponse const& r);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_BATCH_REQUEST_H
@@ -0,0 +1,196 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/batch_request.h"
+#include "google/cloud/storage/idempotency_policy.h"
+#include "google/cloud/storage/internal/nljson.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+TEST(BatchRequestTest, EscapeString) {
+  EXPECT_EQ("abc-._~123", BatchPartBuilder::EscapeString("abc-._~123"));
+  EXPECT_EQ("a%2Fb%20c%3F", BatchPartBuilder::EscapeString("a/b c?"));
+}
+
+TEST(BatchRequestTest, DeleteObject) {
+  DeleteObjectRequest delete_request("test-bucket", "dir/test-object");
+  delete_request.set_multiple_options(Generation(7),
+                                      UserProject("test-project"));
+  BatchRequest request;
+  request.AddRequest(delete_request);
+  ASSERT_EQ(1, request.size());
+  auto const& part = request.parts()[0];
+  EXPECT_EQ("test-bucket", part.bucket_name);
+  EXPECT_EQ("dir/test-object", part.object_name);
+  EXPECT_EQ("DELETE", part.method);
+  EXPECT_EQ(
+      "/b/test-bucket/o/dir%2Ftest-object"
+      "?generation=7&userProject=test-project",
+      part.path);
+  EXPECT_TRUE(part.payload.empty());
+
+  EXPECT_EQ(
+      "DELETE /storage/v1/b/test-bucket/o/dir%2Ftest-object?generation=7"
+      "&userProject=test-project HTTP/1.1\r\n\r\n",
+      FormatBatchPart(part, "/storage/v1"));
+}
+
+TEST(BatchRequestTest, ObjectAcl) {
+  BatchRequest request;
+  request.AddRequest(
+      CreateObjectAclRequest("test-bucket", "test-object", "user-a", "READER"));
+  request.AddRequest(
+      DeleteObjectAclRequest("test-bucket", "test-object", "user-b"));
+  ASSERT_EQ(2, request.size());
+
+  auto const& create = request.parts()[0];
+  EXPECT_EQ("POST", create.method);
+  EXPECT_EQ("/b/test-bucket/o/test-object/acl", create.path);
+  EXPECT_THAT(create.headers, ElementsAre("Content-Type: application/json"));
+  auto payload = nl::json::parse(create.payload);
+  EXPECT_EQ("user-a", payload.value("entity", ""));
+  EXPECT_EQ("READER", payload.value("role", ""));
+
+  auto const& remove = request.parts()[1];
+  EXPECT_EQ("DELETE", remove.method);
+  EXPECT_EQ("/b/test-bucket/o/test-object/acl/user-b", remove.path);
+}
+
+TEST(BatchRequestTest, IsIdempotent) {
+  BatchRequest request;
+  DeleteObjectRequest with_generation("test-bucket", "test-object");
+  with_generation.set_option(Generation(7));
+  request.AddRequest(with_generation);
+  EXPECT_TRUE(request.IsIdempotent(StrictIdempotencyPolicy()));
+  EXPECT_TRUE(request.IsIdempotent(AlwaysRetryIdempotencyPolicy()));
+
+  request.AddRequest(DeleteObjectRequest("test-bucket", "test-object"));
+  EXPECT_FALSE(request.IsIdempotent(StrictIdempotencyPolicy()));
+  EXPECT_TRUE(request.IsIdempotent(AlwaysRetryIdempotencyPolicy()));
+}
+
+TEST(BatchRequestTest, FormatPayload) {
+  auto actual = FormatBatchPayload({"part-0", "part-1"}, "test-boundary");
+  EXPECT_EQ(
+      "--test-boundary\r\n"
+      "Content-Type: application/http\r\n"
+      "Content-Transfer-Encoding: binary\r\n"
+      "Content-ID: <item-0>\r\n"
+      "\r\n"
+      "part-0\r\n"
+      "--test-boundary\r\n"
+      "Content-Type: application/http\r\n"
+      "Content-Transfer-Encoding: binary\r\n"
+      "Content-ID: <item-1>\r\n"
+      "\r\n"
+      "part-1\r\n"
+      "--test-boundary--\r\n",
+      actual);
+}
+
+TEST(BatchResponseTest, Parse) {
+  // The parts are out of order, and the last one is missing.
+  HttpResponse response{
+      200,
+      "--batch_abc\r\n"
+      "Content-Type: application/http\r\n"
+      "Content-ID: <response-item-1>\r\n"
+      "\r\n"
+      "HTTP/1.1 404 Not Found\r\n"
+      "Content-Type: application/json\r\n"
+      "\r\n"
+      "{\"error\": \"not found\"}\r\n"
+      "--batch_abc\r\n"
+      "Content-Type: application/http\r\n"
+      "Content-ID: <response-item-0>\r\n"
+      "\r\n"
+      "HTTP/1.1 204 No Content\r\n"
+      "\r\n"
+      "\r\n"
+      "--batch_abc--\r\n",
+      {{"content-type", "multipart/mixed; boundary=\"batch_abc\""}}};
+  auto actual = BatchResponse::FromHttpResponse(response, 3);
+  ASSERT_STATUS_OK(actual);
+  ASSERT_EQ(3, actual->responses.size());
+  ASSERT_STATUS_OK(actual->responses[0]);
+  EXPECT_EQ(204, actual->responses[0]->status_code);
+  EXPECT_EQ("", actual->responses[0]->payload);
+  ASSERT_STATUS_OK(actual->responses[1]);
+  EXPECT_EQ(404, actual->responses[1]->status_code);
+  EXPECT_EQ("{\"error\": \"not found\"}", actual->responses[1]->payload);
+  EXPECT_EQ(1, actual->responses[1]->headers.count("content-type"));
+  EXPECT_FALSE(actual->responses[2].ok());
+}
+
+TEST(BatchResponseTest, ParseWithoutContentId) {
+  HttpResponse response{200,
+                        "preamble\n"
+                        "--b1\n"
+                        "Content-Type: application/http\n"
+                        "\n"
+                        "HTTP/1.1 200 OK\n"
+                        "\n"
+                        "{}\n"
+                        "--b1\n"
+                        "Content-Type: application/http\n"
+                        "\n"
+                        "HTTP/1.1 412 Precondition Failed\n"
+                        "\n"
+                        "\n"
+                        "--b1--\n",
+                        {{"content-type", "multipart/mixed; boundary=b1"}}};
+  auto actual = BatchResponse::FromHttpResponse(response, 2);
+  ASSERT_STATUS_OK(actual);
+  ASSERT_EQ(2, actual->responses.size());
+  ASSERT_STATUS_OK(actual->responses[0]);
+  EXPECT_EQ(200, actual->responses[0]->status_code);
+  EXPECT_EQ("{}", actual->responses[0]->payload);
+  ASSERT_STATUS_OK(actual->responses[1]);
+  EXPECT_EQ(412, actual->responses[1]->status_code);
+}
+
+TEST(BatchResponseTest, ParseErrors) {
+  auto actual = BatchResponse::FromHttpResponse(HttpResponse{200, "", {}}, 1);
+  EXPECT_FALSE(actual.ok());
+
+  actual = BatchResponse::FromHttpResponse(
+      HttpResponse{200, "", {{"content-type", "multipart/mixed"}}}, 1);
+  ASSERT_FALSE(actual.ok());
+  EXPECT_THAT(actual.status().message(), HasSubstr("boundary"));
+
+  actual = BatchResponse::FromHttpResponse(
+      HttpResponse{200,
+                   "--b1\r\n\r\nnot-http\r\n--b1--\r\n",
+                   {{"content-type", "multipart/mixed; boundary=b1"}}},
+      1);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_FALSE(actual->responses[0].ok());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
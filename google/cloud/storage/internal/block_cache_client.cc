@@ -0,0 +1,541 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/block_cache_client.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+namespace {
+bool IsCacheable(ReadObjectRangeRequest const& request) {
+  // Reads without an upper bound may be arbitrarily large, and would just
+  // thrash the cache.
+  if (request.HasOption<ReadRange>() == request.HasOption<ReadLast>()) {
+    return false;
+  }
+  return !request.HasOption<EncryptionKey>() &&
+         !request.HasOption<IfGenerationMatch>() &&
+         !request.HasOption<IfGenerationNotMatch>() &&
+         !request.HasOption<IfMetagenerationMatch>() &&
+         !request.HasOption<IfMetagenerationNotMatch>();
+}
+
+/**
+ * Reads a range of a single object generation, one cached block at a time.
+ *
+ * The object size may be unknown (for reads pinned to a generation), in that
+ * case the end of the object is detected when a block is shorter than the
+ * block size, or when the service reports that a block is out of range.
+ */
+class BlockCacheReadSource : public ObjectReadSource {
+ public:
+  struct Range {
+    std::int64_t generation = 0;
+    std::int64_t begin = 0;
+    std::int64_t end = 0;
+  };
+
+  BlockCacheReadSource(std::shared_ptr<RawClient> client,
+                       std::shared_ptr<ObjectBlockCache> cache,
+                       std::size_t block_size,
+                       ReadObjectRangeRequest const& request, Range range)
+      : client_(std::move(client)),
+        cache_(std::move(cache)),
+        block_size_(static_cast<std::int64_t>(block_size)),
+        bucket_name_(request.bucket_name()),
+        object_name_(request.object_name()),
+        user_project_(request.GetOption<UserProject>()),
+        range_(range),
+        offset_(range.begin) {}
+
+  bool IsOpen() const override { return is_open_; }
+
+  StatusOr<HttpResponse> Close() override {
+    is_open_ = false;
+    return HttpResponse{200, {}, {}};
+  }
+
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override {
+    if (!is_open_) {
+      return Status(StatusCode::kFailedPrecondition, "Stream is not open");
+    }
+    std::size_t count = 0;
+    while (count < n && offset_ < range_.end) {
+      auto block = GetBlock(offset_ / block_size_);
+      if (!block) {
+        if (block.status().code() == StatusCode::kOutOfRange &&
+            offset_ != range_.begin) {
+          // The previous block was the last block in the object.
+          range_.end = offset_;
+          break;
+        }
+        if (count != 0) {
+          // Return the data already copied, the error is reported on the
+          // next call.
+          break;
+        }
+        return std::move(block).status();
+      }
+      auto const& data = **block;
+      auto const block_offset = static_cast<std::size_t>(offset_ % block_size_);
+      if (block_offset >= data.size()) {
+        range_.end = offset_;
+        break;
+      }
+      auto const m = (std::min)(
+          {n - count, data.size() - block_offset,
+           static_cast<std::size_t>(range_.end - offset_)});
+      std::memcpy(buf + count, data.data() + block_offset, m);
+      count += m;
+      offset_ += static_cast<std::int64_t>(m);
+      if (data.size() < static_cast<std::size_t>(block_size_) &&
+          block_offset + m == data.size()) {
+        range_.end = offset_;
+      }
+    }
+
+    HttpResponse response{100, {}, {}};
+    if (!headers_sent_) {
+      response.headers.emplace("x-goog-generation",
+                               std::to_string(range_.generation));
+      headers_sent_ = true;
+    }
+    if (offset_ >= range_.end) {
+      is_open_ = false;
+      response.status_code = 200;
+    }
+    return ReadSourceResult{count, std::move(response)};
+  }
+
+ private:
+  StatusOr<ObjectBlockCache::Block> GetBlock(std::int64_t block) {
+    // Consecutive reads typically use the same block, avoid looking it up
+    // (and counting a hit) each time.
+    if (current_block_ && current_index_ == block) {
+      return current_block_;
+    }
+    ObjectBlockCache::Key key{bucket_name_, object_name_, range_.generation,
+                              block};
+    // Concurrent readers missing the same block share a single download.
+    auto loaded = cache_->LookupOrLoad(
+        key, [this, block] { return Download(block); });
+    if (!loaded) {
+      return loaded;
+    }
+    current_index_ = block;
+    current_block_ = *loaded;
+    return loaded;
+  }
+
+  StatusOr<ObjectBlockCache::Block> Download(std::int64_t block) {
+    ReadObjectRangeRequest request(bucket_name_, object_name_);
+    request.set_multiple_options(
+        Generation(range_.generation),
+        ReadRange(block * block_size_, (block + 1) * block_size_),
+        user_project_);
+    auto source = client_->ReadObject(request);
+    if (!source) {
+      return std::move(source).status();
+    }
+    std::string data(static_cast<std::size_t>(block_size_), '\0');
+    std::size_t size = 0;
+    while (size < data.size()) {
+      auto result = (*source)->Read(&data[size], data.size() - size);
+      if (!result) {
+        return std::move(result).status();
+      }
+      size += result->bytes_received;
+      if (result->response.status_code >= 300) {
+        return AsStatus(result->response);
+      }
+      if (result->response.status_code != 100) {
+        break;
+      }
+    }
+    (void)(*source)->Close();
+    data.resize(size);
+    return ObjectBlockCache::Block(
+        std::make_shared<std::string const>(std::move(data)));
+  }
+
+  std::shared_ptr<RawClient> client_;
+  std::shared_ptr<ObjectBlockCache> cache_;
+  std::int64_t const block_size_;
+  std::string bucket_name_;
+  std::string object_name_;
+  UserProject user_project_;
+  Range range_;
+  std::int64_t offset_;
+  bool is_open_ = true;
+  bool headers_sent_ = false;
+  std::int64_t current_index_ = 0;
+  ObjectBlockCache::Block current_block_;
+};
+}  // namespace
+
+BlockCacheClient::BlockCacheClient(std::shared_ptr<RawClient> client,
+                                   std::shared_ptr<ObjectBlockCache> cache,
+                                   std::size_t block_size)
+    : client_(std::move(client)),
+      cache_(std::move(cache)),
+      block_size_(block_size) {}
+
+ClientOptions const& BlockCacheClient::client_options() const {
+  return client_->client_options();
+}
+
+StatusOr<ListBucketsResponse> BlockCacheClient::ListBuckets(
+    ListBucketsRequest const& request) {
+  return client_->ListBuckets(request);
+}
+
+StatusOr<BucketMetadata> BlockCacheClient::CreateBucket(
+    CreateBucketRequest const& request) {
+  return client_->CreateBucket(request);
+}
+
+StatusOr<BucketMetadata> BlockCacheClient::GetBucketMetadata(
+    GetBucketMetadataRequest const& request) {
+  return client_->GetBucketMetadata(request);
+}
+
+StatusOr<EmptyResponse> BlockCacheClient::DeleteBucket(
+    DeleteBucketRequest const& request) {
+  return client_->DeleteBucket(request);
+}
+
+StatusOr<BucketMetadata> BlockCacheClient::UpdateBucket(
+    UpdateBucketRequest const& request) {
+  return client_->UpdateBucket(request);
+}
+
+StatusOr<BucketMetadata> BlockCacheClient::PatchBucket(
+    PatchBucketRequest const& request) {
+  return client_->PatchBucket(request);
+}
+
+StatusOr<IamPolicy> BlockCacheClient::GetBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return client_->GetBucketIamPolicy(request);
+}
+
+StatusOr<NativeIamPolicy> BlockCacheClient::GetNativeBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return client_->GetNativeBucketIamPolicy(request);
+}
+
+StatusOr<IamPolicy> BlockCacheClient::SetBucketIamPolicy(
+    SetBucketIamPolicyRequest const& request) {
+  return client_->SetBucketIamPolicy(request);
+}
+
+StatusOr<NativeIamPolicy> BlockCacheClient::SetNativeBucketIamPolicy(
+    SetNativeBucketIamPolicyRequest const& request) {
+  return client_->SetNativeBucketIamPolicy(request);
+}
+
+StatusOr<TestBucketIamPermissionsResponse>
+BlockCacheClient::TestBucketIamPermissions(
+    TestBucketIamPermissionsRequest const& request) {
+  return client_->TestBucketIamPermissions(request);
+}
+
+StatusOr<BucketMetadata> BlockCacheClient::LockBucketRetentionPolicy(
+    LockBucketRetentionPolicyRequest const& request) {
+  return client_->LockBucketRetentionPolicy(request);
+}
+
+StatusOr<ObjectMetadata> BlockCacheClient::InsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  return client_->InsertObjectMedia(request);
+}
+
+StatusOr<ObjectMetadata> BlockCacheClient::CopyObject(
+    CopyObjectRequest const& request) {
+  return client_->CopyObject(request);
+}
+
+StatusOr<ObjectMetadata> BlockCacheClient::GetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return client_->GetObjectMetadata(request);
+}
+
+StatusOr<std::unique_ptr<ObjectReadSource>> BlockCacheClient::ReadObject(
+    ReadObjectRangeRequest const& request) {
+  if (!IsCacheable(request)) {
+    return client_->ReadObject(request);
+  }
+
+  BlockCacheReadSource::Range range;
+  range.end = (std::numeric_limits<std::int64_t>::max)();
+  if (request.HasOption<ReadRange>()) {
+    range.begin = request.GetOption<ReadRange>().value().begin;
+    range.end = request.GetOption<ReadRange>().value().end;
+  }
+  if (request.HasOption<ReadFromOffset>()) {
+    range.begin =
+        (std::max)(range.begin, request.GetOption<ReadFromOffset>().value());
+  }
+
+  // Reads pinned to a generation need no validation, but `ReadLast` needs the
+  // object size to compute the range.
+  if (request.HasOption<Generation>() && !request.HasOption<ReadLast>()) {
+    range.generation = request.GetOption<Generation>().value();
+  } else {
+    GetObjectMetadataRequest metadata_request(request.bucket_name(),
+                                              request.object_name());
+    metadata_request.set_multiple_options(request.GetOption<Generation>(),
+                                          request.GetOption<UserProject>());
+    auto metadata = client_->GetObjectMetadata(metadata_request);
+    if (!metadata) {
+      return std::move(metadata).status();
+    }
+    range.generation = metadata->generation();
+    auto const size = static_cast<std::int64_t>(metadata->size());
+    if (request.HasOption<ReadLast>()) {
+      range.begin = (std::max)(
+          std::int64_t(0), size - request.GetOption<ReadLast>().value());
+    }
+    range.end = (std::min)(range.end, size);
+  }
+  if (range.begin >= range.end) {
+    // Let the service report any errors for empty or invalid ranges.
+    return client_->ReadObject(request);
+  }
+
+  return std::unique_ptr<ObjectReadSource>(new BlockCacheReadSource(
+      client_, cache_, block_size_, request, range));
+}
+
+StatusOr<ListObjectsResponse> BlockCacheClient::ListObjects(
+    ListObjectsRequest const& request) {
+  return client_->ListObjects(request);
+}
+
+StatusOr<EmptyResponse> BlockCacheClient::DeleteObject(
+    DeleteObjectRequest const& request) {
+  return client_->DeleteObject(request);
+}
+
+StatusOr<ObjectMetadata> BlockCacheClient::UpdateObject(
+    UpdateObjectRequest const& request) {
+  return client_->UpdateObject(request);
+}
+
+StatusOr<ObjectMetadata> BlockCacheClient::PatchObject(
+    PatchObjectRequest const& request) {
+  return client_->PatchObject(request);
+}
+
+StatusOr<ObjectMetadata> BlockCacheClient::ComposeObject(
+    ComposeObjectRequest const& request) {
+  return client_->ComposeObject(request);
+}
+
+StatusOr<RewriteObjectResponse> BlockCacheClient::RewriteObject(
+    RewriteObjectRequest const& request) {
+  return client_->RewriteObject(request);
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+BlockCacheClient::CreateResumableSession(
+    ResumableUploadRequest const& request) {
+  return client_->CreateResumableSession(request);
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+BlockCacheClient::RestoreResumableSession(std::string const& request) {
+  return client_->RestoreResumableSession(request);
+}
+
+StatusOr<ListBucketAclResponse> BlockCacheClient::ListBucketAcl(
+    ListBucketAclRequest const& request) {
+  return client_->ListBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> BlockCacheClient::GetBucketAcl(
+    GetBucketAclRequest const& request) {
+  return client_->GetBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> BlockCacheClient::CreateBucketAcl(
+    CreateBucketAclRequest const& request) {
+  return client_->CreateBucketAcl(request);
+}
+
+StatusOr<EmptyResponse> BlockCacheClient::DeleteBucketAcl(
+    DeleteBucketAclRequest const& request) {
+  return client_->DeleteBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> BlockCacheClient::UpdateBucketAcl(
+    UpdateBucketAclRequest const& request) {
+  return client_->UpdateBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> BlockCacheClient::PatchBucketAcl(
+    PatchBucketAclRequest const& request) {
+  return client_->PatchBucketAcl(request);
+}
+
+StatusOr<ListObjectAclResponse> BlockCacheClient::ListObjectAcl(
+    ListObjectAclRequest const& request) {
+  return client_->ListObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> BlockCacheClient::CreateObjectAcl(
+    CreateObjectAclRequest const& request) {
+  return client_->CreateObjectAcl(request);
+}
+
+StatusOr<EmptyResponse> BlockCacheClient::DeleteObjectAcl(
+    DeleteObjectAclRequest const& request) {
+  return client_->DeleteObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> BlockCacheClient::GetObjectAcl(
+    GetObjectAclRequest const& request) {
+  return client_->GetObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> BlockCacheClient::UpdateObjectAcl(
+    UpdateObjectAclRequest const& request) {
+  return client_->UpdateObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> BlockCacheClient::PatchObjectAcl(
+    PatchObjectAclRequest const& request) {
+  return client_->PatchObjectAcl(request);
+}
+
+StatusOr<ListDefaultObjectAclResponse> BlockCacheClient::ListDefaultObjectAcl(
+    ListDefaultObjectAclRequest const& request) {
+  return client_->ListDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> BlockCacheClient::CreateDefaultObjectAcl(
+    CreateDefaultObjectAclRequest const& request) {
+  return client_->CreateDefaultObjectAcl(request);
+}
+
+StatusOr<EmptyResponse> BlockCacheClient::DeleteDefaultObjectAcl(
+    DeleteDefaultObjectAclRequest const& request) {
+  return client_->DeleteDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> BlockCacheClient::GetDefaultObjectAcl(
+    GetDefaultObjectAclRequest const& request) {
+  return client_->GetDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> BlockCacheClient::UpdateDefaultObjectAcl(
+    UpdateDefaultObjectAclRequest const& request) {
+  return client_->UpdateDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> BlockCacheClient::PatchDefaultObjectAcl(
+    PatchDefaultObjectAclRequest const& request) {
+  return client_->PatchDefaultObjectAcl(request);
+}
+
+StatusOr<ServiceAccount> BlockCacheClient::GetServiceAccount(
+    GetProjectServiceAccountRequest const& request) {
+  return client_->GetServiceAccount(request);
+}
+
+StatusOr<ListHmacKeysResponse> BlockCacheClient::ListHmacKeys(
+    ListHmacKeysRequest const& request) {
+  return client_->ListHmacKeys(request);
+}
+
+StatusOr<CreateHmacKeyResponse> BlockCacheClient::CreateHmacKey(
+    CreateHmacKeyRequest const& request) {
+  return client_->CreateHmacKey(request);
+}
+
+StatusOr<EmptyResponse> BlockCacheClient::DeleteHmacKey(
+    DeleteHmacKeyRequest const& request) {
+  return client_->DeleteHmacKey(request);
+}
+
+StatusOr<HmacKeyMetadata> BlockCacheClient::GetHmacKey(
+    GetHmacKeyRequest const& request) {
+  return client_->GetHmacKey(request);
+}
+
+StatusOr<HmacKeyMetadata> BlockCacheClient::UpdateHmacKey(
+    UpdateHmacKeyRequest const& request) {
+  return client_->UpdateHmacKey(request);
+}
+
+StatusOr<SignBlobResponse> BlockCacheClient::SignBlob(
+    SignBlobRequest const& request) {
+  return client_->SignBlob(request);
+}
+
+StatusOr<ListNotificationsResponse> BlockCacheClient::ListNotifications(
+    ListNotificationsRequest const& request) {
+  return client_->ListNotifications(request);
+}
+
+StatusOr<NotificationMetadata> BlockCacheClient::CreateNotification(
+    CreateNotificationRequest const& request) {
+  return client_->CreateNotification(request);
+}
+
+StatusOr<NotificationMetadata> BlockCacheClient::GetNotification(
+    GetNotificationRequest const& request) {
+  return client_->GetNotification(request);
+}
+
+StatusOr<EmptyResponse> BlockCacheClient::DeleteNotification(
+    DeleteNotificationRequest const& request) {
+  return client_->DeleteNotification(request);
+}
+
+StatusOr<BatchResponse> BlockCacheClient::ExecuteBatch(
+    BatchRequest const& request) {
+  return client_->ExecuteBatch(request);
+}
+
+future<StatusOr<ObjectMetadata>> BlockCacheClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  return client_->AsyncInsertObjectMedia(request);
+}
+
+future<StatusOr<ObjectMetadata>> BlockCacheClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return client_->AsyncGetObjectMetadata(request);
+}
+
+future<StatusOr<std::string>> BlockCacheClient::AsyncReadObject(
+    ReadObjectRangeRequest const& request) {
+  return client_->AsyncReadObject(request);
+}
+
+future<void> BlockCacheClient::AsyncSleep(std::chrono::milliseconds duration) {
+  return client_->AsyncSleep(duration);
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
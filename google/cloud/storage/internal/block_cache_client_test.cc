@@ -0,0 +1,194 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/block_cache_client.h"
+#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::TransientError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+std::string const kContents = "0123456789";
+std::size_t const kBlockSize = 4;
+
+/// Simulate a ranged download from an object with `kContents`.
+StatusOr<std::unique_ptr<ObjectReadSource>> MockReadObject(
+    ReadObjectRangeRequest const& r) {
+  EXPECT_TRUE(r.HasOption<Generation>());
+  EXPECT_TRUE(r.HasOption<ReadRange>());
+  auto const range = r.GetOption<ReadRange>().value();
+  auto const size = static_cast<std::int64_t>(kContents.size());
+  if (range.begin >= size) {
+    return Status(StatusCode::kOutOfRange, "range not satisfiable");
+  }
+  auto data = kContents.substr(static_cast<std::size_t>(range.begin),
+                               static_cast<std::size_t>(range.end) -
+                                   static_cast<std::size_t>(range.begin));
+  auto source = google::cloud::internal::make_unique<
+      testing::MockObjectReadSource>();
+  EXPECT_CALL(*source, Read(_, _))
+      .WillOnce(Invoke([data](char* buf, std::size_t n) {
+        EXPECT_LE(data.size(), n);
+        std::copy(data.begin(), data.end(), buf);
+        return ReadSourceResult{data.size(), HttpResponse{200, {}, {}}};
+      }));
+  EXPECT_CALL(*source, Close())
+      .WillRepeatedly(Return(HttpResponse{200, {}, {}}));
+  return std::unique_ptr<ObjectReadSource>(std::move(source));
+}
+
+ObjectMetadata MockMetadata(std::int64_t generation) {
+  return ObjectMetadataParser::FromString(R"""({
+      "bucket": "test-bucket",
+      "name": "test-object",
+      "generation": ")""" + std::to_string(generation) +
+                                          R"""(",
+      "size": ")""" + std::to_string(kContents.size()) +
+                                          R"""("
+})""")
+      .value();
+}
+
+/// Read all the data from @p source.
+StatusOr<std::string> ReadAll(ObjectReadSource& source) {
+  std::string contents;
+  std::vector<char> buffer(3);
+  while (source.IsOpen()) {
+    auto result = source.Read(buffer.data(), buffer.size());
+    if (!result) {
+      return std::move(result).status();
+    }
+    contents.append(buffer.data(), result->bytes_received);
+  }
+  return contents;
+}
+
+template <typename... Options>
+ReadObjectRangeRequest MakeRequest(Options&&... options) {
+  ReadObjectRangeRequest request("test-bucket", "test-object");
+  request.set_multiple_options(std::forward<Options>(options)...);
+  return request;
+}
+
+std::shared_ptr<BlockCacheClient> MakeClient(
+    std::shared_ptr<testing::MockClient> mock) {
+  return std::make_shared<BlockCacheClient>(
+      std::move(mock), std::make_shared<ObjectBlockCache>(1024, "", 0),
+      kBlockSize);
+}
+
+TEST(BlockCacheClientTest, GenerationPinnedReadsAreCached) {
+  auto mock = std::make_shared<testing::MockClient>();
+  // Only blocks 0 and 1 are needed for the range [2, 7).
+  EXPECT_CALL(*mock, ReadObject(_)).Times(2).WillRepeatedly(MockReadObject);
+  EXPECT_CALL(*mock, GetObjectMetadata(_)).Times(0);
+  auto client = MakeClient(mock);
+
+  for (int i = 0; i != 3; ++i) {
+    SCOPED_TRACE("Running iteration " + std::to_string(i));
+    auto source =
+        client->ReadObject(MakeRequest(Generation(42), ReadRange(2, 7)));
+    ASSERT_STATUS_OK(source);
+    auto contents = ReadAll(**source);
+    ASSERT_STATUS_OK(contents);
+    EXPECT_EQ("23456", *contents);
+  }
+
+  auto counters = client->cache()->counters();
+  EXPECT_EQ(4, counters.hits);
+  EXPECT_EQ(2, counters.misses);
+}
+
+TEST(BlockCacheClientTest, ReadsValidatedWithMetadata) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Return(MockMetadata(42)))
+      .WillOnce(Return(MockMetadata(42)))
+      .WillOnce(Return(MockMetadata(43)));
+  // The range [7, 10) needs blocks 1 and 2, the cache is invalidated when the
+  // generation changes.
+  EXPECT_CALL(*mock, ReadObject(_)).Times(4).WillRepeatedly(MockReadObject);
+  auto client = MakeClient(mock);
+
+  for (int i = 0; i != 3; ++i) {
+    SCOPED_TRACE("Running iteration " + std::to_string(i));
+    auto source = client->ReadObject(MakeRequest(ReadLast(3)));
+    ASSERT_STATUS_OK(source);
+    auto contents = ReadAll(**source);
+    ASSERT_STATUS_OK(contents);
+    EXPECT_EQ("789", *contents);
+  }
+}
+
+TEST(BlockCacheClientTest, UnknownObjectSize) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, ReadObject(_)).Times(3).WillRepeatedly(MockReadObject);
+  auto client = MakeClient(mock);
+
+  auto source =
+      client->ReadObject(MakeRequest(Generation(42), ReadRange(0, 1000)));
+  ASSERT_STATUS_OK(source);
+  auto contents = ReadAll(**source);
+  ASSERT_STATUS_OK(contents);
+  EXPECT_EQ(kContents, *contents);
+}
+
+TEST(BlockCacheClientTest, MetadataError) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(TransientError())));
+  EXPECT_CALL(*mock, ReadObject(_)).Times(0);
+  auto client = MakeClient(mock);
+
+  auto source = client->ReadObject(MakeRequest(ReadRange(0, 4)));
+  EXPECT_EQ(TransientError().code(), source.status().code());
+}
+
+TEST(BlockCacheClientTest, UncacheableReadsAreForwarded) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, GetObjectMetadata(_)).Times(0);
+  EXPECT_CALL(*mock, ReadObject(_))
+      .Times(3)
+      .WillRepeatedly(Invoke([](ReadObjectRangeRequest const&) {
+        return StatusOr<std::unique_ptr<ObjectReadSource>>(TransientError());
+      }));
+  auto client = MakeClient(mock);
+
+  auto source = client->ReadObject(MakeRequest());
+  EXPECT_EQ(TransientError().code(), source.status().code());
+  source = client->ReadObject(MakeRequest(ReadFromOffset(4)));
+  EXPECT_EQ(TransientError().code(), source.status().code());
+  source = client->ReadObject(
+      MakeRequest(Generation(42), ReadRange(0, 4), IfMetagenerationMatch(7)));
+  EXPECT_EQ(TransientError().code(), source.status().code());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
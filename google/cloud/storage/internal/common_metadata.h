@@ -80,22 +80,48 @@ class CommonMetadata {
     if (!json.is_object()) {
       return Status(StatusCode::kInvalidArgument, __func__);
     }
-    result.etag_ = json.value("etag", "");
-    result.id_ = json.value("id", "");
-    result.kind_ = json.value("kind", "");
-    result.metageneration_ = ParseLongField(json, "metageneration");
-    result.name_ = json.value("name", "");
-    if (json.count("owner") != 0) {
+    for (auto const& kv : json.items()) {
+      ParseField(result, kv.key(), kv.value());
+    }
+    return Status();
+  }
+
+  /**
+   * Parses one of the common fields from its JSON @p value.
+   *
+   * @return `false` if @p key is not one of the common fields, in which case
+   *     @p result is unchanged.
+   */
+  static bool ParseField(CommonMetadata<Derived>& result,
+                         std::string const& key,
+                         internal::nl::json const& value) {
+    if (key == "etag") {
+      result.etag_ = value.get<std::string>();
+    } else if (key == "id") {
+      result.id_ = value.get<std::string>();
+    } else if (key == "kind") {
+      result.kind_ = value.get<std::string>();
+    } else if (key == "metageneration") {
+      result.metageneration_ = ParseLongValue(value, "metageneration");
+    } else if (key == "name") {
+      result.name_ = value.get<std::string>();
+    } else if (key == "owner") {
       Owner o;
-      o.entity = json["owner"].value("entity", "");
-      o.entity_id = json["owner"].value("entityId", "");
+      o.entity = value.value("entity", "");
+      o.entity_id = value.value("entityId", "");
       result.owner_ = std::move(o);
+    } else if (key == "selfLink") {
+      result.self_link_ = value.get<std::string>();
+    } else if (key == "storageClass") {
+      result.storage_class_ = value.get<std::string>();
+    } else if (key == "timeCreated") {
+      result.time_created_ = ParseTimestampValue(value);
+    } else if (key == "updated") {
+      result.updated_ = ParseTimestampValue(value);
+    } else {
+      return false;
     }
-    result.self_link_ = json.value("selfLink", "");
-    result.storage_class_ = json.value("storageClass", "");
-    result.time_created_ = ParseTimestampField(json, "timeCreated");
-    result.updated_ = ParseTimestampField(json, "updated");
-    return Status();
+    return true;
   }
   static StatusOr<CommonMetadata> ParseFromString(std::string const& payload) {
     auto json = internal::nl::json::parse(payload);
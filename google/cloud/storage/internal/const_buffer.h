@@ -0,0 +1,64 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CONST_BUFFER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CONST_BUFFER_H
+
+#include "google/cloud/storage/version.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * A non-owning reference to a contiguous block of bytes.
+ *
+ * The referenced bytes must remain valid while the buffer is in use.
+ */
+class ConstBuffer {
+ public:
+  ConstBuffer(char const* data, std::size_t size) : data_(data), size_(size) {}
+
+  char const* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  char const* data_;
+  std::size_t size_;
+};
+
+/// A sequence of buffers sent as a single payload (scatter-gather I/O).
+using ConstBufferSequence = std::vector<ConstBuffer>;
+
+/// Returns the number of bytes in all the buffers in @p s.
+std::size_t TotalBytes(ConstBufferSequence const& s);
+
+/// Removes the first @p count bytes from @p s.
+void PopFrontBytes(ConstBufferSequence& s, std::size_t count);
+
+/// Copies the contents of @p s into a single string.
+std::string GatherBytes(ConstBufferSequence const& s);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CONST_BUFFER_H
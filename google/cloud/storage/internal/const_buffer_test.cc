@@ -0,0 +1,64 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/const_buffer.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+TEST(ConstBufferTest, TotalBytes) {
+  std::string const a = "abc";
+  std::string const b = "12345";
+  EXPECT_EQ(0, TotalBytes(ConstBufferSequence{}));
+  EXPECT_EQ(8, TotalBytes({ConstBuffer(a.data(), a.size()),
+                           ConstBuffer(b.data(), b.size())}));
+}
+
+TEST(ConstBufferTest, PopFrontBytes) {
+  std::string const a = "abc";
+  std::string const b = "12345";
+  ConstBufferSequence s{ConstBuffer(a.data(), a.size()),
+                        ConstBuffer(b.data(), b.size())};
+  PopFrontBytes(s, 0);
+  EXPECT_EQ("abc12345", GatherBytes(s));
+  PopFrontBytes(s, 2);
+  EXPECT_EQ("c12345", GatherBytes(s));
+  PopFrontBytes(s, 1);
+  ASSERT_EQ(1, s.size());
+  EXPECT_EQ("12345", GatherBytes(s));
+  PopFrontBytes(s, 4);
+  EXPECT_EQ("5", GatherBytes(s));
+  PopFrontBytes(s, 10);
+  EXPECT_TRUE(s.empty());
+}
+
+TEST(ConstBufferTest, GatherBytes) {
+  std::string const a = "abc";
+  std::string const b = "12345";
+  EXPECT_EQ("", GatherBytes({}));
+  EXPECT_EQ("12345abc", GatherBytes({ConstBuffer(b.data(), b.size()),
+                                     ConstBuffer(a.data(), a.size())}));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
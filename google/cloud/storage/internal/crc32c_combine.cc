@@ -0,0 +1,96 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/crc32c_combine.h"
+#include <array>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+// The CRC32C (Castagnoli) polynomial, in reversed bit order.
+std::uint32_t constexpr kCrc32cPolynomial = 0x82F63B78U;
+
+// Appending `n` zero bits to a message is a linear transformation of its CRC,
+// represented here as a 32x32 matrix over GF(2), one column per entry.
+using Gf2Matrix = std::array<std::uint32_t, 32>;
+
+std::uint32_t Gf2MatrixTimes(Gf2Matrix const& matrix, std::uint32_t vector) {
+  std::uint32_t sum = 0;
+  for (auto const& column : matrix) {
+    if (vector == 0) {
+      break;
+    }
+    if ((vector & 1U) != 0) {
+      sum ^= column;
+    }
+    vector >>= 1U;
+  }
+  return sum;
+}
+
+Gf2Matrix Gf2MatrixSquare(Gf2Matrix const& matrix) {
+  Gf2Matrix square;
+  for (std::size_t i = 0; i != matrix.size(); ++i) {
+    square[i] = Gf2MatrixTimes(matrix, matrix[i]);
+  }
+  return square;
+}
+}  // namespace
+
+std::uint32_t Crc32cCombine(std::uint32_t crc_a, std::uint32_t crc_b,
+                            std::uint64_t size_b) {
+  if (size_b == 0) {
+    return crc_a;
+  }
+
+  // `odd` is the operator to append a single zero bit.
+  Gf2Matrix odd;
+  odd[0] = kCrc32cPolynomial;
+  std::uint32_t row = 1;
+  for (std::size_t i = 1; i != odd.size(); ++i) {
+    odd[i] = row;
+    row <<= 1U;
+  }
+  // Compute the operators for two and four zero bits, then apply the operators
+  // for 8, 16, 32, ... bits (i.e. 1, 2, 4, ... bytes) as indicated by the bits
+  // in `size_b`.
+  Gf2Matrix even = Gf2MatrixSquare(odd);
+  odd = Gf2MatrixSquare(even);
+  do {
+    even = Gf2MatrixSquare(odd);
+    if ((size_b & 1U) != 0) {
+      crc_a = Gf2MatrixTimes(even, crc_a);
+    }
+    size_b >>= 1U;
+    if (size_b == 0) {
+      break;
+    }
+    odd = Gf2MatrixSquare(even);
+    if ((size_b & 1U) != 0) {
+      crc_a = Gf2MatrixTimes(odd, crc_a);
+    }
+    size_b >>= 1U;
+  } while (size_b != 0);
+
+  return crc_a ^ crc_b;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,64 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/crc32c_combine.h"
+#include <crc32c/crc32c.h>
+#include <gmock/gmock.h>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+TEST(Crc32cCombineTest, Simple) {
+  std::string const a = "The quick brown fox jumps ";
+  std::string const b = "over the lazy dog";
+  EXPECT_EQ(crc32c::Crc32c(a + b),
+            Crc32cCombine(crc32c::Crc32c(a), crc32c::Crc32c(b), b.size()));
+}
+
+TEST(Crc32cCombineTest, Empty) {
+  std::string const a = "123456789";
+  EXPECT_EQ(crc32c::Crc32c(a),
+            Crc32cCombine(crc32c::Crc32c(a), crc32c::Crc32c(""), 0));
+  EXPECT_EQ(crc32c::Crc32c(a),
+            Crc32cCombine(crc32c::Crc32c(""), crc32c::Crc32c(a), a.size()));
+}
+
+TEST(Crc32cCombineTest, ManyParts) {
+  std::string data;
+  for (int i = 0; i != 1000; ++i) {
+    data += std::to_string(i) + ": some data to checksum\n";
+  }
+  auto const expected = crc32c::Crc32c(data);
+  for (std::size_t part_size : {1, 7, 64, 1000, 4096, 10000}) {
+    SCOPED_TRACE("Testing with part_size=" + std::to_string(part_size));
+    std::uint32_t actual = 0;
+    for (std::size_t offset = 0; offset < data.size(); offset += part_size) {
+      auto const part = data.substr(offset, part_size);
+      actual = Crc32cCombine(actual, crc32c::Crc32c(part), part.size());
+    }
+    EXPECT_EQ(expected, actual);
+  }
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
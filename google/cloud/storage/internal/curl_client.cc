@@ -13,15 +13,19 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/curl_client.h"
+#include "google/cloud/internal/filesystem.h"
 #include "google/cloud/internal/getenv.h"
 #include "google/cloud/internal/make_unique.h"
 #include "google/cloud/storage/internal/curl_request_builder.h"
 #include "google/cloud/storage/internal/curl_resumable_upload_session.h"
 #include "google/cloud/storage/internal/generate_message_boundary.h"
+#include "google/cloud/storage/internal/hash_validator_impl.h"
 #include "google/cloud/storage/internal/object_streambuf.h"
+#include "google/cloud/storage/internal/upload_file_source.h"
 #include "google/cloud/storage/object_stream.h"
 #include "google/cloud/storage/version.h"
 #include "google/cloud/terminate_handler.h"
+#include <algorithm>
 #include <sstream>
 
 namespace google {
@@ -106,6 +110,28 @@ StatusOr<EmptyResponse> ReturnEmptyResponse(StatusOr<HttpResponse> response) {
   return EmptyResponse{};
 }
 
+/// Validates the hashes of a download made with `AsyncReadObject()`.
+StatusOr<std::string> CheckedDownload(HashValidator& validator,
+                                      StatusOr<HttpResponse> response) {
+  if (!response.ok()) {
+    return std::move(response).status();
+  }
+  if (response->status_code >= 300) {
+    return AsStatus(*response);
+  }
+  for (auto const& kv : response->headers) {
+    validator.ProcessHeader(kv.first, kv.second);
+  }
+  validator.Update(response->payload.data(), response->payload.size());
+  auto result = std::move(validator).Finish();
+  if (result.is_mismatch) {
+    return Status(StatusCode::kDataLoss,
+                  "mismatched hashes in download, expected=" +
+                      result.computed + ", received=" + result.received);
+  }
+  return std::move(response->payload);
+}
+
 template <typename ReturnType>
 StatusOr<ReturnType> ParseFromHttpResponse(StatusOr<HttpResponse> response) {
   if (!response.ok()) {
@@ -117,6 +143,147 @@ StatusOr<ReturnType> ParseFromHttpResponse(StatusOr<HttpResponse> response) {
   return ReturnType::FromHttpResponse(response->payload);
 }
 
+/**
+ * Makes the request in @p builder, streaming @p buffers as the payload.
+ *
+ * libcurl copies the data from the buffers as it needs more of it, they are
+ * never gathered into a single payload.
+ */
+StatusOr<HttpResponse> UploadBuffers(CurlRequestBuilder& builder,
+                                     ConstBufferSequence const& buffers) {
+  auto const payload_size = TotalBytes(buffers);
+  // libcurl reads the payload in order, unless it rewinds it to send the
+  // request again. Remember the buffer where the last read ended to find the
+  // next offset without searching all the buffers.
+  std::size_t index = 0;
+  std::uint64_t index_offset = 0;
+  auto source = [&buffers, index, index_offset](
+                    std::uint64_t offset, char* buffer,
+                    std::size_t size) mutable -> StatusOr<std::size_t> {
+    if (offset < index_offset) {
+      index = 0;
+      index_offset = 0;
+    }
+    while (index != buffers.size() &&
+           offset - index_offset >= buffers[index].size()) {
+      index_offset += buffers[index].size();
+      ++index;
+    }
+    std::size_t count = 0;
+    while (count != size && index != buffers.size()) {
+      auto const& current = buffers[index];
+      auto const start = static_cast<std::size_t>(offset - index_offset);
+      auto const n = (std::min)(size - count, current.size() - start);
+      std::copy(current.data() + start, current.data() + start + n,
+                buffer + count);
+      offset += n;
+      count += n;
+      if (start + n == current.size()) {
+        index_offset += current.size();
+        ++index;
+      }
+    }
+    return count;
+  };
+  return builder.BuildRequest().MakeUploadRequest(payload_size,
+                                                  std::move(source));
+}
+
+/// Makes the request in @p builder, sending the contents of @p request.
+StatusOr<HttpResponse> UploadContents(CurlRequestBuilder& builder,
+                                      InsertObjectMediaRequest const& request) {
+  if (!request.has_contents_view()) {
+    return builder.BuildRequest().MakeRequest(request.contents());
+  }
+  return UploadBuffers(builder, {request.contents_view()});
+}
+
+/**
+ * Makes the request in @p builder, sending @p header, the contents of @p file,
+ * and @p trailer as the payload.
+ *
+ * The file is read as libcurl needs more data, it is never loaded in memory.
+ */
+StatusOr<HttpResponse> UploadFile(CurlRequestBuilder& builder,
+                                  UploadFileSource& file,
+                                  std::string const& header = {},
+                                  std::string const& trailer = {}) {
+  auto const file_end = header.size() + file.size();
+  auto const payload_size = file_end + trailer.size();
+  auto source = [&](std::uint64_t offset, char* buffer,
+                    std::size_t size) -> StatusOr<std::size_t> {
+    std::size_t count = 0;
+    while (count != size && offset != payload_size) {
+      auto* out = buffer + count;
+      auto const available = size - count;
+      std::size_t n;
+      if (offset < header.size()) {
+        n = static_cast<std::size_t>(
+            (std::min<std::uint64_t>)(available, header.size() - offset));
+        std::copy(header.data() + offset, header.data() + offset + n, out);
+      } else if (offset < file_end) {
+        auto const wanted = static_cast<std::size_t>(
+            (std::min<std::uint64_t>)(available, file_end - offset));
+        auto read = file.ReadAt(offset - header.size(), out, wanted);
+        if (!read) {
+          return std::move(read).status();
+        }
+        if (*read == 0) {
+          return Status(StatusCode::kAborted,
+                        "UploadFile(" + file.file_name() +
+                            "): the file was truncated during the upload");
+        }
+        n = *read;
+      } else {
+        auto const start = static_cast<std::size_t>(offset - file_end);
+        n = (std::min)(available, trailer.size() - start);
+        std::copy(trailer.data() + start, trailer.data() + start + n, out);
+      }
+      offset += n;
+      count += n;
+    }
+    return count;
+  };
+  return builder.BuildRequest().MakeUploadRequest(payload_size,
+                                                  std::move(source));
+}
+
+/// The initial length for the separators in multipart uploads.
+constexpr int kCandidateInitialSize = 16;
+/// How fast the separator grows when found in the contents.
+constexpr int kCandidateGrowthSize = 4;
+
+/// The APIs used by `CurlClient::InsertObjectMedia()`.
+enum class InsertObjectMediaApi { kXml, kMultipart, kSimple };
+
+/// Picks the API to upload the object described by @p request.
+InsertObjectMediaApi PickInsertObjectMediaApi(
+    InsertObjectMediaRequest const& request) {
+  // If the object metadata is specified, then we need to do a multipart upload.
+  if (request.HasOption<WithObjectMetadata>()) {
+    return InsertObjectMediaApi::kMultipart;
+  }
+
+  // Unless the request uses a feature that disables it, prefer to use XML.
+  if (!request.HasOption<IfMetagenerationNotMatch>() &&
+      !request.HasOption<IfGenerationNotMatch>() &&
+      !request.HasOption<QuotaUser>() && !request.HasOption<UserIp>() &&
+      !request.HasOption<Projection>() && request.HasOption<Fields>() &&
+      request.GetOption<Fields>().value().empty()) {
+    return InsertObjectMediaApi::kXml;
+  }
+
+  // If the application has set an explicit hash value we need to use multipart
+  // uploads.
+  if (!request.HasOption<DisableMD5Hash>() &&
+      !request.HasOption<DisableCrc32cChecksum>()) {
+    return InsertObjectMediaApi::kMultipart;
+  }
+
+  // Otherwise do a simple upload.
+  return InsertObjectMediaApi::kSimple;
+}
+
 }  // namespace
 
 Status CurlClient::SetupBuilderCommon(CurlRequestBuilder& builder,
@@ -261,10 +428,14 @@ CurlClient::CurlClient(ClientOptions options)
       storage_factory_(CreateHandleFactory(options_)),
       upload_factory_(CreateHandleFactory(options_)),
       xml_upload_factory_(CreateHandleFactory(options_)),
-      xml_download_factory_(CreateHandleFactory(options_)) {
+      xml_download_factory_(CreateHandleFactory(options_)),
+      download_reactors_(CreateCurlDownloadReactors(
+          options_.download_reactor_thread_count())) {
   storage_endpoint_ = options_.endpoint() + "/storage/" + options_.version();
   upload_endpoint_ =
       options_.endpoint() + "/upload/storage/" + options_.version();
+  batch_endpoint_ =
+      options_.endpoint() + "/batch/storage/" + options_.version();
   iam_endpoint_ = options_.iam_endpoint();
 
   auto endpoint =
@@ -302,8 +473,11 @@ StatusOr<ResumableUploadResponse> CurlClient::UploadChunk(
   builder.AddHeader(request.RangeHeader());
   builder.AddHeader("Content-Type: application/octet-stream");
   builder.AddHeader("Content-Length: " +
-                    std::to_string(request.payload().size()));
-  auto response = builder.BuildRequest().MakeRequest(request.payload());
+                    std::to_string(request.payload_size()));
+  auto response =
+      request.has_payload_buffers()
+          ? UploadBuffers(builder, request.payload_buffers())
+          : builder.BuildRequest().MakeRequest(request.payload());
   if (!response.ok()) {
     return std::move(response).status();
   }
@@ -530,28 +704,17 @@ StatusOr<BucketMetadata> CurlClient::LockBucketRetentionPolicy(
 
 StatusOr<ObjectMetadata> CurlClient::InsertObjectMedia(
     InsertObjectMediaRequest const& request) {
-  // If the object metadata is specified, then we need to do a multipart upload.
-  if (request.HasOption<WithObjectMetadata>()) {
-    return InsertObjectMediaMultipart(request);
-  }
-
-  // Unless the request uses a feature that disables it, prefer to use XML.
-  if (!request.HasOption<IfMetagenerationNotMatch>() &&
-      !request.HasOption<IfGenerationNotMatch>() &&
-      !request.HasOption<QuotaUser>() && !request.HasOption<UserIp>() &&
-      !request.HasOption<Projection>() && request.HasOption<Fields>() &&
-      request.GetOption<Fields>().value().empty()) {
-    return InsertObjectMediaXml(request);
-  }
-
-  // If the application has set an explicit hash value we need to use multipart
-  // uploads.
-  if (!request.HasOption<DisableMD5Hash>() &&
-      !request.HasOption<DisableCrc32cChecksum>()) {
-    return InsertObjectMediaMultipart(request);
+  if (!request.contents_file().empty()) {
+    return InsertObjectMediaFile(request);
+  }
+  switch (PickInsertObjectMediaApi(request)) {
+    case InsertObjectMediaApi::kXml:
+      return InsertObjectMediaXml(request);
+    case InsertObjectMediaApi::kMultipart:
+      return InsertObjectMediaMultipart(request);
+    case InsertObjectMediaApi::kSimple:
+      break;
   }
-
-  // Otherwise do a simple upload.
   return InsertObjectMediaSimple(request);
 }
 
@@ -613,6 +776,7 @@ StatusOr<std::unique_ptr<ObjectReadSource>> CurlClient::ReadObject(
   if (request.RequiresNoCache()) {
     builder.AddHeader("Cache-Control: no-transform");
   }
+  builder.SetDownloadReactor(PickDownloadReactor());
 
   return std::unique_ptr<ObjectReadSource>(
       new CurlDownloadRequest(builder.BuildDownloadRequest(std::string{})));
@@ -1184,6 +1348,130 @@ StatusOr<EmptyResponse> CurlClient::DeleteNotification(
   return ReturnEmptyResponse(builder.BuildRequest().MakeRequest(std::string{}));
 }
 
+StatusOr<BatchResponse> CurlClient::ExecuteBatch(BatchRequest const& request) {
+  if (request.empty()) {
+    return BatchResponse{};
+  }
+  if (request.size() > kMaximumBatchSize) {
+    return Status(StatusCode::kInvalidArgument,
+                  "too many sub-requests in batch (" +
+                      std::to_string(request.size()) + "), the maximum is " +
+                      std::to_string(kMaximumBatchSize));
+  }
+  CurlRequestBuilder builder(batch_endpoint_, storage_factory_);
+  auto status = SetupBuilderCommon(builder, "POST");
+  if (!status.ok()) {
+    return status;
+  }
+
+  // Each sub-request is an embedded HTTP request, with a path relative to the
+  // host, the boundary must not appear in any of them.
+  auto const path_prefix = "/storage/" + options_.version();
+  std::vector<std::string> parts;
+  parts.reserve(request.size());
+  std::string text_to_avoid;
+  for (auto const& part : request.parts()) {
+    parts.push_back(FormatBatchPart(part, path_prefix));
+    text_to_avoid += parts.back();
+  }
+  auto boundary =
+      PickBoundary(ConstBuffer(text_to_avoid.data(), text_to_avoid.size()));
+  builder.AddHeader("content-type: multipart/mixed; boundary=" + boundary);
+  auto contents = FormatBatchPayload(parts, boundary);
+  builder.AddHeader("Content-Length: " + std::to_string(contents.size()));
+
+  auto response = builder.BuildRequest().MakeRequest(contents);
+  if (!response.ok()) {
+    return std::move(response).status();
+  }
+  if (response->status_code >= 300) {
+    return AsStatus(*response);
+  }
+  return BatchResponse::FromHttpResponse(*response, request.size());
+}
+
+future<StatusOr<ObjectMetadata>> CurlClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  if (!request.contents_file().empty()) {
+    return make_ready_future(StatusOr<ObjectMetadata>(
+        Status(StatusCode::kInvalidArgument,
+               std::string(__func__) + "(): uploads from files are not "
+                                       "supported by asynchronous requests")));
+  }
+  // The multipart upload works with all the request options, and validates the
+  // hashes of the object contents.
+  CurlRequestBuilder builder(
+      upload_endpoint_ + "/b/" + request.bucket_name() + "/o", upload_factory_);
+  auto payload = SetupMultipartUpload(builder, request);
+  if (!payload) {
+    return make_ready_future(
+        StatusOr<ObjectMetadata>(std::move(payload).status()));
+  }
+  // The asynchronous request owns its payload, the caller may release the
+  // contents before the request completes.
+  auto contents = std::move(payload->header);
+  contents.append(payload->contents.data(), payload->contents.size());
+  contents += payload->trailer;
+  // Keep the client, and therefore the CURLSH* handle used by the transfer,
+  // alive until the request completes.
+  auto self = shared_from_this();
+  return builder.BuildRequest()
+      .MakeRequestAsync(*CurlAsyncReactor(), std::move(contents))
+      .then([self](future<StatusOr<HttpResponse>> f) {
+        return CheckedFromString<ObjectMetadataParser>(f.get());
+      });
+}
+
+future<StatusOr<ObjectMetadata>> CurlClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  CurlRequestBuilder builder(storage_endpoint_ + "/b/" + request.bucket_name() +
+                                 "/o/" + UrlEscapeString(request.object_name()),
+                             storage_factory_);
+  auto status = SetupBuilder(builder, request, "GET");
+  if (!status.ok()) {
+    return make_ready_future(StatusOr<ObjectMetadata>(std::move(status)));
+  }
+  auto self = shared_from_this();
+  return builder.BuildRequest()
+      .MakeRequestAsync(*CurlAsyncReactor(), std::string{})
+      .then([self](future<StatusOr<HttpResponse>> f) {
+        return CheckedFromString<ObjectMetadataParser>(f.get());
+      });
+}
+
+future<StatusOr<std::string>> CurlClient::AsyncReadObject(
+    ReadObjectRangeRequest const& request) {
+  CurlRequestBuilder builder(storage_endpoint_ + "/b/" + request.bucket_name() +
+                                 "/o/" + UrlEscapeString(request.object_name()),
+                             storage_factory_);
+  auto status = SetupBuilder(builder, request, "GET");
+  if (!status.ok()) {
+    return make_ready_future(StatusOr<std::string>(std::move(status)));
+  }
+  builder.AddQueryParameter("alt", "media");
+  if (request.RequiresRangeHeader()) {
+    builder.AddHeader(request.RangeHeader());
+  }
+  if (request.RequiresNoCache()) {
+    builder.AddHeader("Cache-Control: no-transform");
+  }
+  auto self = shared_from_this();
+  std::shared_ptr<HashValidator> validator = CreateHashValidator(request);
+  return builder.BuildRequest()
+      .MakeRequestAsync(*CurlAsyncReactor(), std::string{})
+      .then([self, validator](future<StatusOr<HttpResponse>> f) {
+        return CheckedDownload(*validator, f.get());
+      });
+}
+
+future<void> CurlClient::AsyncSleep(std::chrono::milliseconds duration) {
+  auto done = std::make_shared<promise<void>>();
+  auto f = done->get_future();
+  CurlAsyncReactor()->AddTimer(std::chrono::steady_clock::now() + duration,
+                               [done] { done->set_value(); });
+  return f;
+}
+
 void CurlClient::LockShared(curl_lock_data data) {
   switch (data) {
     case CURL_LOCK_DATA_SHARE:
@@ -1243,7 +1531,7 @@ void CurlClient::UnlockShared(curl_lock_data data) {
 }
 
 StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaXml(
-    InsertObjectMediaRequest const& request) {
+    InsertObjectMediaRequest const& request, UploadFileSource* file) {
   CurlRequestBuilder builder(xml_upload_endpoint_ + "/" +
                                  request.bucket_name() + "/" +
                                  UrlEscapeString(request.object_name()),
@@ -1253,6 +1541,7 @@ StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaXml(
     return status;
   }
   builder.AddHeader("Host: storage.googleapis.com");
+  auto const contents = request.contents_view();
 
   //
   // Apply the options from InsertObjectMediaRequest that are set, translating
@@ -1286,15 +1575,16 @@ StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaXml(
   if (request.HasOption<MD5HashValue>()) {
     builder.AddHeader("x-goog-hash: md5=" +
                       request.GetOption<MD5HashValue>().value());
-  } else if (!request.HasOption<DisableMD5Hash>()) {
-    builder.AddHeader("x-goog-hash: md5=" + ComputeMD5Hash(request.contents()));
+  } else if (file == nullptr && !request.HasOption<DisableMD5Hash>()) {
+    builder.AddHeader("x-goog-hash: md5=" +
+                      ComputeMD5Hash(contents.data(), contents.size()));
   }
   if (request.HasOption<Crc32cChecksumValue>()) {
     builder.AddHeader("x-goog-hash: crc32c=" +
                       request.GetOption<Crc32cChecksumValue>().value());
-  } else if (!request.HasOption<DisableCrc32cChecksum>()) {
+  } else if (file == nullptr && !request.HasOption<DisableCrc32cChecksum>()) {
     builder.AddHeader("x-goog-hash: crc32c=" +
-                      ComputeCrc32cChecksum(request.contents()));
+                      ComputeCrc32cChecksum(contents.data(), contents.size()));
   }
   if (request.HasOption<PredefinedAcl>()) {
     builder.AddHeader(
@@ -1314,19 +1604,43 @@ StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaXml(
   // QuotaUser cannot be set, checked by the caller.
   // UserIp cannot be set, checked by the caller.
 
-  builder.AddHeader("Content-Length: " +
-                    std::to_string(request.contents().size()));
-  auto response = builder.BuildRequest().MakeRequest(request.contents());
+  auto const contents_size =
+      file == nullptr ? std::uint64_t{contents.size()} : file->size();
+  builder.AddHeader("Content-Length: " + std::to_string(contents_size));
+  auto response = file == nullptr ? UploadContents(builder, request)
+                                  : UploadFile(builder, *file);
   if (!response.ok()) {
     return std::move(response).status();
   }
   if (response->status_code >= 300) {
     return AsStatus(*response);
   }
-  return internal::ObjectMetadataParser::FromJson(internal::nl::json{
+  auto metadata = internal::nl::json{
       {"name", request.object_name()},
       {"bucket", request.bucket_name()},
-  });
+  };
+  // The XML API returns the hashes of the new object as headers, e.g.
+  // "x-goog-hash: crc32c=...", report them in the metadata.
+  for (auto const& kv : response->headers) {
+    if (kv.first != "x-goog-hash") {
+      continue;
+    }
+    std::istringstream values(kv.second);
+    std::string value;
+    while (std::getline(values, value, ',')) {
+      auto const pos = value.find('=');
+      if (pos == std::string::npos) {
+        continue;
+      }
+      auto const name = value.substr(0, pos);
+      if (name == "md5") {
+        metadata["md5Hash"] = value.substr(pos + 1);
+      } else if (name == "crc32c") {
+        metadata["crc32c"] = value.substr(pos + 1);
+      }
+    }
+  }
+  return internal::ObjectMetadataParser::FromJson(metadata);
 }
 
 StatusOr<std::unique_ptr<ObjectReadSource>> CurlClient::ReadObjectXml(
@@ -1377,26 +1691,57 @@ StatusOr<std::unique_ptr<ObjectReadSource>> CurlClient::ReadObjectXml(
   if (request.RequiresNoCache()) {
     builder.AddHeader("Cache-Control: no-transform");
   }
+  builder.SetDownloadReactor(PickDownloadReactor());
 
   return std::unique_ptr<ObjectReadSource>(
       new CurlDownloadRequest(builder.BuildDownloadRequest(std::string{})));
 }
 
 StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaMultipart(
-    InsertObjectMediaRequest const& request) {
+    InsertObjectMediaRequest const& request, UploadFileSource* file,
+    std::string boundary) {
+  CurlRequestBuilder builder(
+      upload_endpoint_ + "/b/" + request.bucket_name() + "/o", upload_factory_);
+  auto payload =
+      file == nullptr
+          ? SetupMultipartUpload(builder, request)
+          : SetupMultipartUpload(builder, request, boundary, file->size());
+  if (!payload) {
+    return std::move(payload).status();
+  }
+  if (file != nullptr) {
+    return CheckedFromString<ObjectMetadataParser>(
+        UploadFile(builder, *file, payload->header, payload->trailer));
+  }
+  auto const& header = payload->header;
+  auto const& trailer = payload->trailer;
+  return CheckedFromString<ObjectMetadataParser>(UploadBuffers(
+      builder, {ConstBuffer(header.data(), header.size()), payload->contents,
+                ConstBuffer(trailer.data(), trailer.size())}));
+}
+
+StatusOr<CurlClient::MultipartPayload> CurlClient::SetupMultipartUpload(
+    CurlRequestBuilder& builder, InsertObjectMediaRequest const& request) {
+  auto const contents = request.contents_view();
+  return SetupMultipartUpload(builder, request, PickBoundary(contents),
+                              contents.size());
+}
+
+StatusOr<CurlClient::MultipartPayload> CurlClient::SetupMultipartUpload(
+    CurlRequestBuilder& builder, InsertObjectMediaRequest const& request,
+    std::string const& boundary, std::uint64_t contents_size) {
   // To perform a multipart upload we need to separate the parts using:
   //   https://cloud.google.com/storage/docs/json_api/v1/how-tos/multipart-upload
   // This function is structured as follows:
-  // 1. Create a request object, as we often do.
-  CurlRequestBuilder builder(
-      upload_endpoint_ + "/b/" + request.bucket_name() + "/o", upload_factory_);
+  // 1. Configure the request object, as we often do.
   auto status = SetupBuilder(builder, request, "POST");
   if (!status.ok()) {
     return status;
   }
 
-  // 2. Pick a separator that does not conflict with the request contents.
-  auto boundary = PickBoundary(request.contents());
+  // 2. Use the separator, the caller picked one that does not conflict with the
+  //    request contents.
+  auto const contents = request.contents_view();
   builder.AddHeader("content-type: multipart/related; boundary=" + boundary);
   builder.AddQueryParameter("uploadType", "multipart");
   builder.AddQueryParameter("name", request.object_name());
@@ -1410,16 +1755,20 @@ StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaMultipart(
     metadata = ObjectMetadataJsonForInsert(
         request.GetOption<WithObjectMetadata>().value());
   }
+  // The hashes for files are computed while the file is uploaded, and
+  // validated after the upload, see `InsertObjectMediaFile()`.
+  auto const in_memory = request.contents_file().empty();
   if (request.HasOption<MD5HashValue>()) {
     metadata["md5Hash"] = request.GetOption<MD5HashValue>().value();
-  } else {
-    metadata["md5Hash"] = ComputeMD5Hash(request.contents());
+  } else if (in_memory) {
+    metadata["md5Hash"] = ComputeMD5Hash(contents.data(), contents.size());
   }
 
   if (request.HasOption<Crc32cChecksumValue>()) {
     metadata["crc32c"] = request.GetOption<Crc32cChecksumValue>().value();
-  } else {
-    metadata["crc32c"] = ComputeCrc32cChecksum(request.contents());
+  } else if (in_memory) {
+    metadata["crc32c"] =
+        ComputeCrc32cChecksum(contents.data(), contents.size());
   }
 
   std::string crlf = "\r\n";
@@ -1440,16 +1789,32 @@ StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaMultipart(
   } else {
     writer << "content-type: application/octet-stream" << crlf;
   }
-  writer << crlf << request.contents() << crlf << marker << "--" << crlf;
+  writer << crlf;
 
-  // 6. Return the results as usual.
-  auto contents = std::move(writer).str();
-  builder.AddHeader("Content-Length: " + std::to_string(contents.size()));
-  return CheckedFromString<ObjectMetadataParser>(
-      builder.BuildRequest().MakeRequest(contents));
+  // 6. Return the payload, the caller makes the request. The object contents
+  //    are not copied, they are sent between the headers and the trailer.
+  MultipartPayload payload{std::move(writer).str(), contents,
+                           crlf + marker + "--" + crlf};
+  builder.AddHeader("Content-Length: " +
+                    std::to_string(payload.header.size() + contents_size +
+                                   payload.trailer.size()));
+  return payload;
+}
+
+std::shared_ptr<CurlDownloadReactor> CurlClient::PickDownloadReactor() const {
+  std::shared_ptr<CurlDownloadReactor> best;
+  std::size_t best_load = 0;
+  for (auto const& r : download_reactors_) {
+    auto load = r->active_handles();
+    if (!best || load < best_load) {
+      best = r;
+      best_load = load;
+    }
+  }
+  return best;
 }
 
-std::string CurlClient::PickBoundary(std::string const& text_to_avoid) {
+std::string CurlClient::PickBoundary(ConstBuffer const& text_to_avoid) {
   // We need to find a string that is *not* found in `text_to_avoid`, we pick
   // a string at random, and see if it is in `text_to_avoid`, if it is, we grow
   // the string with random characters and start from where we last found a
@@ -1457,19 +1822,21 @@ std::string CurlClient::PickBoundary(std::string const& text_to_avoid) {
   // larger than `text_to_avoid`.  And we only make (approximately) one pass
   // over `text_to_avoid`.
   auto generate_candidate = [this](int n) {
-    static std::string const kChars =
-        "abcdefghijklmnopqrstuvwxyz012456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    std::unique_lock<std::mutex> lk(mu_);
-    return google::cloud::internal::Sample(generator_, n, kChars);
+    return GenerateBoundaryCandidate(n);
   };
-  constexpr int kCandidateInitialSize = 16;
-  constexpr int kCandidateGrowthSize = 4;
   return GenerateMessageBoundary(text_to_avoid, std::move(generate_candidate),
                                  kCandidateInitialSize, kCandidateGrowthSize);
 }
 
+std::string CurlClient::GenerateBoundaryCandidate(int n) {
+  static std::string const kChars =
+      "abcdefghijklmnopqrstuvwxyz012456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  std::unique_lock<std::mutex> lk(mu_);
+  return google::cloud::internal::Sample(generator_, n, kChars);
+}
+
 StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaSimple(
-    InsertObjectMediaRequest const& request) {
+    InsertObjectMediaRequest const& request, UploadFileSource* file) {
   CurlRequestBuilder builder(
       upload_endpoint_ + "/b/" + request.bucket_name() + "/o", upload_factory_);
   auto status = SetupBuilder(builder, request, "POST");
@@ -1483,10 +1850,74 @@ StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaSimple(
   }
   builder.AddQueryParameter("uploadType", "media");
   builder.AddQueryParameter("name", request.object_name());
+  if (file != nullptr) {
+    builder.AddHeader("Content-Length: " + std::to_string(file->size()));
+    return CheckedFromString<ObjectMetadataParser>(UploadFile(builder, *file));
+  }
   builder.AddHeader("Content-Length: " +
-                    std::to_string(request.contents().size()));
+                    std::to_string(request.contents_view().size()));
   return CheckedFromString<ObjectMetadataParser>(
-      builder.BuildRequest().MakeRequest(request.contents()));
+      UploadContents(builder, request));
+}
+
+StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaFile(
+    InsertObjectMediaRequest const& request) {
+  auto file = UploadFileSource::Open(request.contents_file());
+  if (!file) {
+    return std::move(file).status();
+  }
+  auto& source = **file;
+  auto const api = PickInsertObjectMediaApi(request);
+
+  // Sending the hashes before the contents would need an extra pass over the
+  // file. Instead, compute them while libcurl reads the file and compare them
+  // against the hashes of the new object, as `ObjectWriteStream` does.
+  // Multipart uploads also check that the boundary does not appear in the
+  // file. That is very unlikely, but if it happens the upload is aborted and
+  // restarted with a longer boundary.
+  std::string boundary;
+  if (api == InsertObjectMediaApi::kMultipart) {
+    boundary = GenerateBoundaryCandidate(kCandidateInitialSize);
+  }
+  for (;;) {
+    auto validator = CreateHashValidator(request);
+    BlockSearch search(boundary);
+    source.set_observer([&](char const* data, std::size_t n) {
+      validator->Update(data, n);
+      search.Update(data, n);
+      if (search.found()) {
+        return Status(StatusCode::kAborted,
+                      "the multipart boundary appears in the file");
+      }
+      return Status();
+    });
+    auto metadata = [&]() -> StatusOr<ObjectMetadata> {
+      switch (api) {
+        case InsertObjectMediaApi::kXml:
+          return InsertObjectMediaXml(request, &source);
+        case InsertObjectMediaApi::kMultipart:
+          return InsertObjectMediaMultipart(request, &source, boundary);
+        case InsertObjectMediaApi::kSimple:
+          break;
+      }
+      return InsertObjectMediaSimple(request, &source);
+    }();
+    if (search.found()) {
+      boundary += GenerateBoundaryCandidate(kCandidateGrowthSize);
+      continue;
+    }
+    if (!metadata) {
+      return metadata;
+    }
+    validator->ProcessMetadata(*metadata);
+    auto result = std::move(*validator).Finish();
+    if (result.is_mismatch) {
+      return Status(StatusCode::kDataLoss,
+                    "mismatched hashes in upload, expected=" +
+                        result.computed + ", received=" + result.received);
+    }
+    return metadata;
+  }
 }
 
 StatusOr<std::string> CurlClient::AuthorizationHeader(
@@ -16,6 +16,7 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_CLIENT_H
 
 #include "google/cloud/internal/random.h"
+#include "google/cloud/storage/internal/curl_download_reactor.h"
 #include "google/cloud/storage/internal/curl_handle_factory.h"
 #include "google/cloud/storage/internal/raw_client.h"
 #include "google/cloud/storage/internal/resumable_upload_session.h"
@@ -29,6 +30,7 @@ namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
 class CurlRequestBuilder;
+class UploadFileSource;
 
 /**
  * Implements the low-level RPCs to Google Cloud Storage using libcurl.
@@ -177,6 +179,16 @@ class CurlClient : public RawClient,
   StatusOr<EmptyResponse> DeleteNotification(
       DeleteNotificationRequest const&) override;
 
+  StatusOr<BatchResponse> ExecuteBatch(BatchRequest const& request) override;
+
+  future<StatusOr<ObjectMetadata>> AsyncInsertObjectMedia(
+      InsertObjectMediaRequest const& request) override;
+  future<StatusOr<ObjectMetadata>> AsyncGetObjectMetadata(
+      GetObjectMetadataRequest const& request) override;
+  future<StatusOr<std::string>> AsyncReadObject(
+      ReadObjectRangeRequest const& request) override;
+  future<void> AsyncSleep(std::chrono::milliseconds duration) override;
+
   StatusOr<std::string> AuthorizationHeader(
       std::shared_ptr<google::cloud::storage::oauth2::Credentials> const&);
 
@@ -197,18 +209,76 @@ class CurlClient : public RawClient,
   Status SetupBuilder(CurlRequestBuilder& builder, Request const& request,
                       char const* method);
 
+  /**
+   * Insert an object using the XML API.
+   *
+   * The contents are read from @p file if it is not null, otherwise they are
+   * in @p request.
+   */
   StatusOr<ObjectMetadata> InsertObjectMediaXml(
-      InsertObjectMediaRequest const& request);
+      InsertObjectMediaRequest const& request,
+      UploadFileSource* file = nullptr);
   StatusOr<std::unique_ptr<ObjectReadSource>> ReadObjectXml(
       ReadObjectRangeRequest const& request);
 
-  /// Insert an object using uploadType=multipart.
+  /// Returns the least loaded download reactor, or `nullptr` if disabled.
+  std::shared_ptr<CurlDownloadReactor> PickDownloadReactor() const;
+
+  /**
+   * Insert an object using uploadType=multipart.
+   *
+   * The contents are read from @p file if it is not null, in that case
+   * @p boundary must not appear in the file. Otherwise the contents are in
+   * @p request and the boundary is computed from them.
+   */
   StatusOr<ObjectMetadata> InsertObjectMediaMultipart(
-      InsertObjectMediaRequest const& request);
-  std::string PickBoundary(std::string const& text_to_avoid);
+      InsertObjectMediaRequest const& request,
+      UploadFileSource* file = nullptr, std::string boundary = {});
+
+  /// The payload for a uploadType=multipart upload.
+  struct MultipartPayload {
+    /// The metadata part, and the headers for the media part.
+    std::string header;
+    /// The object contents, not owned by the payload.
+    ConstBuffer contents;
+    /// The final separator.
+    std::string trailer;
+  };
+
+  /**
+   * Prepares @p builder for a uploadType=multipart upload.
+   *
+   * @return the payload for the upload, which refers to the object contents in
+   *     @p request.
+   */
+  StatusOr<MultipartPayload> SetupMultipartUpload(
+      CurlRequestBuilder& builder, InsertObjectMediaRequest const& request);
 
-  /// Insert an object using uploadType=media.
+  /**
+   * Prepares @p builder for a uploadType=multipart upload of @p contents_size
+   * bytes separated by @p boundary.
+   *
+   * The hashes not set in @p request are computed from its contents, unless
+   * the contents are in a file.
+   */
+  StatusOr<MultipartPayload> SetupMultipartUpload(
+      CurlRequestBuilder& builder, InsertObjectMediaRequest const& request,
+      std::string const& boundary, std::uint64_t contents_size);
+  std::string PickBoundary(ConstBuffer const& text_to_avoid);
+  std::string GenerateBoundaryCandidate(int n);
+
+  /**
+   * Insert an object using uploadType=media.
+   *
+   * The contents are read from @p file if it is not null, otherwise they are
+   * in @p request.
+   */
   StatusOr<ObjectMetadata> InsertObjectMediaSimple(
+      InsertObjectMediaRequest const& request,
+      UploadFileSource* file = nullptr);
+
+  /// Insert an object streaming its contents from `request.contents_file()`.
+  StatusOr<ObjectMetadata> InsertObjectMediaFile(
       InsertObjectMediaRequest const& request);
 
   template <typename RequestType>
@@ -218,6 +288,7 @@ class CurlClient : public RawClient,
   ClientOptions options_;
   std::string storage_endpoint_;
   std::string upload_endpoint_;
+  std::string batch_endpoint_;
   std::string xml_upload_endpoint_;
   std::string xml_download_endpoint_;
   std::string iam_endpoint_;
@@ -242,6 +313,10 @@ class CurlClient : public RawClient,
   std::shared_ptr<CurlHandleFactory> upload_factory_;
   std::shared_ptr<CurlHandleFactory> xml_upload_factory_;
   std::shared_ptr<CurlHandleFactory> xml_download_factory_;
+
+  // Each download holds a reference to its reactor, so the reactors (and their
+  // background threads) are only deleted after all downloads complete.
+  std::vector<std::shared_ptr<CurlDownloadReactor>> download_reactors_;
 };
 
 }  // namespace internal
@@ -19,9 +19,16 @@
 #include "google/cloud/storage/internal/curl_request_builder.h"
 #include "google/cloud/storage/oauth2/credentials.h"
 #include "google/cloud/storage/oauth2/google_credentials.h"
+#include "google/cloud/storage/testing/loopback_http_server.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/testing_util/assert_ok.h"
 #include "google/cloud/testing_util/scoped_environment.h"
 #include <gmock/gmock.h>
+#include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -33,7 +40,12 @@ namespace internal {
 namespace {
 
 using ::google::cloud::storage::oauth2::Credentials;
+using ::google::cloud::storage::testing::LoopbackHttpRequest;
+using ::google::cloud::storage::testing::LoopbackHttpResponse;
+using ::google::cloud::storage::testing::LoopbackHttpServer;
 using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::StartsWith;
 
 StatusCode const STATUS_ERROR_CODE = StatusCode::kUnavailable;
 std::string const STATUS_ERROR_MSG =
@@ -227,6 +239,26 @@ TEST_P(CurlClientTest, InsertObjectMediaXml) {
   CheckStatus(actual);
 }
 
+TEST_P(CurlClientTest, InsertObjectMediaFile) {
+  testing::TempFile temp_file("contents");
+  auto actual = client_
+                    ->InsertObjectMedia(
+                        InsertObjectMediaRequest("bkt", "obj", std::string{})
+                            .set_contents_file(temp_file.name()))
+                    .status();
+  CheckStatus(actual);
+}
+
+TEST_P(CurlClientTest, InsertObjectMediaFileMissing) {
+  auto actual = client_
+                    ->InsertObjectMedia(
+                        InsertObjectMediaRequest("bkt", "obj", std::string{})
+                            .set_contents_file("/not-a-directory/not-a-file"))
+                    .status();
+  EXPECT_EQ(StatusCode::kNotFound, actual.code());
+  EXPECT_THAT(actual.message(), HasSubstr("/not-a-directory/not-a-file"));
+}
+
 TEST_P(CurlClientTest, GetObjectMetadata) {
   auto actual =
       client_->GetObjectMetadata(GetObjectMetadataRequest("bkt", "obj"))
@@ -501,12 +533,255 @@ TEST_P(CurlClientTest, DeleteNotification) {
   CheckStatus(actual);
 }
 
+TEST_P(CurlClientTest, ExecuteBatch) {
+  BatchRequest request;
+  request.AddRequest(DeleteObjectRequest("bkt", "obj"));
+  auto actual = client_->ExecuteBatch(request).status();
+  CheckStatus(actual);
+}
+
 INSTANTIATE_TEST_SUITE_P(CredentialsFailure, CurlClientTest,
                          ::testing::Values("credentials-failure"));
 
 INSTANTIATE_TEST_SUITE_P(LibCurlFailure, CurlClientTest,
                          ::testing::Values("libcurl-failure"));
 
+#ifndef _WIN32
+/// Verify the requests created by `CurlClient` using a local HTTP server.
+class CurlClientLoopbackTest : public ::testing::Test {
+ protected:
+  CurlClientLoopbackTest()
+      : server_([this](LoopbackHttpRequest const&) {
+          std::unique_lock<std::mutex> lk(mu_);
+          LoopbackHttpResponse response = response_;
+          lk.unlock();
+          response.drop_connection = drop_next_request_.exchange(false);
+          return response;
+        }),
+        endpoint_("CLOUD_STORAGE_TESTBENCH_ENDPOINT", server_.endpoint()),
+        client_(CurlClient::Create(
+            ClientOptions(oauth2::CreateAnonymousCredentials())
+                .set_endpoint(server_.endpoint()))) {
+    SetResponse(R"""({"name": "obj"})""");
+  }
+
+  /// The values of the @p name header in @p request.
+  static std::vector<std::string> Headers(LoopbackHttpRequest const& request,
+                                          std::string const& name) {
+    std::vector<std::string> values;
+    auto range = request.headers.equal_range(name);
+    for (auto i = range.first; i != range.second; ++i) {
+      values.push_back(i->second);
+    }
+    return values;
+  }
+
+  /// Sets the response for the following requests.
+  void SetResponse(std::string payload,
+                   std::multimap<std::string, std::string> headers = {}) {
+    std::lock_guard<std::mutex> lk(mu_);
+    response_.payload = std::move(payload);
+    response_.headers = std::move(headers);
+  }
+
+  /// The metadata for an object with the hashes of @p contents.
+  static std::string ObjectWithHashes(std::string const& contents) {
+    return nl::json{{"name", "obj"},
+                    {"md5Hash", ComputeMD5Hash(contents)},
+                    {"crc32c", ComputeCrc32cChecksum(contents)}}
+        .dump();
+  }
+
+  std::mutex mu_;
+  LoopbackHttpResponse response_;  // GUARDED_BY(mu_)
+  /// If true, the server closes the connection instead of responding.
+  std::atomic<bool> drop_next_request_{false};
+  LoopbackHttpServer server_;
+  testing_util::ScopedEnvironment endpoint_;
+  std::shared_ptr<CurlClient> client_;
+};
+
+TEST_F(CurlClientLoopbackTest, InsertObjectMediaFileXml) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  SetResponse({}, {{"x-goog-hash", "crc32c=" + ComputeCrc32cChecksum(contents)},
+                   {"x-goog-hash", "md5=" + ComputeMD5Hash(contents)}});
+  testing::TempFile temp_file(contents);
+  auto actual = client_->InsertObjectMedia(
+      InsertObjectMediaRequest("bkt", "obj", std::string{})
+          .set_contents_file(temp_file.name())
+          .set_multiple_options(Fields("")));
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ("obj", actual->name());
+  EXPECT_EQ(ComputeMD5Hash(contents), actual->md5_hash());
+  EXPECT_EQ(ComputeCrc32cChecksum(contents), actual->crc32c());
+
+  auto requests = server_.requests();
+  ASSERT_EQ(1, requests.size());
+  auto const& r = requests.front();
+  EXPECT_THAT(r.request_line, StartsWith("PUT /xmlapi/bkt/obj "));
+  // The hashes are validated after the upload, the file is read only once.
+  EXPECT_TRUE(Headers(r, "x-goog-hash").empty());
+  EXPECT_EQ(contents, r.body);
+}
+
+TEST_F(CurlClientLoopbackTest, InsertObjectMediaFileXmlHashMismatch) {
+  SetResponse({}, {{"x-goog-hash", "crc32c=" + ComputeCrc32cChecksum("x") +
+                                       ",md5=" + ComputeMD5Hash("x")}});
+  testing::TempFile temp_file("some contents");
+  auto actual = client_->InsertObjectMedia(
+      InsertObjectMediaRequest("bkt", "obj", std::string{})
+          .set_contents_file(temp_file.name())
+          .set_multiple_options(Fields("")));
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(StatusCode::kDataLoss, actual.status().code());
+}
+
+TEST_F(CurlClientLoopbackTest, InsertObjectMediaFileXmlExplicitHashes) {
+  testing::TempFile temp_file("some contents");
+  auto actual = client_->InsertObjectMedia(
+      InsertObjectMediaRequest("bkt", "obj", std::string{})
+          .set_contents_file(temp_file.name())
+          .set_multiple_options(Fields(""), MD5HashValue("test-md5"),
+                                DisableCrc32cChecksum(true)));
+  ASSERT_STATUS_OK(actual);
+
+  auto requests = server_.requests();
+  ASSERT_EQ(1, requests.size());
+  EXPECT_THAT(Headers(requests.front(), "x-goog-hash"),
+              ::testing::ElementsAre("md5=test-md5"));
+}
+
+TEST_F(CurlClientLoopbackTest, InsertObjectMediaFileMultipart) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  SetResponse(ObjectWithHashes(contents));
+  testing::TempFile temp_file(contents);
+  auto actual = client_->InsertObjectMedia(
+      InsertObjectMediaRequest("bkt", "obj", std::string{})
+          .set_contents_file(temp_file.name())
+          .set_multiple_options(
+              WithObjectMetadata(ObjectMetadata().set_content_type("text/x"))));
+  ASSERT_STATUS_OK(actual);
+
+  auto requests = server_.requests();
+  ASSERT_EQ(1, requests.size());
+  auto const& r = requests.front();
+  EXPECT_THAT(r.request_line, StartsWith("POST /upload/storage/v1/b/bkt/o?"));
+  EXPECT_THAT(r.request_line, HasSubstr("uploadType=multipart"));
+  auto content_type = Headers(r, "content-type");
+  ASSERT_EQ(1, content_type.size());
+  std::string const prefix = "multipart/related; boundary=";
+  ASSERT_THAT(content_type.front(), StartsWith(prefix));
+  auto const boundary = content_type.front().substr(prefix.size());
+  EXPECT_THAT(contents, Not(HasSubstr(boundary)));
+  EXPECT_THAT(r.body, StartsWith("--" + boundary + "\r\n"));
+  EXPECT_THAT(r.body, Not(HasSubstr("md5Hash")));
+  EXPECT_THAT(r.body, Not(HasSubstr("crc32c")));
+  EXPECT_THAT(r.body, HasSubstr("content-type: text/x\r\n\r\n" + contents +
+                                "\r\n--" + boundary + "--\r\n"));
+}
+
+TEST_F(CurlClientLoopbackTest, InsertObjectMediaFileMultipartHashMismatch) {
+  SetResponse(ObjectWithHashes("some other contents"));
+  testing::TempFile temp_file("some contents");
+  auto actual = client_->InsertObjectMedia(
+      InsertObjectMediaRequest("bkt", "obj", std::string{})
+          .set_contents_file(temp_file.name())
+          .set_multiple_options(
+              WithObjectMetadata(ObjectMetadata().set_content_type("text/x"))));
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(StatusCode::kDataLoss, actual.status().code());
+}
+
+TEST_F(CurlClientLoopbackTest, InsertObjectMediaFileSimple) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  testing::TempFile temp_file(contents);
+  auto actual = client_->InsertObjectMedia(
+      InsertObjectMediaRequest("bkt", "obj", std::string{})
+          .set_contents_file(temp_file.name())
+          .set_multiple_options(DisableMD5Hash(true),
+                                DisableCrc32cChecksum(true)));
+  ASSERT_STATUS_OK(actual);
+
+  auto requests = server_.requests();
+  ASSERT_EQ(1, requests.size());
+  auto const& r = requests.front();
+  EXPECT_THAT(r.request_line, StartsWith("POST /upload/storage/v1/b/bkt/o?"));
+  EXPECT_THAT(r.request_line, HasSubstr("uploadType=media"));
+  EXPECT_EQ(contents, r.body);
+}
+
+TEST_F(CurlClientLoopbackTest, UploadChunkResentOnReusedConnection) {
+  std::string const header = "The quick brown fox ";
+  std::string const contents = "jumps over the lazy dog";
+  auto upload = [&] {
+    return client_->UploadChunk(UploadChunkRequest(
+        server_.endpoint() + "/upload/session", 0,
+        {ConstBuffer(header.data(), header.size()),
+         ConstBuffer(contents.data(), contents.size())}));
+  };
+  ASSERT_STATUS_OK(upload());
+  ASSERT_EQ(1, server_.connection_count());
+
+  // The server closes the kept-alive connection without responding, libcurl
+  // must rewind the payload to send it again on a new connection.
+  drop_next_request_ = true;
+  ASSERT_STATUS_OK(upload());
+  EXPECT_EQ(2, server_.connection_count());
+  auto requests = server_.requests();
+  ASSERT_EQ(3, requests.size());
+  for (auto const& r : requests) {
+    EXPECT_EQ(header + contents, r.body);
+  }
+}
+
+TEST_F(CurlClientLoopbackTest, InsertObjectMediaMultipartResent) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  auto insert = [&] {
+    return client_->InsertObjectMedia(
+        InsertObjectMediaRequest("bkt", "obj", contents)
+            .set_multiple_options(WithObjectMetadata(
+                ObjectMetadata().set_content_type("text/x"))));
+  };
+  ASSERT_STATUS_OK(insert());
+
+  // The server closes the kept-alive connection without responding, libcurl
+  // must rewind the multipart payload to send it again on a new connection.
+  drop_next_request_ = true;
+  auto actual = insert();
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ("obj", actual->name());
+  EXPECT_EQ(2, server_.connection_count());
+  auto requests = server_.requests();
+  ASSERT_EQ(3, requests.size());
+  EXPECT_THAT(requests[2].request_line, HasSubstr("uploadType=multipart"));
+  EXPECT_THAT(requests[2].body, HasSubstr(contents));
+  EXPECT_EQ(requests[1].body, requests[2].body);
+}
+
+TEST_F(CurlClientLoopbackTest, InsertObjectMediaFileMultipartResent) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  // The file is read again when the upload is resent, but only hashed once.
+  SetResponse(ObjectWithHashes(contents));
+  testing::TempFile temp_file(contents);
+  auto insert = [&] {
+    return client_->InsertObjectMedia(
+        InsertObjectMediaRequest("bkt", "obj", std::string{})
+            .set_contents_file(temp_file.name())
+            .set_multiple_options(WithObjectMetadata(
+                ObjectMetadata().set_content_type("text/x"))));
+  };
+  ASSERT_STATUS_OK(insert());
+
+  drop_next_request_ = true;
+  ASSERT_STATUS_OK(insert());
+  EXPECT_EQ(2, server_.connection_count());
+  auto requests = server_.requests();
+  ASSERT_EQ(3, requests.size());
+  EXPECT_THAT(requests[2].body, HasSubstr(contents));
+  EXPECT_EQ(requests[1].body, requests[2].body);
+}
+#endif  // _WIN32
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
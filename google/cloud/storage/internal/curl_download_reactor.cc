@@ -0,0 +1,338 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/curl_download_reactor.h"
+#include "google/cloud/log.h"
+#include "google/cloud/storage/internal/curl_handle.h"
+#include <curl/multi.h>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+Status AsStatus(CURLMcode result, char const* where) {
+  if (result == CURLM_OK) {
+    return Status();
+  }
+  std::ostringstream os;
+  os << where << "(): unexpected error code in curl_multi_*, [" << result
+     << "]=" << curl_multi_strerror(result);
+  return Status(StatusCode::kUnknown, std::move(os).str());
+}
+}  // namespace
+
+CurlDownloadReactor::CurlDownloadReactor()
+    : multi_(curl_multi_init(), &curl_multi_cleanup) {
+  thread_ = std::thread([this] { Run(); });
+}
+
+CurlDownloadReactor::~CurlDownloadReactor() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+  }
+  cv_.notify_one();
+#if LIBCURL_VERSION_NUM >= 0x074400
+  curl_multi_wakeup(multi_.get());
+#endif  // LIBCURL_VERSION_NUM
+  thread_.join();
+}
+
+void CurlDownloadReactor::AddHandle(CURL* handle,
+                                    CompletionCallback on_completion) {
+  PostCommand(Command{CommandType::kAdd, handle, std::move(on_completion),
+                      nullptr, {}});
+}
+
+void CurlDownloadReactor::ResumeHandle(CURL* handle) {
+  PostCommand(Command{CommandType::kResume, handle, nullptr, nullptr, {}});
+}
+
+void CurlDownloadReactor::RemoveHandle(CURL* handle) {
+  std::promise<void> removed;
+  auto done = removed.get_future();
+  PostCommand(Command{CommandType::kRemove, handle, nullptr,
+                      [&removed] { removed.set_value(); }, {}});
+  done.get();
+}
+
+void CurlDownloadReactor::CancelHandle(CURL* handle) {
+  PostCommand(Command{CommandType::kCancel, handle, nullptr, nullptr, {}});
+}
+
+void CurlDownloadReactor::AddTimer(
+    std::chrono::steady_clock::time_point deadline,
+    std::function<void()> callback) {
+  PostCommand(Command{CommandType::kTimer, nullptr, nullptr,
+                      std::move(callback), deadline});
+}
+
+std::size_t CurlDownloadReactor::active_handles() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return active_handles_;
+}
+
+void CurlDownloadReactor::PostCommand(Command command) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (command.type == CommandType::kAdd) {
+      ++active_handles_;
+    }
+    pending_.push_back(std::move(command));
+  }
+  cv_.notify_one();
+#if LIBCURL_VERSION_NUM >= 0x074400
+  // Interrupt any blocking curl_multi_poll() call, otherwise the command would
+  // wait until the next I/O event or timeout.
+  curl_multi_wakeup(multi_.get());
+#endif  // LIBCURL_VERSION_NUM
+}
+
+void CurlDownloadReactor::Run() {
+  int repeats = 0;
+  std::unique_lock<std::mutex> lk(mu_);
+  while (true) {
+    // Block (without spinning) while there is nothing to do, but wake up in
+    // time for the next timer.
+    auto has_work = [this] {
+      return shutdown_ || !pending_.empty() || !callbacks_.empty();
+    };
+    if (timers_.empty()) {
+      cv_.wait(lk, has_work);
+    } else {
+      cv_.wait_until(lk, timers_.begin()->first, has_work);
+    }
+    if (shutdown_) {
+      break;
+    }
+    auto commands = std::move(pending_);
+    pending_.clear();
+    lk.unlock();
+    // Never call into libcurl while holding `mu_`: the callbacks may need to
+    // acquire locks held by threads blocked in `PostCommand()`.
+    for (auto& c : commands) {
+      ExecuteCommand(c);
+    }
+    RunExpiredTimers();
+    if (!callbacks_.empty()) {
+      PerformWork();
+    }
+    if (!callbacks_.empty()) {
+      WaitForHandles(repeats);
+    }
+    lk.lock();
+  }
+  // Shutting down, there should be no transfers left because each
+  // `CurlDownloadRequest` holds a reference to its reactor. Nevertheless,
+  // release any threads blocked in `RemoveHandle()` and detach any remaining
+  // handles.
+  auto commands = std::move(pending_);
+  pending_.clear();
+  lk.unlock();
+  for (auto& c : commands) {
+    if (c.type == CommandType::kRemove) {
+      c.on_done();
+    }
+  }
+  timers_.clear();
+  for (auto& kv : callbacks_) {
+    (void)curl_multi_remove_handle(multi_.get(), kv.first);
+  }
+  callbacks_.clear();
+}
+
+void CurlDownloadReactor::ExecuteCommand(Command& command) {
+  switch (command.type) {
+    case CommandType::kAdd: {
+      auto status = AsStatus(
+          curl_multi_add_handle(multi_.get(), command.handle), __func__);
+      if (!status.ok()) {
+        {
+          std::lock_guard<std::mutex> lk(mu_);
+          --active_handles_;
+        }
+        command.on_completion(std::move(status));
+        break;
+      }
+      callbacks_.emplace(command.handle, std::move(command.on_completion));
+    } break;
+
+    case CommandType::kResume:
+      // The transfer may have completed (or been removed) before the command
+      // was executed, in which case there is nothing to resume.
+      if (callbacks_.find(command.handle) != callbacks_.end()) {
+        (void)curl_easy_pause(command.handle, CURLPAUSE_RECV_CONT);
+      }
+      break;
+
+    case CommandType::kRemove: {
+      auto loc = callbacks_.find(command.handle);
+      if (loc != callbacks_.end()) {
+        (void)curl_multi_remove_handle(multi_.get(), command.handle);
+        callbacks_.erase(loc);
+        std::lock_guard<std::mutex> lk(mu_);
+        --active_handles_;
+      }
+      command.on_done();
+    } break;
+
+    case CommandType::kCancel: {
+      // The transfer may have completed before the command was executed, in
+      // which case there is nothing to cancel.
+      auto loc = callbacks_.find(command.handle);
+      if (loc == callbacks_.end()) {
+        break;
+      }
+      auto callback = std::move(loc->second);
+      callbacks_.erase(loc);
+      (void)curl_multi_remove_handle(multi_.get(), command.handle);
+      {
+        std::lock_guard<std::mutex> lk(mu_);
+        --active_handles_;
+      }
+      callback(Status(StatusCode::kCancelled, "transfer cancelled"));
+    } break;
+
+    case CommandType::kTimer:
+      timers_.emplace(command.deadline, std::move(command.on_done));
+      break;
+  }
+}
+
+void CurlDownloadReactor::RunExpiredTimers() {
+  auto const now = std::chrono::steady_clock::now();
+  while (!timers_.empty() && timers_.begin()->first <= now) {
+    auto callback = std::move(timers_.begin()->second);
+    timers_.erase(timers_.begin());
+    callback();
+  }
+}
+
+void CurlDownloadReactor::PerformWork() {
+  int running_handles = 0;
+  CURLMcode result;
+  do {
+    result = curl_multi_perform(multi_.get(), &running_handles);
+  } while (result == CURLM_CALL_MULTI_PERFORM);
+
+  if (result != CURLM_OK) {
+    // This indicates a bug in the library, or memory corruption. Either way
+    // none of the transfers can make progress, report the error to all of
+    // them.
+    auto status = AsStatus(result, __func__);
+    GCP_LOG(WARNING) << __func__ << " " << status;
+    auto callbacks = std::move(callbacks_);
+    callbacks_.clear();
+    for (auto& kv : callbacks) {
+      (void)curl_multi_remove_handle(multi_.get(), kv.first);
+      {
+        std::lock_guard<std::mutex> lk(mu_);
+        --active_handles_;
+      }
+      kv.second(status);
+    }
+    return;
+  }
+
+  int remaining;
+  while (auto* msg = curl_multi_info_read(multi_.get(), &remaining)) {
+    if (msg->msg != CURLMSG_DONE) {
+      continue;
+    }
+    auto loc = callbacks_.find(msg->easy_handle);
+    if (loc == callbacks_.end()) {
+      GCP_LOG(WARNING) << __func__
+                       << " unknown handle returned by curl_multi_info_read()";
+      continue;
+    }
+    auto status = CurlHandle::AsStatus(msg->data.result, __func__);
+    auto callback = std::move(loc->second);
+    callbacks_.erase(loc);
+    (void)curl_multi_remove_handle(multi_.get(), msg->easy_handle);
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      --active_handles_;
+    }
+    callback(std::move(status));
+  }
+}
+
+void CurlDownloadReactor::WaitForHandles(int& repeats) {
+#if LIBCURL_VERSION_NUM >= 0x074400
+  // curl_multi_poll() can be interrupted by curl_multi_wakeup(), so it is safe
+  // to block for longer periods. libcurl shortens the timeout if any transfer
+  // has a pending timer.
+  (void)repeats;
+  int timeout_ms = 1000;
+  if (!timers_.empty()) {
+    using std::chrono::milliseconds;
+    auto const next = std::chrono::duration_cast<milliseconds>(
+        timers_.begin()->first - std::chrono::steady_clock::now());
+    timeout_ms = static_cast<int>(
+        (std::max)(milliseconds(0), (std::min)(milliseconds(timeout_ms), next))
+            .count());
+  }
+  int numfds = 0;
+  auto result = curl_multi_poll(multi_.get(), nullptr, 0, timeout_ms, &numfds);
+  if (result != CURLM_OK) {
+    GCP_LOG(WARNING) << __func__ << " " << AsStatus(result, __func__);
+  }
+#else
+  int const timeout_ms = 1;
+  std::chrono::milliseconds const timeout(timeout_ms);
+  int numfds = 0;
+  auto result = curl_multi_wait(multi_.get(), nullptr, 0, timeout_ms, &numfds);
+  if (result != CURLM_OK) {
+    GCP_LOG(WARNING) << __func__ << " " << AsStatus(result, __func__);
+  }
+  // The documentation for curl_multi_wait() recommends sleeping if it returns
+  // numfds == 0 more than once in a row :shrug:
+  //    https://curl.haxx.se/libcurl/c/curl_multi_wait.html
+  if (numfds == 0) {
+    if (++repeats > 1) {
+      std::this_thread::sleep_for(timeout);
+    }
+  } else {
+    repeats = 0;
+  }
+#endif  // LIBCURL_VERSION_NUM
+}
+
+std::vector<std::shared_ptr<CurlDownloadReactor>> CreateCurlDownloadReactors(
+    std::size_t thread_count) {
+  std::vector<std::shared_ptr<CurlDownloadReactor>> reactors;
+  reactors.reserve(thread_count);
+  for (std::size_t i = 0; i != thread_count; ++i) {
+    reactors.push_back(std::make_shared<CurlDownloadReactor>());
+  }
+  return reactors;
+}
+
+std::shared_ptr<CurlDownloadReactor> CurlAsyncReactor() {
+  static auto const* const kReactor =
+      new auto(std::make_shared<CurlDownloadReactor>());
+  return *kReactor;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
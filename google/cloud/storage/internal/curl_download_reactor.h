@@ -0,0 +1,160 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_DOWNLOAD_REACTOR_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_DOWNLOAD_REACTOR_H
+
+#include "google/cloud/status.h"
+#include "google/cloud/storage/internal/curl_wrappers.h"
+#include "google/cloud/storage/version.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Drives many streaming downloads from a single background thread.
+ *
+ * By default each `CurlDownloadRequest` owns a `CURLM*` handle and performs
+ * the I/O for its transfer in the thread that calls `Read()`. With many
+ * concurrent downloads that results in one poll set (and one blocked thread)
+ * per stream. A `CurlDownloadReactor` owns a single `CURLM*` handle and a
+ * thread that runs the libcurl event loop for every transfer added to it. The
+ * reader threads only wait for their buffers to fill up.
+ *
+ * The libcurl multi interface is not thread-safe: all the operations on the
+ * `CURLM*` handle, and on any `CURL*` handle added to it, happen in the
+ * background thread. Other threads request changes by posting commands, which
+ * the background thread executes on its next iteration.
+ *
+ * The reactor also drives the transfers for asynchronous requests, and runs
+ * timers used to schedule their retries.
+ *
+ * The completion callbacks, the timer callbacks, and the
+ * `CURLOPT_WRITEFUNCTION` callbacks run in the background thread, they should
+ * not block.
+ */
+class CurlDownloadReactor {
+ public:
+  /// The callback invoked when a transfer completes (successfully or not).
+  using CompletionCallback = std::function<void(Status)>;
+
+  CurlDownloadReactor();
+  ~CurlDownloadReactor();
+
+  CurlDownloadReactor(CurlDownloadReactor const&) = delete;
+  CurlDownloadReactor& operator=(CurlDownloadReactor const&) = delete;
+
+  /**
+   * Starts a transfer for @p handle.
+   *
+   * The caller retains ownership of @p handle, it must call `RemoveHandle()`
+   * before releasing the handle unless @p on_completion has been invoked.
+   */
+  void AddHandle(CURL* handle, CompletionCallback on_completion);
+
+  /// Resumes a transfer paused by its `CURLOPT_WRITEFUNCTION` callback.
+  void ResumeHandle(CURL* handle);
+
+  /**
+   * Stops the transfer for @p handle.
+   *
+   * Blocks until the background thread no longer uses @p handle. The
+   * completion callback is not invoked for transfers removed by this function.
+   */
+  void RemoveHandle(CURL* handle);
+
+  /**
+   * Stops the transfer for @p handle without waiting.
+   *
+   * If the transfer has not completed its completion callback is invoked, in
+   * the background thread, with a `kCancelled` status. Unlike `RemoveHandle()`
+   * this function is safe to call from the reactor's callbacks.
+   */
+  void CancelHandle(CURL* handle);
+
+  /**
+   * Runs @p callback in the background thread once @p deadline expires.
+   *
+   * Timers still pending when the reactor is destroyed are discarded.
+   */
+  void AddTimer(std::chrono::steady_clock::time_point deadline,
+                std::function<void()> callback);
+
+  /// The number of transfers currently managed by this reactor.
+  std::size_t active_handles() const;
+
+ private:
+  enum class CommandType { kAdd, kResume, kRemove, kCancel, kTimer };
+  struct Command {
+    CommandType type;
+    CURL* handle;
+    CompletionCallback on_completion;
+    std::function<void()> on_done;
+    std::chrono::steady_clock::time_point deadline;
+  };
+
+  void PostCommand(Command command);
+  void Run();
+  void ExecuteCommand(Command& command);
+  void RunExpiredTimers();
+  void PerformWork();
+  void WaitForHandles(int& repeats);
+
+  CurlMulti multi_;
+
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  std::vector<Command> pending_;    // GUARDED_BY(mu_)
+  std::size_t active_handles_ = 0;  // GUARDED_BY(mu_)
+  bool shutdown_ = false;           // GUARDED_BY(mu_)
+
+  // Only accessed by the background thread.
+  std::map<CURL*, CompletionCallback> callbacks_;
+  std::multimap<std::chrono::steady_clock::time_point, std::function<void()>>
+      timers_;
+
+  std::thread thread_;
+};
+
+/**
+ * Creates @p thread_count reactors, used by `CurlClient` to spread the
+ * downloads over a few background threads.
+ */
+std::vector<std::shared_ptr<CurlDownloadReactor>> CreateCurlDownloadReactors(
+    std::size_t thread_count);
+
+/**
+ * Returns the reactor shared by the asynchronous requests of all clients.
+ *
+ * The reactor outlives any `CurlClient`, which makes it safe to release the
+ * last reference to a client from a completion callback.
+ */
+std::shared_ptr<CurlDownloadReactor> CurlAsyncReactor();
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_DOWNLOAD_REACTOR_H
@@ -0,0 +1,290 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/curl_download_reactor.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::TempFile;
+
+/// A download driven by the reactor, reading a local file via `file://`.
+struct TestTransfer {
+  explicit TestTransfer(std::string const& url)
+      : handle(curl_easy_init(), &curl_easy_cleanup) {
+    curl_easy_setopt(handle.get(), CURLOPT_URL, url.c_str());
+    curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION,
+                     &TestTransfer::WriteCallback);
+    curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, this);
+  }
+
+  static std::size_t WriteCallback(char* ptr, std::size_t size,
+                                   std::size_t nmemb, void* userdata) {
+    auto* self = static_cast<TestTransfer*>(userdata);
+    if (self->pause_next_write) {
+      self->pause_next_write = false;
+      self->paused.set_value();
+      return CURL_WRITEFUNC_PAUSE;
+    }
+    if (self->fail_writes) {
+      return 0;
+    }
+    self->contents.append(ptr, size * nmemb);
+    return size * nmemb;
+  }
+
+  void Start(CurlDownloadReactor& reactor) {
+    reactor.AddHandle(handle.get(),
+                      [this](Status status) { done.set_value(status); });
+  }
+
+  CurlPtr handle;
+  // Only modified by the reactor thread while the transfer is active.
+  std::string contents;
+  bool pause_next_write = false;
+  bool fail_writes = false;
+  std::promise<void> paused;
+  std::promise<Status> done;
+};
+
+std::string FileUrl(TempFile& file) { return "file://" + file.name(); }
+
+#ifndef _WIN32
+/**
+ * A minimal HTTP server on the loopback interface.
+ *
+ * Transfers from `file://` URLs complete in a single step, the tests that
+ * need a transfer to remain active use this server instead. Connections are
+ * queued by the kernel, but not accepted until `Serve()` is called, so the
+ * transfers wait for a response until then.
+ */
+class LoopbackServer {
+ public:
+  LoopbackServer() : fd_(socket(AF_INET, SOCK_STREAM, 0)) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+        listen(fd_, 8) != 0 ||
+        getsockname(fd_, reinterpret_cast<sockaddr*>(&address), &length) !=
+            0) {
+      ADD_FAILURE() << "cannot create loopback server";
+    }
+    port_ = ntohs(address.sin_port);
+  }
+
+  ~LoopbackServer() {
+    if (server_.joinable()) {
+      server_.join();
+    }
+    close(fd_);
+  }
+
+  std::string url() const {
+    return "http://127.0.0.1:" + std::to_string(port_) + "/";
+  }
+
+  /// Accepts one connection and responds with @p body.
+  void Serve(std::string body) {
+    server_ = std::thread([this, body] {
+      int connection = accept(fd_, nullptr, nullptr);
+      if (connection < 0) {
+        return;
+      }
+      char request[4096];
+      (void)read(connection, request, sizeof(request));
+      std::string const response =
+          "HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: " +
+          std::to_string(body.size()) + "\r\n\r\n" + body;
+      (void)write(connection, response.data(), response.size());
+      close(connection);
+    });
+  }
+
+ private:
+  int fd_;
+  int port_ = 0;
+  std::thread server_;
+};
+#endif  // _WIN32
+
+/// @test Verify that the reactor drives several downloads to completion.
+TEST(CurlDownloadReactorTest, ManyDownloads) {
+  CurlDownloadReactor reactor;
+  std::vector<std::unique_ptr<TempFile>> files;
+  std::vector<std::unique_ptr<TestTransfer>> transfers;
+  for (int i = 0; i != 8; ++i) {
+    files.emplace_back(new TempFile(
+        std::string(64 * 1024 * (i + 1), static_cast<char>('a' + i))));
+    transfers.emplace_back(new TestTransfer(FileUrl(*files.back())));
+  }
+  for (auto& t : transfers) {
+    t->Start(reactor);
+  }
+  for (int i = 0; i != 8; ++i) {
+    auto status = transfers[i]->done.get_future().get();
+    EXPECT_STATUS_OK(status);
+    EXPECT_EQ(std::string(64 * 1024 * (i + 1), static_cast<char>('a' + i)),
+              transfers[i]->contents);
+  }
+  EXPECT_EQ(0, reactor.active_handles());
+}
+
+/// @test Verify that transfer errors are reported to the completion callback.
+TEST(CurlDownloadReactorTest, TransferErrors) {
+  CurlDownloadReactor reactor;
+  TempFile file("some contents");
+
+  TestTransfer missing("file:///this-file-does-not-exist/really/not");
+  TestTransfer bad_protocol("not-a-protocol://example.com/");
+  TestTransfer write_error(FileUrl(file));
+  write_error.fail_writes = true;
+  TestTransfer success(FileUrl(file));
+
+  missing.Start(reactor);
+  bad_protocol.Start(reactor);
+  write_error.Start(reactor);
+  success.Start(reactor);
+
+  EXPECT_FALSE(missing.done.get_future().get().ok());
+  EXPECT_FALSE(bad_protocol.done.get_future().get().ok());
+  EXPECT_FALSE(write_error.done.get_future().get().ok());
+  // Errors in some transfers do not affect the others.
+  EXPECT_STATUS_OK(success.done.get_future().get());
+  EXPECT_EQ("some contents", success.contents);
+  EXPECT_EQ(0, reactor.active_handles());
+}
+
+#ifndef _WIN32
+/// @test Verify that paused transfers can be resumed.
+TEST(CurlDownloadReactorTest, PauseAndResume) {
+  CurlDownloadReactor reactor;
+  LoopbackServer server;
+  server.Serve("some contents");
+  TestTransfer transfer(server.url());
+  transfer.pause_next_write = true;
+  transfer.Start(reactor);
+
+  transfer.paused.get_future().get();
+  EXPECT_EQ(1, reactor.active_handles());
+  reactor.ResumeHandle(transfer.handle.get());
+
+  EXPECT_STATUS_OK(transfer.done.get_future().get());
+  EXPECT_EQ("some contents", transfer.contents);
+  EXPECT_EQ(0, reactor.active_handles());
+}
+
+/// @test Verify that removed transfers do not invoke their callback.
+TEST(CurlDownloadReactorTest, RemoveHandle) {
+  CurlDownloadReactor reactor;
+  // The server never responds, the transfer is active until it is removed.
+  LoopbackServer server;
+  TestTransfer transfer(server.url());
+  bool called = false;
+  reactor.AddHandle(transfer.handle.get(),
+                    [&called](Status) { called = true; });
+  EXPECT_EQ(1, reactor.active_handles());
+
+  reactor.RemoveHandle(transfer.handle.get());
+  EXPECT_EQ(0, reactor.active_handles());
+  // Resuming or removing a handle that is no longer active is a no-op.
+  reactor.ResumeHandle(transfer.handle.get());
+  reactor.RemoveHandle(transfer.handle.get());
+  EXPECT_FALSE(called);
+  EXPECT_TRUE(transfer.contents.empty());
+}
+
+/// @test Verify that cancelled transfers report a `kCancelled` error.
+TEST(CurlDownloadReactorTest, CancelHandle) {
+  CurlDownloadReactor reactor;
+  // The server never responds, the transfer is active until it is cancelled.
+  LoopbackServer server;
+  TestTransfer transfer(server.url());
+  transfer.Start(reactor);
+  EXPECT_EQ(1, reactor.active_handles());
+
+  reactor.CancelHandle(transfer.handle.get());
+  auto status = transfer.done.get_future().get();
+  EXPECT_EQ(StatusCode::kCancelled, status.code());
+  EXPECT_EQ(0, reactor.active_handles());
+  // Cancelling a handle that is no longer active is a no-op.
+  reactor.CancelHandle(transfer.handle.get());
+  reactor.RemoveHandle(transfer.handle.get());
+  EXPECT_TRUE(transfer.contents.empty());
+}
+#endif  // _WIN32
+
+/// @test Verify that timers run in order once they expire.
+TEST(CurlDownloadReactorTest, Timers) {
+  CurlDownloadReactor reactor;
+  std::vector<int> order;
+  std::promise<void> done;
+  auto const now = std::chrono::steady_clock::now();
+  reactor.AddTimer(now + std::chrono::milliseconds(30), [&] {
+    order.push_back(2);
+    done.set_value();
+  });
+  reactor.AddTimer(now + std::chrono::milliseconds(10),
+                   [&] { order.push_back(1); });
+  done.get_future().get();
+  EXPECT_LE(now + std::chrono::milliseconds(30),
+            std::chrono::steady_clock::now());
+  EXPECT_THAT(order, ::testing::ElementsAre(1, 2));
+}
+
+/// @test Verify that pending timers are discarded on shutdown.
+TEST(CurlDownloadReactorTest, PendingTimersDiscarded) {
+  bool called = false;
+  {
+    CurlDownloadReactor reactor;
+    reactor.AddTimer(std::chrono::steady_clock::now() + std::chrono::hours(1),
+                     [&called] { called = true; });
+  }
+  EXPECT_FALSE(called);
+}
+
+/// @test Verify that `CreateCurlDownloadReactors()` creates distinct reactors.
+TEST(CurlDownloadReactorTest, CreateReactors) {
+  auto reactors = CreateCurlDownloadReactors(3);
+  ASSERT_EQ(3, reactors.size());
+  EXPECT_NE(reactors[0], reactors[1]);
+  EXPECT_NE(reactors[1], reactors[2]);
+  EXPECT_TRUE(CreateCurlDownloadReactors(0).empty());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
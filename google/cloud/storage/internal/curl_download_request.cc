@@ -59,6 +59,36 @@ CurlDownloadRequest::CurlDownloadRequest()
       multi_(nullptr, &curl_multi_cleanup),
       spill_(CURL_MAX_WRITE_SIZE) {}
 
+CurlDownloadRequest::~CurlDownloadRequest() {
+  if (!factory_) {
+    return;
+  }
+  if (reactor_) {
+    bool in_reactor;
+    {
+      std::lock_guard<std::mutex> lk(reactor_state_->mu);
+      in_reactor = in_multi_;
+    }
+    // Block until the reactor stops using the handle, this must happen
+    // without holding the lock, as the reactor thread may be blocked on it.
+    if (in_reactor) {
+      reactor_->RemoveHandle(handle_.handle_.get());
+    }
+  }
+  factory_->CleanupHandle(std::move(handle_));
+  if (multi_) {
+    factory_->CleanupMultiHandle(std::move(multi_));
+  }
+}
+
+bool CurlDownloadRequest::IsOpen() const {
+  if (reactor_state_) {
+    std::lock_guard<std::mutex> lk(reactor_state_->mu);
+    return !(curl_closed_ && spill_offset_ == 0);
+  }
+  return !(curl_closed_ && spill_offset_ == 0);
+}
+
 template <typename Predicate>
 Status CurlDownloadRequest::Wait(Predicate predicate) {
   int repeats = 0;
@@ -88,6 +118,9 @@ Status CurlDownloadRequest::Wait(Predicate predicate) {
 }
 
 StatusOr<HttpResponse> CurlDownloadRequest::Close() {
+  if (reactor_) {
+    return CloseWithReactor();
+  }
   TRACE_STATE();
   // Set the the closing_ flag to trigger a return 0 from the next read
   // callback, see the comments in the header file for more details.
@@ -128,6 +161,9 @@ StatusOr<HttpResponse> CurlDownloadRequest::Close() {
 }
 
 StatusOr<ReadSourceResult> CurlDownloadRequest::Read(char* buf, std::size_t n) {
+  if (reactor_) {
+    return ReadWithReactor(buf, n);
+  }
   buffer_ = buf;
   buffer_offset_ = 0;
   buffer_size_ = n;
@@ -170,6 +206,11 @@ StatusOr<ReadSourceResult> CurlDownloadRequest::Read(char* buf, std::size_t n) {
   buffer_ = nullptr;
   buffer_offset_ = 0;
   buffer_size_ = 0;
+  return MakeReadResult(bytes_read);
+}
+
+StatusOr<ReadSourceResult> CurlDownloadRequest::MakeReadResult(
+    std::size_t bytes_read) {
   if (curl_closed_) {
     // Retrieve the response code for a closed stream. Note the use of
     // `.value()`, this is equivalent to: assert(http_code.ok());
@@ -184,7 +225,7 @@ StatusOr<ReadSourceResult> CurlDownloadRequest::Read(char* buf, std::size_t n) {
     HttpResponse response{handle_.GetResponseCode().value(), std::string{},
                           std::move(received_headers_)};
     TRACE_STATE() << ", code=" << response.status_code;
-    status = google::cloud::storage::internal::AsStatus(response);
+    auto status = google::cloud::storage::internal::AsStatus(response);
     if (!status.ok()) {
       TRACE_STATE() << ", status=" << response.status_code;
       return status;
@@ -196,6 +237,131 @@ StatusOr<ReadSourceResult> CurlDownloadRequest::Read(char* buf, std::size_t n) {
                           HttpResponse{100, {}, std::move(received_headers_)}};
 }
 
+StatusOr<ReadSourceResult> CurlDownloadRequest::ReadWithReactor(
+    char* buf, std::size_t n) {
+  if (n == 0) {
+    return Status(StatusCode::kInvalidArgument, "Empty buffer for Read()");
+  }
+  std::unique_lock<std::mutex> lk(reactor_state_->mu);
+  buffer_ = buf;
+  buffer_offset_ = 0;
+  buffer_size_ = n;
+  // See the comments in `Read()` about draining the spill buffer first.
+  DrainSpillBuffer();
+  TRACE_STATE();
+  if (buffer_offset_ < buffer_size_) {
+    StartOrResumeInReactor();
+  }
+  reactor_state_->cv.wait(
+      lk, [this] { return curl_closed_ || buffer_offset_ >= buffer_size_; });
+  TRACE_STATE();
+  auto bytes_read = buffer_offset_;
+  buffer_ = nullptr;
+  buffer_offset_ = 0;
+  buffer_size_ = 0;
+  if (curl_closed_ && !reactor_state_->status.ok()) {
+    return reactor_state_->status;
+  }
+  return MakeReadResult(bytes_read);
+}
+
+StatusOr<HttpResponse> CurlDownloadRequest::CloseWithReactor() {
+  std::unique_lock<std::mutex> lk(reactor_state_->mu);
+  TRACE_STATE();
+  // Set the the closing_ flag to trigger a return 0 from the next read
+  // callback, see the comments in the header file for more details. Errors
+  // reported by libcurl after this point are expected, and ignored.
+  closing_ = true;
+  StartOrResumeInReactor();
+  reactor_state_->cv.wait(lk, [this] { return curl_closed_; });
+  TRACE_STATE();
+
+  // The reactor has removed the handle, it is safe to query it in this thread.
+  StatusOr<long> http_code = handle_.GetResponseCode();
+  if (!http_code.ok()) {
+    TRACE_STATE() << ", http_code.status=" << http_code.status();
+    return http_code.status();
+  }
+  TRACE_STATE() << ", http_code.status=" << http_code.status()
+                << ", http_code=" << *http_code;
+  return HttpResponse{http_code.value(), std::string{},
+                      std::move(received_headers_)};
+}
+
+void CurlDownloadRequest::Cancel() {
+  if (!reactor_) {
+    return;
+  }
+  bool in_reactor;
+  {
+    std::lock_guard<std::mutex> lk(reactor_state_->mu);
+    if (curl_closed_) {
+      return;
+    }
+    cancelled_ = true;
+    in_reactor = in_multi_;
+  }
+  // Block until the reactor stops using the handle, this must happen without
+  // holding the lock, as the reactor thread may be blocked on it.
+  if (in_reactor) {
+    reactor_->RemoveHandle(handle_.handle_.get());
+  }
+  std::lock_guard<std::mutex> lk(reactor_state_->mu);
+  TRACE_STATE();
+  // The transfer may have completed before it was removed.
+  if (!curl_closed_) {
+    curl_closed_ = true;
+    in_multi_ = false;
+    reactor_state_->status =
+        Status(StatusCode::kCancelled, "download cancelled");
+  }
+  reactor_state_->cv.notify_one();
+}
+
+void CurlDownloadRequest::StartOrResumeInReactor() {
+  if (curl_closed_ || cancelled_) {
+    return;
+  }
+  if (!in_multi_) {
+    // The handle is added lazily, at this point the object has reached its
+    // final location in memory and it is safe to use `this` in the callbacks.
+    handle_.SetOption(CURLOPT_WRITEFUNCTION, &CurlDownloadRequestWrite);
+    handle_.SetOption(CURLOPT_WRITEDATA, this);
+    handle_.SetOption(CURLOPT_HEADERFUNCTION, &CurlDownloadRequestHeader);
+    handle_.SetOption(CURLOPT_HEADERDATA, this);
+    in_multi_ = true;
+    reactor_->AddHandle(handle_.handle_.get(), [this](Status status) {
+      OnReactorCompletion(std::move(status));
+    });
+    return;
+  }
+  if (paused_) {
+    paused_ = false;
+    reactor_->ResumeHandle(handle_.handle_.get());
+  }
+}
+
+void CurlDownloadRequest::OnReactorCompletion(Status status) {
+  std::lock_guard<std::mutex> lk(reactor_state_->mu);
+  TRACE_STATE() << ", status=" << status;
+  curl_closed_ = true;
+  in_multi_ = false;
+  if (!closing_) {
+    reactor_state_->status = std::move(status);
+  }
+  // Notify while holding the lock, once the lock is released the reader may
+  // delete this object.
+  reactor_state_->cv.notify_one();
+}
+
+ReadCopyCounters CurlDownloadRequest::copy_counters() const {
+  if (reactor_state_) {
+    std::lock_guard<std::mutex> lk(reactor_state_->mu);
+    return copy_counters_;
+  }
+  return copy_counters_;
+}
+
 void CurlDownloadRequest::SetOptions() {
   handle_.SetOption(CURLOPT_URL, url_.c_str());
   handle_.SetOption(CURLOPT_HTTPHEADER, headers_.get());
@@ -216,7 +382,8 @@ void CurlDownloadRequest::SetOptions() {
     handle_.SetOption(CURLOPT_LOW_SPEED_TIME,
                       static_cast<long>(download_stall_timeout_.count()));
   }
-  if (in_multi_) {
+  // With a reactor the handle is added on the first `Read()` or `Close()`.
+  if (reactor_ || in_multi_) {
     return;
   }
   auto error = curl_multi_add_handle(multi_.get(), handle_.handle_.get());
@@ -232,15 +399,36 @@ void CurlDownloadRequest::SetOptions() {
 void CurlDownloadRequest::DrainSpillBuffer() {
   std::size_t free = buffer_size_ - buffer_offset_;
   auto copy_count = (std::min)(free, spill_offset_);
+  if (copy_count == 0) {
+    return;
+  }
   std::memcpy(buffer_ + buffer_offset_, spill_.data(), copy_count);
   buffer_offset_ += copy_count;
-  std::memmove(spill_.data(), spill_.data() + copy_count,
-               spill_.size() - copy_count);
-  spill_offset_ -= copy_count;
+  copy_counters_.bytes_delivered += copy_count;
+  // Only the bytes still in use need to move to the front of the buffer.
+  auto const remaining = spill_offset_ - copy_count;
+  std::memmove(spill_.data(), spill_.data() + copy_count, remaining);
+  copy_counters_.bytes_staged += remaining;
+  spill_offset_ = remaining;
 }
 
 std::size_t CurlDownloadRequest::WriteCallback(void* ptr, std::size_t size,
                                                std::size_t nmemb) {
+  if (!reactor_state_) {
+    return WriteCallbackImpl(ptr, size, nmemb);
+  }
+  std::lock_guard<std::mutex> lk(reactor_state_->mu);
+  auto const n = WriteCallbackImpl(ptr, size, nmemb);
+  // Only wake up the reader if its wait is over, most callbacks just append
+  // some data to the buffer.
+  if (paused_ || buffer_offset_ >= buffer_size_) {
+    reactor_state_->cv.notify_one();
+  }
+  return n;
+}
+
+std::size_t CurlDownloadRequest::WriteCallbackImpl(void* ptr, std::size_t size,
+                                                   std::size_t nmemb) {
   handle_.FlushDebug(__func__);
   TRACE_STATE() << ", n=" << size * nmemb;
   // This transfer is closing, just return zero, that will make libcurl finish
@@ -271,15 +459,18 @@ std::size_t CurlDownloadRequest::WriteCallback(void* ptr, std::size_t size,
   if (size * nmemb < free) {
     std::memcpy(buffer_ + buffer_offset_, ptr, size * nmemb);
     buffer_offset_ += size * nmemb;
+    copy_counters_.bytes_delivered += size * nmemb;
     TRACE_STATE() << ", n=" << size * nmemb;
     return size * nmemb;
   }
   // Copy as much as possible from `ptr` into the application buffer.
   std::memcpy(buffer_ + buffer_offset_, ptr, free);
   buffer_offset_ += free;
+  copy_counters_.bytes_delivered += free;
   spill_offset_ = size * nmemb - free;
   // The rest goes into the spill buffer.
   std::memcpy(spill_.data(), static_cast<char*>(ptr) + free, spill_offset_);
+  copy_counters_.bytes_staged += spill_offset_;
   TRACE_STATE() << ", n=" << size * nmemb << ", free=" << free;
   return size * nmemb;
 }
@@ -287,6 +478,10 @@ std::size_t CurlDownloadRequest::WriteCallback(void* ptr, std::size_t size,
 std::size_t CurlDownloadRequest::HeaderCallback(char* contents,
                                                 std::size_t size,
                                                 std::size_t nitems) {
+  if (reactor_state_) {
+    std::lock_guard<std::mutex> lk(reactor_state_->mu);
+    return CurlAppendHeaderData(received_headers_, contents, size * nitems);
+  }
   return CurlAppendHeaderData(received_headers_, contents, size * nitems);
 }
 
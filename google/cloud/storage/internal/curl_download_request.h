@@ -15,10 +15,13 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_DOWNLOAD_REQUEST_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_DOWNLOAD_REQUEST_H
 
+#include "google/cloud/storage/internal/curl_download_reactor.h"
 #include "google/cloud/storage/internal/curl_request.h"
 #include "google/cloud/storage/internal/http_response.h"
 #include "google/cloud/storage/internal/object_read_source.h"
 #include "google/cloud/storage/version.h"
+#include <condition_variable>
+#include <mutex>
 
 namespace google {
 namespace cloud {
@@ -39,6 +42,12 @@ extern "C" std::size_t CurlDownloadRequestHeader(char* contents,
  * payload is streamed, and the total size is not known. Under the hood this
  * uses chunked transfer encoding.
  *
+ * By default the transfer is performed by the thread calling `Read()` or
+ * `Close()`, using a `CURLM*` handle owned by this object. If the request is
+ * created with a `CurlDownloadReactor` the transfer is performed by the
+ * reactor's background thread, and the calling thread only waits until the
+ * application buffer is filled or the transfer completes.
+ *
  * @see `CurlRequest` for simpler transfers where the size of the payload is
  *     known and relatively small.
  */
@@ -46,18 +55,12 @@ class CurlDownloadRequest : public ObjectReadSource {
  public:
   explicit CurlDownloadRequest();
 
-  ~CurlDownloadRequest() override {
-    if (!factory_) {
-      return;
-    }
-    factory_->CleanupHandle(std::move(handle_));
-    factory_->CleanupMultiHandle(std::move(multi_));
-  }
+  ~CurlDownloadRequest() override;
 
   CurlDownloadRequest(CurlDownloadRequest&&) = default;
   CurlDownloadRequest& operator=(CurlDownloadRequest&& rhs) = default;
 
-  bool IsOpen() const override { return !(curl_closed_ && spill_offset_ == 0); }
+  bool IsOpen() const override;
   StatusOr<HttpResponse> Close() override;
 
   /**
@@ -72,6 +75,16 @@ class CurlDownloadRequest : public ObjectReadSource {
    */
   StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override;
 
+  ReadCopyCounters copy_counters() const override;
+
+  /**
+   * Removes the transfer from its reactor.
+   *
+   * Without a reactor the transfer is performed by the thread calling
+   * `Read()`, and cannot be interrupted.
+   */
+  void Cancel() override;
+
  private:
   friend class CurlRequestBuilder;
   /// Set the underlying CurlHandle options on a new CurlDownloadRequest.
@@ -83,12 +96,30 @@ class CurlDownloadRequest : public ObjectReadSource {
                                                std::size_t nitems,
                                                void* userdata);
 
+  /// Implement `Read()` when the transfer is driven by a reactor.
+  StatusOr<ReadSourceResult> ReadWithReactor(char* buf, std::size_t n);
+
+  /// Implement `Close()` when the transfer is driven by a reactor.
+  StatusOr<HttpResponse> CloseWithReactor();
+
+  /// Add the handle to the reactor, or resume it if paused.
+  void StartOrResumeInReactor();
+
+  /// Called by the reactor when the transfer completes.
+  void OnReactorCompletion(Status status);
+
+  /// Create the result for a `Read()` call once its wait is over.
+  StatusOr<ReadSourceResult> MakeReadResult(std::size_t bytes_read);
+
   /// Copy any available data from the spill buffer to `buffer_`
   void DrainSpillBuffer();
 
   /// Called by libcurl to show that more data is available in the download.
   std::size_t WriteCallback(void* ptr, std::size_t size, std::size_t nmemb);
 
+  std::size_t WriteCallbackImpl(void* ptr, std::size_t size,
+                                std::size_t nmemb);
+
   std::size_t HeaderCallback(char* contents, std::size_t size,
                              std::size_t nitems);
 
@@ -117,6 +148,17 @@ class CurlDownloadRequest : public ObjectReadSource {
   CurlMulti multi_;
   std::shared_ptr<CurlHandleFactory> factory_;
 
+  // When not null, the transfer is driven by this reactor (and `multi_` is not
+  // used). In that case the callbacks run in the reactor's thread, and all the
+  // member variables below are guarded by `reactor_state_->mu`.
+  std::shared_ptr<CurlDownloadReactor> reactor_;
+  struct ReactorState {
+    std::mutex mu;
+    std::condition_variable cv;
+    Status status;
+  };
+  std::unique_ptr<ReactorState> reactor_state_;
+
   // Explicitly closing the handle happens in two steps.
   // 1. First the application (or higher-level class), calls Close(). This class
   //    needs to notify libcurl that the transfer is terminated by returning 0
@@ -134,13 +176,16 @@ class CurlDownloadRequest : public ObjectReadSource {
   // completes.
   bool curl_closed_ = false;
 
-  // Track whether `handle_` has been added to `multi_` or not. The exact
-  // lifecycle for the handle depends on the libcurl version, and using this
-  // flag makes the code less elegant, but less prone to bugs.
+  // Track whether `handle_` has been added to `multi_` (or to `reactor_`) or
+  // not. The exact lifecycle for the handle depends on the libcurl version, and
+  // using this flag makes the code less elegant, but less prone to bugs.
   bool in_multi_ = false;
 
   bool paused_ = false;
 
+  // Set by `Cancel()`, prevents adding the handle to the reactor again.
+  bool cancelled_ = false;
+
   char* buffer_ = nullptr;
   std::size_t buffer_size_ = 0;
   std::size_t buffer_offset_ = 0;
@@ -152,6 +197,10 @@ class CurlDownloadRequest : public ObjectReadSource {
   // call to `Read()`, so we need a place to store the additional bytes.
   std::vector<char> spill_;
   std::size_t spill_offset_ = 0;
+
+  // Every byte written to `buffer_` counts as delivered, bytes that go through
+  // `spill_` are also counted as staged.
+  ReadCopyCounters copy_counters_;
 };
 
 }  // namespace internal
@@ -104,6 +104,7 @@ class CurlHandle {
   explicit CurlHandle(CurlPtr ptr) : handle_(std::move(ptr)) {}
 
   friend class CurlDownloadRequest;
+  friend class CurlRequest;
   friend class CurlRequestBuilder;
   friend class CurlHandleFactory;
 
@@ -13,7 +13,9 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/curl_request.h"
+#include <cstdio>
 #include <iostream>
+#include <memory>
 
 namespace google {
 namespace cloud {
@@ -33,7 +35,95 @@ extern "C" size_t CurlRequestOnHeaderData(char* contents, size_t size,
   return request->OnHeaderData(contents, size, nitems);
 }
 
+extern "C" size_t CurlRequestOnReadData(char* buffer, size_t size,
+                                        size_t nitems, void* userdata) {
+  auto* request = reinterpret_cast<CurlRequest*>(userdata);
+  return request->OnReadData(buffer, size, nitems);
+}
+
+extern "C" int CurlRequestOnSeekData(void* userdata, curl_off_t offset,
+                                     int origin) {
+  auto* request = reinterpret_cast<CurlRequest*>(userdata);
+  return request->OnSeekData(offset, origin);
+}
+
 StatusOr<HttpResponse> CurlRequest::MakeRequest(std::string const& payload) {
+  SetCommonOptions();
+  if (!payload.empty()) {
+    handle_.SetOption(CURLOPT_POSTFIELDSIZE, payload.length());
+    handle_.SetOption(CURLOPT_POSTFIELDS, payload.c_str());
+  }
+  return PerformRequest();
+}
+
+StatusOr<HttpResponse> CurlRequest::MakeUploadRequest(
+    std::uint64_t payload_size, ReadCallback source) {
+  SetCommonOptions();
+  read_callback_ = std::move(source);
+  read_offset_ = 0;
+  read_size_ = payload_size;
+  read_status_ = Status();
+  handle_.SetOption(CURLOPT_POST, 1L);
+  handle_.SetOption(CURLOPT_POSTFIELDSIZE_LARGE,
+                    static_cast<curl_off_t>(payload_size));
+  handle_.SetOption(CURLOPT_READFUNCTION, &CurlRequestOnReadData);
+  handle_.SetOption(CURLOPT_READDATA, this);
+  handle_.SetOption(CURLOPT_SEEKFUNCTION, &CurlRequestOnSeekData);
+  handle_.SetOption(CURLOPT_SEEKDATA, this);
+  auto response = PerformRequest();
+  read_callback_ = nullptr;
+  if (!read_status_.ok()) {
+    // The transfer was aborted by OnReadData(), the error from the source is
+    // more interesting than the CURLE_ABORTED_BY_CALLBACK error.
+    return read_status_;
+  }
+  return response;
+}
+
+future<StatusOr<HttpResponse>> CurlRequest::MakeRequestAsync(
+    CurlDownloadReactor& reactor, std::string payload) && {
+  // The libcurl callbacks receive the address of the request, and libcurl
+  // keeps a pointer to the payload, both must remain stable until the transfer
+  // completes.
+  struct State {
+    CurlRequest request;
+    std::string payload;
+    promise<StatusOr<HttpResponse>> result;
+  };
+  auto state = std::make_shared<State>();
+  state->request = std::move(*this);
+  state->payload = std::move(payload);
+  auto& request = state->request;
+  request.SetCommonOptions();
+  if (!state->payload.empty()) {
+    request.handle_.SetOption(CURLOPT_POSTFIELDSIZE, state->payload.length());
+    request.handle_.SetOption(CURLOPT_POSTFIELDS, state->payload.c_str());
+  }
+  auto* handle = request.handle_.handle_.get();
+  // Cancelling the future stops the transfer, the completion callback then
+  // satisfies the future with a `kCancelled` error. Once the transfer
+  // completes the handle may be reused by other requests, the weak pointer
+  // prevents cancelling them by mistake.
+  std::weak_ptr<State> weak = state;
+  auto* r = &reactor;
+  state->result = promise<StatusOr<HttpResponse>>([weak, r, handle] {
+    if (auto s = weak.lock()) {
+      r->CancelHandle(handle);
+    }
+  });
+  auto f = state->result.get_future();
+  reactor.AddHandle(handle, [state](Status status) mutable {
+    auto response = state->request.CompleteRequest(std::move(status));
+    auto result = std::move(state->result);
+    // Return the handle to the factory before running any continuations, they
+    // may start new requests.
+    state.reset();
+    result.set_value(std::move(response));
+  });
+  return f;
+}
+
+void CurlRequest::SetCommonOptions() {
   response_payload_.clear();
   handle_.SetOption(CURLOPT_BUFFERSIZE, 128 * 1024L);
   handle_.SetOption(CURLOPT_URL, url_.c_str());
@@ -48,11 +138,13 @@ StatusOr<HttpResponse> CurlRequest::MakeRequest(std::string const& payload) {
   handle_.SetOption(CURLOPT_WRITEDATA, this);
   handle_.SetOption(CURLOPT_HEADERFUNCTION, &CurlRequestOnHeaderData);
   handle_.SetOption(CURLOPT_HEADERDATA, this);
-  if (!payload.empty()) {
-    handle_.SetOption(CURLOPT_POSTFIELDSIZE, payload.length());
-    handle_.SetOption(CURLOPT_POSTFIELDS, payload.c_str());
-  }
-  auto status = handle_.EasyPerform();
+}
+
+StatusOr<HttpResponse> CurlRequest::PerformRequest() {
+  return CompleteRequest(handle_.EasyPerform());
+}
+
+StatusOr<HttpResponse> CurlRequest::CompleteRequest(Status status) {
   if (!status.ok()) {
     return status;
   }
@@ -78,6 +170,27 @@ std::size_t CurlRequest::OnHeaderData(char* contents, std::size_t size,
   return CurlAppendHeaderData(received_headers_, contents, size * nitems);
 }
 
+std::size_t CurlRequest::OnReadData(char* buffer, std::size_t size,
+                                    std::size_t nitems) {
+  auto bytes = read_callback_(read_offset_, buffer, size * nitems);
+  if (!bytes) {
+    read_status_ = std::move(bytes).status();
+    return CURL_READFUNC_ABORT;
+  }
+  read_offset_ += *bytes;
+  return *bytes;
+}
+
+int CurlRequest::OnSeekData(curl_off_t offset, int origin) {
+  // libcurl only seeks to rewind the payload, always with SEEK_SET.
+  if (origin != SEEK_SET || offset < 0 ||
+      static_cast<std::uint64_t>(offset) > read_size_) {
+    return CURL_SEEKFUNC_CANTSEEK;
+  }
+  read_offset_ = static_cast<std::uint64_t>(offset);
+  return CURL_SEEKFUNC_OK;
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
@@ -15,10 +15,14 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_REQUEST_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_REQUEST_H
 
+#include "google/cloud/future.h"
+#include "google/cloud/storage/internal/curl_download_reactor.h"
 #include "google/cloud/storage/internal/curl_handle.h"
 #include "google/cloud/storage/internal/curl_handle_factory.h"
 #include "google/cloud/storage/internal/http_response.h"
 #include "google/cloud/storage/version.h"
+#include <cstdint>
+#include <functional>
 
 namespace google {
 namespace cloud {
@@ -29,6 +33,10 @@ extern "C" size_t CurlRequestOnWriteData(char* ptr, size_t size, size_t nmemb,
                                          void* userdata);
 extern "C" size_t CurlRequestOnHeaderData(char* contents, size_t size,
                                           size_t nitems, void* userdata);
+extern "C" size_t CurlRequestOnReadData(char* buffer, size_t size,
+                                        size_t nitems, void* userdata);
+extern "C" int CurlRequestOnSeekData(void* userdata, curl_off_t offset,
+                                     int origin);
 
 class CurlRequest {
  public:
@@ -49,16 +57,67 @@ class CurlRequest {
    */
   StatusOr<HttpResponse> MakeRequest(std::string const& payload);
 
+  /**
+   * The callback used by `MakeUploadRequest()` to fetch the payload.
+   *
+   * Copies up to `size` bytes, starting at `offset` in the payload, into
+   * `buffer`, returns the number of bytes copied, or an error to abort the
+   * request.
+   */
+  using ReadCallback = std::function<StatusOr<std::size_t>(
+      std::uint64_t offset, char* buffer, std::size_t size)>;
+
+  /**
+   * Makes the prepared request, streaming the payload from @p source.
+   *
+   * The payload is never held in memory: libcurl calls @p source each time it
+   * needs more data for its upload buffer, until @p payload_size bytes are
+   * sent. If @p source returns an error the request is aborted and that error
+   * is returned.
+   *
+   * The payload is usually read in order, but libcurl rewinds it when it needs
+   * to send the request again, for example, when a reused connection was
+   * closed by the server. Then @p source is called again from the start.
+   *
+   * @return The response HTTP error code, the headers and an empty payload.
+   */
+  StatusOr<HttpResponse> MakeUploadRequest(std::uint64_t payload_size,
+                                           ReadCallback source);
+
+  /**
+   * Makes the prepared request without blocking the calling thread.
+   *
+   * The transfer is driven by @p reactor, the returned future is satisfied
+   * (and any continuations run) in the reactor's background thread. The
+   * request object is consumed, and kept alive until the transfer completes.
+   * Cancelling the returned future removes the transfer from @p reactor.
+   *
+   * @return The response HTTP error code, the headers and the response
+   *     payload.
+   */
+  future<StatusOr<HttpResponse>> MakeRequestAsync(CurlDownloadReactor& reactor,
+                                                  std::string payload) &&;
+
  private:
   friend class CurlRequestBuilder;
   friend size_t CurlRequestOnWriteData(char* ptr, size_t size, size_t nmemb,
                                        void* userdata);
   friend size_t CurlRequestOnHeaderData(char* contents, size_t size,
                                         size_t nitems, void* userdata);
+  friend size_t CurlRequestOnReadData(char* buffer, size_t size,
+                                      size_t nitems, void* userdata);
+  friend int CurlRequestOnSeekData(void* userdata, curl_off_t offset,
+                                   int origin);
+
+  void SetCommonOptions();
+  StatusOr<HttpResponse> PerformRequest();
+  StatusOr<HttpResponse> CompleteRequest(Status status);
 
   std::size_t OnWriteData(char* contents, std::size_t size, std::size_t nmemb);
   std::size_t OnHeaderData(char* contents, std::size_t size,
                            std::size_t nitems);
+  std::size_t OnReadData(char* buffer, std::size_t size, std::size_t nitems);
+  int OnSeekData(curl_off_t offset, int origin);
 
   std::string url_;
   CurlHeaders headers_ = CurlHeaders(nullptr, &curl_slist_free_all);
@@ -69,6 +128,10 @@ class CurlRequest {
   CurlHandle::SocketOptions socket_options_;
   CurlHandle handle_;
   std::shared_ptr<CurlHandleFactory> factory_;
+  ReadCallback read_callback_;
+  std::uint64_t read_offset_ = 0;
+  std::uint64_t read_size_ = 0;
+  Status read_status_;
 };
 
 }  // namespace internal
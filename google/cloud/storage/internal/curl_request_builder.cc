@@ -14,6 +14,7 @@
 
 #include "google/cloud/storage/internal/curl_request_builder.h"
 #include "google/cloud/internal/build_info.h"
+#include "google/cloud/internal/make_unique.h"
 #include "google/cloud/storage/version.h"
 
 namespace google {
@@ -58,7 +59,13 @@ CurlDownloadRequest CurlRequestBuilder::BuildDownloadRequest(
   request.user_agent_ = user_agent_prefix_ + UserAgentSuffix();
   request.payload_ = std::move(payload);
   request.handle_ = std::move(handle_);
-  request.multi_ = factory_->CreateMultiHandle();
+  if (download_reactor_) {
+    request.reactor_ = std::move(download_reactor_);
+    request.reactor_state_ = google::cloud::internal::make_unique<
+        CurlDownloadRequest::ReactorState>();
+  } else {
+    request.multi_ = factory_->CreateMultiHandle();
+  }
   request.factory_ = factory_;
   request.logging_enabled_ = logging_enabled_;
   request.socket_options_ = socket_options_;
@@ -109,6 +116,12 @@ CurlRequestBuilder& CurlRequestBuilder::SetCurlShare(CURLSH* share) {
   return *this;
 }
 
+CurlRequestBuilder& CurlRequestBuilder::SetDownloadReactor(
+    std::shared_ptr<CurlDownloadReactor> reactor) {
+  download_reactor_ = std::move(reactor);
+  return *this;
+}
+
 std::string CurlRequestBuilder::UserAgentSuffix() const {
   ValidateBuilderState(__func__);
   // Pre-compute and cache the user agent string:
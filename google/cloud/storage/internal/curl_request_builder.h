@@ -147,6 +147,15 @@ class CurlRequestBuilder {
   /// Sets the CURLSH* handle to share resources.
   CurlRequestBuilder& SetCurlShare(CURLSH* share);
 
+  /**
+   * Sets the reactor used to drive download requests.
+   *
+   * If not set (or set to `nullptr`), the requests created by
+   * `BuildDownloadRequest()` perform their own I/O in the calling thread.
+   */
+  CurlRequestBuilder& SetDownloadReactor(
+      std::shared_ptr<CurlDownloadReactor> reactor);
+
   /// Gets the user-agent suffix.
   std::string UserAgentSuffix() const;
 
@@ -175,6 +184,7 @@ class CurlRequestBuilder {
   bool logging_enabled_;
   CurlHandle::SocketOptions socket_options_;
   std::chrono::seconds download_stall_timeout_;
+  std::shared_ptr<CurlDownloadReactor> download_reactor_;
 };
 
 }  // namespace internal
@@ -28,6 +28,14 @@ StatusOr<ResumableUploadResponse> CurlResumableUploadSession::UploadChunk(
   return result;
 }
 
+StatusOr<ResumableUploadResponse> CurlResumableUploadSession::UploadChunk(
+    ConstBufferSequence const& buffers) {
+  UploadChunkRequest request(session_id_, next_expected_, buffers);
+  auto result = client_->UploadChunk(request);
+  Update(result, request.payload_size());
+  return result;
+}
+
 StatusOr<ResumableUploadResponse> CurlResumableUploadSession::UploadFinalChunk(
     std::string const& buffer, std::uint64_t upload_size) {
   UploadChunkRequest request(session_id_, next_expected_, buffer, upload_size);
@@ -36,6 +44,15 @@ StatusOr<ResumableUploadResponse> CurlResumableUploadSession::UploadFinalChunk(
   return result;
 }
 
+StatusOr<ResumableUploadResponse> CurlResumableUploadSession::UploadFinalChunk(
+    ConstBufferSequence const& buffers, std::uint64_t upload_size) {
+  UploadChunkRequest request(session_id_, next_expected_, buffers,
+                             upload_size);
+  auto result = client_->UploadChunk(request);
+  Update(result, request.payload_size());
+  return result;
+}
+
 StatusOr<ResumableUploadResponse> CurlResumableUploadSession::ResetSession() {
   QueryResumableUploadRequest request(session_id_);
   auto result = client_->QueryResumableUpload(request);
@@ -16,8 +16,11 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_GENERATE_MESSAGE_BOUNDARY_H
 
 #include "google/cloud/internal/invoke_result.h"
+#include "google/cloud/storage/internal/const_buffer.h"
 #include "google/cloud/storage/version.h"
+#include <algorithm>
 #include <string>
+#include <utility>
 
 namespace google {
 namespace cloud {
@@ -56,15 +59,31 @@ template <typename RandomStringGenerator,
                                       RandomStringGenerator, int>::value,
                                   int>::type = 0>
 std::string GenerateMessageBoundary(
-    std::string const& message, RandomStringGenerator&& random_string_generator,
+    ConstBuffer const& message, RandomStringGenerator&& random_string_generator,
     int initial_size, int growth_size) {
+  auto const* begin = message.data();
+  auto const* end = begin + message.size();
   std::string candidate = random_string_generator(initial_size);
-  for (std::string::size_type i = message.find(candidate, 0);
-       i != std::string::npos; i = message.find(candidate, i)) {
+  for (auto i = std::search(begin, end, candidate.begin(), candidate.end());
+       i != end; i = std::search(i, end, candidate.begin(), candidate.end())) {
     candidate += random_string_generator(growth_size);
   }
   return candidate;
 }
+
+/// Generate a string that is not found in @p message.
+template <typename RandomStringGenerator,
+          typename std::enable_if<google::cloud::internal::is_invocable<
+                                      RandomStringGenerator, int>::value,
+                                  int>::type = 0>
+std::string GenerateMessageBoundary(
+    std::string const& message, RandomStringGenerator&& random_string_generator,
+    int initial_size, int growth_size) {
+  return GenerateMessageBoundary(
+      ConstBuffer(message.data(), message.size()),
+      std::forward<RandomStringGenerator>(random_string_generator),
+      initial_size, growth_size);
+}
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
@@ -17,6 +17,7 @@
 #include "google/cloud/storage/internal/hash_validator_impl.h"
 #include "google/cloud/storage/internal/object_requests.h"
 #include "google/cloud/storage/object_metadata.h"
+#include <algorithm>
 
 namespace google {
 namespace cloud {
@@ -24,9 +25,19 @@ namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
 
+std::size_t constexpr CompositeValidator::kBlockSize;
+
 void CompositeValidator::Update(char const* buf, std::size_t n) {
-  left_->Update(buf, n);
-  right_->Update(buf, n);
+  // Running each validator over the full buffer would read it from memory
+  // twice. Both hashes are incremental, so alternating on small blocks gives
+  // the same results and the second validator reads the block from cache.
+  while (n != 0) {
+    auto const block = (std::min)(n, kBlockSize);
+    left_->Update(buf, block);
+    right_->Update(buf, block);
+    buf += block;
+    n -= block;
+  }
 }
 
 void CompositeValidator::ProcessMetadata(ObjectMetadata const& meta) {
@@ -68,6 +79,15 @@ std::unique_ptr<HashValidator> CreateHashValidator(bool disable_md5,
       google::cloud::internal::make_unique<MD5HashValidator>());
 }
 
+std::unique_ptr<HashValidator> CreateHashValidator(
+    InsertObjectMediaRequest const& request) {
+  auto disable_md5 = request.HasOption<DisableMD5Hash>() &&
+                     request.GetOption<DisableMD5Hash>().value();
+  auto disable_crc32c = request.HasOption<DisableCrc32cChecksum>() &&
+                        request.GetOption<DisableCrc32cChecksum>().value();
+  return CreateHashValidator(disable_md5, disable_crc32c);
+}
+
 std::unique_ptr<HashValidator> CreateHashValidator(
     ReadObjectRangeRequest const& request) {
   if (request.RequiresRangeHeader()) {
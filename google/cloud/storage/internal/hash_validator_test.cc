@@ -223,6 +223,36 @@ TEST(CompositeHashValidator, Missing) {
   EXPECT_FALSE(result.is_mismatch);
 }
 
+TEST(CompositeHashValidator, LargeBuffers) {
+  // Use a size that is not a multiple of the block size, and feed the data in
+  // both large and small pieces.
+  std::string data(3 * CompositeValidator::kBlockSize + 7, '\0');
+  for (std::size_t i = 0; i != data.size(); ++i) {
+    data[i] = static_cast<char>('a' + i % 26);
+  }
+
+  Crc32cHashValidator crc32c;
+  crc32c.Update(data.data(), data.size());
+  MD5HashValidator md5;
+  md5.Update(data.data(), data.size());
+  auto expected_crc32c = std::move(crc32c).Finish().computed;
+  auto expected_md5 = std::move(md5).Finish().computed;
+
+  CompositeValidator validator(
+      google::cloud::internal::make_unique<Crc32cHashValidator>(),
+      google::cloud::internal::make_unique<MD5HashValidator>());
+  auto const head = CompositeValidator::kBlockSize + 3;
+  validator.Update(data.data(), head);
+  validator.Update(data.data() + head, data.size() - head);
+  validator.ProcessHeader("x-goog-hash", "crc32c=" + expected_crc32c);
+  validator.ProcessHeader("x-goog-hash", "md5=" + expected_md5);
+  auto result = std::move(validator).Finish();
+  EXPECT_EQ("crc32c=" + expected_crc32c + ",md5=" + expected_md5,
+            result.computed);
+  EXPECT_EQ(result.computed, result.received);
+  EXPECT_FALSE(result.is_mismatch);
+}
+
 TEST(CreateHashValidator, Read_Null) {
   auto validator =
       CreateHashValidator(ReadObjectRangeRequest("test-bucket", "test-object")
@@ -300,6 +330,24 @@ TEST(CreateHashValidator, Read_DisableMD5_Default_Constructor) {
   EXPECT_THAT(result.computed, HasSubstr(QUICK_FOX_CRC32C_CHECKSUM));
 }
 
+TEST(CreateHashValidator, Insert_OnlyCrc32c) {
+  auto validator = CreateHashValidator(
+      InsertObjectMediaRequest("test-bucket", "test-object", std::string{})
+          .set_multiple_options(DisableMD5Hash(true)));
+  UpdateValidator(*validator, "The quick brown fox jumps over the lazy dog");
+  auto result = std::move(*validator).Finish();
+  EXPECT_EQ(QUICK_FOX_CRC32C_CHECKSUM, result.computed);
+}
+
+TEST(CreateHashValidator, Insert_Both) {
+  auto validator = CreateHashValidator(
+      InsertObjectMediaRequest("test-bucket", "test-object", std::string{}));
+  UpdateValidator(*validator, "The quick brown fox jumps over the lazy dog");
+  auto result = std::move(*validator).Finish();
+  EXPECT_THAT(result.computed, HasSubstr(QUICK_FOX_MD5_HASH));
+  EXPECT_THAT(result.computed, HasSubstr(QUICK_FOX_CRC32C_CHECKSUM));
+}
+
 TEST(CreateHashValidator, Write_Null) {
   auto validator =
       CreateHashValidator(ResumableUploadRequest("test-bucket", "test-object")
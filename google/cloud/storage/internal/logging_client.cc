@@ -75,6 +75,30 @@ static typename Signature<MemberFunction>::ReturnType MakeCallNoResponseLogging(
   GCP_LOG(INFO) << context << "() << " << request;
   return (client.*function)(request);
 }
+
+/**
+ * Logs the input and results of an asynchronous `RawClient` operation.
+ *
+ * The results are logged when the operation completes, in the thread that
+ * satisfies the future.
+ */
+template <typename T, typename Request>
+future<StatusOr<T>> MakeAsyncCall(
+    RawClient& client,
+    future<StatusOr<T>> (RawClient::*function)(Request const&),
+    Request const& request, char const* context) {
+  GCP_LOG(INFO) << context << "() << " << request;
+  std::string name = context;
+  return (client.*function)(request).then([name](future<StatusOr<T>> f) {
+    auto response = f.get();
+    if (response.ok()) {
+      GCP_LOG(INFO) << name << "() >> payload={" << response.value() << "}";
+    } else {
+      GCP_LOG(INFO) << name << "() >> status={" << response.status() << "}";
+    }
+    return response;
+  });
+}
 }  // namespace
 
 LoggingClient::LoggingClient(std::shared_ptr<RawClient> client)
@@ -369,6 +393,45 @@ StatusOr<EmptyResponse> LoggingClient::DeleteNotification(
   return MakeCall(*client_, &RawClient::DeleteNotification, request, __func__);
 }
 
+StatusOr<BatchResponse> LoggingClient::ExecuteBatch(
+    BatchRequest const& request) {
+  return MakeCall(*client_, &RawClient::ExecuteBatch, request, __func__);
+}
+
+future<StatusOr<ObjectMetadata>> LoggingClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  return MakeAsyncCall(*client_, &RawClient::AsyncInsertObjectMedia, request,
+                       __func__);
+}
+
+future<StatusOr<ObjectMetadata>> LoggingClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return MakeAsyncCall(*client_, &RawClient::AsyncGetObjectMetadata, request,
+                       __func__);
+}
+
+future<StatusOr<std::string>> LoggingClient::AsyncReadObject(
+    ReadObjectRangeRequest const& request) {
+  // The object contents are not logged, only their size.
+  GCP_LOG(INFO) << __func__ << "() << " << request;
+  std::string name = __func__;
+  return client_->AsyncReadObject(request).then(
+      [name](future<StatusOr<std::string>> f) {
+        auto response = f.get();
+        if (response.ok()) {
+          GCP_LOG(INFO) << name << "() >> size=" << response->size();
+        } else {
+          GCP_LOG(INFO) << name << "() >> status={" << response.status()
+                        << "}";
+        }
+        return response;
+      });
+}
+
+future<void> LoggingClient::AsyncSleep(std::chrono::milliseconds duration) {
+  return client_->AsyncSleep(duration);
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
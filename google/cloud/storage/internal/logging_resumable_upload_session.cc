@@ -34,6 +34,19 @@ StatusOr<ResumableUploadResponse> LoggingResumableUploadSession::UploadChunk(
   return response;
 }
 
+StatusOr<ResumableUploadResponse> LoggingResumableUploadSession::UploadChunk(
+    ConstBufferSequence const& buffers) {
+  GCP_LOG(INFO) << __func__ << "() << {buffers.size=" << buffers.size()
+                << ", total_bytes=" << TotalBytes(buffers) << "}";
+  auto response = session_->UploadChunk(buffers);
+  if (response.ok()) {
+    GCP_LOG(INFO) << __func__ << "() >> payload={" << response.value() << "}";
+  } else {
+    GCP_LOG(INFO) << __func__ << "() >> status={" << response.status() << "}";
+  }
+  return response;
+}
+
 StatusOr<ResumableUploadResponse>
 LoggingResumableUploadSession::UploadFinalChunk(std::string const& buffer,
                                                 std::uint64_t upload_size) {
@@ -48,6 +61,21 @@ LoggingResumableUploadSession::UploadFinalChunk(std::string const& buffer,
   return response;
 }
 
+StatusOr<ResumableUploadResponse>
+LoggingResumableUploadSession::UploadFinalChunk(
+    ConstBufferSequence const& buffers, std::uint64_t upload_size) {
+  GCP_LOG(INFO) << __func__ << "() << upload_size=" << upload_size
+                << ", buffers.size=" << buffers.size()
+                << ", total_bytes=" << TotalBytes(buffers);
+  auto response = session_->UploadFinalChunk(buffers, upload_size);
+  if (response.ok()) {
+    GCP_LOG(INFO) << __func__ << "() >> payload={" << response.value() << "}";
+  } else {
+    GCP_LOG(INFO) << __func__ << "() >> status={" << response.status() << "}";
+  }
+  return response;
+}
+
 StatusOr<ResumableUploadResponse>
 LoggingResumableUploadSession::ResetSession() {
   GCP_LOG(INFO) << __func__ << "() << {}";
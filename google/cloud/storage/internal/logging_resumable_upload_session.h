@@ -35,8 +35,12 @@ class LoggingResumableUploadSession : public ResumableUploadSession {
 
   StatusOr<ResumableUploadResponse> UploadChunk(
       std::string const& buffer) override;
+  StatusOr<ResumableUploadResponse> UploadChunk(
+      ConstBufferSequence const& buffers) override;
   StatusOr<ResumableUploadResponse> UploadFinalChunk(
       std::string const& buffer, std::uint64_t upload_size) override;
+  StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      ConstBufferSequence const& buffers, std::uint64_t upload_size) override;
   StatusOr<ResumableUploadResponse> ResetSession() override;
   std::uint64_t next_expected_byte() const override;
   std::string const& session_id() const override;
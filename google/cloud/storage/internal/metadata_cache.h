@@ -0,0 +1,282 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_METADATA_CACHE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_METADATA_CACHE_H
+
+#include "google/cloud/status_or.h"
+#include "google/cloud/storage/metadata_cache_counters.h"
+#include "google/cloud/storage/version.h"
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * A cache for metadata results, with a TTL and single-flight requests.
+ *
+ * The entries are organized in groups (e.g. all the requests for the same
+ * object), and each entry within a group is identified by a key that captures
+ * all the request parameters. Successful results are kept for `ttl`. Errors
+ * are never cached, but they are shared with any requests that were waiting
+ * for the same result.
+ *
+ * While a request for a key is in flight, any identical requests wait for its
+ * result instead of contacting the service. Invalidating a group discards its
+ * entries, and prevents any requests already in flight from storing their
+ * (possibly stale) results.
+ *
+ * The cache holds at most `max_entries` entries. When it is full, the
+ * expired entries are discarded, and if that is not enough, new results are
+ * simply not cached.
+ *
+ * @tparam T the type of the cached values.
+ * @tparam Clock the clock used to expire entries, tests can replace it.
+ */
+template <typename T, typename Clock = std::chrono::steady_clock>
+class MetadataCache {
+ public:
+  MetadataCache(typename Clock::duration ttl, std::size_t max_entries)
+      : ttl_(ttl), max_entries_(max_entries) {}
+
+  /**
+   * Returns the cached value for @p key, calling @p fetch on a miss.
+   *
+   * @p fetch is called without holding any locks, only one call for each
+   * key and group is in flight at any time.
+   */
+  StatusOr<T> Get(std::string const& group, std::string const& key,
+                  std::function<StatusOr<T>()> const& fetch) {
+    std::unique_lock<std::mutex> lk(mu_);
+    auto& g = groups_[group];
+    auto const now = Clock::now();
+    auto e = g.entries.find(key);
+    if (e != g.entries.end()) {
+      if (now < e->second.expiration) {
+        ++counters_.hits;
+        return e->second.value;
+      }
+      g.entries.erase(e);
+      --size_;
+    }
+    auto p = g.pending.find(key);
+    if (p != g.pending.end()) {
+      ++counters_.coalesced;
+      auto f = p->second.result;
+      lk.unlock();
+      return f.get();
+    }
+
+    ++counters_.misses;
+    FlightGuard guard(*this, group, g, key, ++flight_count_);
+    lk.unlock();
+    guard.Run(fetch);
+    return guard.result();
+  }
+
+  /// Discards all the entries in @p group.
+  void Invalidate(std::string const& group) {
+    std::lock_guard<std::mutex> lk(mu_);
+    ++counters_.invalidations;
+    auto loc = groups_.find(group);
+    if (loc == groups_.end()) {
+      return;
+    }
+    auto& g = loc->second;
+    size_ -= g.entries.size();
+    g.entries.clear();
+    // Requests that start after the invalidation should not wait for results
+    // fetched before it.
+    g.pending.clear();
+    ++g.version;
+    RemoveIfEmptyLocked(group);
+  }
+
+  /// The number of entries in the cache, including expired entries.
+  std::size_t size() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return size_;
+  }
+
+  /// The number of groups with entries or requests in flight.
+  std::size_t group_count() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return groups_.size();
+  }
+
+  MetadataCacheCounters counters() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return counters_;
+  }
+
+ private:
+  struct Entry {
+    T value;
+    typename Clock::time_point expiration;
+  };
+  struct Flight {
+    std::uint64_t id;
+    std::shared_future<StatusOr<T>> result;
+  };
+  struct Group {
+    std::uint64_t version = 0;
+    std::map<std::string, Entry> entries;
+    std::map<std::string, Flight> pending;
+    std::size_t active = 0;
+  };
+
+  /**
+   * Tracks a request in flight, and publishes its result.
+   *
+   * The destructor removes the request from its group, caches its result (if
+   * any), wakes up any requests waiting for it, and removes the group once it
+   * is empty. It runs even if `fetch` throws, the waiting requests then get
+   * the same exception.
+   */
+  class FlightGuard {
+   public:
+    FlightGuard(MetadataCache& cache, std::string group, Group& g,
+                std::string key, std::uint64_t id)
+        : cache_(cache),
+          group_(std::move(group)),
+          g_(g),
+          key_(std::move(key)),
+          id_(id),
+          version_(g.version) {
+      g_.pending.emplace(key_, Flight{id_, promise_.get_future().share()});
+      ++g_.active;
+    }
+
+    ~FlightGuard() {
+      std::unique_lock<std::mutex> lk(cache_.mu_);
+      // `g_` is still valid, groups are not removed while they have requests
+      // in flight.
+      --g_.active;
+      auto p = g_.pending.find(key_);
+      if (p != g_.pending.end() && p->second.id == id_) {
+        g_.pending.erase(p);
+      }
+      if (!exception_ && result_ && g_.version == version_) {
+        cache_.InsertLocked(g_, key_, *result_, Clock::now() + cache_.ttl_);
+      }
+      cache_.RemoveIfEmptyLocked(group_);
+      lk.unlock();
+      if (exception_) {
+        promise_.set_exception(exception_);
+        return;
+      }
+      promise_.set_value(result_);
+    }
+
+    FlightGuard(FlightGuard const&) = delete;
+    FlightGuard& operator=(FlightGuard const&) = delete;
+
+    /// Calls @p fetch, recording its result or exception.
+    void Run(std::function<StatusOr<T>()> const& fetch) {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+      try {
+        result_ = fetch();
+      } catch (...) {
+        exception_ = std::current_exception();
+        throw;
+      }
+#else
+      result_ = fetch();
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    }
+
+    StatusOr<T> const& result() const { return result_; }
+
+   private:
+    MetadataCache& cache_;
+    std::string group_;
+    Group& g_;
+    std::string key_;
+    std::uint64_t id_;
+    std::uint64_t version_;
+    std::promise<StatusOr<T>> promise_;
+    StatusOr<T> result_;
+    std::exception_ptr exception_;
+  };
+
+  void InsertLocked(Group& g, std::string const& key, T const& value,
+                    typename Clock::time_point expiration) {
+    auto e = g.entries.find(key);
+    if (e != g.entries.end()) {
+      e->second = Entry{value, expiration};
+      return;
+    }
+    if (size_ >= max_entries_) {
+      PurgeExpiredLocked();
+    }
+    if (size_ >= max_entries_) {
+      return;
+    }
+    g.entries.emplace(key, Entry{value, expiration});
+    ++size_;
+  }
+
+  void PurgeExpiredLocked() {
+    auto const now = Clock::now();
+    for (auto& kv : groups_) {
+      auto& entries = kv.second.entries;
+      for (auto e = entries.begin(); e != entries.end();) {
+        if (now < e->second.expiration) {
+          ++e;
+          continue;
+        }
+        e = entries.erase(e);
+        --size_;
+      }
+    }
+  }
+
+  void RemoveIfEmptyLocked(std::string const& group) {
+    auto loc = groups_.find(group);
+    if (loc == groups_.end()) {
+      return;
+    }
+    // Groups with requests in flight must keep their version.
+    if (loc->second.entries.empty() && loc->second.active == 0) {
+      groups_.erase(loc);
+    }
+  }
+
+  typename Clock::duration const ttl_;
+  std::size_t const max_entries_;
+
+  mutable std::mutex mu_;
+  std::map<std::string, Group> groups_;  // GUARDED_BY(mu_)
+  std::size_t size_ = 0;                 // GUARDED_BY(mu_)
+  std::uint64_t flight_count_ = 0;       // GUARDED_BY(mu_)
+  MetadataCacheCounters counters_;       // GUARDED_BY(mu_)
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_METADATA_CACHE_H
@@ -0,0 +1,508 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/metadata_cache_client.h"
+#include <functional>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+/**
+ * A decorator for `ResumableUploadSession` that reports when the upload ends.
+ *
+ * The object only changes when the final chunk is committed, @p on_commit is
+ * called with the response for the final chunk (even if it failed), and with
+ * any other response reporting the upload as done.
+ */
+class CommitNotifyingUploadSession : public ResumableUploadSession {
+ public:
+  using CommitCallback =
+      std::function<void(StatusOr<ResumableUploadResponse> const&)>;
+
+  CommitNotifyingUploadSession(std::unique_ptr<ResumableUploadSession> session,
+                               CommitCallback on_commit)
+      : session_(std::move(session)), on_commit_(std::move(on_commit)) {}
+
+  StatusOr<ResumableUploadResponse> UploadChunk(
+      std::string const& buffer) override {
+    return Notify(session_->UploadChunk(buffer), false);
+  }
+  StatusOr<ResumableUploadResponse> UploadChunk(
+      ConstBufferSequence const& buffers) override {
+    return Notify(session_->UploadChunk(buffers), false);
+  }
+  StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      std::string const& buffer, std::uint64_t upload_size) override {
+    return Notify(session_->UploadFinalChunk(buffer, upload_size), true);
+  }
+  StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      ConstBufferSequence const& buffers, std::uint64_t upload_size) override {
+    return Notify(session_->UploadFinalChunk(buffers, upload_size), true);
+  }
+  StatusOr<ResumableUploadResponse> ResetSession() override {
+    return Notify(session_->ResetSession(), false);
+  }
+  std::uint64_t next_expected_byte() const override {
+    return session_->next_expected_byte();
+  }
+  std::string const& session_id() const override {
+    return session_->session_id();
+  }
+  bool done() const override { return session_->done(); }
+  StatusOr<ResumableUploadResponse> const& last_response() const override {
+    return session_->last_response();
+  }
+
+ private:
+  StatusOr<ResumableUploadResponse> Notify(
+      StatusOr<ResumableUploadResponse> response, bool final_chunk) {
+    if (final_chunk ||
+        (response &&
+         response->upload_state == ResumableUploadResponse::kDone)) {
+      on_commit_(response);
+    }
+    return response;
+  }
+
+  std::unique_ptr<ResumableUploadSession> session_;
+  CommitCallback on_commit_;
+};
+}  // namespace
+
+MetadataCacheClient::MetadataCacheClient(std::shared_ptr<RawClient> client,
+                                         std::chrono::milliseconds ttl,
+                                         std::size_t max_entries)
+    : client_(std::move(client)),
+      objects_(ttl, max_entries),
+      buckets_(ttl, max_entries) {}
+
+ClientOptions const& MetadataCacheClient::client_options() const {
+  return client_->client_options();
+}
+
+StatusOr<ListBucketsResponse> MetadataCacheClient::ListBuckets(
+    ListBucketsRequest const& request) {
+  return client_->ListBuckets(request);
+}
+
+StatusOr<BucketMetadata> MetadataCacheClient::CreateBucket(
+    CreateBucketRequest const& request) {
+  auto result = client_->CreateBucket(request);
+  InvalidateBucket(request.metadata().name());
+  return result;
+}
+
+StatusOr<BucketMetadata> MetadataCacheClient::GetBucketMetadata(
+    GetBucketMetadataRequest const& request) {
+  std::ostringstream key;
+  key << request;
+  return buckets_.Get(request.bucket_name(), key.str(), [this, &request] {
+    return client_->GetBucketMetadata(request);
+  });
+}
+
+StatusOr<EmptyResponse> MetadataCacheClient::DeleteBucket(
+    DeleteBucketRequest const& request) {
+  auto result = client_->DeleteBucket(request);
+  InvalidateBucket(request.bucket_name());
+  return result;
+}
+
+StatusOr<BucketMetadata> MetadataCacheClient::UpdateBucket(
+    UpdateBucketRequest const& request) {
+  auto result = client_->UpdateBucket(request);
+  InvalidateBucket(request.metadata().name());
+  return result;
+}
+
+StatusOr<BucketMetadata> MetadataCacheClient::PatchBucket(
+    PatchBucketRequest const& request) {
+  auto result = client_->PatchBucket(request);
+  InvalidateBucket(request.bucket());
+  return result;
+}
+
+StatusOr<IamPolicy> MetadataCacheClient::GetBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return client_->GetBucketIamPolicy(request);
+}
+
+StatusOr<NativeIamPolicy> MetadataCacheClient::GetNativeBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return client_->GetNativeBucketIamPolicy(request);
+}
+
+StatusOr<IamPolicy> MetadataCacheClient::SetBucketIamPolicy(
+    SetBucketIamPolicyRequest const& request) {
+  return client_->SetBucketIamPolicy(request);
+}
+
+StatusOr<NativeIamPolicy> MetadataCacheClient::SetNativeBucketIamPolicy(
+    SetNativeBucketIamPolicyRequest const& request) {
+  return client_->SetNativeBucketIamPolicy(request);
+}
+
+StatusOr<TestBucketIamPermissionsResponse>
+MetadataCacheClient::TestBucketIamPermissions(
+    TestBucketIamPermissionsRequest const& request) {
+  return client_->TestBucketIamPermissions(request);
+}
+
+StatusOr<BucketMetadata> MetadataCacheClient::LockBucketRetentionPolicy(
+    LockBucketRetentionPolicyRequest const& request) {
+  auto result = client_->LockBucketRetentionPolicy(request);
+  InvalidateBucket(request.bucket_name());
+  return result;
+}
+
+StatusOr<ObjectMetadata> MetadataCacheClient::InsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  auto result = client_->InsertObjectMedia(request);
+  InvalidateObject(request.bucket_name(), request.object_name());
+  return result;
+}
+
+StatusOr<ObjectMetadata> MetadataCacheClient::CopyObject(
+    CopyObjectRequest const& request) {
+  auto result = client_->CopyObject(request);
+  InvalidateObject(request.destination_bucket(), request.destination_object());
+  return result;
+}
+
+StatusOr<ObjectMetadata> MetadataCacheClient::GetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  std::ostringstream key;
+  key << request;
+  return objects_.Get(request.bucket_name() + "/" + request.object_name(),
+                      key.str(), [this, &request] {
+                        return client_->GetObjectMetadata(request);
+                      });
+}
+
+StatusOr<std::unique_ptr<ObjectReadSource>> MetadataCacheClient::ReadObject(
+    ReadObjectRangeRequest const& request) {
+  return client_->ReadObject(request);
+}
+
+StatusOr<ListObjectsResponse> MetadataCacheClient::ListObjects(
+    ListObjectsRequest const& request) {
+  return client_->ListObjects(request);
+}
+
+StatusOr<EmptyResponse> MetadataCacheClient::DeleteObject(
+    DeleteObjectRequest const& request) {
+  auto result = client_->DeleteObject(request);
+  InvalidateObject(request.bucket_name(), request.object_name());
+  return result;
+}
+
+StatusOr<ObjectMetadata> MetadataCacheClient::UpdateObject(
+    UpdateObjectRequest const& request) {
+  auto result = client_->UpdateObject(request);
+  InvalidateObject(request.bucket_name(), request.object_name());
+  return result;
+}
+
+StatusOr<ObjectMetadata> MetadataCacheClient::PatchObject(
+    PatchObjectRequest const& request) {
+  auto result = client_->PatchObject(request);
+  InvalidateObject(request.bucket_name(), request.object_name());
+  return result;
+}
+
+StatusOr<ObjectMetadata> MetadataCacheClient::ComposeObject(
+    ComposeObjectRequest const& request) {
+  auto result = client_->ComposeObject(request);
+  InvalidateObject(request.bucket_name(), request.object_name());
+  return result;
+}
+
+StatusOr<RewriteObjectResponse> MetadataCacheClient::RewriteObject(
+    RewriteObjectRequest const& request) {
+  auto result = client_->RewriteObject(request);
+  InvalidateObject(request.destination_bucket(), request.destination_object());
+  return result;
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+MetadataCacheClient::CreateResumableSession(
+    ResumableUploadRequest const& request) {
+  return InvalidateOnCommit(client_->CreateResumableSession(request),
+                            request.bucket_name(), request.object_name());
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+MetadataCacheClient::RestoreResumableSession(std::string const& request) {
+  // The object name is not known, use the metadata in the final response.
+  return InvalidateOnCommit(client_->RestoreResumableSession(request), {}, {});
+}
+
+StatusOr<ListBucketAclResponse> MetadataCacheClient::ListBucketAcl(
+    ListBucketAclRequest const& request) {
+  return client_->ListBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> MetadataCacheClient::GetBucketAcl(
+    GetBucketAclRequest const& request) {
+  return client_->GetBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> MetadataCacheClient::CreateBucketAcl(
+    CreateBucketAclRequest const& request) {
+  auto result = client_->CreateBucketAcl(request);
+  InvalidateBucket(request.bucket_name());
+  return result;
+}
+
+StatusOr<EmptyResponse> MetadataCacheClient::DeleteBucketAcl(
+    DeleteBucketAclRequest const& request) {
+  auto result = client_->DeleteBucketAcl(request);
+  InvalidateBucket(request.bucket_name());
+  return result;
+}
+
+StatusOr<BucketAccessControl> MetadataCacheClient::UpdateBucketAcl(
+    UpdateBucketAclRequest const& request) {
+  auto result = client_->UpdateBucketAcl(request);
+  InvalidateBucket(request.bucket_name());
+  return result;
+}
+
+StatusOr<BucketAccessControl> MetadataCacheClient::PatchBucketAcl(
+    PatchBucketAclRequest const& request) {
+  auto result = client_->PatchBucketAcl(request);
+  InvalidateBucket(request.bucket_name());
+  return result;
+}
+
+StatusOr<ListObjectAclResponse> MetadataCacheClient::ListObjectAcl(
+    ListObjectAclRequest const& request) {
+  return client_->ListObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> MetadataCacheClient::CreateObjectAcl(
+    CreateObjectAclRequest const& request) {
+  auto result = client_->CreateObjectAcl(request);
+  InvalidateObject(request.bucket_name(), request.object_name());
+  return result;
+}
+
+StatusOr<EmptyResponse> MetadataCacheClient::DeleteObjectAcl(
+    DeleteObjectAclRequest const& request) {
+  auto result = client_->DeleteObjectAcl(request);
+  InvalidateObject(request.bucket_name(), request.object_name());
+  return result;
+}
+
+StatusOr<ObjectAccessControl> MetadataCacheClient::GetObjectAcl(
+    GetObjectAclRequest const& request) {
+  return client_->GetObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> MetadataCacheClient::UpdateObjectAcl(
+    UpdateObjectAclRequest const& request) {
+  auto result = client_->UpdateObjectAcl(request);
+  InvalidateObject(request.bucket_name(), request.object_name());
+  return result;
+}
+
+StatusOr<ObjectAccessControl> MetadataCacheClient::PatchObjectAcl(
+    PatchObjectAclRequest const& request) {
+  auto result = client_->PatchObjectAcl(request);
+  InvalidateObject(request.bucket_name(), request.object_name());
+  return result;
+}
+
+StatusOr<ListDefaultObjectAclResponse>
+MetadataCacheClient::ListDefaultObjectAcl(
+    ListDefaultObjectAclRequest const& request) {
+  return client_->ListDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> MetadataCacheClient::CreateDefaultObjectAcl(
+    CreateDefaultObjectAclRequest const& request) {
+  auto result = client_->CreateDefaultObjectAcl(request);
+  InvalidateBucket(request.bucket_name());
+  return result;
+}
+
+StatusOr<EmptyResponse> MetadataCacheClient::DeleteDefaultObjectAcl(
+    DeleteDefaultObjectAclRequest const& request) {
+  auto result = client_->DeleteDefaultObjectAcl(request);
+  InvalidateBucket(request.bucket_name());
+  return result;
+}
+
+StatusOr<ObjectAccessControl> MetadataCacheClient::GetDefaultObjectAcl(
+    GetDefaultObjectAclRequest const& request) {
+  return client_->GetDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> MetadataCacheClient::UpdateDefaultObjectAcl(
+    UpdateDefaultObjectAclRequest const& request) {
+  auto result = client_->UpdateDefaultObjectAcl(request);
+  InvalidateBucket(request.bucket_name());
+  return result;
+}
+
+StatusOr<ObjectAccessControl> MetadataCacheClient::PatchDefaultObjectAcl(
+    PatchDefaultObjectAclRequest const& request) {
+  auto result = client_->PatchDefaultObjectAcl(request);
+  InvalidateBucket(request.bucket_name());
+  return result;
+}
+
+StatusOr<ServiceAccount> MetadataCacheClient::GetServiceAccount(
+    GetProjectServiceAccountRequest const& request) {
+  return client_->GetServiceAccount(request);
+}
+
+StatusOr<ListHmacKeysResponse> MetadataCacheClient::ListHmacKeys(
+    ListHmacKeysRequest const& request) {
+  return client_->ListHmacKeys(request);
+}
+
+StatusOr<CreateHmacKeyResponse> MetadataCacheClient::CreateHmacKey(
+    CreateHmacKeyRequest const& request) {
+  return client_->CreateHmacKey(request);
+}
+
+StatusOr<EmptyResponse> MetadataCacheClient::DeleteHmacKey(
+    DeleteHmacKeyRequest const& request) {
+  return client_->DeleteHmacKey(request);
+}
+
+StatusOr<HmacKeyMetadata> MetadataCacheClient::GetHmacKey(
+    GetHmacKeyRequest const& request) {
+  return client_->GetHmacKey(request);
+}
+
+StatusOr<HmacKeyMetadata> MetadataCacheClient::UpdateHmacKey(
+    UpdateHmacKeyRequest const& request) {
+  return client_->UpdateHmacKey(request);
+}
+
+StatusOr<SignBlobResponse> MetadataCacheClient::SignBlob(
+    SignBlobRequest const& request) {
+  return client_->SignBlob(request);
+}
+
+StatusOr<ListNotificationsResponse> MetadataCacheClient::ListNotifications(
+    ListNotificationsRequest const& request) {
+  return client_->ListNotifications(request);
+}
+
+StatusOr<NotificationMetadata> MetadataCacheClient::CreateNotification(
+    CreateNotificationRequest const& request) {
+  return client_->CreateNotification(request);
+}
+
+StatusOr<NotificationMetadata> MetadataCacheClient::GetNotification(
+    GetNotificationRequest const& request) {
+  return client_->GetNotification(request);
+}
+
+StatusOr<EmptyResponse> MetadataCacheClient::DeleteNotification(
+    DeleteNotificationRequest const& request) {
+  return client_->DeleteNotification(request);
+}
+
+StatusOr<BatchResponse> MetadataCacheClient::ExecuteBatch(
+    BatchRequest const& request) {
+  auto result = client_->ExecuteBatch(request);
+  for (auto const& part : request.parts()) {
+    InvalidateObject(part.bucket_name, part.object_name);
+  }
+  return result;
+}
+
+future<StatusOr<ObjectMetadata>> MetadataCacheClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  auto self = shared_from_this();
+  auto bucket_name = request.bucket_name();
+  auto object_name = request.object_name();
+  return client_->AsyncInsertObjectMedia(request).then(
+      [self, bucket_name, object_name](future<StatusOr<ObjectMetadata>> f) {
+        auto result = f.get();
+        self->InvalidateObject(bucket_name, object_name);
+        return result;
+      });
+}
+
+future<StatusOr<ObjectMetadata>> MetadataCacheClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return client_->AsyncGetObjectMetadata(request);
+}
+
+future<StatusOr<std::string>> MetadataCacheClient::AsyncReadObject(
+    ReadObjectRangeRequest const& request) {
+  return client_->AsyncReadObject(request);
+}
+
+future<void> MetadataCacheClient::AsyncSleep(
+    std::chrono::milliseconds duration) {
+  return client_->AsyncSleep(duration);
+}
+
+MetadataCacheCounters MetadataCacheClient::counters() const {
+  auto counters = objects_.counters();
+  counters += buckets_.counters();
+  return counters;
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+MetadataCacheClient::InvalidateOnCommit(
+    StatusOr<std::unique_ptr<ResumableUploadSession>> session,
+    std::string bucket_name, std::string object_name) {
+  if (!session) {
+    return session;
+  }
+  std::weak_ptr<MetadataCacheClient> w = shared_from_this();
+  auto on_commit = [w, bucket_name, object_name](
+                       StatusOr<ResumableUploadResponse> const& response) {
+    auto self = w.lock();
+    if (!self) {
+      return;
+    }
+    if (!object_name.empty()) {
+      self->InvalidateObject(bucket_name, object_name);
+    }
+    if (response && response->payload.has_value()) {
+      self->InvalidateObject(response->payload->bucket(),
+                             response->payload->name());
+    }
+  };
+  return std::unique_ptr<ResumableUploadSession>(
+      new CommitNotifyingUploadSession(*std::move(session),
+                                       std::move(on_commit)));
+}
+
+void MetadataCacheClient::InvalidateObject(std::string const& bucket_name,
+                                           std::string const& object_name) {
+  objects_.Invalidate(bucket_name + "/" + object_name);
+}
+
+void MetadataCacheClient::InvalidateBucket(std::string const& bucket_name) {
+  buckets_.Invalidate(bucket_name);
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,259 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/metadata_cache_client.h"
+#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::TransientError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+ObjectMetadata MockObject(std::int64_t generation) {
+  return ObjectMetadataParser::FromString(
+             R"""({"bucket": "test-bucket", "name": "test-object",)""" +
+             std::string(R"""("generation": ")""") +
+             std::to_string(generation) + R"""("})""")
+      .value();
+}
+
+BucketMetadata MockBucket(std::int64_t metageneration) {
+  return BucketMetadataParser::FromString(
+             R"""({"name": "test-bucket", "metageneration": ")""" +
+             std::to_string(metageneration) + R"""("})""")
+      .value();
+}
+
+std::shared_ptr<MetadataCacheClient> MakeClient(
+    std::shared_ptr<testing::MockClient> mock) {
+  return std::make_shared<MetadataCacheClient>(
+      std::move(mock), std::chrono::minutes(5), 100);
+}
+
+TEST(MetadataCacheClientTest, GetObjectMetadata) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Return(MockObject(1)))
+      .WillOnce(Return(MockObject(2)));
+  auto client = MakeClient(mock);
+
+  for (int i = 0; i != 3; ++i) {
+    auto metadata = client->GetObjectMetadata(
+        GetObjectMetadataRequest("test-bucket", "test-object"));
+    ASSERT_STATUS_OK(metadata);
+    EXPECT_EQ(1, metadata->generation());
+  }
+  // Requests with different options use different entries.
+  GetObjectMetadataRequest request("test-bucket", "test-object");
+  request.set_multiple_options(Generation(2));
+  auto metadata = client->GetObjectMetadata(request);
+  ASSERT_STATUS_OK(metadata);
+  EXPECT_EQ(2, metadata->generation());
+
+  auto counters = client->counters();
+  EXPECT_EQ(2, counters.hits);
+  EXPECT_EQ(2, counters.misses);
+}
+
+TEST(MetadataCacheClientTest, GetObjectMetadataErrors) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(TransientError())))
+      .WillOnce(Return(MockObject(1)));
+  auto client = MakeClient(mock);
+
+  auto metadata = client->GetObjectMetadata(
+      GetObjectMetadataRequest("test-bucket", "test-object"));
+  EXPECT_EQ(TransientError().code(), metadata.status().code());
+  metadata = client->GetObjectMetadata(
+      GetObjectMetadataRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(metadata);
+  EXPECT_EQ(1, metadata->generation());
+}
+
+TEST(MetadataCacheClientTest, ObjectWritesInvalidate) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Return(MockObject(1)))
+      .WillOnce(Return(MockObject(2)))
+      .WillOnce(Return(MockObject(3)));
+  EXPECT_CALL(*mock, InsertObjectMedia(_)).WillOnce(Return(MockObject(2)));
+  EXPECT_CALL(*mock, DeleteObject(_))
+      .WillOnce(Return(make_status_or(EmptyResponse{})));
+  auto client = MakeClient(mock);
+
+  auto get = [&client] {
+    return client
+        ->GetObjectMetadata(
+            GetObjectMetadataRequest("test-bucket", "test-object"))
+        .value()
+        .generation();
+  };
+  EXPECT_EQ(1, get());
+  EXPECT_EQ(1, get());
+  ASSERT_STATUS_OK(client->InsertObjectMedia(
+      InsertObjectMediaRequest("test-bucket", "test-object", "contents")));
+  EXPECT_EQ(2, get());
+  EXPECT_EQ(2, get());
+
+  // Writes to other objects do not invalidate the entry.
+  ASSERT_STATUS_OK(
+      client->DeleteObject(DeleteObjectRequest("test-bucket", "other-object")));
+  EXPECT_EQ(2, get());
+  // The result of the write does not matter, it may have changed the object.
+  EXPECT_CALL(*mock, PatchObject(_))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(TransientError())));
+  auto patch = ObjectMetadataPatchBuilder().SetContentType("text/plain");
+  EXPECT_FALSE(client
+                   ->PatchObject(
+                       PatchObjectRequest("test-bucket", "test-object", patch))
+                   .ok());
+  EXPECT_EQ(3, get());
+}
+
+TEST(MetadataCacheClientTest, BatchInvalidates) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Return(MockObject(1)))
+      .WillOnce(Return(MockObject(2)));
+  EXPECT_CALL(*mock, ExecuteBatch(_))
+      .WillOnce(Return(StatusOr<BatchResponse>(TransientError())));
+  auto client = MakeClient(mock);
+
+  auto get = [&client] {
+    return client
+        ->GetObjectMetadata(
+            GetObjectMetadataRequest("test-bucket", "test-object"))
+        .value()
+        .generation();
+  };
+  EXPECT_EQ(1, get());
+  EXPECT_EQ(1, get());
+  BatchRequest batch;
+  batch.AddRequest(DeleteObjectRequest("test-bucket", "test-object"));
+  EXPECT_FALSE(client->ExecuteBatch(batch).ok());
+  EXPECT_EQ(2, get());
+}
+
+TEST(MetadataCacheClientTest, ResumableUploadInvalidatesOnCommit) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Return(MockObject(1)))
+      .WillOnce(Return(MockObject(2)));
+  EXPECT_CALL(*mock, CreateResumableSession(_))
+      .WillOnce(Invoke([](ResumableUploadRequest const&) {
+        auto session = google::cloud::internal::make_unique<
+            testing::MockResumableUploadSession>();
+        EXPECT_CALL(*session, UploadChunk(_))
+            .WillOnce(Return(make_status_or(ResumableUploadResponse{
+                "", 1023, {}, ResumableUploadResponse::kInProgress, {}})));
+        EXPECT_CALL(*session, UploadFinalChunk(_, _))
+            .WillOnce(Return(make_status_or(
+                ResumableUploadResponse{"", 2047, MockObject(2),
+                                        ResumableUploadResponse::kDone, {}})));
+        return make_status_or(
+            std::unique_ptr<ResumableUploadSession>(std::move(session)));
+      }));
+  auto client = MakeClient(mock);
+
+  auto get = [&client] {
+    return client
+        ->GetObjectMetadata(
+            GetObjectMetadataRequest("test-bucket", "test-object"))
+        .value()
+        .generation();
+  };
+  auto session = client->CreateResumableSession(
+      ResumableUploadRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(session);
+  EXPECT_EQ(1, get());
+  ASSERT_STATUS_OK((*session)->UploadChunk(std::string(1024, 'a')));
+  // The upload is not committed, the cached metadata is still valid.
+  EXPECT_EQ(1, get());
+  ASSERT_STATUS_OK((*session)->UploadFinalChunk(std::string(1024, 'a'), 2048));
+  EXPECT_EQ(2, get());
+  EXPECT_EQ(2, get());
+}
+
+TEST(MetadataCacheClientTest, RestoredUploadInvalidatesOnCommit) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Return(MockObject(1)))
+      .WillOnce(Return(MockObject(2)));
+  EXPECT_CALL(*mock, RestoreResumableSession(_))
+      .WillOnce(Invoke([](std::string const&) {
+        auto session = google::cloud::internal::make_unique<
+            testing::MockResumableUploadSession>();
+        EXPECT_CALL(*session, UploadFinalChunk(_, _))
+            .WillOnce(Return(make_status_or(
+                ResumableUploadResponse{"", 1023, MockObject(2),
+                                        ResumableUploadResponse::kDone, {}})));
+        return make_status_or(
+            std::unique_ptr<ResumableUploadSession>(std::move(session)));
+      }));
+  auto client = MakeClient(mock);
+
+  auto get = [&client] {
+    return client
+        ->GetObjectMetadata(
+            GetObjectMetadataRequest("test-bucket", "test-object"))
+        .value()
+        .generation();
+  };
+  EXPECT_EQ(1, get());
+  auto session = client->RestoreResumableSession("test-session-id");
+  ASSERT_STATUS_OK(session);
+  ASSERT_STATUS_OK((*session)->UploadFinalChunk(std::string(1024, 'a'), 1024));
+  EXPECT_EQ(2, get());
+}
+
+TEST(MetadataCacheClientTest, BucketWritesInvalidate) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, GetBucketMetadata(_))
+      .WillOnce(Return(MockBucket(1)))
+      .WillOnce(Return(MockBucket(2)));
+  EXPECT_CALL(*mock, PatchBucket(_)).WillOnce(Return(MockBucket(2)));
+  auto client = MakeClient(mock);
+
+  auto get = [&client] {
+    return client->GetBucketMetadata(GetBucketMetadataRequest("test-bucket"))
+        .value()
+        .metageneration();
+  };
+  EXPECT_EQ(1, get());
+  EXPECT_EQ(1, get());
+  auto patch = BucketMetadataPatchBuilder().SetStorageClass("COLDLINE");
+  ASSERT_STATUS_OK(
+      client->PatchBucket(PatchBucketRequest("test-bucket", patch)));
+  EXPECT_EQ(2, get());
+  EXPECT_EQ(2, get());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
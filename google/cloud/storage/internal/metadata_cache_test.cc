@@ -0,0 +1,230 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/metadata_cache.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+/// A clock controlled by the test.
+struct FakeClock {
+  using duration = std::chrono::milliseconds;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = std::chrono::time_point<FakeClock, duration>;
+  static bool const is_steady = true;
+
+  static time_point now() { return current; }
+  static time_point current;
+};
+
+FakeClock::time_point FakeClock::current;
+
+using TestCache = MetadataCache<std::string, FakeClock>;
+
+TEST(MetadataCacheTest, HitsAndExpiration) {
+  TestCache cache(std::chrono::milliseconds(100), 10);
+  int calls = 0;
+  auto fetch = [&calls] {
+    return StatusOr<std::string>(std::to_string(++calls));
+  };
+
+  auto v = cache.Get("g", "k1", fetch);
+  ASSERT_STATUS_OK(v);
+  EXPECT_EQ("1", *v);
+  FakeClock::current += std::chrono::milliseconds(50);
+  v = cache.Get("g", "k1", fetch);
+  ASSERT_STATUS_OK(v);
+  EXPECT_EQ("1", *v);
+  v = cache.Get("g", "k2", fetch);
+  ASSERT_STATUS_OK(v);
+  EXPECT_EQ("2", *v);
+  EXPECT_EQ(2, cache.size());
+
+  FakeClock::current += std::chrono::milliseconds(60);
+  v = cache.Get("g", "k1", fetch);
+  ASSERT_STATUS_OK(v);
+  EXPECT_EQ("3", *v);
+
+  auto counters = cache.counters();
+  EXPECT_EQ(1, counters.hits);
+  EXPECT_EQ(3, counters.misses);
+  EXPECT_EQ(0, counters.coalesced);
+}
+
+TEST(MetadataCacheTest, ErrorsAreNotCached) {
+  TestCache cache(std::chrono::milliseconds(100), 10);
+  int calls = 0;
+  auto fetch = [&calls] {
+    ++calls;
+    return StatusOr<std::string>(Status(StatusCode::kUnavailable, "try-again"));
+  };
+  auto v = cache.Get("g", "k", fetch);
+  EXPECT_EQ(StatusCode::kUnavailable, v.status().code());
+  v = cache.Get("g", "k", fetch);
+  EXPECT_EQ(StatusCode::kUnavailable, v.status().code());
+  EXPECT_EQ(2, calls);
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST(MetadataCacheTest, Invalidate) {
+  TestCache cache(std::chrono::milliseconds(100), 10);
+  int calls = 0;
+  auto fetch = [&calls] {
+    return StatusOr<std::string>(std::to_string(++calls));
+  };
+
+  EXPECT_EQ("1", cache.Get("g1", "k", fetch).value());
+  EXPECT_EQ("2", cache.Get("g2", "k", fetch).value());
+  cache.Invalidate("g1");
+  EXPECT_EQ("3", cache.Get("g1", "k", fetch).value());
+  EXPECT_EQ("2", cache.Get("g2", "k", fetch).value());
+  EXPECT_EQ(1, cache.counters().invalidations);
+}
+
+TEST(MetadataCacheTest, MaxEntries) {
+  TestCache cache(std::chrono::milliseconds(100), 2);
+  int calls = 0;
+  auto fetch = [&calls] {
+    return StatusOr<std::string>(std::to_string(++calls));
+  };
+
+  EXPECT_EQ("1", cache.Get("g", "k1", fetch).value());
+  EXPECT_EQ("2", cache.Get("g", "k2", fetch).value());
+  // The cache is full, this result is not cached.
+  EXPECT_EQ("3", cache.Get("g", "k3", fetch).value());
+  EXPECT_EQ("4", cache.Get("g", "k3", fetch).value());
+  EXPECT_EQ(2, cache.size());
+
+  // Once the entries expire they are replaced.
+  FakeClock::current += std::chrono::milliseconds(200);
+  EXPECT_EQ("5", cache.Get("g", "k3", fetch).value());
+  EXPECT_EQ(1, cache.size());
+}
+
+TEST(MetadataCacheTest, SingleFlight) {
+  TestCache cache(std::chrono::milliseconds(100), 10);
+  std::promise<void> started;
+  std::promise<void> release;
+  auto release_future = release.get_future().share();
+  int calls = 0;
+  auto fetch = [&] {
+    ++calls;
+    started.set_value();
+    release_future.wait();
+    return StatusOr<std::string>("value");
+  };
+
+  auto leader = std::async(std::launch::async,
+                           [&] { return cache.Get("g", "k", fetch); });
+  started.get_future().wait();
+  int const kFollowerCount = 4;
+  std::vector<std::future<StatusOr<std::string>>> followers;
+  for (int i = 0; i != kFollowerCount; ++i) {
+    followers.push_back(std::async(std::launch::async,
+                                   [&] { return cache.Get("g", "k", fetch); }));
+  }
+  // Wait until all the followers are waiting for the leader.
+  while (cache.counters().coalesced != kFollowerCount) {
+    std::this_thread::yield();
+  }
+  release.set_value();
+
+  EXPECT_EQ("value", leader.get().value());
+  for (auto& f : followers) {
+    EXPECT_EQ("value", f.get().value());
+  }
+  EXPECT_EQ(1, calls);
+}
+
+TEST(MetadataCacheTest, InvalidateDuringFetch) {
+  TestCache cache(std::chrono::milliseconds(100), 10);
+  int calls = 0;
+  auto fetch = [&] {
+    if (++calls == 1) {
+      // Simulate a write completing while the first fetch is in flight.
+      cache.Invalidate("g");
+      return StatusOr<std::string>("stale");
+    }
+    return StatusOr<std::string>("fresh");
+  };
+  EXPECT_EQ("stale", cache.Get("g", "k", fetch).value());
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ("fresh", cache.Get("g", "k", fetch).value());
+  EXPECT_EQ("fresh", cache.Get("g", "k", fetch).value());
+  EXPECT_EQ(2, calls);
+}
+
+TEST(MetadataCacheTest, ErrorsRemoveGroups) {
+  TestCache cache(std::chrono::milliseconds(100), 10);
+  auto fetch = [] {
+    return StatusOr<std::string>(Status(StatusCode::kUnavailable, "try-again"));
+  };
+  for (auto const* group : {"g1", "g2", "g3"}) {
+    EXPECT_FALSE(cache.Get(group, "k", fetch));
+  }
+  EXPECT_EQ(0, cache.group_count());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+TEST(MetadataCacheTest, FetchThrows) {
+  TestCache cache(std::chrono::milliseconds(100), 10);
+  std::promise<void> started;
+  std::promise<void> release;
+  auto release_future = release.get_future().share();
+  auto failing = [&]() -> StatusOr<std::string> {
+    started.set_value();
+    release_future.wait();
+    throw std::runtime_error("fetch failed");
+  };
+
+  auto leader = std::async(std::launch::async,
+                           [&] { return cache.Get("g", "k", failing); });
+  started.get_future().wait();
+  auto follower = std::async(std::launch::async, [&] {
+    return cache.Get("g", "k", [] { return StatusOr<std::string>("unused"); });
+  });
+  while (cache.counters().coalesced != 1) {
+    std::this_thread::yield();
+  }
+  release.set_value();
+
+  // Both the leader and the follower get the exception.
+  EXPECT_THROW(leader.get(), std::runtime_error);
+  EXPECT_THROW(follower.get(), std::runtime_error);
+  EXPECT_EQ(0, cache.group_count());
+
+  // The next request contacts the service again.
+  EXPECT_EQ("fresh", cache.Get("g", "k", [] {
+                            return StatusOr<std::string>("fresh");
+                          }).value());
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -26,12 +26,15 @@ bool ParseBoolField(nl::json const& json, char const* field_name) {
   if (json.count(field_name) == 0) {
     return false;
   }
-  auto const& f = json[field_name];
-  if (f.is_boolean()) {
-    return f.get<bool>();
+  return ParseBoolValue(json[field_name], field_name);
+}
+
+bool ParseBoolValue(nl::json const& value, char const* field_name) {
+  if (value.is_boolean()) {
+    return value.get<bool>();
   }
-  if (f.is_string()) {
-    auto v = f.get<std::string>();
+  if (value.is_string()) {
+    auto v = value.get<std::string>();
     if (v == "true") {
       return true;
     }
@@ -41,7 +44,7 @@ bool ParseBoolField(nl::json const& json, char const* field_name) {
   }
   std::ostringstream os;
   os << "Error parsing field <" << field_name
-     << "> as a boolean, json=" << json;
+     << "> as a boolean, json=" << value;
   google::cloud::internal::ThrowInvalidArgument(os.str());
 }
 
@@ -49,16 +52,19 @@ std::int32_t ParseIntField(nl::json const& json, char const* field_name) {
   if (json.count(field_name) == 0) {
     return 0;
   }
-  auto const& f = json[field_name];
-  if (f.is_number()) {
-    return f.get<std::int32_t>();
+  return ParseIntValue(json[field_name], field_name);
+}
+
+std::int32_t ParseIntValue(nl::json const& value, char const* field_name) {
+  if (value.is_number()) {
+    return value.get<std::int32_t>();
   }
-  if (f.is_string()) {
-    return std::stol(f.get_ref<std::string const&>());
+  if (value.is_string()) {
+    return std::stol(value.get_ref<std::string const&>());
   }
   std::ostringstream os;
   os << "Error parsing field <" << field_name
-     << "> as an std::int32_t, json=" << json;
+     << "> as an std::int32_t, json=" << value;
   google::cloud::internal::ThrowInvalidArgument(os.str());
 }
 
@@ -67,16 +73,20 @@ std::uint32_t ParseUnsignedIntField(nl::json const& json,
   if (json.count(field_name) == 0) {
     return 0;
   }
-  auto const& f = json[field_name];
-  if (f.is_number()) {
-    return f.get<std::uint32_t>();
+  return ParseUnsignedIntValue(json[field_name], field_name);
+}
+
+std::uint32_t ParseUnsignedIntValue(nl::json const& value,
+                                    char const* field_name) {
+  if (value.is_number()) {
+    return value.get<std::uint32_t>();
   }
-  if (f.is_string()) {
-    return std::stoul(f.get_ref<std::string const&>());
+  if (value.is_string()) {
+    return std::stoul(value.get_ref<std::string const&>());
   }
   std::ostringstream os;
   os << "Error parsing field <" << field_name
-     << "> as an std::uint32_t, json=" << json;
+     << "> as an std::uint32_t, json=" << value;
   google::cloud::internal::ThrowInvalidArgument(os.str());
 }
 
@@ -84,16 +94,19 @@ std::int64_t ParseLongField(nl::json const& json, char const* field_name) {
   if (json.count(field_name) == 0) {
     return 0;
   }
-  auto const& f = json[field_name];
-  if (f.is_number()) {
-    return f.get<std::int64_t>();
+  return ParseLongValue(json[field_name], field_name);
+}
+
+std::int64_t ParseLongValue(nl::json const& value, char const* field_name) {
+  if (value.is_number()) {
+    return value.get<std::int64_t>();
   }
-  if (f.is_string()) {
-    return std::stoll(f.get_ref<std::string const&>());
+  if (value.is_string()) {
+    return std::stoll(value.get_ref<std::string const&>());
   }
   std::ostringstream os;
   os << "Error parsing field <" << field_name
-     << "> as an std::int64_t, json=" << json;
+     << "> as an std::int64_t, json=" << value;
   google::cloud::internal::ThrowInvalidArgument(os.str());
 }
 
@@ -102,16 +115,20 @@ std::uint64_t ParseUnsignedLongField(nl::json const& json,
   if (json.count(field_name) == 0) {
     return 0;
   }
-  auto const& f = json[field_name];
-  if (f.is_number()) {
-    return f.get<std::uint64_t>();
+  return ParseUnsignedLongValue(json[field_name], field_name);
+}
+
+std::uint64_t ParseUnsignedLongValue(nl::json const& value,
+                                     char const* field_name) {
+  if (value.is_number()) {
+    return value.get<std::uint64_t>();
   }
-  if (f.is_string()) {
-    return std::stoull(f.get_ref<std::string const&>());
+  if (value.is_string()) {
+    return std::stoull(value.get_ref<std::string const&>());
   }
   std::ostringstream os;
   os << "Error parsing field <" << field_name
-     << "> as an std::uint64_t, json=" << json;
+     << "> as an std::uint64_t, json=" << value;
   google::cloud::internal::ThrowInvalidArgument(os.str());
 }
 
@@ -120,7 +137,12 @@ std::chrono::system_clock::time_point ParseTimestampField(
   if (json.count(field_name) == 0) {
     return std::chrono::system_clock::time_point{};
   }
-  return google::cloud::internal::ParseRfc3339(json[field_name]);
+  return ParseTimestampValue(json[field_name]);
+}
+
+std::chrono::system_clock::time_point ParseTimestampValue(
+    nl::json const& value) {
+  return google::cloud::internal::ParseRfc3339(value);
 }
 
 }  // namespace internal
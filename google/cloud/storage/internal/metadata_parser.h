@@ -74,6 +74,26 @@ std::uint64_t ParseUnsignedLongField(nl::json const& json,
 std::chrono::system_clock::time_point ParseTimestampField(
     nl::json const& json, char const* field_name);
 
+//@{
+/**
+ * @name Parse the value of a field that is known to be present.
+ *
+ * These functions are used when the value of a field has already been
+ * extracted from its JSON object, for example, by a streaming parser. They
+ * accept the same representations as the `Parse*Field()` functions, and
+ * @p field_name is only used in error messages.
+ */
+bool ParseBoolValue(nl::json const& value, char const* field_name);
+std::int32_t ParseIntValue(nl::json const& value, char const* field_name);
+std::uint32_t ParseUnsignedIntValue(nl::json const& value,
+                                    char const* field_name);
+std::int64_t ParseLongValue(nl::json const& value, char const* field_name);
+std::uint64_t ParseUnsignedLongValue(nl::json const& value,
+                                     char const* field_name);
+std::chrono::system_clock::time_point ParseTimestampValue(
+    nl::json const& value);
+//@}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
@@ -0,0 +1,266 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/object_block_cache.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/log.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+ObjectBlockCache::ObjectBlockCache(std::size_t capacity,
+                                   std::string spill_directory,
+                                   std::size_t spill_capacity)
+    : capacity_(capacity),
+      spill_directory_(std::move(spill_directory)),
+      spill_capacity_(spill_directory_.empty() ? 0 : spill_capacity) {
+  if (spill_capacity_ != 0) {
+    auto rng = google::cloud::internal::MakeDefaultPRNG();
+    spill_prefix_ = spill_directory_ + "/gcs-block-cache-" +
+                    google::cloud::internal::Sample(
+                        rng, 16, "abcdefghijklmnopqrstuvwxyz") +
+                    "-";
+  }
+}
+
+ObjectBlockCache::~ObjectBlockCache() {
+  for (auto const& e : spill_) {
+    (void)std::remove(e.path.c_str());
+  }
+}
+
+ObjectBlockCache::Block ObjectBlockCache::Lookup(Key const& key) {
+  auto block = LookupOrLoad(key, [] { return StatusOr<Block>(Block{}); });
+  return block ? *std::move(block) : nullptr;
+}
+
+StatusOr<ObjectBlockCache::Block> ObjectBlockCache::LookupOrLoad(
+    Key const& key, std::function<StatusOr<Block>()> const& load) {
+  auto map_key = AsMapKey(key);
+  std::unique_lock<std::mutex> lk(mu_);
+  SpillWork work;
+  for (;;) {
+    auto loc = memory_map_.find(map_key);
+    if (loc != memory_map_.end()) {
+      ++counters_.hits;
+      memory_.splice(memory_.begin(), memory_, loc->second);
+      return loc->second->block;
+    }
+    auto spilling = spilling_.find(map_key);
+    if (spilling != spilling_.end()) {
+      // The block is still in memory, its spill file is removed once written.
+      ++counters_.hits;
+      auto block = spilling->second.block;
+      InsertLocked(std::move(map_key), block, work);
+      RunSpillWork(std::move(lk), std::move(work));
+      return block;
+    }
+    auto pending = loads_.find(map_key);
+    if (pending == loads_.end()) {
+      break;
+    }
+    ++counters_.coalesced;
+    auto load_state = pending->second;
+    cv_.wait(lk, [&load_state] { return load_state->done; });
+    // A `Lookup()` does not load missing blocks, try again in that case.
+    if (!load_state->result || *load_state->result) {
+      return load_state->result;
+    }
+  }
+
+  // This lookup loads the block, detach its spill file (if any) so it can be
+  // read without holding the lock.
+  auto load_state = std::make_shared<PendingLoad>();
+  loads_.emplace(map_key, load_state);
+  std::string path;
+  std::size_t size = 0;
+  auto spilled = spill_map_.find(map_key);
+  if (spilled != spill_map_.end()) {
+    path = spilled->second->path;
+    size = spilled->second->size;
+    spill_size_ -= size;
+    spill_.erase(spilled->second);
+    spill_map_.erase(spilled);
+  }
+  lk.unlock();
+
+  StatusOr<Block> result;
+  bool from_spill = false;
+  if (!path.empty()) {
+    std::string data(size, '\0');
+    std::ifstream is(path, std::ios::binary);
+    is.read(&data[0], data.size());
+    from_spill = is.gcount() == static_cast<std::streamsize>(data.size());
+    is.close();
+    (void)std::remove(path.c_str());
+    if (from_spill) {
+      result = std::make_shared<std::string const>(std::move(data));
+    } else {
+      GCP_LOG(WARNING) << __func__ << "() cannot read block cache file "
+                       << path;
+    }
+  }
+  if (!from_spill) {
+    result = load();
+  }
+
+  lk.lock();
+  if (from_spill) {
+    ++counters_.spill_hits;
+  } else {
+    ++counters_.misses;
+  }
+  load_state->done = true;
+  load_state->result = result;
+  loads_.erase(map_key);
+  cv_.notify_all();
+  if (result && *result) {
+    InsertLocked(std::move(map_key), *result, work);
+  }
+  RunSpillWork(std::move(lk), std::move(work));
+  return result;
+}
+
+void ObjectBlockCache::Insert(Key const& key, Block block) {
+  auto map_key = AsMapKey(key);
+  std::unique_lock<std::mutex> lk(mu_);
+  SpillWork work;
+  InsertLocked(std::move(map_key), std::move(block), work);
+  RunSpillWork(std::move(lk), std::move(work));
+}
+
+std::size_t ObjectBlockCache::size() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return size_;
+}
+
+BlockCacheCounters ObjectBlockCache::counters() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return counters_;
+}
+
+ObjectBlockCache::MapKey ObjectBlockCache::AsMapKey(Key const& key) {
+  return MapKey(key.bucket_name, key.object_name, key.generation, key.block);
+}
+
+void ObjectBlockCache::InsertLocked(MapKey key, Block block, SpillWork& work) {
+  // Any previous copy of the block is stale. The file for a block being
+  // spilled is removed once written, see `RunSpillWork()`.
+  spilling_.erase(key);
+  auto spilled = spill_map_.find(key);
+  if (spilled != spill_map_.end()) {
+    EraseSpillLocked(spilled->second, work);
+  }
+  auto loc = memory_map_.find(key);
+  if (loc != memory_map_.end()) {
+    size_ -= loc->second->block->size();
+    memory_.erase(loc->second);
+    memory_map_.erase(loc);
+  }
+  if (block->size() > capacity_) {
+    // Blocks larger than the cache would evict everything else, and then be
+    // evicted themselves.
+    return;
+  }
+  size_ += block->size();
+  memory_.push_front(MemoryEntry{key, std::move(block)});
+  memory_map_.emplace(std::move(key), memory_.begin());
+  while (size_ > capacity_) {
+    auto last = std::prev(memory_.end());
+    size_ -= last->block->size();
+    memory_map_.erase(last->key);
+    auto entry = std::move(*last);
+    memory_.erase(last);
+    if (entry.block->size() > spill_capacity_) {
+      ++counters_.evictions;
+      continue;
+    }
+    PendingSpill spill{std::move(entry.block),
+                       spill_prefix_ + std::to_string(++spill_file_count_)};
+    spilling_[entry.key] = spill;
+    work.writes.emplace_back(std::move(entry.key), std::move(spill));
+  }
+}
+
+void ObjectBlockCache::EraseSpillLocked(SpillList::iterator loc,
+                                        SpillWork& work) {
+  work.removes.push_back(std::move(loc->path));
+  spill_size_ -= loc->size;
+  spill_map_.erase(loc->key);
+  spill_.erase(loc);
+}
+
+void ObjectBlockCache::RunSpillWork(std::unique_lock<std::mutex> lk,
+                                    SpillWork work) {
+  if (work.writes.empty() && work.removes.empty()) {
+    return;
+  }
+  lk.unlock();
+  std::vector<bool> written;
+  for (auto const& w : work.writes) {
+    auto const& spill = w.second;
+    std::ofstream os(spill.path, std::ios::binary);
+    os.write(spill.block->data(), spill.block->size());
+    os.close();
+    if (!os) {
+      GCP_LOG(WARNING) << __func__ << "() cannot write block cache file "
+                       << spill.path;
+    }
+    written.push_back(static_cast<bool>(os));
+  }
+  if (!work.writes.empty()) {
+    lk.lock();
+    for (std::size_t i = 0; i != work.writes.size(); ++i) {
+      auto& key = work.writes[i].first;
+      auto& spill = work.writes[i].second;
+      auto loc = spilling_.find(key);
+      if (loc == spilling_.end() || loc->second.path != spill.path) {
+        // The block was used, or replaced, while it was written.
+        work.removes.push_back(std::move(spill.path));
+        continue;
+      }
+      spilling_.erase(loc);
+      if (!written[i]) {
+        ++counters_.evictions;
+        work.removes.push_back(std::move(spill.path));
+        continue;
+      }
+      auto const size = spill.block->size();
+      spill_size_ += size;
+      spill_.push_front(SpillEntry{key, std::move(spill.path), size});
+      spill_map_.emplace(std::move(key), spill_.begin());
+      while (spill_size_ > spill_capacity_) {
+        ++counters_.evictions;
+        EraseSpillLocked(std::prev(spill_.end()), work);
+      }
+    }
+    lk.unlock();
+  }
+  for (auto const& path : work.removes) {
+    (void)std::remove(path.c_str());
+  }
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,162 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_BLOCK_CACHE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_BLOCK_CACHE_H
+
+#include "google/cloud/status_or.h"
+#include "google/cloud/storage/block_cache_counters.h"
+#include "google/cloud/storage/version.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * An LRU cache for fixed-size blocks of immutable object data.
+ *
+ * The blocks are keyed by bucket, object, generation, and block number. Since
+ * each generation of an object is immutable, the blocks never need to be
+ * invalidated, they are simply dropped when the cache exceeds its memory
+ * bound. Optionally, evicted blocks are saved to files in a local directory
+ * (also bounded by size), and moved back to memory when they are needed
+ * again.
+ *
+ * The blocks are shared with the readers, so a block that is evicted while in
+ * use remains valid until the reader releases it.
+ *
+ * The spill files are read and written without holding the lock for the
+ * cache, and concurrent lookups for a missing block wait for a single
+ * download.
+ *
+ * This class is thread-safe.
+ */
+class ObjectBlockCache {
+ public:
+  struct Key {
+    std::string bucket_name;
+    std::string object_name;
+    std::int64_t generation;
+    std::int64_t block;
+  };
+  using Block = std::shared_ptr<std::string const>;
+
+  ObjectBlockCache(std::size_t capacity, std::string spill_directory,
+                   std::size_t spill_capacity);
+  ~ObjectBlockCache();
+
+  ObjectBlockCache(ObjectBlockCache const&) = delete;
+  ObjectBlockCache& operator=(ObjectBlockCache const&) = delete;
+
+  /// Returns the block for @p key, or `nullptr` (counted as a miss).
+  Block Lookup(Key const& key);
+
+  /**
+   * Returns the block for @p key, calling @p load to download it on a miss.
+   *
+   * Concurrent lookups for the same key wait for a single call to @p load, and
+   * share its result. The block returned by @p load is inserted in the cache,
+   * unless it is `nullptr`. @p load is called without holding any locks.
+   */
+  StatusOr<Block> LookupOrLoad(Key const& key,
+                               std::function<StatusOr<Block>()> const& load);
+
+  /// Adds (or replaces) the block for @p key.
+  void Insert(Key const& key, Block block);
+
+  /// The total size of the blocks currently in memory.
+  std::size_t size() const;
+
+  BlockCacheCounters counters() const;
+
+ private:
+  using MapKey =
+      std::tuple<std::string, std::string, std::int64_t, std::int64_t>;
+  struct MemoryEntry {
+    MapKey key;
+    Block block;
+  };
+  struct SpillEntry {
+    MapKey key;
+    std::string path;
+    std::size_t size;
+  };
+  /// A block evicted from memory, while it is written to the spill directory.
+  struct PendingSpill {
+    Block block;
+    std::string path;
+  };
+  /// A block being loaded, other lookups for the same key wait for it.
+  struct PendingLoad {
+    bool done = false;
+    StatusOr<Block> result;
+  };
+  /// The file operations deferred until `mu_` is released.
+  struct SpillWork {
+    std::vector<std::pair<MapKey, PendingSpill>> writes;
+    std::vector<std::string> removes;
+  };
+  using MemoryList = std::list<MemoryEntry>;
+  using SpillList = std::list<SpillEntry>;
+
+  static MapKey AsMapKey(Key const& key);
+
+  void InsertLocked(MapKey key, Block block, SpillWork& work);
+  void EraseSpillLocked(SpillList::iterator loc, SpillWork& work);
+  /// Runs @p work, releasing @p lk while the files are read or written.
+  void RunSpillWork(std::unique_lock<std::mutex> lk, SpillWork work);
+
+  std::size_t const capacity_;
+  std::string const spill_directory_;
+  std::size_t const spill_capacity_;
+  std::string spill_prefix_;
+
+  mutable std::mutex mu_;
+  // The front of each list is the most recently used entry.
+  MemoryList memory_;                                  // GUARDED_BY(mu_)
+  std::map<MapKey, MemoryList::iterator> memory_map_;  // GUARDED_BY(mu_)
+  std::size_t size_ = 0;                               // GUARDED_BY(mu_)
+  SpillList spill_;                                    // GUARDED_BY(mu_)
+  std::map<MapKey, SpillList::iterator> spill_map_;    // GUARDED_BY(mu_)
+  std::size_t spill_size_ = 0;                         // GUARDED_BY(mu_)
+  std::uint64_t spill_file_count_ = 0;                 // GUARDED_BY(mu_)
+  BlockCacheCounters counters_;                        // GUARDED_BY(mu_)
+
+  // The blocks evicted from memory, while they are written to the spill
+  // directory. They are still usable.
+  std::map<MapKey, PendingSpill> spilling_;  // GUARDED_BY(mu_)
+  // The blocks being loaded, `cv_` is notified when each load completes.
+  std::map<MapKey, std::shared_ptr<PendingLoad>> loads_;  // GUARDED_BY(mu_)
+  std::condition_variable cv_;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_BLOCK_CACHE_H
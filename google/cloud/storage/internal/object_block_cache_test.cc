@@ -0,0 +1,180 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/object_block_cache.h"
+#include "google/cloud/future.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+ObjectBlockCache::Key MakeKey(std::int64_t block) {
+  return ObjectBlockCache::Key{"test-bucket", "test-object", 42, block};
+}
+
+ObjectBlockCache::Block MakeBlock(std::string contents) {
+  return std::make_shared<std::string const>(std::move(contents));
+}
+
+TEST(ObjectBlockCacheTest, LookupAndEvict) {
+  ObjectBlockCache cache(10, std::string{}, 0);
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(0)));
+
+  cache.Insert(MakeKey(0), MakeBlock("0000"));
+  cache.Insert(MakeKey(1), MakeBlock("1111"));
+  EXPECT_EQ(8, cache.size());
+  auto block = cache.Lookup(MakeKey(0));
+  ASSERT_NE(nullptr, block);
+  EXPECT_EQ("0000", *block);
+
+  // Block 1 is the least recently used block, it should be evicted.
+  cache.Insert(MakeKey(2), MakeBlock("2222"));
+  EXPECT_EQ(8, cache.size());
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(1)));
+  EXPECT_NE(nullptr, cache.Lookup(MakeKey(0)));
+  EXPECT_NE(nullptr, cache.Lookup(MakeKey(2)));
+
+  // Different generations use different entries.
+  EXPECT_EQ(nullptr,
+            cache.Lookup(ObjectBlockCache::Key{"test-bucket", "test-object",
+                                               7, 0}));
+
+  auto counters = cache.counters();
+  EXPECT_EQ(3, counters.hits);
+  EXPECT_EQ(3, counters.misses);
+  EXPECT_EQ(0, counters.spill_hits);
+  EXPECT_EQ(1, counters.evictions);
+}
+
+TEST(ObjectBlockCacheTest, BlocksLargerThanCapacityAreNotCached) {
+  ObjectBlockCache cache(4, std::string{}, 0);
+  cache.Insert(MakeKey(0), MakeBlock("0123456789"));
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(0)));
+}
+
+TEST(ObjectBlockCacheTest, Spill) {
+  ObjectBlockCache cache(4, ::testing::TempDir(), 8);
+  cache.Insert(MakeKey(0), MakeBlock("0000"));
+  cache.Insert(MakeKey(1), MakeBlock("1111"));
+  cache.Insert(MakeKey(2), MakeBlock("2222"));
+  EXPECT_EQ(4, cache.size());
+
+  // Block 0 and 1 should be in the spill directory, reading block 0 moves it
+  // back to memory and spills block 2.
+  auto block = cache.Lookup(MakeKey(0));
+  ASSERT_NE(nullptr, block);
+  EXPECT_EQ("0000", *block);
+  block = cache.Lookup(MakeKey(2));
+  ASSERT_NE(nullptr, block);
+  EXPECT_EQ("2222", *block);
+  block = cache.Lookup(MakeKey(1));
+  ASSERT_NE(nullptr, block);
+  EXPECT_EQ("1111", *block);
+
+  auto counters = cache.counters();
+  EXPECT_EQ(0, counters.hits);
+  EXPECT_EQ(3, counters.spill_hits);
+  EXPECT_EQ(0, counters.misses);
+  EXPECT_EQ(0, counters.evictions);
+
+  // Exceed the spill capacity, the oldest spilled blocks are discarded.
+  cache.Insert(MakeKey(3), MakeBlock("3333"));
+  cache.Insert(MakeKey(4), MakeBlock("4444"));
+  cache.Insert(MakeKey(5), MakeBlock("5555"));
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(0)));
+  counters = cache.counters();
+  EXPECT_EQ(1, counters.misses);
+  EXPECT_EQ(3, counters.evictions);
+}
+
+TEST(ObjectBlockCacheTest, LookupOrLoad) {
+  ObjectBlockCache cache(10, std::string{}, 0);
+  int calls = 0;
+  auto load = [&calls] {
+    ++calls;
+    return StatusOr<ObjectBlockCache::Block>(MakeBlock("0000"));
+  };
+  auto block = cache.LookupOrLoad(MakeKey(0), load);
+  ASSERT_STATUS_OK(block);
+  EXPECT_EQ("0000", **block);
+  block = cache.LookupOrLoad(MakeKey(0), load);
+  ASSERT_STATUS_OK(block);
+  EXPECT_EQ("0000", **block);
+  EXPECT_EQ(1, calls);
+
+  auto counters = cache.counters();
+  EXPECT_EQ(1, counters.hits);
+  EXPECT_EQ(1, counters.misses);
+}
+
+TEST(ObjectBlockCacheTest, LookupOrLoadErrorIsNotCached) {
+  ObjectBlockCache cache(10, std::string{}, 0);
+  auto block = cache.LookupOrLoad(MakeKey(0), [] {
+    return StatusOr<ObjectBlockCache::Block>(
+        Status(StatusCode::kUnavailable, "try-again"));
+  });
+  EXPECT_EQ(StatusCode::kUnavailable, block.status().code());
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(0)));
+}
+
+TEST(ObjectBlockCacheTest, ConcurrentMissesLoadOnce) {
+  ObjectBlockCache cache(10, std::string{}, 0);
+  std::atomic<int> calls{0};
+  promise<void> loading;
+  promise<void> release;
+  auto load = [&] {
+    if (++calls == 1) {
+      loading.set_value();
+      release.get_future().get();
+    }
+    return StatusOr<ObjectBlockCache::Block>(MakeBlock("0000"));
+  };
+
+  auto lookup = [&] { return cache.LookupOrLoad(MakeKey(0), load); };
+  auto first = std::async(std::launch::async, lookup);
+  loading.get_future().get();
+  auto second = std::async(std::launch::async, lookup);
+  // Wait until the second lookup is waiting for the first download.
+  while (cache.counters().coalesced == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  release.set_value();
+
+  auto b1 = first.get();
+  auto b2 = second.get();
+  ASSERT_STATUS_OK(b1);
+  ASSERT_STATUS_OK(b2);
+  EXPECT_EQ(*b1, *b2);
+  EXPECT_EQ(1, calls.load());
+  auto counters = cache.counters();
+  EXPECT_EQ(1, counters.misses);
+  EXPECT_EQ(1, counters.coalesced);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,293 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/object_metadata_sax_parser.h"
+#include "google/cloud/storage/internal/nljson.h"
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+/**
+ * Receives the events from the nlohmann::json SAX parser.
+ *
+ * Scalar fields of each object are stored as soon as they are parsed. Nested
+ * fields, such as `acl` or `metadata`, are small; they are captured into a
+ * `nl::json` value and then stored. In both cases the values are stored using
+ * `ObjectMetadataParser::ParseField()`, so the results match the DOM parser.
+ * Fields that `ObjectMetadata` does not represent are skipped.
+ */
+class ObjectMetadataSaxHandler {
+ public:
+  explicit ObjectMetadataSaxHandler(bool list_response)
+      : list_response_(list_response) {}
+
+  Status const& status() const { return status_; }
+  ObjectMetadata& object() { return object_; }
+  ListObjectsResponse& response() { return response_; }
+
+  //@{
+  /// @name The SAX interface, see `nl::json::sax_parse()`.
+  bool null() { return Skip() || Value(nl::json(nullptr)); }
+  bool boolean(bool v) { return Skip() || Value(nl::json(v)); }
+  bool number_integer(nl::json::number_integer_t v) {
+    return Skip() || Value(nl::json(v));
+  }
+  bool number_unsigned(nl::json::number_unsigned_t v) {
+    return Skip() || Value(nl::json(v));
+  }
+  bool number_float(nl::json::number_float_t v, nl::json::string_t const&) {
+    return Skip() || Value(nl::json(v));
+  }
+  bool string(nl::json::string_t& v) {
+    return Skip() || Value(nl::json(std::move(v)));
+  }
+  template <typename Binary>
+  bool binary(Binary&) {
+    return Error();
+  }
+  bool start_object(std::size_t);
+  bool key(nl::json::string_t& k);
+  bool end_object() { return End(); }
+  bool start_array(std::size_t);
+  bool end_array() { return End(); }
+  template <typename Exception>
+  bool parse_error(std::size_t, std::string const&, Exception const&) {
+    return Error();
+  }
+  //@}
+
+ private:
+  enum class Frame { kResponse, kItems, kPrefixes, kObject, kCapture, kSkip };
+
+  bool Skip() const;
+  bool Value(nl::json value);
+  bool End();
+  void StartCapture(nl::json value);
+  nl::json* AddCaptured(nl::json value);
+  bool Error(Status status = Status(StatusCode::kInvalidArgument,
+                                    "malformed object metadata")) {
+    if (status_.ok()) {
+      status_ = std::move(status);
+    }
+    return false;
+  }
+
+  bool const list_response_;
+  Status status_;
+  std::vector<Frame> frames_;
+  // The last key seen in a `kResponse` or `kObject` frame, and whether its
+  // value is ignored.
+  std::string key_;
+  bool skip_value_ = false;
+  // The field value being captured, and the path to its innermost container.
+  nl::json captured_;
+  std::vector<nl::json*> capture_stack_;
+  nl::json* capture_element_ = nullptr;
+
+  ObjectMetadata object_;
+  ListObjectsResponse response_;
+};
+
+bool ObjectMetadataSaxHandler::Skip() const {
+  if (frames_.empty()) {
+    return false;
+  }
+  switch (frames_.back()) {
+    case Frame::kSkip:
+      return true;
+    case Frame::kResponse:
+    case Frame::kObject:
+      return skip_value_;
+    default:
+      return false;
+  }
+}
+
+bool ObjectMetadataSaxHandler::Value(nl::json value) {
+  if (frames_.empty()) {
+    return Error();
+  }
+  switch (frames_.back()) {
+    case Frame::kResponse:
+      if (key_ == "nextPageToken" && value.is_string()) {
+        response_.next_page_token = value.get<std::string>();
+        return true;
+      }
+      // Treat `"items": null` and `"prefixes": null` as empty arrays.
+      if (key_ != "nextPageToken" && value.is_null()) {
+        return true;
+      }
+      return Error();
+    case Frame::kPrefixes:
+      if (!value.is_string()) {
+        return Error();
+      }
+      response_.prefixes.emplace_back(value.get<std::string>());
+      return true;
+    case Frame::kObject: {
+      auto status = ObjectMetadataParser::ParseField(object_, key_, value);
+      return status.ok() ? true : Error(std::move(status));
+    }
+    case Frame::kCapture:
+      AddCaptured(std::move(value));
+      return true;
+    case Frame::kItems:
+      return Error();
+    case Frame::kSkip:
+      return true;
+  }
+  return Error();
+}
+
+bool ObjectMetadataSaxHandler::start_object(std::size_t) {
+  if (frames_.empty()) {
+    frames_.push_back(list_response_ ? Frame::kResponse : Frame::kObject);
+    return true;
+  }
+  if (Skip()) {
+    frames_.push_back(Frame::kSkip);
+    return true;
+  }
+  switch (frames_.back()) {
+    case Frame::kItems:
+      object_ = ObjectMetadata{};
+      frames_.push_back(Frame::kObject);
+      return true;
+    case Frame::kObject:
+    case Frame::kCapture:
+      StartCapture(nl::json::object());
+      return true;
+    default:
+      return Error();
+  }
+}
+
+bool ObjectMetadataSaxHandler::key(nl::json::string_t& k) {
+  switch (frames_.back()) {
+    case Frame::kResponse:
+      key_ = k;
+      skip_value_ = key_ != "items" && key_ != "nextPageToken" &&
+                    key_ != "prefixes";
+      break;
+    case Frame::kObject:
+      key_ = k;
+      skip_value_ = !ObjectMetadataParser::IsKnownField(key_);
+      break;
+    case Frame::kCapture:
+      capture_element_ = &(*capture_stack_.back())[k];
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+bool ObjectMetadataSaxHandler::start_array(std::size_t) {
+  if (frames_.empty()) {
+    return Error();
+  }
+  if (Skip()) {
+    frames_.push_back(Frame::kSkip);
+    return true;
+  }
+  switch (frames_.back()) {
+    case Frame::kResponse:
+      if (key_ == "items") {
+        frames_.push_back(Frame::kItems);
+        return true;
+      }
+      if (key_ == "prefixes") {
+        frames_.push_back(Frame::kPrefixes);
+        return true;
+      }
+      return Error();
+    case Frame::kObject:
+    case Frame::kCapture:
+      StartCapture(nl::json::array());
+      return true;
+    default:
+      return Error();
+  }
+}
+
+bool ObjectMetadataSaxHandler::End() {
+  auto const frame = frames_.back();
+  frames_.pop_back();
+  if (frame == Frame::kObject && list_response_) {
+    response_.items.push_back(std::move(object_));
+    return true;
+  }
+  if (frame != Frame::kCapture) {
+    return true;
+  }
+  capture_stack_.pop_back();
+  if (!capture_stack_.empty()) {
+    return true;
+  }
+  auto status = ObjectMetadataParser::ParseField(object_, key_, captured_);
+  return status.ok() ? true : Error(std::move(status));
+}
+
+void ObjectMetadataSaxHandler::StartCapture(nl::json value) {
+  frames_.push_back(Frame::kCapture);
+  if (capture_stack_.empty()) {
+    captured_ = std::move(value);
+    capture_stack_.push_back(&captured_);
+    return;
+  }
+  capture_stack_.push_back(AddCaptured(std::move(value)));
+}
+
+nl::json* ObjectMetadataSaxHandler::AddCaptured(nl::json value) {
+  auto& parent = *capture_stack_.back();
+  if (parent.is_array()) {
+    parent.push_back(std::move(value));
+    return &parent.back();
+  }
+  *capture_element_ = std::move(value);
+  return capture_element_;
+}
+
+}  // namespace
+
+StatusOr<ObjectMetadata> ParseObjectMetadataSax(std::string const& payload) {
+  ObjectMetadataSaxHandler handler(/*list_response=*/false);
+  if (!nl::json::sax_parse(payload, &handler)) {
+    return handler.status().ok()
+               ? Status(StatusCode::kInvalidArgument, __func__)
+               : handler.status();
+  }
+  return std::move(handler.object());
+}
+
+StatusOr<ListObjectsResponse> ParseListObjectsResponseSax(
+    std::string const& payload) {
+  ObjectMetadataSaxHandler handler(/*list_response=*/true);
+  if (!nl::json::sax_parse(payload, &handler)) {
+    return handler.status().ok()
+               ? Status(StatusCode::kInvalidArgument, __func__)
+               : handler.status();
+  }
+  return std::move(handler.response());
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
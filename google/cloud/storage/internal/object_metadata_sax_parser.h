@@ -0,0 +1,53 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_METADATA_SAX_PARSER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_METADATA_SAX_PARSER_H
+
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/object_metadata.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Parses an object resource without building a JSON DOM.
+ *
+ * The fields are stored in the result as the parser reaches them, fields that
+ * `ObjectMetadata` does not represent are skipped. The result is the same as
+ * `ObjectMetadataParser::FromJson(nl::json::parse(payload))`.
+ */
+StatusOr<ObjectMetadata> ParseObjectMetadataSax(std::string const& payload);
+
+/**
+ * Parses an `Objects: list` response without building a JSON DOM.
+ *
+ * The result is the same as
+ * `ListObjectsResponse::FromJson(nl::json::parse(payload))`.
+ */
+StatusOr<ListObjectsResponse> ParseListObjectsResponseSax(
+    std::string const& payload);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_METADATA_SAX_PARSER_H
@@ -0,0 +1,185 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/object_metadata_sax_parser.h"
+#include "google/cloud/storage/internal/nljson.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+// This object resource has some impossible combination of fields in it. The
+// goal is to test all the fields, including some the parser must skip.
+char const kFullObject[] = R"""({
+      "acl": [{
+        "kind": "storage#objectAccessControl",
+        "id": "acl-id-0",
+        "bucket": "foo-bar",
+        "object": "baz",
+        "generation": 12345,
+        "entity": "user-qux",
+        "role": "OWNER",
+        "email": "qux@example.com",
+        "projectTeam": {
+          "projectNumber": "4567",
+          "team": "owners"
+        },
+        "etag": "AYX="
+      }],
+      "bucket": "foo-bar",
+      "cacheControl": "no-cache",
+      "componentCount": 7,
+      "contentDisposition": "a-disposition",
+      "contentEncoding": "an-encoding",
+      "contentLanguage": "a-language",
+      "contentType": "application/octet-stream",
+      "crc32c": "deadbeef",
+      "customerEncryption": {
+        "encryptionAlgorithm": "some-algo",
+        "keySha256": "abc123"
+      },
+      "etag": "XYZ=",
+      "eventBasedHold": true,
+      "generation": "12345",
+      "id": "foo-bar/baz/12345",
+      "kind": "storage#object",
+      "kmsKeyName": "/foo/bar/baz/key",
+      "md5Hash": "deaderBeef=",
+      "mediaLink": "https://storage.googleapis.com/download/v1/b/foo-bar/o/baz",
+      "metadata": {
+        "foo": "bar",
+        "baz": "qux"
+      },
+      "metageneration": "4",
+      "name": "baz",
+      "owner": {
+        "entity": "user-qux",
+        "entityId": "user-qux-id-123"
+      },
+      "retentionExpirationTime": "2019-01-01T00:00:00Z",
+      "selfLink": "https://storage.googleapis.com/storage/v1/b/foo-bar/o/baz",
+      "size": 102400,
+      "storageClass": "STANDARD",
+      "temporaryHold": "true",
+      "timeCreated": "2018-05-19T19:31:14Z",
+      "timeDeleted": "2018-05-19T19:32:24Z",
+      "timeStorageClassUpdated": "2018-05-19T19:31:34Z",
+      "updated": "2018-05-19T19:31:24Z",
+      "unknownScalar": 1.5,
+      "unknownObject": {"a": [1, 2, {"b": null}], "c": {}},
+      "unknownArray": [[], [{}], "x"]
+})""";
+
+std::string ToString(ObjectMetadata const& m) {
+  std::ostringstream os;
+  os << m;
+  return os.str();
+}
+
+/// @test Verify the streaming and DOM parsers produce the same object.
+TEST(ObjectMetadataSaxParserTest, ObjectMatchesDom) {
+  auto expected = ObjectMetadataParser::FromJson(nl::json::parse(kFullObject));
+  ASSERT_STATUS_OK(expected);
+  auto actual = ParseObjectMetadataSax(kFullObject);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(*expected, *actual);
+  EXPECT_EQ(ToString(*expected), ToString(*actual));
+
+  EXPECT_EQ(1, actual->acl().size());
+  EXPECT_EQ("user-qux", actual->acl().at(0).entity());
+  EXPECT_EQ(7, actual->component_count());
+  EXPECT_EQ("some-algo", actual->customer_encryption().encryption_algorithm);
+  EXPECT_EQ(12345, actual->generation());
+  EXPECT_EQ(4, actual->metageneration());
+  EXPECT_EQ(2, actual->metadata().size());
+  EXPECT_EQ("user-qux-id-123", actual->owner().entity_id);
+  EXPECT_EQ(102400, actual->size());
+  EXPECT_TRUE(actual->temporary_hold());
+}
+
+/// @test Verify the streaming and DOM parsers produce the same list.
+TEST(ObjectMetadataSaxParserTest, ListMatchesDom) {
+  std::string const text = std::string(R"""({
+      "kind": "storage#objects",
+      "nextPageToken": "some-token-42",
+      "unknown": {"items": [1, 2, 3], "prefixes": [{}]},
+      "prefixes": ["dir-1/", "dir-2/"],
+      "items": [)""") + kFullObject +
+                           R"""(, {"name": "foo", "size": "7"}, {}]
+})""";
+  auto expected = ListObjectsResponse::FromJson(nl::json::parse(text));
+  ASSERT_STATUS_OK(expected);
+  auto actual = ParseListObjectsResponseSax(text);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ("some-token-42", actual->next_page_token);
+  EXPECT_EQ(expected->prefixes, actual->prefixes);
+  EXPECT_EQ(expected->items, actual->items);
+  ASSERT_EQ(3, actual->items.size());
+  EXPECT_EQ("baz", actual->items[0].name());
+  EXPECT_EQ("foo", actual->items[1].name());
+  EXPECT_EQ(7, actual->items[1].size());
+  EXPECT_EQ("", actual->items[2].name());
+}
+
+/// @test Verify the streaming parser handles missing and null fields.
+TEST(ObjectMetadataSaxParserTest, ListEmpty) {
+  auto actual = ParseListObjectsResponseSax(R"""({"items": null})""");
+  ASSERT_STATUS_OK(actual);
+  EXPECT_TRUE(actual->next_page_token.empty());
+  EXPECT_TRUE(actual->items.empty());
+  EXPECT_TRUE(actual->prefixes.empty());
+}
+
+/// @test Verify the streaming parser reports malformed payloads.
+TEST(ObjectMetadataSaxParserTest, Errors) {
+  for (auto const* text : {
+           "{123",
+           "[]",
+           "\"not-an-object\"",
+           R"""({"name": "foo"} trailing)""",
+       }) {
+    SCOPED_TRACE(text);
+    EXPECT_EQ(StatusCode::kInvalidArgument,
+              ParseObjectMetadataSax(text).status().code());
+  }
+
+  for (auto const* text : {
+           "{123",
+           "[]",
+           R"""({"items": ["not-an-object"]})""",
+           R"""({"items": [[]]})""",
+           R"""({"items": {}})""",
+           R"""({"prefixes": [1]})""",
+           R"""({"prefixes": "dir/"})""",
+           R"""({"nextPageToken": 7})""",
+           R"""({"nextPageToken": {}})""",
+       }) {
+    SCOPED_TRACE(text);
+    EXPECT_EQ(StatusCode::kInvalidArgument,
+              ParseListObjectsResponseSax(text).status().code());
+  }
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
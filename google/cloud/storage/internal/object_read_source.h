@@ -17,7 +17,9 @@
 
 #include "google/cloud/status_or.h"
 #include "google/cloud/storage/internal/http_response.h"
+#include "google/cloud/storage/read_copy_counters.h"
 #include "google/cloud/storage/version.h"
+#include <cstdint>
 #include <string>
 
 namespace google {
@@ -69,6 +71,18 @@ class ObjectReadSource {
   /// Read more data from the download, returning any HTTP headers and error
   /// codes.
   virtual StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) = 0;
+
+  /// The copies performed by this source, used in benchmarks and tests.
+  virtual ReadCopyCounters copy_counters() const { return {}; }
+
+  /**
+   * Stops the download, can be called from any thread.
+   *
+   * A `Read()` blocked in another thread returns a `kCancelled` error. Sources
+   * that cannot be interrupted ignore this call, their `Read()` calls complete
+   * as usual.
+   */
+  virtual void Cancel() {}
 };
 
 /**
@@ -17,7 +17,10 @@
 #include "google/cloud/storage/internal/metadata_parser.h"
 #include "google/cloud/storage/internal/nljson.h"
 #include "google/cloud/storage/internal/object_acl_requests.h"
+#include "google/cloud/storage/internal/object_metadata_sax_parser.h"
 #include "google/cloud/storage/object_metadata.h"
+#include <algorithm>
+#include <set>
 #include <sstream>
 
 namespace google {
@@ -47,60 +50,120 @@ StatusOr<ObjectMetadata> ObjectMetadataParser::FromJson(
     return Status(StatusCode::kInvalidArgument, __func__);
   }
   ObjectMetadata result{};
-  auto status = CommonMetadata<ObjectMetadata>::ParseFromJson(result, json);
-  if (!status.ok()) {
-    return status;
+  for (auto const& kv : json.items()) {
+    auto status = ParseField(result, kv.key(), kv.value());
+    if (!status.ok()) {
+      return status;
+    }
   }
+  return result;
+}
 
-  if (json.count("acl") != 0) {
-    for (auto const& kv : json["acl"].items()) {
+StatusOr<ObjectMetadata> ObjectMetadataParser::FromString(
+    std::string const& payload) {
+  return ParseObjectMetadataSax(payload);
+}
+
+bool ObjectMetadataParser::IsKnownField(std::string const& key) {
+  // Keep in sync with ParseField() and CommonMetadata::ParseField().
+  static std::set<std::string> const kFields{
+      "acl",
+      "bucket",
+      "cacheControl",
+      "componentCount",
+      "contentDisposition",
+      "contentEncoding",
+      "contentLanguage",
+      "contentType",
+      "crc32c",
+      "customerEncryption",
+      "etag",
+      "eventBasedHold",
+      "generation",
+      "id",
+      "kind",
+      "kmsKeyName",
+      "md5Hash",
+      "mediaLink",
+      "metadata",
+      "metageneration",
+      "name",
+      "owner",
+      "retentionExpirationTime",
+      "selfLink",
+      "size",
+      "storageClass",
+      "temporaryHold",
+      "timeCreated",
+      "timeDeleted",
+      "timeStorageClassUpdated",
+      "updated",
+  };
+  return kFields.count(key) != 0;
+}
+
+Status ObjectMetadataParser::ParseField(ObjectMetadata& result,
+                                        std::string const& key,
+                                        internal::nl::json const& value) {
+  if (CommonMetadata<ObjectMetadata>::ParseField(result, key, value)) {
+    return Status();
+  }
+  if (key == "acl") {
+    for (auto const& kv : value.items()) {
       auto parsed = ObjectAccessControlParser::FromJson(kv.value());
       if (!parsed.ok()) {
         return std::move(parsed).status();
       }
       result.acl_.emplace_back(std::move(*parsed));
     }
-  }
-
-  result.bucket_ = json.value("bucket", "");
-  result.cache_control_ = json.value("cacheControl", "");
-  result.component_count_ = internal::ParseIntField(json, "componentCount");
-  result.content_disposition_ = json.value("contentDisposition", "");
-  result.content_encoding_ = json.value("contentEncoding", "");
-  result.content_language_ = json.value("contentLanguage", "");
-  result.content_type_ = json.value("contentType", "");
-  result.crc32c_ = json.value("crc32c", "");
-  if (json.count("customerEncryption") != 0) {
-    auto field = json["customerEncryption"];
+  } else if (key == "bucket") {
+    result.bucket_ = value.get<std::string>();
+  } else if (key == "cacheControl") {
+    result.cache_control_ = value.get<std::string>();
+  } else if (key == "componentCount") {
+    result.component_count_ = internal::ParseIntValue(value, "componentCount");
+  } else if (key == "contentDisposition") {
+    result.content_disposition_ = value.get<std::string>();
+  } else if (key == "contentEncoding") {
+    result.content_encoding_ = value.get<std::string>();
+  } else if (key == "contentLanguage") {
+    result.content_language_ = value.get<std::string>();
+  } else if (key == "contentType") {
+    result.content_type_ = value.get<std::string>();
+  } else if (key == "crc32c") {
+    result.crc32c_ = value.get<std::string>();
+  } else if (key == "customerEncryption") {
     CustomerEncryption e;
-    e.encryption_algorithm = field.value("encryptionAlgorithm", "");
-    e.key_sha256 = field.value("keySha256", "");
+    e.encryption_algorithm = value.value("encryptionAlgorithm", "");
+    e.key_sha256 = value.value("keySha256", "");
     result.customer_encryption_ = std::move(e);
-  }
-  result.event_based_hold_ = internal::ParseBoolField(json, "eventBasedHold");
-  result.generation_ = internal::ParseLongField(json, "generation");
-  result.kms_key_name_ = json.value("kmsKeyName", "");
-  result.md5_hash_ = json.value("md5Hash", "");
-  result.media_link_ = json.value("mediaLink", "");
-  if (json.count("metadata") > 0) {
-    for (auto const& kv : json["metadata"].items()) {
+  } else if (key == "eventBasedHold") {
+    result.event_based_hold_ =
+        internal::ParseBoolValue(value, "eventBasedHold");
+  } else if (key == "generation") {
+    result.generation_ = internal::ParseLongValue(value, "generation");
+  } else if (key == "kmsKeyName") {
+    result.kms_key_name_ = value.get<std::string>();
+  } else if (key == "md5Hash") {
+    result.md5_hash_ = value.get<std::string>();
+  } else if (key == "mediaLink") {
+    result.media_link_ = value.get<std::string>();
+  } else if (key == "metadata") {
+    for (auto const& kv : value.items()) {
       result.metadata_.emplace(kv.key(), kv.value().get<std::string>());
     }
+  } else if (key == "retentionExpirationTime") {
+    result.retention_expiration_time_ = internal::ParseTimestampValue(value);
+  } else if (key == "size") {
+    result.size_ = internal::ParseUnsignedLongValue(value, "size");
+  } else if (key == "temporaryHold") {
+    result.temporary_hold_ = internal::ParseBoolValue(value, "temporaryHold");
+  } else if (key == "timeDeleted") {
+    result.time_deleted_ = internal::ParseTimestampValue(value);
+  } else if (key == "timeStorageClassUpdated") {
+    result.time_storage_class_updated_ = internal::ParseTimestampValue(value);
   }
-  result.retention_expiration_time_ =
-      internal::ParseTimestampField(json, "retentionExpirationTime");
-  result.size_ = internal::ParseUnsignedLongField(json, "size");
-  result.temporary_hold_ = internal::ParseBoolField(json, "temporaryHold");
-  result.time_deleted_ = internal::ParseTimestampField(json, "timeDeleted");
-  result.time_storage_class_updated_ =
-      internal::ParseTimestampField(json, "timeStorageClassUpdated");
-  return result;
-}
-
-StatusOr<ObjectMetadata> ObjectMetadataParser::FromString(
-    std::string const& payload) {
-  auto json = internal::nl::json::parse(payload, nullptr, false);
-  return FromJson(json);
+  return Status();
 }
 
 internal::nl::json ObjectMetadataJsonForCompose(ObjectMetadata const& meta) {
@@ -195,7 +258,11 @@ std::ostream& operator<<(std::ostream& os, ListObjectsRequest const& r) {
 
 StatusOr<ListObjectsResponse> ListObjectsResponse::FromHttpResponse(
     std::string const& payload) {
-  auto json = storage::internal::nl::json::parse(payload, nullptr, false);
+  return ParseListObjectsResponseSax(payload);
+}
+
+StatusOr<ListObjectsResponse> ListObjectsResponse::FromJson(
+    internal::nl::json const& json) {
   if (!json.is_object()) {
     return Status(StatusCode::kInvalidArgument, __func__);
   }
@@ -203,12 +270,23 @@ StatusOr<ListObjectsResponse> ListObjectsResponse::FromHttpResponse(
   ListObjectsResponse result;
   result.next_page_token = json.value("nextPageToken", "");
 
-  for (auto const& kv : json["items"].items()) {
-    auto parsed = internal::ObjectMetadataParser::FromJson(kv.value());
-    if (!parsed.ok()) {
-      return std::move(parsed).status();
+  if (json.count("items") != 0) {
+    for (auto const& kv : json["items"].items()) {
+      auto parsed = internal::ObjectMetadataParser::FromJson(kv.value());
+      if (!parsed.ok()) {
+        return std::move(parsed).status();
+      }
+      result.items.emplace_back(std::move(*parsed));
+    }
+  }
+
+  if (json.count("prefixes") != 0) {
+    for (auto const& kv : json["prefixes"].items()) {
+      if (!kv.value().is_string()) {
+        return Status(StatusCode::kInvalidArgument, __func__);
+      }
+      result.prefixes.emplace_back(kv.value().get<std::string>());
     }
-    result.items.emplace_back(std::move(*parsed));
   }
 
   return result;
@@ -219,6 +297,9 @@ std::ostream& operator<<(std::ostream& os, ListObjectsResponse const& r) {
      << ", items={";
   std::copy(r.items.begin(), r.items.end(),
             std::ostream_iterator<ObjectMetadata>(os, "\n  "));
+  os << "}, prefixes={";
+  std::copy(r.prefixes.begin(), r.prefixes.end(),
+            std::ostream_iterator<std::string>(os, ", "));
   return os << "}}";
 }
 
@@ -233,12 +314,15 @@ std::ostream& operator<<(std::ostream& os, InsertObjectMediaRequest const& r) {
   os << "InsertObjectMediaRequest={bucket_name=" << r.bucket_name()
      << ", object_name=" << r.object_name();
   r.DumpOptions(os, ", ");
-  if (r.contents().size() > 1024) {
+  auto const contents = r.contents_view();
+  if (!r.contents_file().empty()) {
+    os << ", contents_file=" << r.contents_file();
+  } else if (contents.size() > 1024) {
     os << ", contents[0..1024]=\n"
-       << BinaryDataAsDebugString(r.contents().data(), 1024);
+       << BinaryDataAsDebugString(contents.data(), 1024);
   } else {
     os << ", contents=\n"
-       << BinaryDataAsDebugString(r.contents().data(), r.contents().size());
+       << BinaryDataAsDebugString(contents.data(), contents.size());
   }
   return os << "}";
 }
@@ -564,10 +648,20 @@ std::ostream& operator<<(std::ostream& os, ResumableUploadRequest const& r) {
   return os << "}";
 }
 
+ConstBufferSequence UploadChunkRequest::payload_buffers() const {
+  if (has_payload_buffers()) {
+    return payload_buffers_;
+  }
+  if (payload_.empty()) {
+    return {};
+  }
+  return {ConstBuffer(payload_.data(), payload_.size())};
+}
+
 std::string UploadChunkRequest::RangeHeader() const {
   std::ostringstream os;
   os << "Content-Range: bytes ";
-  if (payload().empty()) {
+  if (payload_size() == 0) {
     // This typically happens when the sender realizes too late that the
     // previous chunk was really the last chunk (e.g. the file is exactly a
     // multiple of the quantum, reading the last chunk from a file, or sending
@@ -575,7 +669,7 @@ std::string UploadChunkRequest::RangeHeader() const {
     // the range is special in this case.
     os << "*";
   } else {
-    os << range_begin() << "-" << range_begin() + payload().size() - 1;
+    os << range_begin() << "-" << range_end();
   }
   if (!last_chunk_) {
     os << "/*";
@@ -589,9 +683,19 @@ std::ostream& operator<<(std::ostream& os, UploadChunkRequest const& r) {
   os << "UploadChunkRequest={upload_session_url=" << r.upload_session_url()
      << ", range=<" << r.RangeHeader() << ">";
   r.DumpOptions(os, ", ");
+  // Only the first bytes are printed, avoid copying the complete payload.
+  std::size_t constexpr kMaxOutputBytes = 128;
+  std::string prefix;
+  for (auto const& b : r.payload_buffers()) {
+    if (prefix.size() >= kMaxOutputBytes) {
+      break;
+    }
+    prefix.append(b.data(),
+                  (std::min)(b.size(), kMaxOutputBytes - prefix.size()));
+  }
   return os << ", payload="
-            << BinaryDataAsDebugString(r.payload().data(), r.payload().size(),
-                                       128)
+            << BinaryDataAsDebugString(prefix.data(), prefix.size(),
+                                       kMaxOutputBytes)
             << "}";
 }
 
@@ -17,6 +17,7 @@
 
 #include "google/cloud/storage/download_options.h"
 #include "google/cloud/storage/hashing_options.h"
+#include "google/cloud/storage/internal/const_buffer.h"
 #include "google/cloud/storage/internal/generic_object_request.h"
 #include "google/cloud/storage/internal/http_response.h"
 #include "google/cloud/storage/object_metadata.h"
@@ -32,6 +33,18 @@ namespace internal {
 struct ObjectMetadataParser {
   static StatusOr<ObjectMetadata> FromJson(internal::nl::json const& json);
   static StatusOr<ObjectMetadata> FromString(std::string const& payload);
+
+  /// Returns true if @p key is a field of the object resource we parse.
+  static bool IsKnownField(std::string const& key);
+
+  /**
+   * Parses a single field of the object resource from its JSON @p value.
+   *
+   * Both `FromJson()` and the streaming parser use this function, so they
+   * always produce the same results. Unknown fields are ignored.
+   */
+  static Status ParseField(ObjectMetadata& result, std::string const& key,
+                           internal::nl::json const& value);
 };
 
 //@{
@@ -76,11 +89,14 @@ class ListObjectsRequest
 std::ostream& operator<<(std::ostream& os, ListObjectsRequest const& r);
 
 struct ListObjectsResponse {
+  /// Parses the response without building a JSON DOM for the full payload.
   static StatusOr<ListObjectsResponse> FromHttpResponse(
       std::string const& payload);
+  static StatusOr<ListObjectsResponse> FromJson(internal::nl::json const& json);
 
   std::string next_page_token;
   std::vector<ObjectMetadata> items;
+  std::vector<std::string> prefixes;
 };
 
 std::ostream& operator<<(std::ostream& os, ListObjectsResponse const& r);
@@ -130,8 +146,47 @@ class InsertObjectMediaRequest
     return *this;
   }
 
+  /**
+   * A non-owning reference to the object contents.
+   *
+   * When set, the contents are sent directly from this buffer, and
+   * `contents()` is ignored. The application must keep the buffer valid until
+   * the request completes.
+   */
+  bool has_contents_view() const { return has_contents_view_; }
+  InsertObjectMediaRequest& set_contents_view(char const* data,
+                                              std::size_t size) {
+    contents_view_ = ConstBuffer(data, size);
+    has_contents_view_ = true;
+    return *this;
+  }
+
+  /// The object contents, either the view or a reference to `contents()`.
+  ConstBuffer contents_view() const {
+    if (has_contents_view_) {
+      return contents_view_;
+    }
+    return ConstBuffer(contents_.data(), contents_.size());
+  }
+
+  /**
+   * The name of a file with the object contents.
+   *
+   * When set, the contents are streamed from this file, and `contents()` is
+   * ignored. Each attempt reads the file to compute the hashes sent with the
+   * request, and then streams it, without loading the full file into memory.
+   */
+  std::string const& contents_file() const { return contents_file_; }
+  InsertObjectMediaRequest& set_contents_file(std::string v) {
+    contents_file_ = std::move(v);
+    return *this;
+  }
+
  private:
   std::string contents_;
+  ConstBuffer contents_view_{nullptr, 0};
+  bool has_contents_view_ = false;
+  std::string contents_file_;
 };
 
 std::ostream& operator<<(std::ostream& os, InsertObjectMediaRequest const& r);
@@ -394,12 +449,48 @@ class UploadChunkRequest : public GenericRequest<UploadChunkRequest> {
         source_size_(source_size),
         last_chunk_(true) {}
 
+  /**
+   * Creates a request to upload a chunk stored in several buffers.
+   *
+   * The request does not copy the buffers, they must remain valid until the
+   * request completes.
+   */
+  UploadChunkRequest(std::string upload_session_url, std::uint64_t range_begin,
+                     ConstBufferSequence payload)
+      : GenericRequest(),
+        upload_session_url_(std::move(upload_session_url)),
+        range_begin_(range_begin),
+        payload_buffers_(std::move(payload)),
+        source_size_(0),
+        last_chunk_(false) {}
+  UploadChunkRequest(std::string upload_session_url, std::uint64_t range_begin,
+                     ConstBufferSequence payload, std::uint64_t source_size)
+      : GenericRequest(),
+        upload_session_url_(std::move(upload_session_url)),
+        range_begin_(range_begin),
+        payload_buffers_(std::move(payload)),
+        source_size_(source_size),
+        last_chunk_(true) {}
+
   std::string const& upload_session_url() const { return upload_session_url_; }
   std::uint64_t range_begin() const { return range_begin_; }
-  std::uint64_t range_end() const { return range_begin_ + payload_.size() - 1; }
+  std::uint64_t range_end() const { return range_begin_ + payload_size() - 1; }
   std::uint64_t source_size() const { return source_size_; }
+
+  /// The payload, empty if the request was created from a buffer sequence.
   std::string const& payload() const { return payload_; }
 
+  /// The payload as a sequence of buffers, valid while the request is.
+  ConstBufferSequence payload_buffers() const;
+
+  /// The number of bytes in the payload.
+  std::size_t payload_size() const {
+    return payload_.size() + TotalBytes(payload_buffers_);
+  }
+
+  /// Returns true if the request was created from a buffer sequence.
+  bool has_payload_buffers() const { return !payload_buffers_.empty(); }
+
   std::string RangeHeader() const;
 
   // Chunks must be multiples of 256 KiB:
@@ -421,6 +512,7 @@ class UploadChunkRequest : public GenericRequest<UploadChunkRequest> {
   std::string upload_session_url_;
   std::uint64_t range_begin_ = 0;
   std::string payload_;
+  ConstBufferSequence payload_buffers_;
   std::uint64_t source_size_ = 0;
   bool last_chunk_ = false;
 };
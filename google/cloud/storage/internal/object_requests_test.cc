@@ -116,6 +116,27 @@ TEST(ObjectRequestsTest, ParseListResponse) {
   EXPECT_THAT(actual.items, ::testing::ElementsAre(o1, o2));
 }
 
+TEST(ObjectRequestsTest, ParseListResponsePrefixes) {
+  std::string text = R"""({
+      "kind": "storage#objects",
+      "prefixes": ["dir-a/", "dir-b/"]
+})""";
+
+  auto actual = ListObjectsResponse::FromHttpResponse(text).value();
+  EXPECT_TRUE(actual.items.empty());
+  EXPECT_THAT(actual.prefixes, ::testing::ElementsAre("dir-a/", "dir-b/"));
+  std::ostringstream os;
+  os << actual;
+  EXPECT_THAT(os.str(), HasSubstr("dir-b/"));
+}
+
+TEST(ObjectRequestsTest, ParseListResponseFailureInPrefixes) {
+  std::string text = R"""({"prefixes": [ 42 ]})""";
+
+  auto actual = ListObjectsResponse::FromHttpResponse(text);
+  EXPECT_FALSE(actual.ok());
+}
+
 TEST(ObjectRequestsTest, ParseListResponseFailure) {
   std::string text = R"""({123)""";
 
@@ -167,6 +188,32 @@ TEST(ObjectRequestsTest, InsertObjectMediaUpdateContents) {
   EXPECT_EQ("new contents", request.contents());
 }
 
+TEST(ObjectRequestsTest, InsertObjectMediaContentsView) {
+  InsertObjectMediaRequest request("my-bucket", "my-object", "object contents");
+  EXPECT_FALSE(request.has_contents_view());
+  EXPECT_EQ(request.contents().data(), request.contents_view().data());
+  EXPECT_EQ(request.contents().size(), request.contents_view().size());
+
+  std::string const view = "view contents";
+  request.set_contents_view(view.data(), view.size());
+  EXPECT_TRUE(request.has_contents_view());
+  EXPECT_EQ(view.data(), request.contents_view().data());
+  EXPECT_EQ(view.size(), request.contents_view().size());
+  std::ostringstream os;
+  os << request;
+  EXPECT_THAT(os.str(), HasSubstr("view contents"));
+}
+
+TEST(ObjectRequestsTest, InsertObjectMediaContentsFile) {
+  InsertObjectMediaRequest request("my-bucket", "my-object", std::string{});
+  EXPECT_TRUE(request.contents_file().empty());
+  request.set_contents_file("/some/file/name.txt");
+  EXPECT_EQ("/some/file/name.txt", request.contents_file());
+  std::ostringstream os;
+  os << request;
+  EXPECT_THAT(os.str(), HasSubstr("contents_file=/some/file/name.txt"));
+}
+
 TEST(ObjectRequestsTest, Copy) {
   CopyObjectRequest request("source-bucket", "source-object", "my-bucket",
                             "my-object");
@@ -519,6 +566,22 @@ TEST(ObjectRequestsTest, UploadChunk) {
   EXPECT_THAT(actual, HasSubstr("<Content-Range: bytes 0-5/2048>"));
 }
 
+TEST(ObjectRequestsTest, UploadChunkBuffers) {
+  std::string const url = "https://unused.googleapis.com/test-only";
+  std::string const p0 = "abc";
+  std::string const p1 = "123";
+  UploadChunkRequest request(
+      url, 0, ConstBufferSequence{ConstBuffer(p0.data(), p0.size()),
+                                  ConstBuffer(p1.data(), p1.size())},
+      2048U);
+  EXPECT_TRUE(request.has_payload_buffers());
+  EXPECT_TRUE(request.payload().empty());
+  EXPECT_EQ(6, request.payload_size());
+  EXPECT_EQ(5, request.range_end());
+  EXPECT_EQ("Content-Range: bytes 0-5/2048", request.RangeHeader());
+  EXPECT_EQ("abc123", GatherBytes(request.payload_buffers()));
+}
+
 TEST(ObjectRequestsTest, UploadChunkContentRangeNotLast) {
   std::string const url = "https://unused.googleapis.com/test-only";
   UploadChunkRequest request(url, 1024, "1234");
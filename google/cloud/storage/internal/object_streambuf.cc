@@ -16,6 +16,7 @@
 #include "google/cloud/log.h"
 #include "google/cloud/storage/internal/object_requests.h"
 #include "google/cloud/storage/object_stream.h"
+#include <algorithm>
 #include <cstring>
 
 namespace google {
@@ -25,8 +26,9 @@ inline namespace STORAGE_CLIENT_NS {
 namespace internal {
 ObjectReadStreambuf::ObjectReadStreambuf(
     ReadObjectRangeRequest const& request,
-    std::unique_ptr<ObjectReadSource> source)
-    : source_(std::move(source)) {
+    std::unique_ptr<ObjectReadSource> source,
+    std::shared_ptr<BufferPool> buffer_pool)
+    : source_(std::move(source)), buffer_pool_(std::move(buffer_pool)) {
   hash_validator_ = CreateHashValidator(request);
 }
 
@@ -56,15 +58,23 @@ StatusOr<ObjectReadStreambuf::int_type> ObjectReadStreambuf::Peek() {
     return traits_type::eof();
   }
 
-  current_ios_buffer_.resize(128 * 1024);
-  std::size_t n = current_ios_buffer_.size();
+  // Keep the buffer until the download ends, obtaining it again from the pool
+  // for each read would add contention for no benefit.
+  std::size_t const buffer_size = 128 * 1024;
+  if (current_ios_buffer_.size() < buffer_size) {
+    auto buffer = AcquireBuffer(buffer_pool_, buffer_size);
+    if (!buffer) {
+      return std::move(buffer).status();
+    }
+    current_ios_buffer_ = *std::move(buffer);
+  }
   StatusOr<ReadSourceResult> read_result =
-      source_->Read(current_ios_buffer_.data(), n);
+      source_->Read(current_ios_buffer_.data(), buffer_size);
   if (!read_result.ok()) {
     return std::move(read_result).status();
   }
-  // assert(n <= current_ios_buffer_.size())
-  current_ios_buffer_.resize(read_result->bytes_received);
+  // assert(read_result->bytes_received <= buffer_size)
+  auto const bytes_received = read_result->bytes_received;
 
   for (auto const& kv : read_result->response.headers) {
     hash_validator_->ProcessHeader(kv.first, kv.second);
@@ -74,10 +84,12 @@ StatusOr<ObjectReadStreambuf::int_type> ObjectReadStreambuf::Peek() {
     return AsStatus(read_result->response);
   }
 
-  if (!current_ios_buffer_.empty()) {
+  if (bytes_received != 0) {
     char* data = current_ios_buffer_.data();
-    hash_validator_->Update(data, current_ios_buffer_.size());
-    setg(data, data, data + current_ios_buffer_.size());
+    hash_validator_->Update(data, bytes_received);
+    // These bytes must be copied again to reach the application.
+    copy_counters_.bytes_staged += bytes_received;
+    setg(data, data, data + bytes_received);
     return traits_type::to_int_type(*data);
   }
 
@@ -206,6 +218,66 @@ std::streamsize ObjectReadStreambuf::xsgetn(char* s, std::streamsize count) {
   return run_validator_if_closed(Status());
 }
 
+StatusOr<std::size_t> ObjectReadStreambuf::ReadDirect(char* buf,
+                                                      std::size_t n) {
+  if (!status_.ok()) {
+    return status_;
+  }
+  // Any data in the get area must be returned first, it precedes the data
+  // still in the source.
+  auto const buffered = static_cast<std::size_t>(egptr() - gptr());
+  bool const has_data = buffered != 0 || IsOpen();
+  std::size_t offset = (std::min)(n, buffered);
+  if (offset != 0) {
+    std::memcpy(buf, gptr(), offset);
+    gbump(static_cast<int>(offset));
+  }
+
+  if (offset < n && IsOpen()) {
+    StatusOr<ReadSourceResult> read_result =
+        source_->Read(buf + offset, n - offset);
+    if (!read_result) {
+      status_ = std::move(read_result).status();
+      return status_;
+    }
+    hash_validator_->Update(buf + offset, read_result->bytes_received);
+    offset += read_result->bytes_received;
+    for (auto const& kv : read_result->response.headers) {
+      hash_validator_->ProcessHeader(kv.first, kv.second);
+      headers_.emplace(kv.first, kv.second);
+    }
+    if (read_result->response.status_code >= 300) {
+      status_ = AsStatus(read_result->response);
+      return status_;
+    }
+  }
+
+  // Only validate the checksums once all the data has been consumed, and only
+  // once: `has_data` is false for calls after the end of the download.
+  if (!has_data || IsOpen() || gptr() != egptr()) {
+    return offset;
+  }
+  hash_validator_result_ = std::move(*hash_validator_).Finish();
+  if (hash_validator_result_.is_mismatch) {
+    std::string msg;
+    msg += __func__;
+    msg += "(): mismatched hashes in download";
+    msg += ", expected=";
+    msg += hash_validator_result_.computed;
+    msg += ", received=";
+    msg += hash_validator_result_.received;
+    status_ = Status(StatusCode::kDataLoss, std::move(msg));
+    return status_;
+  }
+  return offset;
+}
+
+ReadCopyCounters ObjectReadStreambuf::copy_counters() const {
+  auto counters = source_->copy_counters();
+  counters.bytes_staged += copy_counters_.bytes_staged;
+  return counters;
+}
+
 ObjectReadStreambuf::int_type ObjectReadStreambuf::ReportError(Status status) {
   // The only way to report errors from a std::basic_streambuf<> (which this
   // class derives from) is to throw exceptions:
@@ -227,21 +299,40 @@ ObjectReadStreambuf::int_type ObjectReadStreambuf::ReportError(Status status) {
 }
 
 void ObjectReadStreambuf::SetEmptyRegion() {
-  current_ios_buffer_.clear();
-  current_ios_buffer_.push_back('\0');
-  char* data = &current_ios_buffer_[0];
-  setg(data, data + 1, data + 1);
+  // There is no more data to read, return the buffer to the pool.
+  current_ios_buffer_ = PooledBuffer();
+  empty_region_ = '\0';
+  setg(&empty_region_, &empty_region_ + 1, &empty_region_ + 1);
 }
 
 ObjectWriteStreambuf::ObjectWriteStreambuf(
     std::unique_ptr<ResumableUploadSession> upload_session,
-    std::size_t max_buffer_size, std::unique_ptr<HashValidator> hash_validator)
+    std::size_t max_buffer_size, std::unique_ptr<HashValidator> hash_validator,
+    std::unique_ptr<AdaptiveChunkSize> chunk_size,
+    std::shared_ptr<BufferPool> buffer_pool)
     : upload_session_(std::move(upload_session)),
+      buffer_pool_(std::move(buffer_pool)),
       max_buffer_size_(UploadChunkRequest::RoundUpToQuantum(max_buffer_size)),
       hash_validator_(std::move(hash_validator)),
+      chunk_size_(std::move(chunk_size)),
       last_response_(ResumableUploadResponse{
           {}, 0, {}, ResumableUploadResponse::kInProgress, {}}) {
-  current_ios_buffer_.resize(max_buffer_size_);
+  if (chunk_size_) {
+    max_buffer_size_ = chunk_size_->chunk_size();
+  }
+  auto buffer = AcquireBuffer(buffer_pool_, max_buffer_size_);
+  if (!buffer) {
+    // Keep the session id and offset, so the application can resume the
+    // upload once other streams release their buffers.
+    last_response_ = std::move(buffer).status();
+    upload_session_ = std::unique_ptr<ResumableUploadSession>(
+        new ResumableUploadSessionError(last_response_.status(),
+                                        next_expected_byte(),
+                                        resumable_session_id()));
+    setp(nullptr, nullptr);
+    return;
+  }
+  current_ios_buffer_ = *std::move(buffer);
   auto pbeg = current_ios_buffer_.data();
   auto pend = pbeg + current_ios_buffer_.size();
   setp(pbeg, pend);
@@ -282,7 +373,24 @@ std::streamsize ObjectWriteStreambuf::xsputn(char const* s,
     return traits_type::eof();
   }
 
+  // Large writes are uploaded directly from the application buffer, only the
+  // bytes that do not fill a complete buffer are copied into it.
   std::streamsize bytes_copied = 0;
+  while (static_cast<std::size_t>(pptr() - pbase()) +
+             static_cast<std::size_t>(count - bytes_copied) >=
+         max_buffer_size_) {
+    auto consumed = UploadDirect(s);
+    if (!consumed) {
+      last_response_ = std::move(consumed).status();
+      upload_session_ = std::unique_ptr<ResumableUploadSession>(
+          new ResumableUploadSessionError(last_response_.status(),
+                                          next_expected_byte(),
+                                          resumable_session_id()));
+      return traits_type::eof();
+    }
+    bytes_copied += static_cast<std::streamsize>(*consumed);
+    s += *consumed;
+  }
   while (bytes_copied != count) {
     std::streamsize remaining_buffer_size = epptr() - pptr();
     std::streamsize bytes_to_copy =
@@ -339,17 +447,16 @@ StatusOr<ResumableUploadResponse> ObjectWriteStreambuf::FlushFinal() {
   std::size_t upload_size = upload_session_->next_expected_byte() + actual_size;
   hash_validator_->Update(pbase(), actual_size);
 
-  std::string to_upload(pbase(), actual_size);
-  last_response_ = upload_session_->UploadFinalChunk(to_upload, upload_size);
+  last_response_ = upload_session_->UploadFinalChunk(
+      ConstBufferSequence{ConstBuffer(pbase(), actual_size)}, upload_size);
   if (!last_response_) {
     // This was an unrecoverable error, time to store status and signal an
     // error.
     return last_response_;
   }
-  // Reset the iostream put area with valid pointers, but empty.
-  current_ios_buffer_.resize(1);
-  auto pbeg = current_ios_buffer_.data();
-  setp(pbeg, pbeg);
+  // Reset the iostream put area, and return the buffer to the pool.
+  setp(nullptr, nullptr);
+  current_ios_buffer_ = PooledBuffer();
 
   upload_session_.reset();
 
@@ -374,9 +481,9 @@ StatusOr<ResumableUploadResponse> ObjectWriteStreambuf::Flush() {
   auto expected_next_byte = upload_session_->next_expected_byte() + chunk_size;
 
   hash_validator_->Update(pbase(), chunk_size);
-  StatusOr<ResumableUploadResponse> result;
-  std::string to_send(pbase(), chunk_size);
-  last_response_ = upload_session_->UploadChunk(to_send);
+  auto const start = std::chrono::steady_clock::now();
+  last_response_ = upload_session_->UploadChunk(
+      ConstBufferSequence{ConstBuffer(pbase(), chunk_size)});
   if (!last_response_) {
     return last_response_;
   }
@@ -401,9 +508,92 @@ StatusOr<ResumableUploadResponse> ObjectWriteStreambuf::Flush() {
   std::copy(pbase() + bytes_uploaded, epptr(), pbase());
   setp(pbase(), epptr());
   pbump(static_cast<int>(actual_size - bytes_uploaded));
+  AdaptChunkSize(chunk_size, std::chrono::steady_clock::now() - start);
   return last_response_;
 }
 
+StatusOr<std::size_t> ObjectWriteStreambuf::UploadDirect(char const* s) {
+  auto const buffered = static_cast<std::size_t>(pptr() - pbase());
+  // Keep the same chunk size as the buffered uploads, the application
+  // controls the size of each request via the buffer size.
+  auto const chunk_size = max_buffer_size_;
+  ConstBufferSequence buffers;
+  if (buffered != 0) {
+    buffers.emplace_back(pbase(), (std::min)(buffered, chunk_size));
+  }
+  if (chunk_size > buffered) {
+    buffers.emplace_back(s, chunk_size - buffered);
+  }
+
+  auto const start = upload_session_->next_expected_byte();
+  auto const upload_start = std::chrono::steady_clock::now();
+  last_response_ = upload_session_->UploadChunk(buffers);
+  if (!last_response_) {
+    return last_response_.status();
+  }
+  auto const elapsed = std::chrono::steady_clock::now() - upload_start;
+  auto const actual_next_byte = upload_session_->next_expected_byte();
+  if (actual_next_byte < start) {
+    std::ostringstream error_message;
+    error_message << "Could not continue upload stream. GCS requested byte "
+                  << actual_next_byte << " which has already been uploaded.";
+    return Status(StatusCode::kAborted, error_message.str());
+  }
+  if (actual_next_byte > start + chunk_size) {
+    std::ostringstream error_message;
+    error_message << "Could not continue upload stream. "
+                  << "GCS requested unexpected byte. (expected: "
+                  << start + chunk_size << ", actual: " << actual_next_byte
+                  << ")";
+    return Status(StatusCode::kAborted, error_message.str());
+  }
+
+  auto const committed = static_cast<std::size_t>(actual_next_byte - start);
+  if (committed <= buffered) {
+    hash_validator_->Update(pbase(), committed);
+    std::copy(pbase() + committed, pptr(), pbase());
+    setp(pbase(), epptr());
+    pbump(static_cast<int>(buffered - committed));
+    AdaptChunkSize(chunk_size, elapsed);
+    return 0;
+  }
+  hash_validator_->Update(pbase(), buffered);
+  hash_validator_->Update(s, committed - buffered);
+  setp(pbase(), epptr());
+  AdaptChunkSize(chunk_size, elapsed);
+  return committed - buffered;
+}
+
+void ObjectWriteStreambuf::AdaptChunkSize(
+    std::size_t bytes, std::chrono::steady_clock::duration elapsed) {
+  if (!chunk_size_) {
+    return;
+  }
+  auto const size = chunk_size_->OnChunkUploaded(
+      bytes, std::chrono::duration_cast<std::chrono::microseconds>(elapsed));
+  auto const buffered = static_cast<std::size_t>(pptr() - pbase());
+  // Keep the current buffer if the data in it would not fit, the size is
+  // checked again after the next chunk.
+  if (size == max_buffer_size_ || size < buffered) {
+    return;
+  }
+  // Do not wait for the pool, the current buffer is good enough to continue.
+  auto buffer = TryAcquireBuffer(buffer_pool_, size);
+  if (!buffer) {
+    GCP_LOG(DEBUG) << __func__ << "() cannot resize the upload buffer to "
+                   << size << ": " << buffer.status();
+    return;
+  }
+  GCP_LOG(DEBUG) << __func__ << "() upload chunk size changed from "
+                 << max_buffer_size_ << " to " << size;
+  std::copy(pbase(), pptr(), buffer->data());
+  current_ios_buffer_ = *std::move(buffer);
+  max_buffer_size_ = size;
+  auto pbeg = current_ios_buffer_.data();
+  setp(pbeg, pbeg + current_ios_buffer_.size());
+  pbump(static_cast<int>(buffered));
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
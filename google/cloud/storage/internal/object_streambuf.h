@@ -16,11 +16,14 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OBJECT_STREAMBUF_H
 
 #include "google/cloud/status_or.h"
+#include "google/cloud/storage/buffer_pool.h"
+#include "google/cloud/storage/internal/adaptive_chunk_size.h"
 #include "google/cloud/storage/internal/hash_validator.h"
 #include "google/cloud/storage/internal/http_response.h"
 #include "google/cloud/storage/internal/object_read_source.h"
 #include "google/cloud/storage/internal/resumable_upload_session.h"
 #include "google/cloud/storage/version.h"
+#include <chrono>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -41,8 +44,14 @@ namespace internal {
  */
 class ObjectReadStreambuf : public std::basic_streambuf<char> {
  public:
+  /**
+   * Creates a streambuf reading from @p source.
+   *
+   * If @p buffer_pool is not null the get area is obtained from it.
+   */
   ObjectReadStreambuf(ReadObjectRangeRequest const& request,
-                      std::unique_ptr<ObjectReadSource> source);
+                      std::unique_ptr<ObjectReadSource> source,
+                      std::shared_ptr<BufferPool> buffer_pool = {});
 
   /// Create a streambuf in a permanent error status.
   ObjectReadStreambuf(ReadObjectRangeRequest const& request, Status status);
@@ -67,6 +76,23 @@ class ObjectReadStreambuf : public std::basic_streambuf<char> {
     return headers_;
   }
 
+  /**
+   * Reads up to @p n bytes into @p buf, bypassing the get area.
+   *
+   * Any data already in the get area is returned first, the rest is read from
+   * the data source directly into @p buf. Unlike `xsgetn()` this function
+   * reports errors, including checksum mismatches, via its return value.
+   *
+   * @return the number of bytes read, or the error. This can be 0 before the
+   *     end of the download, for example, if @p n is 0 or the source only
+   *     returned headers. The download is complete once `IsOpen()` is `false`
+   *     and this function returns 0.
+   */
+  StatusOr<std::size_t> ReadDirect(char* buf, std::size_t n);
+
+  /// The copies performed to deliver the data, used in benchmarks and tests.
+  ReadCopyCounters copy_counters() const;
+
  private:
   int_type ReportError(Status status);
   void SetEmptyRegion();
@@ -76,11 +102,15 @@ class ObjectReadStreambuf : public std::basic_streambuf<char> {
   std::streamsize xsgetn(char* s, std::streamsize count) override;
 
   std::unique_ptr<ObjectReadSource> source_;
-  std::vector<char> current_ios_buffer_;
+  std::shared_ptr<BufferPool> buffer_pool_;
+  PooledBuffer current_ios_buffer_;
+  char empty_region_ = '\0';
   std::unique_ptr<HashValidator> hash_validator_;
   HashValidator::Result hash_validator_result_;
   Status status_;
   std::multimap<std::string, std::string> headers_;
+  // Only counts the bytes staged in the get area, `source_` counts the rest.
+  ReadCopyCounters copy_counters_;
 };
 
 /**
@@ -94,9 +124,20 @@ class ObjectWriteStreambuf : public std::basic_streambuf<char> {
  public:
   ObjectWriteStreambuf() = default;
 
+  /**
+   * Creates a streambuf uploading chunks of @p max_buffer_size bytes.
+   *
+   * If @p chunk_size is not null it overrides @p max_buffer_size, and the
+   * buffer is resized after each chunk to the size it recommends.
+   *
+   * If @p buffer_pool is not null the buffer is obtained from it. If the pool
+   * cannot provide a buffer the streambuf is created in an error state.
+   */
   ObjectWriteStreambuf(std::unique_ptr<ResumableUploadSession> upload_session,
                        std::size_t max_buffer_size,
-                       std::unique_ptr<HashValidator> hash_validator);
+                       std::unique_ptr<HashValidator> hash_validator,
+                       std::unique_ptr<AdaptiveChunkSize> chunk_size = {},
+                       std::shared_ptr<BufferPool> buffer_pool = {});
 
   ~ObjectWriteStreambuf() override = default;
 
@@ -128,6 +169,9 @@ class ObjectWriteStreambuf : public std::basic_streambuf<char> {
 
   virtual Status last_status() const { return last_response_.status(); }
 
+  /// The size of the next chunk uploaded by this streambuf.
+  virtual std::size_t upload_chunk_size() const { return max_buffer_size_; }
+
  protected:
   int sync() override;
   std::streamsize xsputn(char const* s, std::streamsize count) override;
@@ -140,13 +184,32 @@ class ObjectWriteStreambuf : public std::basic_streambuf<char> {
   /// Flush any remaining data and commit the upload.
   StatusOr<ResumableUploadResponse> FlushFinal();
 
+  /**
+   * Upload the buffered data followed by a prefix of @p s, without copying.
+   *
+   * Uploads a full buffer worth of data, taken from the current buffer
+   * contents followed by the first bytes in @p s. The caller must guarantee
+   * that @p s has enough bytes to complete the chunk. Any uncommitted bytes
+   * from the buffer are kept in it.
+   *
+   * @return the number of bytes consumed from @p s. This is 0 if the service
+   *     committed none of the bytes from @p s, the caller should try again.
+   */
+  StatusOr<std::size_t> UploadDirect(char const* s);
+
+  /// Resizes the buffer, if needed, after uploading a chunk.
+  void AdaptChunkSize(std::size_t bytes,
+                      std::chrono::steady_clock::duration elapsed);
+
   std::unique_ptr<ResumableUploadSession> upload_session_;
 
-  std::vector<char> current_ios_buffer_;
+  std::shared_ptr<BufferPool> buffer_pool_;
+  PooledBuffer current_ios_buffer_;
   std::size_t max_buffer_size_;
 
   std::unique_ptr<HashValidator> hash_validator_;
   HashValidator::Result hash_validator_result_;
+  std::unique_ptr<AdaptiveChunkSize> chunk_size_;
 
   StatusOr<ResumableUploadResponse> last_response_;
 };
@@ -19,6 +19,7 @@
 #include "google/cloud/storage/testing/mock_client.h"
 #include "google/cloud/testing_util/assert_ok.h"
 #include <gmock/gmock.h>
+#include <thread>
 
 namespace google {
 namespace cloud {
@@ -30,6 +31,7 @@ namespace {
 using ::google::cloud::storage::testing::canonical_errors::PermanentError;
 using ::google::cloud::storage::testing::canonical_errors::TransientError;
 using ::testing::_;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::InSequence;
 using ::testing::Invoke;
@@ -192,6 +194,142 @@ TEST(ObjectWriteStreambufTest, FlushAfterLargePayload) {
   EXPECT_STATUS_OK(response);
 }
 
+/// @test Verify that large writes are uploaded after the buffered data.
+TEST(ObjectWriteStreambufTest, LargeWriteAfterBufferedData) {
+  auto mock = google::cloud::internal::make_unique<
+      testing::MockResumableUploadSession>();
+  EXPECT_CALL(*mock, done).WillRepeatedly(Return(false));
+
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  std::string const header("header");
+  std::string const payload = std::string(quantum, 'a') +
+                              std::string(quantum, 'b') +
+                              std::string(quantum, 'c');
+  auto const contents = header + payload;
+
+  size_t next_byte = 0;
+  std::vector<std::string> uploaded;
+  EXPECT_CALL(*mock, UploadChunk(_))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](std::string const& p) {
+        uploaded.push_back(p);
+        next_byte += p.size();
+        return make_status_or(ResumableUploadResponse{
+            "", next_byte - 1, {}, ResumableUploadResponse::kInProgress, {}});
+      }));
+  EXPECT_CALL(*mock, UploadFinalChunk(contents.substr(3 * quantum),
+                                      contents.size()))
+      .WillOnce(Return(make_status_or(
+          ResumableUploadResponse{"{}",
+                                  contents.size() - 1,
+                                  {},
+                                  ResumableUploadResponse::kInProgress,
+                                  {}})));
+  EXPECT_CALL(*mock, next_expected_byte()).WillRepeatedly(Invoke([&]() {
+    return next_byte;
+  }));
+
+  ObjectWriteStreambuf streambuf(
+      std::move(mock), quantum,
+      google::cloud::internal::make_unique<NullHashValidator>());
+
+  streambuf.sputn(header.data(), header.size());
+  streambuf.sputn(payload.data(), payload.size());
+  auto response = streambuf.Close();
+  EXPECT_STATUS_OK(response);
+  ASSERT_EQ(3, uploaded.size());
+  EXPECT_EQ(contents.substr(0, quantum), uploaded[0]);
+  EXPECT_EQ(contents.substr(quantum, quantum), uploaded[1]);
+  EXPECT_EQ(contents.substr(2 * quantum, quantum), uploaded[2]);
+}
+
+/// @test Verify that large writes continue if a chunk makes no progress.
+TEST(ObjectWriteStreambufTest, LargeWriteNoBytesAccepted) {
+  auto mock = google::cloud::internal::make_unique<
+      testing::MockResumableUploadSession>();
+  EXPECT_CALL(*mock, done).WillRepeatedly(Return(false));
+
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  std::string const payload =
+      std::string(quantum, 'a') + std::string(quantum, 'b');
+
+  size_t next_byte = 0;
+  std::vector<std::string> uploaded;
+  EXPECT_CALL(*mock, UploadChunk(_))
+      .WillOnce(Invoke([&](std::string const& p) {
+        // The service did not commit any bytes.
+        uploaded.push_back(p);
+        return make_status_or(ResumableUploadResponse{
+            "", 0, {}, ResumableUploadResponse::kInProgress, {}});
+      }))
+      .WillRepeatedly(Invoke([&](std::string const& p) {
+        uploaded.push_back(p);
+        next_byte += p.size();
+        return make_status_or(ResumableUploadResponse{
+            "", next_byte - 1, {}, ResumableUploadResponse::kInProgress, {}});
+      }));
+  EXPECT_CALL(*mock, UploadFinalChunk(std::string{}, payload.size()))
+      .WillOnce(Return(make_status_or(
+          ResumableUploadResponse{"{}",
+                                  payload.size() - 1,
+                                  {},
+                                  ResumableUploadResponse::kInProgress,
+                                  {}})));
+  EXPECT_CALL(*mock, next_expected_byte()).WillRepeatedly(Invoke([&]() {
+    return next_byte;
+  }));
+
+  ObjectWriteStreambuf streambuf(
+      std::move(mock), quantum,
+      google::cloud::internal::make_unique<NullHashValidator>());
+
+  EXPECT_EQ(static_cast<std::streamsize>(payload.size()),
+            streambuf.sputn(payload.data(), payload.size()));
+  EXPECT_STATUS_OK(streambuf.last_status());
+  auto response = streambuf.Close();
+  EXPECT_STATUS_OK(response);
+  ASSERT_EQ(3, uploaded.size());
+  EXPECT_EQ(payload.substr(0, quantum), uploaded[0]);
+  EXPECT_EQ(payload.substr(0, quantum), uploaded[1]);
+  EXPECT_EQ(payload.substr(quantum, quantum), uploaded[2]);
+}
+
+/// @test Verify that the chunk size adapts to the upload performance.
+TEST(ObjectWriteStreambufTest, AdaptiveChunkSize) {
+  auto mock = google::cloud::internal::make_unique<
+      testing::MockResumableUploadSession>();
+  EXPECT_CALL(*mock, done).WillRepeatedly(Return(false));
+
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  size_t next_byte = 0;
+  std::vector<std::size_t> sizes;
+  EXPECT_CALL(*mock, UploadChunk(_))
+      .WillRepeatedly(Invoke([&](std::string const& p) {
+        // Make the elapsed time measurable, this is a very fast network.
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        sizes.push_back(p.size());
+        next_byte += p.size();
+        return make_status_or(ResumableUploadResponse{
+            "", next_byte - 1, {}, ResumableUploadResponse::kInProgress, {}});
+      }));
+  EXPECT_CALL(*mock, next_expected_byte()).WillRepeatedly(Invoke([&]() {
+    return next_byte;
+  }));
+
+  ObjectWriteStreambuf streambuf(
+      std::move(mock), 16 * quantum,
+      google::cloud::internal::make_unique<NullHashValidator>(),
+      google::cloud::internal::make_unique<AdaptiveChunkSize>(
+          quantum, quantum, 4 * quantum));
+  EXPECT_EQ(quantum, streambuf.upload_chunk_size());
+
+  std::string const payload(7 * quantum + 5, '*');
+  streambuf.sputn(payload.data(), payload.size());
+  EXPECT_STATUS_OK(streambuf.last_status());
+  EXPECT_THAT(sizes, ElementsAre(quantum, 2 * quantum, 4 * quantum));
+  EXPECT_EQ(4 * quantum, streambuf.upload_chunk_size());
+}
+
 /// @test Verify that a stream flushes when a full quantum is available.
 TEST(ObjectWriteStreambufTest, FlushAfterFullQuantum) {
   auto mock = google::cloud::internal::make_unique<
@@ -540,6 +678,180 @@ TEST(ObjectWriteStreambufTest, ErrorInLargePayload) {
   EXPECT_EQ(StatusCode::kInvalidArgument, response.status().code())
       << ", status=" << response.status();
 }
+
+/// @test Verify that the upload buffer is obtained from the pool.
+TEST(ObjectWriteStreambufTest, BufferPool) {
+  auto mock = google::cloud::internal::make_unique<
+      testing::MockResumableUploadSession>();
+  EXPECT_CALL(*mock, done).WillRepeatedly(Return(false));
+
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  std::string const payload = "small test payload";
+
+  EXPECT_CALL(*mock, UploadFinalChunk(_, _))
+      .WillOnce(Invoke([&](std::string const& p, std::uint64_t s) {
+        EXPECT_EQ(payload, p);
+        EXPECT_EQ(payload.size(), s);
+        return make_status_or(ResumableUploadResponse{
+            "{}", payload.size() - 1, {}, ResumableUploadResponse::kDone, {}});
+      }));
+  EXPECT_CALL(*mock, next_expected_byte()).WillOnce(Return(0));
+
+  auto pool = std::make_shared<BufferPool>(2 * quantum);
+  ObjectWriteStreambuf streambuf(
+      std::move(mock), quantum,
+      google::cloud::internal::make_unique<NullHashValidator>(), {}, pool);
+  EXPECT_EQ(quantum, pool->stats().bytes_in_use);
+
+  streambuf.sputn(payload.data(), payload.size());
+  auto response = streambuf.Close();
+  EXPECT_STATUS_OK(response);
+
+  // The buffer is returned to the pool when the upload completes.
+  auto stats = pool->stats();
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(quantum, stats.bytes_cached);
+}
+
+/// @test Verify that the streambuf reports an error if the pool is exhausted.
+TEST(ObjectWriteStreambufTest, BufferPoolExhausted) {
+  auto mock = google::cloud::internal::make_unique<
+      testing::MockResumableUploadSession>();
+  EXPECT_CALL(*mock, done).WillRepeatedly(Return(false));
+  EXPECT_CALL(*mock, UploadChunk(_)).Times(0);
+  EXPECT_CALL(*mock, UploadFinalChunk(_, _)).Times(0);
+  std::string const session_id = "upload_id";
+  EXPECT_CALL(*mock, session_id).WillOnce(ReturnRef(session_id));
+  EXPECT_CALL(*mock, next_expected_byte()).WillOnce(Return(0));
+
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  auto pool = std::make_shared<BufferPool>(quantum);
+  auto in_use = pool->Acquire(quantum);
+  ASSERT_STATUS_OK(in_use);
+
+  ObjectWriteStreambuf streambuf(
+      std::move(mock), quantum,
+      google::cloud::internal::make_unique<NullHashValidator>(), {}, pool);
+  EXPECT_FALSE(streambuf.IsOpen());
+  EXPECT_EQ(StatusCode::kResourceExhausted, streambuf.last_status().code());
+  EXPECT_EQ(session_id, streambuf.resumable_session_id());
+
+  std::string const payload = "small test payload";
+  streambuf.sputn(payload.data(), payload.size());
+  auto response = streambuf.Close();
+  EXPECT_EQ(StatusCode::kResourceExhausted, response.status().code());
+  EXPECT_EQ(1, pool->stats().rejections);
+}
+
+/// @test Verify that ReadDirect() returns buffered data first.
+TEST(ObjectReadStreambufTest, ReadDirect) {
+  auto mock =
+      google::cloud::internal::make_unique<testing::MockObjectReadSource>();
+  bool is_open = true;
+  EXPECT_CALL(*mock, IsOpen()).WillRepeatedly(Invoke([&] { return is_open; }));
+  EXPECT_CALL(*mock, Read(_, _))
+      .WillOnce(Invoke([](char* buf, std::size_t n) {
+        std::string const contents = "0123456789";
+        EXPECT_LE(contents.size(), n);
+        std::copy(contents.begin(), contents.end(), buf);
+        return make_status_or(
+            ReadSourceResult{contents.size(), HttpResponse{100, {}, {}}});
+      }))
+      .WillOnce(Invoke([&](char*, std::size_t) {
+        is_open = false;
+        return make_status_or(ReadSourceResult{0, HttpResponse{200, {}, {}}});
+      }));
+
+  ObjectReadStreambuf streambuf(
+      ReadObjectRangeRequest("test-bucket", "test-object"), std::move(mock));
+  // Peeking fills the get area, those bytes count as staged.
+  EXPECT_EQ('0', streambuf.sgetc());
+  EXPECT_EQ(10, streambuf.copy_counters().bytes_staged);
+
+  char buffer[16];
+  auto read = streambuf.ReadDirect(buffer, 4);
+  ASSERT_STATUS_OK(read);
+  EXPECT_EQ("0123", std::string(buffer, *read));
+
+  read = streambuf.ReadDirect(buffer, sizeof(buffer));
+  ASSERT_STATUS_OK(read);
+  EXPECT_EQ("456789", std::string(buffer, *read));
+
+  read = streambuf.ReadDirect(buffer, sizeof(buffer));
+  ASSERT_STATUS_OK(read);
+  EXPECT_EQ(0, *read);
+  EXPECT_EQ(10, streambuf.copy_counters().bytes_staged);
+}
+
+/// @test Verify that ReadDirect() reports errors via its return value.
+TEST(ObjectReadStreambufTest, ReadDirectError) {
+  auto mock =
+      google::cloud::internal::make_unique<testing::MockObjectReadSource>();
+  EXPECT_CALL(*mock, IsOpen()).WillRepeatedly(Return(true));
+  EXPECT_CALL(*mock, Read(_, _)).WillOnce(Return(PermanentError()));
+
+  ObjectReadStreambuf streambuf(
+      ReadObjectRangeRequest("test-bucket", "test-object"), std::move(mock));
+  char buffer[16];
+  auto read = streambuf.ReadDirect(buffer, sizeof(buffer));
+  EXPECT_EQ(PermanentError().code(), read.status().code());
+  EXPECT_EQ(PermanentError().code(), streambuf.status().code());
+
+  // Once the stream has an error all future calls fail.
+  read = streambuf.ReadDirect(buffer, sizeof(buffer));
+  EXPECT_EQ(PermanentError().code(), read.status().code());
+}
+
+/// @test Verify that the get area is obtained from the pool.
+TEST(ObjectReadStreambufTest, BufferPool) {
+  auto mock =
+      google::cloud::internal::make_unique<testing::MockObjectReadSource>();
+  bool is_open = true;
+  EXPECT_CALL(*mock, IsOpen()).WillRepeatedly(Invoke([&] { return is_open; }));
+  EXPECT_CALL(*mock, Read(_, _))
+      .WillOnce(Invoke([](char* buf, std::size_t) {
+        std::string const contents = "0123456789";
+        std::copy(contents.begin(), contents.end(), buf);
+        return make_status_or(
+            ReadSourceResult{contents.size(), HttpResponse{100, {}, {}}});
+      }))
+      .WillOnce(Invoke([&](char*, std::size_t) {
+        is_open = false;
+        return make_status_or(ReadSourceResult{0, HttpResponse{200, {}, {}}});
+      }));
+
+  auto pool = std::make_shared<BufferPool>(1024 * 1024);
+  ObjectReadStreambuf streambuf(
+      ReadObjectRangeRequest("test-bucket", "test-object"), std::move(mock),
+      pool);
+  std::istream stream(&streambuf);
+  std::string contents;
+  stream >> contents;
+  EXPECT_EQ("0123456789", contents);
+
+  // The buffer is returned to the pool once the download completes.
+  auto stats = pool->stats();
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(128 * 1024, stats.bytes_cached);
+  EXPECT_EQ(1, stats.allocations);
+}
+
+/// @test Verify that the streambuf reports an error if the pool is exhausted.
+TEST(ObjectReadStreambufTest, BufferPoolExhausted) {
+  auto mock =
+      google::cloud::internal::make_unique<testing::MockObjectReadSource>();
+  EXPECT_CALL(*mock, IsOpen()).WillRepeatedly(Return(true));
+  EXPECT_CALL(*mock, Read(_, _)).Times(0);
+
+  auto pool = std::make_shared<BufferPool>(64 * 1024);
+  ObjectReadStreambuf streambuf(
+      ReadObjectRangeRequest("test-bucket", "test-object"), std::move(mock),
+      pool);
+  std::istream stream(&streambuf);
+  stream.peek();
+  EXPECT_TRUE(stream.bad());
+  EXPECT_EQ(StatusCode::kResourceExhausted, streambuf.status().code());
+}
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
@@ -39,11 +39,16 @@ GetDigestCtx() {
   return std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_destroy)>(
       EVP_MD_CTX_create(), &EVP_MD_CTX_destroy);
 };
+inline void ResetDigestCtx(EVP_MD_CTX* ctx) {
+  EVP_MD_CTX_cleanup(ctx);
+  EVP_MD_CTX_init(ctx);
+}
 #else
 inline std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> GetDigestCtx() {
   return std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)>(
       EVP_MD_CTX_new(), &EVP_MD_CTX_free);
 };
+inline void ResetDigestCtx(EVP_MD_CTX* ctx) { EVP_MD_CTX_reset(ctx); }
 #endif
 
 #ifndef OPENSSL_IS_BORINGSSL
@@ -173,35 +178,52 @@ std::string Base64Encode(std::vector<std::uint8_t> const& bytes) {
   return Base64Encode(bytes.data(), bytes.size());
 }
 
-std::vector<std::uint8_t> SignStringWithPem(
-    std::string const& str, std::string const& pem_contents,
-    storage::oauth2::JwtSigningAlgorithms alg) {
-  using ::google::cloud::storage::oauth2::JwtSigningAlgorithms;
-
-  // We check for failures several times, so we shorten this into a lambda
-  // to avoid bloating the code with alloc/init checks.
-  const char* func_name = __func__;  // Avoid using the lambda name instead.
-  auto handle_openssl_failure = [&func_name](const char* error_msg) -> void {
-    std::ostringstream err_builder;
-    err_builder << "Permanent error in " << func_name
-                << " (failed to sign string with PEM key):\n"
-                << error_msg;
-    google::cloud::internal::ThrowRuntimeError(err_builder.str());
-  };
+namespace {
+[[noreturn]] void HandleSigningFailure(char const* func_name,
+                                       char const* error_msg) {
+  std::ostringstream err_builder;
+  err_builder << "Permanent error in " << func_name
+              << " (failed to sign string with PEM key):\n"
+              << error_msg;
+  google::cloud::internal::ThrowRuntimeError(err_builder.str());
+}
 
-  auto digest_ctx = GetDigestCtx();
+/**
+ * Returns a digest context owned by the calling thread.
+ *
+ * Creating a context allocates memory, signing many strings in the same thread
+ * is measurably faster when the context is reset and reused instead.
+ */
+EVP_MD_CTX* ThreadLocalDigestCtx() {
+  thread_local auto digest_ctx = GetDigestCtx();
   if (!digest_ctx) {
-    handle_openssl_failure("Could not create context for OpenSSL digest.");
+    return nullptr;
   }
+  ResetDigestCtx(digest_ctx.get());
+  return digest_ctx.get();
+}
+}  // namespace
+
+struct PemSigner::Impl {
+  Impl() : private_key(nullptr, &EVP_PKEY_free) {}
 
+  std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> private_key;
   EVP_MD const* digest_type = nullptr;
+};
+
+PemSigner::PemSigner(std::string const& pem_contents,
+                     storage::oauth2::JwtSigningAlgorithms alg) {
+  using ::google::cloud::storage::oauth2::JwtSigningAlgorithms;
+
+  auto impl = std::make_shared<Impl>();
   switch (alg) {
     case JwtSigningAlgorithms::RS256:
-      digest_type = EVP_sha256();
+      impl->digest_type = EVP_sha256();
       break;
   }
-  if (digest_type == nullptr) {
-    handle_openssl_failure("Could not find specified digest in OpenSSL.");
+  if (impl->digest_type == nullptr) {
+    HandleSigningFailure(__func__,
+                         "Could not find specified digest in OpenSSL.");
   }
 
   auto pem_buffer = std::unique_ptr<BIO, decltype(&BIO_free)>(
@@ -209,36 +231,43 @@ std::vector<std::uint8_t> SignStringWithPem(
                       static_cast<int>(pem_contents.length())),
       &BIO_free);
   if (!pem_buffer) {
-    handle_openssl_failure("Could not create PEM buffer.");
+    HandleSigningFailure(__func__, "Could not create PEM buffer.");
   }
 
-  auto private_key = std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)>(
-      PEM_read_bio_PrivateKey(
-          pem_buffer.get(),
-          nullptr,  // EVP_PKEY **x
-          nullptr,  // pem_password_cb *cb -- a custom callback.
-          // void *u -- this represents the password for the PEM (only
-          // applicable for formats such as PKCS12 (.p12 files) that use
-          // a password, which we don't currently support.
-          nullptr),
-      &EVP_PKEY_free);
-  if (!private_key) {
-    handle_openssl_failure("Could not parse PEM to get private key.");
+  impl->private_key.reset(PEM_read_bio_PrivateKey(
+      pem_buffer.get(),
+      nullptr,  // EVP_PKEY **x
+      nullptr,  // pem_password_cb *cb -- a custom callback.
+      // void *u -- this represents the password for the PEM (only
+      // applicable for formats such as PKCS12 (.p12 files) that use
+      // a password, which we don't currently support.
+      nullptr));
+  if (!impl->private_key) {
+    HandleSigningFailure(__func__, "Could not parse PEM to get private key.");
+  }
+  impl_ = std::move(impl);
+}
+
+std::vector<std::uint8_t> PemSigner::Sign(std::string const& str) const {
+  auto* digest_ctx = ThreadLocalDigestCtx();
+  if (digest_ctx == nullptr) {
+    HandleSigningFailure(__func__,
+                         "Could not create context for OpenSSL digest.");
   }
 
   int const digest_sign_success_code = 1;
   if (digest_sign_success_code !=
-      EVP_DigestSignInit(digest_ctx.get(),
+      EVP_DigestSignInit(digest_ctx,
                          nullptr,  // EVP_PKEY_CTX **pctx
-                         digest_type,
+                         impl_->digest_type,
                          nullptr,  // ENGINE *e
-                         private_key.get())) {
-    handle_openssl_failure("Could not initialize PEM digest.");
+                         impl_->private_key.get())) {
+    HandleSigningFailure(__func__, "Could not initialize PEM digest.");
   }
 
   if (digest_sign_success_code !=
-      EVP_DigestSignUpdate(digest_ctx.get(), str.data(), str.length())) {
-    handle_openssl_failure("Could not update PEM digest.");
+      EVP_DigestSignUpdate(digest_ctx, str.data(), str.length())) {
+    HandleSigningFailure(__func__, "Could not update PEM digest.");
   }
 
   std::size_t signed_str_size = 0;
@@ -246,20 +275,26 @@ std::vector<std::uint8_t> SignStringWithPem(
   // with the resulting buffer's size. This allows us to then call it again,
   // with the correct buffer and size, which actually populates the buffer.
   if (digest_sign_success_code !=
-      EVP_DigestSignFinal(digest_ctx.get(),
+      EVP_DigestSignFinal(digest_ctx,
                           nullptr,  // unsigned char *sig
                           &signed_str_size)) {
-    handle_openssl_failure("Could not finalize PEM digest (1/2).");
+    HandleSigningFailure(__func__, "Could not finalize PEM digest (1/2).");
   }
 
-  std::vector<unsigned char> signed_str(signed_str_size);
-  if (digest_sign_success_code != EVP_DigestSignFinal(digest_ctx.get(),
+  std::vector<std::uint8_t> signed_str(signed_str_size);
+  if (digest_sign_success_code != EVP_DigestSignFinal(digest_ctx,
                                                       signed_str.data(),
                                                       &signed_str_size)) {
-    handle_openssl_failure("Could not finalize PEM digest (2/2).");
+    HandleSigningFailure(__func__, "Could not finalize PEM digest (2/2).");
   }
+  signed_str.resize(signed_str_size);
+  return signed_str;
+}
 
-  return {signed_str.begin(), signed_str.end()};
+std::vector<std::uint8_t> SignStringWithPem(
+    std::string const& str, std::string const& pem_contents,
+    storage::oauth2::JwtSigningAlgorithms alg) {
+  return PemSigner(pem_contents, alg).Sign(str);
 }
 
 std::vector<std::uint8_t> UrlsafeBase64Decode(std::string const& str) {
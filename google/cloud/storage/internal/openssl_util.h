@@ -18,6 +18,8 @@
 #include "google/cloud/storage/oauth2/credential_constants.h"
 #include "google/cloud/storage/version.h"
 #include <algorithm>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace google {
@@ -52,6 +54,27 @@ std::vector<std::uint8_t> SignStringWithPem(
     std::string const& str, std::string const& pem_contents,
     storage::oauth2::JwtSigningAlgorithms alg);
 
+/**
+ * Signs strings with a private key parsed once from a PEM container.
+ *
+ * `SignStringWithPem()` parses the private key on every call, which dominates
+ * the cost of signing many strings with the same key. Copies of a `PemSigner`
+ * share the parsed key, and all member functions are safe to call from
+ * multiple threads.
+ */
+class PemSigner {
+ public:
+  PemSigner(std::string const& pem_contents,
+            storage::oauth2::JwtSigningAlgorithms alg);
+
+  /// Returns the signature of @p str as an *unencoded* byte array.
+  std::vector<std::uint8_t> Sign(std::string const& str) const;
+
+ private:
+  struct Impl;
+  std::shared_ptr<Impl const> impl_;
+};
+
 /**
  * Returns a Base64-encoded version of @p bytes. Using the URL- and
  * filesystem-safe alphabet, making these adjustments:
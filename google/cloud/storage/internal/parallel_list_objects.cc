@@ -0,0 +1,138 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/parallel_list_objects.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+/// The state shared by the threads in `ParallelListObjects()`.
+class ParallelListState {
+ public:
+  ParallelListState(ListObjectsRequest const& request,
+                    ListObjectsPageLoader const& loader,
+                    std::function<void(ObjectMetadata)> const& callback)
+      : request_(request), loader_(loader), callback_(callback) {
+    pending_.push_back(request.HasOption<Prefix>()
+                           ? request.GetOption<Prefix>().value()
+                           : std::string{});
+  }
+
+  /// The loop executed by each thread.
+  void Worker() {
+    for (;;) {
+      std::unique_lock<std::mutex> lk(mu_);
+      cv_.wait(lk, [this] {
+        return !status_.ok() || !pending_.empty() || active_ == 0;
+      });
+      if (!status_.ok() || pending_.empty()) {
+        lk.unlock();
+        cv_.notify_all();
+        return;
+      }
+      auto prefix = std::move(pending_.front());
+      pending_.pop_front();
+      ++active_;
+      lk.unlock();
+
+      auto status = ListPrefix(std::move(prefix));
+
+      lk.lock();
+      --active_;
+      if (!status.ok() && status_.ok()) {
+        status_ = std::move(status);
+      }
+      lk.unlock();
+      cv_.notify_all();
+    }
+  }
+
+  Status status() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return status_;
+  }
+
+ private:
+  Status ListPrefix(std::string prefix) {
+    auto request = request_;
+    request.set_option(Prefix(std::move(prefix)));
+    do {
+      auto response = loader_(request);
+      if (!response) {
+        return std::move(response).status();
+      }
+      if (!response->prefixes.empty()) {
+        std::unique_lock<std::mutex> lk(mu_);
+        for (auto& p : response->prefixes) {
+          pending_.push_back(std::move(p));
+        }
+        lk.unlock();
+        cv_.notify_all();
+      }
+      for (auto& object : response->items) {
+        callback_(std::move(object));
+      }
+      request.set_page_token(std::move(response->next_page_token));
+    } while (!request.page_token().empty() && !Failed());
+    return Status();
+  }
+
+  bool Failed() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return !status_.ok();
+  }
+
+  ListObjectsRequest const& request_;
+  ListObjectsPageLoader const& loader_;
+  std::function<void(ObjectMetadata)> const& callback_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::string> pending_;  // GUARDED_BY(mu_)
+  std::size_t active_ = 0;           // GUARDED_BY(mu_)
+  Status status_;                    // GUARDED_BY(mu_)
+};
+}  // namespace
+
+Status ParallelListObjects(
+    ListObjectsRequest const& request, ListObjectsPageLoader const& loader,
+    std::size_t concurrency,
+    std::function<void(ObjectMetadata)> const& callback) {
+  ParallelListState state(request, loader, callback);
+  std::vector<std::future<void>> workers;
+  for (std::size_t i = 1; i < std::max(concurrency, std::size_t{1}); ++i) {
+    workers.push_back(
+        std::async(std::launch::async, [&state] { state.Worker(); }));
+  }
+  state.Worker();
+  for (auto& w : workers) {
+    w.get();
+  }
+  return state.status();
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
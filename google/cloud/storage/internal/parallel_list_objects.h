@@ -0,0 +1,55 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PARALLEL_LIST_OBJECTS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PARALLEL_LIST_OBJECTS_H
+
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/version.h"
+#include <functional>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/// Loads one page of results for `ParallelListObjects()`.
+using ListObjectsPageLoader =
+    std::function<StatusOr<ListObjectsResponse>(ListObjectsRequest const&)>;
+
+/**
+ * Lists all the objects matching @p request, walking its pseudo-directories in
+ * parallel.
+ *
+ * @p request must have a `Delimiter` option. Each prefix returned by the
+ * service becomes a separate listing, up to @p concurrency listings run at the
+ * same time. The objects are passed to @p callback from multiple threads, in
+ * no particular order.
+ *
+ * Returns the first error, once an error is found no new listings are started.
+ */
+Status ParallelListObjects(ListObjectsRequest const& request,
+                           ListObjectsPageLoader const& loader,
+                           std::size_t concurrency,
+                           std::function<void(ObjectMetadata)> const& callback);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PARALLEL_LIST_OBJECTS_H
@@ -0,0 +1,157 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/parallel_list_objects.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+
+ObjectMetadata CreateObject(std::string const& name) {
+  nl::json metadata{
+      {"bucket", "test-bucket"},
+      {"id", "test-bucket/" + name + "/1"},
+      {"name", name},
+      {"kind", "storage#object"},
+  };
+  return ObjectMetadataParser::FromJson(metadata).value();
+}
+
+/// A fake bucket, lists `objects` using the prefix and delimiter in requests.
+class FakeBucket {
+ public:
+  explicit FakeBucket(std::set<std::string> objects)
+      : objects_(std::move(objects)) {}
+
+  /// Each page contains at most two objects and prefixes.
+  StatusOr<ListObjectsResponse> List(ListObjectsRequest const& r) {
+    auto const prefix =
+        r.HasOption<Prefix>() ? r.GetOption<Prefix>().value() : "";
+    auto const delimiter = r.GetOption<Delimiter>().value();
+    std::set<std::string> prefixes;
+    std::vector<std::string> names;
+    for (auto const& name : objects_) {
+      if (name.compare(0, prefix.size(), prefix) != 0) {
+        continue;
+      }
+      auto pos = name.find(delimiter, prefix.size());
+      if (pos != std::string::npos) {
+        prefixes.insert(name.substr(0, pos + delimiter.size()));
+        continue;
+      }
+      names.push_back(name);
+    }
+    std::vector<std::string> entries(prefixes.begin(), prefixes.end());
+    entries.insert(entries.end(), names.begin(), names.end());
+
+    std::size_t offset =
+        r.page_token().empty() ? 0 : std::stoul(r.page_token());
+    ListObjectsResponse response;
+    for (std::size_t i = offset; i != entries.size() && i != offset + 2; ++i) {
+      if (prefixes.count(entries[i]) != 0) {
+        response.prefixes.push_back(entries[i]);
+      } else {
+        response.items.push_back(CreateObject(entries[i]));
+      }
+    }
+    if (offset + 2 < entries.size()) {
+      response.next_page_token = std::to_string(offset + 2);
+    }
+    std::lock_guard<std::mutex> lk(mu_);
+    ++requests_[prefix];
+    return response;
+  }
+
+  std::map<std::string, int> requests() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return requests_;
+  }
+
+ private:
+  std::set<std::string> objects_;
+  std::mutex mu_;
+  std::map<std::string, int> requests_;
+};
+
+TEST(ParallelListObjectsTest, WalksPseudoDirectories) {
+  std::set<std::string> const objects{
+      "a",       "b",       "c",        "dir-1/a",   "dir-1/b",
+      "dir-1/c", "dir-2/a", "dir-2/x/a", "dir-2/x/b", "dir-2/y/a",
+  };
+  FakeBucket bucket(objects);
+
+  std::mutex mu;
+  std::set<std::string> actual;
+  auto status = ParallelListObjects(
+      ListObjectsRequest("test-bucket").set_multiple_options(Delimiter("/")),
+      [&bucket](ListObjectsRequest const& r) { return bucket.List(r); }, 4,
+      [&](ObjectMetadata object) {
+        std::lock_guard<std::mutex> lk(mu);
+        EXPECT_TRUE(actual.insert(object.name()).second);
+      });
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(objects, actual);
+  EXPECT_EQ((std::map<std::string, int>{{"", 3},
+                                        {"dir-1/", 2},
+                                        {"dir-2/", 2},
+                                        {"dir-2/x/", 1},
+                                        {"dir-2/y/", 1}}),
+            bucket.requests());
+}
+
+TEST(ParallelListObjectsTest, StartsAtPrefix) {
+  FakeBucket bucket({"a", "dir-1/a", "dir-1/sub/b", "dir-2/a"});
+
+  std::set<std::string> actual;
+  auto status = ParallelListObjects(
+      ListObjectsRequest("test-bucket")
+          .set_multiple_options(Prefix("dir-1/"), Delimiter("/")),
+      [&bucket](ListObjectsRequest const& r) { return bucket.List(r); }, 1,
+      [&](ObjectMetadata object) { actual.insert(object.name()); });
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ((std::set<std::string>{"dir-1/a", "dir-1/sub/b"}), actual);
+}
+
+TEST(ParallelListObjectsTest, ReportsFirstError) {
+  FakeBucket bucket({"a", "dir-1/a", "dir-2/a"});
+
+  auto status = ParallelListObjects(
+      ListObjectsRequest("test-bucket").set_multiple_options(Delimiter("/")),
+      [&bucket](ListObjectsRequest const& r) -> StatusOr<ListObjectsResponse> {
+        if (r.GetOption<Prefix>().value() == "dir-2/") {
+          return PermanentError();
+        }
+        return bucket.List(r);
+      },
+      2, [](ObjectMetadata) {});
+  EXPECT_EQ(PermanentError().code(), status.code());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,235 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/pipelined_resumable_upload_session.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+PipelinedResumableUploadSession::PipelinedResumableUploadSession(
+    std::unique_ptr<ResumableUploadSession> session, std::size_t depth)
+    : session_(std::move(session)),
+      depth_(depth == 0 ? 1 : depth),
+      done_(session_->done()),
+      next_expected_byte_(session_->next_expected_byte()),
+      last_response_(session_->last_response()),
+      thread_([this] { Run(); }) {}
+
+PipelinedResumableUploadSession::~PipelinedResumableUploadSession() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  // Any chunk being uploaded completes, queued chunks are discarded.
+  thread_.join();
+}
+
+StatusOr<ResumableUploadResponse> PipelinedResumableUploadSession::UploadChunk(
+    std::string const& buffer) {
+  return UploadChunk(
+      ConstBufferSequence{ConstBuffer(buffer.data(), buffer.size())});
+}
+
+StatusOr<ResumableUploadResponse> PipelinedResumableUploadSession::UploadChunk(
+    ConstBufferSequence const& buffers) {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] {
+    return !error_.ok() || queue_.size() + (sending_ ? 1 : 0) < depth_;
+  });
+  if (!error_.ok()) {
+    last_response_ = error_;
+    return last_response_;
+  }
+  std::string chunk;
+  if (!free_.empty()) {
+    chunk = std::move(free_.back());
+    free_.pop_back();
+  }
+  chunk.clear();
+  for (auto const& b : buffers) {
+    chunk.append(b.data(), b.size());
+  }
+  next_expected_byte_ += chunk.size();
+  queue_.push_back(std::move(chunk));
+  auto const next_expected_byte = next_expected_byte_;
+  lk.unlock();
+  cv_.notify_all();
+
+  last_response_ = ResumableUploadResponse{
+      {}, next_expected_byte - 1, {}, ResumableUploadResponse::kInProgress, {}};
+  return last_response_;
+}
+
+StatusOr<ResumableUploadResponse>
+PipelinedResumableUploadSession::UploadFinalChunk(std::string const& buffer,
+                                                  std::uint64_t upload_size) {
+  return UploadFinalChunk(
+      ConstBufferSequence{ConstBuffer(buffer.data(), buffer.size())},
+      upload_size);
+}
+
+StatusOr<ResumableUploadResponse>
+PipelinedResumableUploadSession::UploadFinalChunk(
+    ConstBufferSequence const& buffers, std::uint64_t upload_size) {
+  std::unique_lock<std::mutex> lk(mu_);
+  WaitIdle(lk);
+  if (!error_.ok()) {
+    last_response_ = error_;
+    return last_response_;
+  }
+  // Send any uncommitted data before the application's buffers, without
+  // copying them.
+  ConstBufferSequence payload;
+  payload.reserve(buffers.size() + 1);
+  if (!carry_.empty()) {
+    payload.emplace_back(carry_.data(), carry_.size());
+  }
+  payload.insert(payload.end(), buffers.begin(), buffers.end());
+  lk.unlock();
+
+  // The background thread is idle, and only this thread queues more work.
+  last_response_ = session_->UploadFinalChunk(payload, upload_size);
+
+  lk.lock();
+  carry_.clear();
+  next_expected_byte_ = session_->next_expected_byte();
+  done_ = session_->done();
+  return last_response_;
+}
+
+StatusOr<ResumableUploadResponse>
+PipelinedResumableUploadSession::ResetSession() {
+  std::unique_lock<std::mutex> lk(mu_);
+  WaitIdle(lk);
+  lk.unlock();
+
+  last_response_ = session_->ResetSession();
+
+  lk.lock();
+  if (last_response_) {
+    // The caller must resend any data after the reported byte.
+    error_ = Status();
+    carry_.clear();
+  }
+  next_expected_byte_ = session_->next_expected_byte();
+  done_ = session_->done();
+  return last_response_;
+}
+
+std::uint64_t PipelinedResumableUploadSession::next_expected_byte() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!error_.ok()) {
+    // The background thread stops after an error, the wrapped session knows
+    // what was actually committed.
+    return session_->next_expected_byte();
+  }
+  return next_expected_byte_;
+}
+
+std::string const& PipelinedResumableUploadSession::session_id() const {
+  // The session id may change while uploading a chunk.
+  std::unique_lock<std::mutex> lk(mu_);
+  WaitIdle(lk);
+  return session_->session_id();
+}
+
+bool PipelinedResumableUploadSession::done() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return done_;
+}
+
+StatusOr<ResumableUploadResponse> const&
+PipelinedResumableUploadSession::last_response() const {
+  return last_response_;
+}
+
+void PipelinedResumableUploadSession::Run() {
+  std::unique_lock<std::mutex> lk(mu_);
+  for (;;) {
+    cv_.wait(lk, [this] { return shutdown_ || !queue_.empty(); });
+    if (shutdown_) {
+      return;
+    }
+    auto chunk = std::move(queue_.front());
+    queue_.pop_front();
+    sending_ = true;
+    lk.unlock();
+    auto status = Send(chunk);
+    lk.lock();
+    sending_ = false;
+    chunk.clear();
+    free_.push_back(std::move(chunk));
+    if (!status.ok()) {
+      error_ = std::move(status);
+      queue_.clear();
+    }
+    cv_.notify_all();
+  }
+}
+
+Status PipelinedResumableUploadSession::Send(std::string& chunk) {
+  auto constexpr kQuantum = UploadChunkRequest::kChunkSizeQuantum;
+  if (!carry_.empty()) {
+    carry_.append(chunk);
+    chunk.swap(carry_);
+    carry_.clear();
+  }
+  // Only full quanta can be uploaded before the final chunk, keep the rest
+  // until more data arrives.
+  auto const size = chunk.size() / kQuantum * kQuantum;
+  if (size != chunk.size()) {
+    carry_.assign(chunk, size, std::string::npos);
+    chunk.resize(size);
+  }
+  if (chunk.empty()) {
+    return Status();
+  }
+
+  auto const expected_start = session_->next_expected_byte();
+  auto response = session_->UploadChunk(chunk);
+  if (!response) {
+    return std::move(response).status();
+  }
+  auto const actual_next_byte = session_->next_expected_byte();
+  if (actual_next_byte < expected_start ||
+      actual_next_byte > expected_start + size) {
+    std::ostringstream os;
+    os << "Could not continue upload stream. GCS requested unexpected byte."
+       << " (expected range: [" << expected_start << ", "
+       << expected_start + size << "], actual: " << actual_next_byte << ")";
+    return Status(StatusCode::kAborted, std::move(os).str());
+  }
+  // Any uncommitted bytes are sent before the data kept from this chunk.
+  auto const committed = actual_next_byte - expected_start;
+  if (committed != size) {
+    carry_.insert(0, chunk, committed, std::string::npos);
+  }
+  return Status();
+}
+
+void PipelinedResumableUploadSession::WaitIdle(
+    std::unique_lock<std::mutex>& lk) const {
+  cv_.wait(lk, [this] { return !sending_ && queue_.empty(); });
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,110 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PIPELINED_RESUMABLE_UPLOAD_SESSION_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PIPELINED_RESUMABLE_UPLOAD_SESSION_H
+
+#include "google/cloud/storage/internal/resumable_upload_session.h"
+#include "google/cloud/storage/version.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Decorates a `ResumableUploadSession` to upload chunks in a background thread.
+ *
+ * `UploadChunk()` queues a copy of the chunk and returns immediately, unless
+ * `depth` chunks are already queued or being uploaded, in which case it waits
+ * for the oldest one to complete. This lets the application fill the next
+ * buffer while the previous one is uploaded. The response returned by
+ * `UploadChunk()` reflects the data accepted, not the data committed.
+ *
+ * Errors in the background thread are reported by the next call to
+ * `UploadChunk()` or `UploadFinalChunk()`. After an error, or once the queue is
+ * drained, `next_expected_byte()` returns the value reported by the wrapped
+ * session, so callers can resume the upload from the last committed byte.
+ *
+ * If the service commits only part of a chunk the remaining bytes are sent
+ * before any queued data.
+ */
+class PipelinedResumableUploadSession : public ResumableUploadSession {
+ public:
+  PipelinedResumableUploadSession(
+      std::unique_ptr<ResumableUploadSession> session, std::size_t depth);
+  ~PipelinedResumableUploadSession() override;
+
+  PipelinedResumableUploadSession(PipelinedResumableUploadSession const&) =
+      delete;
+  PipelinedResumableUploadSession& operator=(
+      PipelinedResumableUploadSession const&) = delete;
+
+  StatusOr<ResumableUploadResponse> UploadChunk(
+      std::string const& buffer) override;
+  StatusOr<ResumableUploadResponse> UploadChunk(
+      ConstBufferSequence const& buffers) override;
+  StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      std::string const& buffer, std::uint64_t upload_size) override;
+  StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      ConstBufferSequence const& buffers, std::uint64_t upload_size) override;
+  StatusOr<ResumableUploadResponse> ResetSession() override;
+  std::uint64_t next_expected_byte() const override;
+  std::string const& session_id() const override;
+  bool done() const override;
+  StatusOr<ResumableUploadResponse> const& last_response() const override;
+
+ private:
+  void Run();
+  Status Send(std::string& chunk);
+
+  /// Waits until the background thread is idle, must be called with `mu_`.
+  void WaitIdle(std::unique_lock<std::mutex>& lk) const;
+
+  std::unique_ptr<ResumableUploadSession> session_;
+  std::size_t const depth_;
+
+  mutable std::mutex mu_;
+  mutable std::condition_variable cv_;
+  std::deque<std::string> queue_;     // GUARDED_BY(mu_)
+  std::vector<std::string> free_;     // GUARDED_BY(mu_)
+  bool sending_ = false;              // GUARDED_BY(mu_)
+  bool shutdown_ = false;             // GUARDED_BY(mu_)
+  bool done_;                         // GUARDED_BY(mu_)
+  Status error_;                      // GUARDED_BY(mu_)
+  std::uint64_t next_expected_byte_;  // GUARDED_BY(mu_)
+
+  // Only used by the background thread, or while it is idle.
+  std::string carry_;
+
+  // Only used by the application thread.
+  StatusOr<ResumableUploadResponse> last_response_;
+
+  std::thread thread_;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PIPELINED_RESUMABLE_UPLOAD_SESSION_H
@@ -0,0 +1,159 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/pipelined_resumable_upload_session.h"
+#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <future>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+auto const kQuantum = UploadChunkRequest::kChunkSizeQuantum;
+
+class PipelinedResumableUploadSessionTest : public ::testing::Test {
+ protected:
+  PipelinedResumableUploadSessionTest()
+      : mock_(google::cloud::internal::make_unique<
+              testing::MockResumableUploadSession>()),
+        initial_response_(ResumableUploadResponse{
+            {}, 0, {}, ResumableUploadResponse::kInProgress, {}}) {
+    EXPECT_CALL(*mock_, done()).WillRepeatedly(Return(false));
+    EXPECT_CALL(*mock_, next_expected_byte()).WillRepeatedly(Invoke([this] {
+      return committed_.load();
+    }));
+    EXPECT_CALL(*mock_, session_id()).WillRepeatedly(ReturnRef(session_id_));
+    EXPECT_CALL(*mock_, last_response())
+        .WillRepeatedly(ReturnRef(initial_response_));
+  }
+
+  StatusOr<ResumableUploadResponse> Commit(std::size_t n) {
+    committed_ += n;
+    return ResumableUploadResponse{
+        {}, committed_ - 1, {}, ResumableUploadResponse::kInProgress, {}};
+  }
+
+  std::unique_ptr<testing::MockResumableUploadSession> mock_;
+  std::atomic<std::uint64_t> committed_{0};
+  std::string session_id_ = "test-session-id";
+  StatusOr<ResumableUploadResponse> initial_response_;
+};
+
+/// @test Verify that chunks are uploaded while the application continues.
+TEST_F(PipelinedResumableUploadSessionTest, UploadInBackground) {
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::vector<std::string> uploaded;
+  EXPECT_CALL(*mock_, UploadChunk(_))
+      .WillRepeatedly(Invoke([&](std::string const& buffer) {
+        released.wait();
+        uploaded.push_back(buffer.substr(0, 1));
+        return Commit(buffer.size());
+      }));
+  EXPECT_CALL(*mock_, UploadFinalChunk(_, 4 * kQuantum + 3))
+      .WillOnce(Invoke([&](std::string const& buffer, std::uint64_t) {
+        uploaded.push_back(buffer);
+        return ResumableUploadResponse{
+            {}, 4 * kQuantum + 2, {}, ResumableUploadResponse::kDone, {}};
+      }));
+
+  PipelinedResumableUploadSession tested(std::move(mock_), 2);
+  // None of these calls block, even though the first upload cannot complete.
+  auto response = tested.UploadChunk(std::string(2 * kQuantum, 'a'));
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(2 * kQuantum - 1, response->last_committed_byte);
+  ASSERT_STATUS_OK(tested.UploadChunk(std::string(kQuantum, 'b')));
+  EXPECT_EQ(3 * kQuantum, tested.next_expected_byte());
+
+  release.set_value();
+  ASSERT_STATUS_OK(tested.UploadChunk(std::string(kQuantum, 'c')));
+  response = tested.UploadFinalChunk("xyz", 4 * kQuantum + 3);
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(ResumableUploadResponse::kDone, response->upload_state);
+  EXPECT_THAT(uploaded, ElementsAre("a", "b", "c", "xyz"));
+}
+
+/// @test Verify that partially committed chunks are completed.
+TEST_F(PipelinedResumableUploadSessionTest, PartialCommit) {
+  std::vector<std::string> uploaded;
+  EXPECT_CALL(*mock_, UploadChunk(_))
+      .WillOnce(Invoke([&](std::string const& buffer) {
+        uploaded.push_back(buffer);
+        return Commit(kQuantum);
+      }))
+      .WillRepeatedly(Invoke([&](std::string const& buffer) {
+        uploaded.push_back(buffer);
+        return Commit(buffer.size());
+      }));
+  EXPECT_CALL(*mock_, UploadFinalChunk(_, 3 * kQuantum))
+      .WillOnce(Invoke([&](std::string const& buffer, std::uint64_t) {
+        uploaded.push_back(buffer);
+        return ResumableUploadResponse{
+            {}, 3 * kQuantum - 1, {}, ResumableUploadResponse::kDone, {}};
+      }));
+
+  PipelinedResumableUploadSession tested(std::move(mock_), 1);
+  auto first = std::string(kQuantum, 'a') + std::string(kQuantum, 'b');
+  ASSERT_STATUS_OK(tested.UploadChunk(first));
+  ASSERT_STATUS_OK(tested.UploadChunk(std::string(kQuantum, 'c')));
+  ASSERT_STATUS_OK(tested.UploadFinalChunk(std::string{}, 3 * kQuantum));
+
+  // The uncommitted data is sent before the next chunk.
+  auto second = std::string(kQuantum, 'b') + std::string(kQuantum, 'c');
+  EXPECT_THAT(uploaded, ElementsAre(first, second, std::string{}));
+}
+
+/// @test Verify that errors are reported by the next call.
+TEST_F(PipelinedResumableUploadSessionTest, ErrorInBackground) {
+  EXPECT_CALL(*mock_, UploadChunk(_))
+      .WillOnce(Invoke([&](std::string const& buffer) {
+        return Commit(buffer.size());
+      }))
+      .WillOnce(Return(StatusOr<ResumableUploadResponse>(PermanentError())));
+  EXPECT_CALL(*mock_, UploadFinalChunk(_, _)).Times(0);
+
+  PipelinedResumableUploadSession tested(std::move(mock_), 1);
+  ASSERT_STATUS_OK(tested.UploadChunk(std::string(kQuantum, 'a')));
+  ASSERT_STATUS_OK(tested.UploadChunk(std::string(kQuantum, 'b')));
+  auto response = tested.UploadFinalChunk("c", 2 * kQuantum + 1);
+  ASSERT_FALSE(response);
+  EXPECT_EQ(PermanentError().code(), response.status().code());
+  EXPECT_EQ(kQuantum, tested.next_expected_byte());
+  EXPECT_EQ("test-session-id", tested.session_id());
+
+  response = tested.UploadChunk(std::string(kQuantum, 'd'));
+  EXPECT_EQ(PermanentError().code(), response.status().code());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
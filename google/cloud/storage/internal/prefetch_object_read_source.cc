@@ -0,0 +1,137 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/prefetch_object_read_source.h"
+#include <algorithm>
+#include <cstring>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+PrefetchObjectReadSource::PrefetchObjectReadSource(
+    std::unique_ptr<ObjectReadSource> source, std::size_t depth,
+    std::size_t block_size)
+    : source_(std::move(source)),
+      depth_((std::max)(depth, std::size_t(1))),
+      block_size_((std::max)(block_size, std::size_t(1))) {
+  thread_ = std::thread([this] { Run(); });
+}
+
+PrefetchObjectReadSource::~PrefetchObjectReadSource() { Shutdown(); }
+
+bool PrefetchObjectReadSource::IsOpen() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return !shutdown_ && (!blocks_.empty() || !done_);
+}
+
+StatusOr<HttpResponse> PrefetchObjectReadSource::Close() {
+  Shutdown();
+  return source_->Close();
+}
+
+StatusOr<ReadSourceResult> PrefetchObjectReadSource::Read(char* buf,
+                                                          std::size_t n) {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] { return shutdown_ || done_ || !blocks_.empty(); });
+  if (blocks_.empty()) {
+    return Status(StatusCode::kFailedPrecondition,
+                  "PrefetchObjectReadSource::Read(): the download is closed");
+  }
+  auto& block = blocks_.front();
+  if (!block.result) {
+    auto status = std::move(block.result).status();
+    blocks_.pop_front();
+    return status;
+  }
+
+  auto const count =
+      (std::min)(n, block.result->bytes_received - block.offset);
+  std::memcpy(buf, block.data.data() + block.offset, count);
+  block.offset += count;
+  copy_counters_.bytes_staged += count;
+
+  // Any headers are returned with the first bytes of the block, but the
+  // status code is only returned with the last bytes: the download is not done
+  // until the application consumes all the data.
+  ReadSourceResult result{count, HttpResponse{100, {}, {}}};
+  result.response.headers.swap(block.result->response.headers);
+  if (block.offset == block.result->bytes_received) {
+    result.response.status_code = block.result->response.status_code;
+    result.response.payload = std::move(block.result->response.payload);
+    free_.push_back(std::move(block.data));
+    blocks_.pop_front();
+    lk.unlock();
+    cv_.notify_all();
+  }
+  return result;
+}
+
+ReadCopyCounters PrefetchObjectReadSource::copy_counters() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto counters = source_copy_counters_;
+  counters += copy_counters_;
+  return counters;
+}
+
+void PrefetchObjectReadSource::Run() {
+  std::unique_lock<std::mutex> lk(mu_);
+  while (true) {
+    cv_.wait(lk, [this] { return shutdown_ || blocks_.size() < depth_; });
+    if (shutdown_) {
+      break;
+    }
+    // Reuse the buffers released by `Read()`, allocating (and zero-filling) a
+    // new one for each block would cost about as much as copying the data.
+    std::vector<char> data;
+    if (!free_.empty()) {
+      data = std::move(free_.back());
+      free_.pop_back();
+    }
+    lk.unlock();
+    data.resize(block_size_);
+    auto result = source_->Read(data.data(), data.size());
+    auto counters = source_->copy_counters();
+    // In-progress downloads return 100 (CONTINUE), anything else is the last
+    // result from the source.
+    bool const last = !result || result->response.status_code != 100;
+    lk.lock();
+    source_copy_counters_ = counters;
+    blocks_.push_back(Block{std::move(data), 0, std::move(result)});
+    done_ = last;
+    cv_.notify_all();
+    if (last) {
+      break;
+    }
+  }
+}
+
+void PrefetchObjectReadSource::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
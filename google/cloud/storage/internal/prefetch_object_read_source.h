@@ -0,0 +1,91 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PREFETCH_OBJECT_READ_SOURCE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PREFETCH_OBJECT_READ_SOURCE_H
+
+#include "google/cloud/storage/internal/object_read_source.h"
+#include "google/cloud/storage/version.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Reads ahead from another `ObjectReadSource` in a background thread.
+ *
+ * The background thread reads up to `depth` blocks of `block_size` bytes from
+ * the wrapped source, while the application processes the data already
+ * received. `Read()` copies the data out of these blocks, so it seldom blocks
+ * waiting for the network.
+ *
+ * The wrapped source is only used by the background thread until `Close()`
+ * or the destructor stop it. Both wait for any pending `Read()` on the wrapped
+ * source to complete.
+ */
+class PrefetchObjectReadSource : public ObjectReadSource {
+ public:
+  PrefetchObjectReadSource(std::unique_ptr<ObjectReadSource> source,
+                           std::size_t depth, std::size_t block_size);
+  ~PrefetchObjectReadSource() override;
+
+  PrefetchObjectReadSource(PrefetchObjectReadSource const&) = delete;
+  PrefetchObjectReadSource& operator=(PrefetchObjectReadSource const&) =
+      delete;
+
+  bool IsOpen() const override;
+  StatusOr<HttpResponse> Close() override;
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override;
+  ReadCopyCounters copy_counters() const override;
+
+ private:
+  struct Block {
+    std::vector<char> data;
+    std::size_t offset;
+    StatusOr<ReadSourceResult> result;
+  };
+
+  void Run();
+  void Shutdown();
+
+  std::unique_ptr<ObjectReadSource> source_;
+  std::size_t const depth_;
+  std::size_t const block_size_;
+
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<Block> blocks_;               // GUARDED_BY(mu_)
+  std::vector<std::vector<char>> free_;    // GUARDED_BY(mu_)
+  bool done_ = false;                      // GUARDED_BY(mu_)
+  bool shutdown_ = false;                  // GUARDED_BY(mu_)
+  ReadCopyCounters source_copy_counters_;  // GUARDED_BY(mu_)
+  ReadCopyCounters copy_counters_;         // GUARDED_BY(mu_)
+
+  std::thread thread_;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_PREFETCH_OBJECT_READ_SOURCE_H
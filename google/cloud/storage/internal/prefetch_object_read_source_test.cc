@@ -0,0 +1,143 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/prefetch_object_read_source.h"
+#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <cstring>
+#include <future>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::TransientError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Pair;
+using ::testing::Return;
+using testing::MockObjectReadSource;
+
+/// Returns a `Read()` action that copies @p contents into the buffer.
+std::function<StatusOr<ReadSourceResult>(char*, std::size_t)> ReturnData(
+    std::string contents, long status_code,
+    std::multimap<std::string, std::string> headers = {}) {
+  return [contents, status_code, headers](char* buf, std::size_t n) {
+    EXPECT_GE(n, contents.size());
+    std::memcpy(buf, contents.data(), contents.size());
+    return make_status_or(ReadSourceResult{
+        contents.size(), HttpResponse{status_code, {}, headers}});
+  };
+}
+
+/// @test Verify the data, headers and status code are delivered in order.
+TEST(PrefetchObjectReadSourceTest, Simple) {
+  auto mock = google::cloud::internal::make_unique<MockObjectReadSource>();
+  EXPECT_CALL(*mock, Read(_, 4))
+      .WillOnce(Invoke(ReturnData("0123", 100, {{"x-goog-hash", "a"}})))
+      .WillOnce(Invoke(ReturnData("4567", 100)))
+      .WillOnce(Invoke(ReturnData("89", 200, {{"x-goog-generation", "7"}})));
+
+  PrefetchObjectReadSource tested(std::move(mock), 2, 4);
+  EXPECT_TRUE(tested.IsOpen());
+
+  std::string actual;
+  std::multimap<std::string, std::string> headers;
+  long status_code = 100;
+  while (status_code == 100) {
+    char buf[3];
+    auto result = tested.Read(buf, sizeof(buf));
+    ASSERT_STATUS_OK(result);
+    actual.append(buf, result->bytes_received);
+    headers.insert(result->response.headers.begin(),
+                   result->response.headers.end());
+    status_code = result->response.status_code;
+  }
+  EXPECT_EQ("0123456789", actual);
+  EXPECT_EQ(200, status_code);
+  EXPECT_THAT(headers, ::testing::UnorderedElementsAre(
+                           Pair("x-goog-hash", "a"),
+                           Pair("x-goog-generation", "7")));
+  EXPECT_FALSE(tested.IsOpen());
+  EXPECT_EQ(10, tested.copy_counters().bytes_staged);
+}
+
+/// @test Verify errors are returned after the data received before them.
+TEST(PrefetchObjectReadSourceTest, Error) {
+  auto mock = google::cloud::internal::make_unique<MockObjectReadSource>();
+  EXPECT_CALL(*mock, Read(_, 4))
+      .WillOnce(Invoke(ReturnData("0123", 100)))
+      .WillOnce(Return(TransientError()));
+
+  PrefetchObjectReadSource tested(std::move(mock), 4, 4);
+  char buf[4];
+  auto result = tested.Read(buf, sizeof(buf));
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("0123", std::string(buf, result->bytes_received));
+  EXPECT_EQ(100, result->response.status_code);
+
+  result = tested.Read(buf, sizeof(buf));
+  ASSERT_FALSE(result);
+  EXPECT_EQ(TransientError().code(), result.status().code());
+  EXPECT_FALSE(tested.IsOpen());
+}
+
+/// @test Verify the background thread does not read more than `depth` blocks.
+TEST(PrefetchObjectReadSourceTest, BoundedDepth) {
+  std::atomic<int> read_count(0);
+  std::promise<void> depth_reached;
+  auto mock = google::cloud::internal::make_unique<MockObjectReadSource>();
+  EXPECT_CALL(*mock, Read(_, 4))
+      .WillRepeatedly(Invoke([&](char* buf, std::size_t n) {
+        if (++read_count == 3) {
+          depth_reached.set_value();
+        }
+        return ReturnData("abcd", 100)(buf, n);
+      }));
+  EXPECT_CALL(*mock, Close())
+      .WillOnce(Return(make_status_or(HttpResponse{200, {}, {}})));
+
+  PrefetchObjectReadSource tested(std::move(mock), 3, 4);
+  depth_reached.get_future().get();
+  // Give the background thread a chance to (incorrectly) read more data.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(3, read_count.load());
+
+  // Consuming one block makes room for exactly one more.
+  char buf[4];
+  auto result = tested.Read(buf, sizeof(buf));
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("abcd", std::string(buf, result->bytes_received));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(4, read_count.load());
+
+  auto response = tested.Close();
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(200, response->status_code);
+  EXPECT_FALSE(tested.IsOpen());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -18,6 +18,7 @@
 #include "google/cloud/status_or.h"
 #include "google/cloud/storage/version.h"
 #include <functional>
+#include <future>
 #include <iterator>
 #include <string>
 #include <utility>
@@ -103,13 +104,23 @@ class PaginationIterator {
 template <typename T, typename Request, typename Response>
 class PaginationRange {
  public:
+  /**
+   * Creates a range that loads each page using @p loader.
+   *
+   * When @p prefetch_next_page is true, the range starts loading the next page
+   * in a background thread as soon as it receives the current one, so the
+   * latency to fetch each page overlaps with the processing of the previous
+   * page. At most one page is prefetched at a time.
+   */
   explicit PaginationRange(
       Request request,
-      std::function<StatusOr<Response>(Request const& r)> loader)
+      std::function<StatusOr<Response>(Request const& r)> loader,
+      bool prefetch_next_page = false)
       : request_(std::move(request)),
         next_page_loader_(std::move(loader)),
         next_page_token_(),
-        on_last_page_(false) {
+        on_last_page_(false),
+        prefetch_next_page_(prefetch_next_page) {
     current_ = current_page_.begin();
   }
 
@@ -148,8 +159,7 @@ class PaginationRange {
       if (on_last_page_) {
         return iterator(nullptr, past_the_end_error);
       }
-      request_.set_page_token(std::move(next_page_token_));
-      auto response = next_page_loader_(request_);
+      auto response = LoadNextPage();
       if (!response.ok()) {
         next_page_token_.clear();
         current_page_.clear();
@@ -162,6 +172,8 @@ class PaginationRange {
       current_ = current_page_.begin();
       if (next_page_token_.empty()) {
         on_last_page_ = true;
+      } else if (prefetch_next_page_) {
+        StartPrefetch();
       }
       if (current_page_.end() == current_) {
         return iterator(nullptr, past_the_end_error);
@@ -171,12 +183,32 @@ class PaginationRange {
   }
 
  private:
+  StatusOr<Response> LoadNextPage() {
+    if (prefetched_page_.valid()) {
+      next_page_token_.clear();
+      return prefetched_page_.get();
+    }
+    request_.set_page_token(std::move(next_page_token_));
+    return next_page_loader_(request_);
+  }
+
+  void StartPrefetch() {
+    request_.set_page_token(next_page_token_);
+    auto loader = next_page_loader_;
+    auto request = request_;
+    prefetched_page_ = std::async(
+        std::launch::async,
+        [loader, request]() -> StatusOr<Response> { return loader(request); });
+  }
+
   Request request_;
   std::function<StatusOr<Response>(Request const& r)> next_page_loader_;
   std::vector<T> current_page_;
   typename std::vector<T>::iterator current_;
   std::string next_page_token_;
   bool on_last_page_;
+  bool prefetch_next_page_;
+  std::future<StatusOr<Response>> prefetched_page_;
 };
 
 }  // namespace internal
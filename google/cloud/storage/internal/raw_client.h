@@ -15,10 +15,12 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_RAW_CLIENT_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_RAW_CLIENT_H
 
+#include "google/cloud/future.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
 #include "google/cloud/storage/bucket_metadata.h"
 #include "google/cloud/storage/client_options.h"
+#include "google/cloud/storage/internal/batch_request.h"
 #include "google/cloud/storage/internal/bucket_acl_requests.h"
 #include "google/cloud/storage/internal/bucket_requests.h"
 #include "google/cloud/storage/internal/default_object_acl_requests.h"
@@ -37,6 +39,7 @@
 #include "google/cloud/storage/object_metadata.h"
 #include "google/cloud/storage/service_account.h"
 #include "google/cloud/storage/version.h"
+#include <chrono>
 
 namespace google {
 namespace cloud {
@@ -175,6 +178,33 @@ class RawClient {
   virtual StatusOr<EmptyResponse> DeleteNotification(
       DeleteNotificationRequest const&) = 0;
   //@}
+
+  /**
+   * Sends the sub-requests in @p request to the batch endpoint.
+   *
+   * The returned status reports errors for the batch as a whole, the result of
+   * each sub-request is in the corresponding element of
+   * `BatchResponse::responses`.
+   */
+  virtual StatusOr<BatchResponse> ExecuteBatch(BatchRequest const&) = 0;
+
+  //@{
+  /**
+   * @name Asynchronous operations
+   *
+   * The returned futures are satisfied in a background thread, continuations
+   * attached to them run in that thread and should not block.
+   */
+  virtual future<StatusOr<ObjectMetadata>> AsyncInsertObjectMedia(
+      InsertObjectMediaRequest const&) = 0;
+  virtual future<StatusOr<ObjectMetadata>> AsyncGetObjectMetadata(
+      GetObjectMetadataRequest const&) = 0;
+  virtual future<StatusOr<std::string>> AsyncReadObject(
+      ReadObjectRangeRequest const&) = 0;
+
+  /// Returns a future satisfied once @p duration elapses.
+  virtual future<void> AsyncSleep(std::chrono::milliseconds duration) = 0;
+  //@}
 };
 
 }  // namespace internal
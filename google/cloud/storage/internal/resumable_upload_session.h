@@ -17,6 +17,7 @@
 
 #include "google/cloud/optional.h"
 #include "google/cloud/status_or.h"
+#include "google/cloud/storage/internal/const_buffer.h"
 #include "google/cloud/storage/internal/http_response.h"
 #include "google/cloud/storage/object_metadata.h"
 #include "google/cloud/storage/version.h"
@@ -47,6 +48,25 @@ class ResumableUploadSession {
   virtual StatusOr<ResumableUploadResponse> UploadChunk(
       std::string const& buffer) = 0;
 
+  /**
+   * Uploads a chunk stored in several buffers.
+   *
+   * The buffers are not copied into a single payload before they are sent,
+   * which saves a copy for callers that hold the data in several places. The
+   * buffers must remain valid until this function returns, and their total
+   * size must be a multiple of `UploadChunkRequest::kChunkSizeQuantum`.
+   *
+   * The default implementation gathers the buffers and calls
+   * `UploadChunk(std::string const&)`.
+   *
+   * @param buffers the chunk to upload.
+   * @return The result of uploading the chunk.
+   */
+  virtual StatusOr<ResumableUploadResponse> UploadChunk(
+      ConstBufferSequence const& buffers) {
+    return UploadChunk(GatherBytes(buffers));
+  }
+
   /**
    * Uploads the final chunk in a stream, committing all previous data.
    *
@@ -58,6 +78,22 @@ class ResumableUploadSession {
   virtual StatusOr<ResumableUploadResponse> UploadFinalChunk(
       std::string const& buffer, std::uint64_t upload_size) = 0;
 
+  /**
+   * Uploads the final chunk, stored in several buffers.
+   *
+   * The default implementation gathers the buffers and calls
+   * `UploadFinalChunk(std::string const&, std::uint64_t)`.
+   *
+   * @param buffers the chunk to upload.
+   * @param upload_size the total size of the upload, use `0` if the size is not
+   *   known.
+   * @return The final result of the upload, including the object metadata.
+   */
+  virtual StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      ConstBufferSequence const& buffers, std::uint64_t upload_size) {
+    return UploadFinalChunk(GatherBytes(buffers), upload_size);
+  }
+
   /// Resets the session by querying its current state.
   virtual StatusOr<ResumableUploadResponse> ResetSession() = 0;
 
@@ -128,11 +164,21 @@ class ResumableUploadSessionError : public ResumableUploadSession {
     return last_response_;
   }
 
+  StatusOr<ResumableUploadResponse> UploadChunk(
+      ConstBufferSequence const&) override {
+    return last_response_;
+  }
+
   StatusOr<ResumableUploadResponse> UploadFinalChunk(std::string const&,
                                                      std::uint64_t) override {
     return last_response_;
   }
 
+  StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      ConstBufferSequence const&, std::uint64_t) override {
+    return last_response_;
+  }
+
   StatusOr<ResumableUploadResponse> ResetSession() override {
     return last_response_;
   }
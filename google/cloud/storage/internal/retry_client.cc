@@ -17,8 +17,14 @@
 #include "google/cloud/storage/internal/raw_client_wrapper_utils.h"
 #include "google/cloud/storage/internal/retry_object_read_source.h"
 #include "google/cloud/storage/internal/retry_resumable_upload_session.h"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <thread>
+#include <utility>
+#include <vector>
 
 // Define the defaults using a pre-processor macro, this allows the application
 // developers to change the defaults for their application by compiling with
@@ -48,27 +54,122 @@ namespace {
 
 using ::google::cloud::storage::internal::raw_client_wrapper_utils::Signature;
 
+/**
+ * Returns the circuit used by a `CircuitBreakerPolicy` for @p request.
+ *
+ * Requests that refer to a bucket use a circuit per bucket, all other requests
+ * share the circuit for the service endpoint.
+ */
+template <typename Request>
+auto CircuitKey(Request const& request, int)
+    -> decltype(request.bucket_name(), std::string()) {
+  return request.bucket_name();
+}
+
+template <typename Request>
+std::string CircuitKey(Request const&, long) {  // NOLINT(google-runtime-int)
+  return std::string{};
+}
+
+template <typename Request>
+std::string CircuitKey(Request const& request) {
+  return CircuitKey(request, 0);
+}
+
+/**
+ * Reports the outcome of one attempt to a `CircuitBreakerPolicy`.
+ *
+ * If no outcome is reported, for example, because the attempt raised an
+ * exception, the destructor reports the attempt as abandoned. Otherwise a
+ * probe could leave its circuit half-open, rejecting all requests, forever.
+ */
+class CircuitBreakerAttempt {
+ public:
+  CircuitBreakerAttempt(std::shared_ptr<CircuitBreakerPolicy> breaker,
+                        std::string circuit)
+      : breaker_(std::move(breaker)), circuit_(std::move(circuit)) {}
+  ~CircuitBreakerAttempt() {
+    if (breaker_) {
+      breaker_->OnAbandoned(circuit_);
+    }
+  }
+
+  CircuitBreakerAttempt(CircuitBreakerAttempt&&) = default;
+  CircuitBreakerAttempt& operator=(CircuitBreakerAttempt&&) = delete;
+  CircuitBreakerAttempt(CircuitBreakerAttempt const&) = delete;
+  CircuitBreakerAttempt& operator=(CircuitBreakerAttempt const&) = delete;
+
+  /// Reports the outcome of the attempt, only the first call has any effect.
+  void OnResult(Status const& status) {
+    if (!breaker_) {
+      return;
+    }
+    auto breaker = std::move(breaker_);
+    // Permanent errors show the service is reachable, the request itself is
+    // invalid.
+    if (status.ok() || internal::StatusTraits::IsPermanentFailure(status)) {
+      breaker->OnSuccess(circuit_);
+    } else {
+      breaker->OnFailure(circuit_);
+    }
+  }
+
+ private:
+  std::shared_ptr<CircuitBreakerPolicy> breaker_;
+  std::string circuit_;
+};
+
+/**
+ * Reports the outcome of the first `Read()` of a download to a circuit breaker.
+ *
+ * `RawClient::ReadObject()` may not contact the service until the first
+ * `Read()`, so creating the download says nothing about the service health.
+ */
+class CircuitBreakerReadSource : public ObjectReadSource {
+ public:
+  CircuitBreakerReadSource(std::unique_ptr<ObjectReadSource> child,
+                           CircuitBreakerAttempt attempt)
+      : child_(std::move(child)), attempt_(std::move(attempt)) {}
+
+  bool IsOpen() const override { return child_->IsOpen(); }
+  StatusOr<HttpResponse> Close() override { return child_->Close(); }
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override {
+    auto result = child_->Read(buf, n);
+    attempt_.OnResult(result.status());
+    return result;
+  }
+  ReadCopyCounters copy_counters() const override {
+    return child_->copy_counters();
+  }
+
+ private:
+  std::unique_ptr<ObjectReadSource> child_;
+  CircuitBreakerAttempt attempt_;
+};
+
 /**
  * Calls a client operation with retries borrowing the RPC policies.
  *
- * @tparam MemberFunction the signature of the member function.
- * @param client the storage::Client object to make the call through.
+ * @tparam AttemptFunction the type of @p attempt.
  * @param retry_policy the policy controlling what failures are retryable, and
  *     for how long we can retry
  * @param backoff_policy the policy controlling how long to wait before
  *     retrying.
- * @param function the pointer to the member function to call.
- * @param request an initialized request parameter for the call.
+ * @param throttle the retry budget and circuit breaker shared by all calls.
+ * @param circuit the circuit breaker key for this call.
+ * @param attempt a functor making a single attempt of the operation. It
+ *     receives the `CircuitBreakerAttempt` for the attempt, and may take it
+ *     over to report the outcome later.
  * @param error_message include this message in any exception or error log.
  * @return the result from making the call;
  * @throw std::exception with a description of the last error.
  */
-template <typename MemberFunction>
-typename Signature<MemberFunction>::ReturnType MakeCall(
-    RetryPolicy& retry_policy, BackoffPolicy& backoff_policy,
-    bool is_idempotent, RawClient& client, MemberFunction function,
-    typename Signature<MemberFunction>::RequestType const& request,
-    char const* error_message) {
+template <typename AttemptFunction>
+auto MakeCallImpl(RetryPolicy& retry_policy, BackoffPolicy& backoff_policy,
+                  bool is_idempotent, RetryThrottle const& throttle,
+                  std::string const& circuit, AttemptFunction attempt,
+                  char const* error_message)
+    -> decltype(attempt(std::declval<CircuitBreakerAttempt&>())) {
   Status last_status(StatusCode::kDeadlineExceeded,
                      "Retry policy exhausted before first attempt was made.");
   auto error = [&last_status](std::string const& msg) {
@@ -76,8 +177,20 @@ typename Signature<MemberFunction>::ReturnType MakeCall(
   };
 
   while (!retry_policy.IsExhausted()) {
-    auto result = (client.*function)(request);
+    if (throttle.circuit_breaker &&
+        !throttle.circuit_breaker->AllowRequest(circuit)) {
+      std::ostringstream os;
+      os << "Circuit breaker open in " << error_message << " for <" << circuit
+         << ">, last error: " << last_status;
+      return Status(StatusCode::kUnavailable, std::move(os).str());
+    }
+    CircuitBreakerAttempt circuit_attempt(throttle.circuit_breaker, circuit);
+    auto result = attempt(circuit_attempt);
+    circuit_attempt.OnResult(result.status());
     if (result.ok()) {
+      if (throttle.budget) {
+        throttle.budget->OnSuccess();
+      }
       return result;
     }
     last_status = std::move(result).status();
@@ -99,6 +212,12 @@ typename Signature<MemberFunction>::ReturnType MakeCall(
       // Exit the loop immediately instead of sleeping before trying again.
       break;
     }
+    if (throttle.budget && !throttle.budget->OnRetry()) {
+      std::ostringstream os;
+      os << "Retry budget exhausted in " << error_message << ": "
+         << last_status;
+      return error(std::move(os).str());
+    }
     auto delay = backoff_policy.OnCompletion();
     std::this_thread::sleep_for(delay);
   }
@@ -106,6 +225,479 @@ typename Signature<MemberFunction>::ReturnType MakeCall(
   os << "Retry policy exhausted in " << error_message << ": " << last_status;
   return error(std::move(os).str());
 }
+
+/**
+ * Calls a member function of @p client with retries.
+ *
+ * @tparam MemberFunction the signature of the member function.
+ * @param client the storage::Client object to make the call through.
+ * @param function the pointer to the member function to call.
+ * @param request an initialized request parameter for the call.
+ */
+template <typename MemberFunction>
+typename Signature<MemberFunction>::ReturnType MakeCall(
+    RetryPolicy& retry_policy, BackoffPolicy& backoff_policy,
+    bool is_idempotent, RetryThrottle const& throttle, RawClient& client,
+    MemberFunction function,
+    typename Signature<MemberFunction>::RequestType const& request,
+    char const* error_message) {
+  return MakeCallImpl(
+      retry_policy, backoff_policy, is_idempotent, throttle,
+      CircuitKey(request),
+      [&client, function, &request](CircuitBreakerAttempt&) {
+        return (client.*function)(request);
+      },
+      error_message);
+}
+
+/**
+ * Makes a single attempt of a client operation, duplicating it if it is slow.
+ *
+ * The attempts use the asynchronous version of the operation, and a timer
+ * from `RawClient::AsyncSleep()` starts the second attempt if the first has
+ * not completed after the delay set by the policy, and the policy budget
+ * allows it. No threads are created. The first successful result is returned,
+ * or the last error if all the attempts fail. Once there is a result the
+ * losing attempt is cancelled, which stops its transfer.
+ */
+template <typename T, typename Request>
+class HedgedAttempt
+    : public std::enable_shared_from_this<HedgedAttempt<T, Request>> {
+ public:
+  using MemberFunction = future<StatusOr<T>> (RawClient::*)(Request const&);
+
+  HedgedAttempt(std::shared_ptr<HedgingPolicy> policy,
+                std::shared_ptr<RawClient> client, MemberFunction function,
+                Request request)
+      : policy_(std::move(policy)),
+        client_(std::move(client)),
+        function_(function),
+        request_(std::move(request)) {}
+
+  future<StatusOr<T>> Start() {
+    auto f = result_.get_future();
+    policy_->OnRequest();
+    StartAttempt(false);
+    // The timer cannot be cancelled, it must not keep this object (and the
+    // client) alive once the attempts are done.
+    std::weak_ptr<HedgedAttempt> weak = this->shared_from_this();
+    client_->AsyncSleep(policy_->HedgeDelay()).then([weak](future<void>) {
+      if (auto self = weak.lock()) {
+        self->OnHedgeDelay();
+      }
+    });
+    return f;
+  }
+
+ private:
+  void StartAttempt(bool is_hedge) {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      ++outstanding_;
+    }
+    auto self = this->shared_from_this();
+    auto const start = std::chrono::steady_clock::now();
+    auto attempt = ((*client_).*function_)(request_).then(
+        [self, start, is_hedge](future<StatusOr<T>> f) {
+          self->OnAttempt(f.get(), start, is_hedge);
+        });
+    std::unique_lock<std::mutex> lk(mu_);
+    if (!done_) {
+      attempts_.push_back(std::move(attempt));
+      return;
+    }
+    lk.unlock();
+    // The other attempt completed while this one was starting.
+    attempt.cancel();
+  }
+
+  void OnHedgeDelay() {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (done_) {
+        return;
+      }
+    }
+    if (policy_->OnHedge()) {
+      StartAttempt(true);
+    }
+  }
+
+  void OnAttempt(StatusOr<T> result,
+                 std::chrono::steady_clock::time_point start, bool is_hedge) {
+    if (result.ok()) {
+      policy_->OnAttemptSuccess(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::steady_clock::now() - start));
+    }
+    std::vector<future<void>> losers;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      --outstanding_;
+      // Once another attempt has won, the result is discarded.
+      if (done_ || (!result.ok() && outstanding_ != 0)) {
+        return;
+      }
+      done_ = true;
+      losers.swap(attempts_);
+    }
+    // Cancelling the attempt that just completed has no effect.
+    for (auto& f : losers) {
+      f.cancel();
+    }
+    if (is_hedge) {
+      policy_->OnHedgeWon();
+    }
+    result_.set_value(std::move(result));
+  }
+
+  std::shared_ptr<HedgingPolicy> policy_;
+  std::shared_ptr<RawClient> client_;
+  MemberFunction function_;
+  Request request_;
+  std::mutex mu_;
+  int outstanding_ = 0;  // GUARDED_BY(mu_)
+  bool done_ = false;    // GUARDED_BY(mu_)
+  std::vector<future<void>> attempts_;  // GUARDED_BY(mu_)
+  promise<StatusOr<T>> result_;
+};
+
+template <typename T, typename Request>
+StatusOr<T> MakeHedgedAttempt(
+    std::shared_ptr<HedgingPolicy> policy, std::shared_ptr<RawClient> client,
+    future<StatusOr<T>> (RawClient::*function)(Request const&),
+    Request const& request) {
+  auto attempt = std::make_shared<HedgedAttempt<T, Request>>(
+      std::move(policy), std::move(client), function, request);
+  return attempt->Start().get();
+}
+
+/**
+ * Races the first `Read()` of a download against a duplicate download.
+ *
+ * The original `Read()` runs in the calling thread. A timer from
+ * `RawClient::AsyncSleep()` starts a duplicate download, in a separate thread,
+ * if the original `Read()` has not completed after the delay set by the
+ * policy, and the policy budget allows it. The first successful `Read()` wins,
+ * and the other download is cancelled. If both fail the error from the
+ * original download is returned.
+ */
+class HedgedFirstRead : public std::enable_shared_from_this<HedgedFirstRead> {
+ public:
+  HedgedFirstRead(std::shared_ptr<HedgingPolicy> policy,
+                  std::shared_ptr<RawClient> client,
+                  ReadObjectRangeRequest request,
+                  std::shared_ptr<ObjectReadSource> original, std::size_t n)
+      : policy_(std::move(policy)),
+        client_(std::move(client)),
+        request_(std::move(request)),
+        original_(std::move(original)),
+        n_(n) {}
+
+  /**
+   * Reads up to `n` bytes into @p buf.
+   *
+   * Replaces @p source with the duplicate download if it wins the race.
+   */
+  StatusOr<ReadSourceResult> Run(char* buf,
+                                 std::shared_ptr<ObjectReadSource>& source) {
+    policy_->OnRequest();
+    // The timer cannot be cancelled, it must not keep this object alive once
+    // the race is over.
+    std::weak_ptr<HedgedFirstRead> weak = shared_from_this();
+    client_->AsyncSleep(policy_->HedgeDelay()).then([weak](future<void>) {
+      if (auto self = weak.lock()) {
+        self->OnHedgeDelay();
+      }
+    });
+    auto const start = std::chrono::steady_clock::now();
+    auto result = original_->Read(buf, n_);
+    OnAttemptResult(result.status(), start);
+
+    std::unique_lock<std::mutex> lk(mu_);
+    original_running_ = false;
+    if (!done_ && (result.ok() || !hedge_running_)) {
+      done_ = true;
+    }
+    cv_.wait(lk, [this] { return done_; });
+    auto hedge = hedge_;
+    auto const hedge_won = hedge_won_;
+    auto thread = std::move(thread_);
+    lk.unlock();
+    if (hedge && !hedge_won) {
+      hedge->Cancel();
+    }
+    // Without cancellation support the duplicate download runs until its
+    // first `Read()` completes.
+    if (thread.joinable()) {
+      thread.join();
+    }
+    if (!hedge_won) {
+      return result;
+    }
+    policy_->OnHedgeWon();
+    source = std::move(hedge);
+    // The thread has exited, nothing else uses the results.
+    std::copy_n(hedge_buffer_.data(), hedge_result_->bytes_received, buf);
+    return std::move(hedge_result_);
+  }
+
+ private:
+  void OnAttemptResult(Status const& status,
+                       std::chrono::steady_clock::time_point start) {
+    if (!status.ok()) {
+      return;
+    }
+    policy_->OnAttemptSuccess(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start));
+  }
+
+  void OnHedgeDelay() {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (done_ || !policy_->OnHedge()) {
+      return;
+    }
+    hedge_running_ = true;
+    auto self = shared_from_this();
+    thread_ = std::thread([self] { self->RunHedge(); });
+  }
+
+  void RunHedge() {
+    auto const start = std::chrono::steady_clock::now();
+    auto source = client_->ReadObject(request_);
+    std::shared_ptr<ObjectReadSource> hedge;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      // Once the race is over the original download only cancels a
+      // duplicate that it can see.
+      if (done_) {
+        hedge_running_ = false;
+        return;
+      }
+      if (source) {
+        hedge_ = *std::move(source);
+        hedge = hedge_;
+      }
+    }
+    std::vector<char> buffer(n_);
+    StatusOr<ReadSourceResult> result = source.status();
+    if (hedge) {
+      result = hedge->Read(buffer.data(), n_);
+    }
+    OnAttemptResult(result.status(), start);
+
+    bool cancel_original = false;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      hedge_running_ = false;
+      if (!done_ && (result.ok() || !original_running_)) {
+        done_ = true;
+        hedge_won_ = result.ok();
+        hedge_result_ = std::move(result);
+        hedge_buffer_ = std::move(buffer);
+        cancel_original = hedge_won_ && original_running_;
+      }
+      cv_.notify_one();
+    }
+    if (cancel_original) {
+      original_->Cancel();
+    }
+  }
+
+  std::shared_ptr<HedgingPolicy> policy_;
+  std::shared_ptr<RawClient> client_;
+  ReadObjectRangeRequest request_;
+  std::shared_ptr<ObjectReadSource> original_;
+  std::size_t n_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool done_ = false;                        // GUARDED_BY(mu_)
+  bool original_running_ = true;             // GUARDED_BY(mu_)
+  bool hedge_running_ = false;               // GUARDED_BY(mu_)
+  bool hedge_won_ = false;                   // GUARDED_BY(mu_)
+  std::thread thread_;                       // GUARDED_BY(mu_)
+  std::shared_ptr<ObjectReadSource> hedge_;  // GUARDED_BY(mu_)
+  StatusOr<ReadSourceResult> hedge_result_;  // GUARDED_BY(mu_)
+  std::vector<char> hedge_buffer_;           // GUARDED_BY(mu_)
+};
+
+/**
+ * Hedges the first `Read()` of a download.
+ *
+ * `RawClient::ReadObject()` may not contact the service until the first
+ * `Read()`, that is where a download waits for the service, and therefore the
+ * call worth duplicating. The following calls are forwarded to the download
+ * that won the race.
+ */
+class HedgedReadSource : public ObjectReadSource {
+ public:
+  HedgedReadSource(std::shared_ptr<HedgingPolicy> policy,
+                   std::shared_ptr<RawClient> client,
+                   ReadObjectRangeRequest request,
+                   std::unique_ptr<ObjectReadSource> child)
+      : policy_(std::move(policy)),
+        client_(std::move(client)),
+        request_(std::move(request)),
+        child_(std::move(child)) {}
+
+  bool IsOpen() const override { return child_->IsOpen(); }
+  StatusOr<HttpResponse> Close() override { return child_->Close(); }
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override {
+    if (!policy_) {
+      return child_->Read(buf, n);
+    }
+    auto race = std::make_shared<HedgedFirstRead>(
+        std::move(policy_), std::move(client_), std::move(request_), child_,
+        n);
+    return race->Run(buf, child_);
+  }
+  ReadCopyCounters copy_counters() const override {
+    return child_->copy_counters();
+  }
+  void Cancel() override { child_->Cancel(); }
+
+ private:
+  // Released after the first `Read()`.
+  std::shared_ptr<HedgingPolicy> policy_;
+  std::shared_ptr<RawClient> client_;
+  ReadObjectRangeRequest request_;
+  std::shared_ptr<ObjectReadSource> child_;
+};
+
+/**
+ * Calls an asynchronous client operation with retries.
+ *
+ * This follows the same rules as `MakeCall()`, but the backoff between
+ * attempts uses `RawClient::AsyncSleep()` instead of blocking the calling
+ * thread. The loop keeps itself alive until the returned future is satisfied.
+ */
+template <typename T, typename Request>
+class AsyncRetryLoop
+    : public std::enable_shared_from_this<AsyncRetryLoop<T, Request>> {
+ public:
+  using MemberFunction = future<StatusOr<T>> (RawClient::*)(Request const&);
+
+  AsyncRetryLoop(std::unique_ptr<RetryPolicy> retry_policy,
+                 std::unique_ptr<BackoffPolicy> backoff_policy,
+                 bool is_idempotent, RetryThrottle throttle,
+                 std::shared_ptr<RawClient> client, MemberFunction function,
+                 Request request, char const* error_message)
+      : retry_policy_(std::move(retry_policy)),
+        backoff_policy_(std::move(backoff_policy)),
+        is_idempotent_(is_idempotent),
+        throttle_(std::move(throttle)),
+        circuit_(CircuitKey(request)),
+        client_(std::move(client)),
+        function_(function),
+        request_(std::move(request)),
+        error_message_(error_message),
+        last_status_(StatusCode::kDeadlineExceeded,
+                     "Retry policy exhausted before first attempt was made.") {}
+
+  future<StatusOr<T>> Start() {
+    auto f = result_.get_future();
+    StartAttempt();
+    return f;
+  }
+
+ private:
+  void StartAttempt() {
+    if (retry_policy_->IsExhausted()) {
+      std::ostringstream os;
+      os << "Retry policy exhausted in " << error_message_ << ": "
+         << last_status_;
+      Finish(std::move(os).str());
+      return;
+    }
+    if (throttle_.circuit_breaker &&
+        !throttle_.circuit_breaker->AllowRequest(circuit_)) {
+      std::ostringstream os;
+      os << "Circuit breaker open in " << error_message_ << " for <"
+         << circuit_ << ">, last error: " << last_status_;
+      result_.set_value(Status(StatusCode::kUnavailable, std::move(os).str()));
+      return;
+    }
+    auto self = this->shared_from_this();
+    auto circuit_attempt = std::make_shared<CircuitBreakerAttempt>(
+        throttle_.circuit_breaker, circuit_);
+    ((*client_).*function_)(request_).then(
+        [self, circuit_attempt](future<StatusOr<T>> f) {
+          auto result = f.get();
+          circuit_attempt->OnResult(result.status());
+          self->OnAttempt(std::move(result));
+        });
+  }
+
+  void OnAttempt(StatusOr<T> result) {
+    if (result.ok()) {
+      if (throttle_.budget) {
+        throttle_.budget->OnSuccess();
+      }
+      result_.set_value(std::move(result));
+      return;
+    }
+    last_status_ = std::move(result).status();
+    if (!is_idempotent_) {
+      std::ostringstream os;
+      os << "Error in non-idempotent operation " << error_message_ << ": "
+         << last_status_;
+      Finish(std::move(os).str());
+      return;
+    }
+    if (!retry_policy_->OnFailure(last_status_)) {
+      std::ostringstream os;
+      if (internal::StatusTraits::IsPermanentFailure(last_status_)) {
+        os << "Permanent error in " << error_message_ << ": " << last_status_;
+      } else {
+        os << "Retry policy exhausted in " << error_message_ << ": "
+           << last_status_;
+      }
+      Finish(std::move(os).str());
+      return;
+    }
+    if (throttle_.budget && !throttle_.budget->OnRetry()) {
+      std::ostringstream os;
+      os << "Retry budget exhausted in " << error_message_ << ": "
+         << last_status_;
+      Finish(std::move(os).str());
+      return;
+    }
+    auto self = this->shared_from_this();
+    client_->AsyncSleep(backoff_policy_->OnCompletion())
+        .then([self](future<void>) { self->StartAttempt(); });
+  }
+
+  void Finish(std::string message) {
+    result_.set_value(Status(last_status_.code(), std::move(message)));
+  }
+
+  std::unique_ptr<RetryPolicy> retry_policy_;
+  std::unique_ptr<BackoffPolicy> backoff_policy_;
+  bool is_idempotent_;
+  RetryThrottle throttle_;
+  std::string circuit_;
+  std::shared_ptr<RawClient> client_;
+  MemberFunction function_;
+  Request request_;
+  std::string error_message_;
+  Status last_status_;
+  promise<StatusOr<T>> result_;
+};
+
+template <typename T, typename Request>
+future<StatusOr<T>> MakeAsyncCall(
+    std::unique_ptr<RetryPolicy> retry_policy,
+    std::unique_ptr<BackoffPolicy> backoff_policy, bool is_idempotent,
+    RetryThrottle throttle, std::shared_ptr<RawClient> client,
+    future<StatusOr<T>> (RawClient::*function)(Request const&),
+    Request const& request, char const* error_message) {
+  auto loop = std::make_shared<AsyncRetryLoop<T, Request>>(
+      std::move(retry_policy), std::move(backoff_policy), is_idempotent,
+      std::move(throttle), std::move(client), function, request,
+      error_message);
+  return loop->Start();
+}
 }  // namespace
 
 RetryClient::RetryClient(std::shared_ptr<RawClient> client, DefaultPolicies)
@@ -130,8 +722,8 @@ StatusOr<ListBucketsResponse> RetryClient::ListBuckets(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListBuckets, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::ListBuckets, request, __func__);
 }
 
 StatusOr<BucketMetadata> RetryClient::CreateBucket(
@@ -139,8 +731,8 @@ StatusOr<BucketMetadata> RetryClient::CreateBucket(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateBucket, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::CreateBucket, request, __func__);
 }
 
 StatusOr<BucketMetadata> RetryClient::GetBucketMetadata(
@@ -148,8 +740,8 @@ StatusOr<BucketMetadata> RetryClient::GetBucketMetadata(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetBucketMetadata, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::GetBucketMetadata, request, __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteBucket(
@@ -157,8 +749,8 @@ StatusOr<EmptyResponse> RetryClient::DeleteBucket(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteBucket, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::DeleteBucket, request, __func__);
 }
 
 StatusOr<BucketMetadata> RetryClient::UpdateBucket(
@@ -166,8 +758,8 @@ StatusOr<BucketMetadata> RetryClient::UpdateBucket(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateBucket, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::UpdateBucket, request, __func__);
 }
 
 StatusOr<BucketMetadata> RetryClient::PatchBucket(
@@ -175,8 +767,8 @@ StatusOr<BucketMetadata> RetryClient::PatchBucket(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::PatchBucket, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::PatchBucket, request, __func__);
 }
 
 StatusOr<IamPolicy> RetryClient::GetBucketIamPolicy(
@@ -184,8 +776,8 @@ StatusOr<IamPolicy> RetryClient::GetBucketIamPolicy(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetBucketIamPolicy, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::GetBucketIamPolicy, request, __func__);
 }
 
 StatusOr<NativeIamPolicy> RetryClient::GetNativeBucketIamPolicy(
@@ -193,8 +785,9 @@ StatusOr<NativeIamPolicy> RetryClient::GetNativeBucketIamPolicy(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetNativeBucketIamPolicy, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::GetNativeBucketIamPolicy, request,
+                  __func__);
 }
 
 StatusOr<IamPolicy> RetryClient::SetBucketIamPolicy(
@@ -202,8 +795,8 @@ StatusOr<IamPolicy> RetryClient::SetBucketIamPolicy(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::SetBucketIamPolicy, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::SetBucketIamPolicy, request, __func__);
 }
 
 StatusOr<NativeIamPolicy> RetryClient::SetNativeBucketIamPolicy(
@@ -211,8 +804,9 @@ StatusOr<NativeIamPolicy> RetryClient::SetNativeBucketIamPolicy(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::SetNativeBucketIamPolicy, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::SetNativeBucketIamPolicy, request,
+                  __func__);
 }
 
 StatusOr<TestBucketIamPermissionsResponse>
@@ -221,8 +815,9 @@ RetryClient::TestBucketIamPermissions(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::TestBucketIamPermissions, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::TestBucketIamPermissions, request,
+                  __func__);
 }
 
 StatusOr<BucketMetadata> RetryClient::LockBucketRetentionPolicy(
@@ -230,8 +825,9 @@ StatusOr<BucketMetadata> RetryClient::LockBucketRetentionPolicy(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::LockBucketRetentionPolicy, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::LockBucketRetentionPolicy, request,
+                  __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::InsertObjectMedia(
@@ -239,8 +835,8 @@ StatusOr<ObjectMetadata> RetryClient::InsertObjectMedia(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::InsertObjectMedia, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::InsertObjectMedia, request, __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::CopyObject(
@@ -248,8 +844,8 @@ StatusOr<ObjectMetadata> RetryClient::CopyObject(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CopyObject, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::CopyObject, request, __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::GetObjectMetadata(
@@ -257,16 +853,57 @@ StatusOr<ObjectMetadata> RetryClient::GetObjectMetadata(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetObjectMetadata, request, __func__);
+  if (hedging_policy_ && is_idempotent) {
+    return MakeCallImpl(
+        *retry_policy, *backoff_policy, is_idempotent, throttle_,
+        CircuitKey(request),
+        [this, &request](CircuitBreakerAttempt&) {
+          return MakeHedgedAttempt(hedging_policy_, client_,
+                                   &RawClient::AsyncGetObjectMetadata,
+                                   request);
+        },
+        __func__);
+  }
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::GetObjectMetadata, request, __func__);
 }
 
 StatusOr<std::unique_ptr<ObjectReadSource>> RetryClient::ReadObjectNotWrapped(
     ReadObjectRangeRequest const& request, RetryPolicy& retry_policy,
     BackoffPolicy& backoff_policy) {
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(retry_policy, backoff_policy, is_idempotent, *client_,
-                  &RawClient::ReadObject, request, __func__);
+  auto hedging_policy = is_idempotent ? hedging_policy_ : nullptr;
+  auto read_object = [this, &request, &hedging_policy]()
+      -> StatusOr<std::unique_ptr<ObjectReadSource>> {
+    auto source = client_->ReadObject(request);
+    if (!source || !hedging_policy) {
+      return source;
+    }
+    return std::unique_ptr<ObjectReadSource>(new HedgedReadSource(
+        hedging_policy, client_, request, *std::move(source)));
+  };
+  if (throttle_.circuit_breaker) {
+    return MakeCallImpl(
+        retry_policy, backoff_policy, is_idempotent, throttle_,
+        CircuitKey(request),
+        [&read_object](CircuitBreakerAttempt& circuit_attempt)
+            -> StatusOr<std::unique_ptr<ObjectReadSource>> {
+          auto source = read_object();
+          if (!source) {
+            return source;
+          }
+          // Report the outcome of the first Read(), moving `circuit_attempt`
+          // out leaves nothing for `MakeCallImpl()` to report.
+          return std::unique_ptr<ObjectReadSource>(new CircuitBreakerReadSource(
+              *std::move(source), std::move(circuit_attempt)));
+        },
+        __func__);
+  }
+  return MakeCallImpl(
+      retry_policy, backoff_policy, is_idempotent, throttle_,
+      CircuitKey(request),
+      [&read_object](CircuitBreakerAttempt&) { return read_object(); },
+      __func__);
 }
 
 StatusOr<std::unique_ptr<ObjectReadSource>> RetryClient::ReadObject(
@@ -288,8 +925,8 @@ StatusOr<ListObjectsResponse> RetryClient::ListObjects(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListObjects, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::ListObjects, request, __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteObject(
@@ -297,8 +934,8 @@ StatusOr<EmptyResponse> RetryClient::DeleteObject(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteObject, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::DeleteObject, request, __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::UpdateObject(
@@ -306,8 +943,8 @@ StatusOr<ObjectMetadata> RetryClient::UpdateObject(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateObject, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::UpdateObject, request, __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::PatchObject(
@@ -315,8 +952,8 @@ StatusOr<ObjectMetadata> RetryClient::PatchObject(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::PatchObject, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::PatchObject, request, __func__);
 }
 
 StatusOr<ObjectMetadata> RetryClient::ComposeObject(
@@ -324,8 +961,8 @@ StatusOr<ObjectMetadata> RetryClient::ComposeObject(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ComposeObject, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::ComposeObject, request, __func__);
 }
 
 StatusOr<RewriteObjectResponse> RetryClient::RewriteObject(
@@ -333,8 +970,8 @@ StatusOr<RewriteObjectResponse> RetryClient::RewriteObject(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::RewriteObject, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::RewriteObject, request, __func__);
 }
 
 StatusOr<std::unique_ptr<ResumableUploadSession>>
@@ -343,8 +980,8 @@ RetryClient::CreateResumableSession(ResumableUploadRequest const& request) {
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
   auto result =
-      MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-               &RawClient::CreateResumableSession, request, __func__);
+      MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+               *client_, &RawClient::CreateResumableSession, request, __func__);
   if (!result.ok()) {
     return result;
   }
@@ -360,8 +997,9 @@ RetryClient::RestoreResumableSession(std::string const& request) {
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = true;
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::RestoreResumableSession, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::RestoreResumableSession, request,
+                  __func__);
 }
 
 StatusOr<ListBucketAclResponse> RetryClient::ListBucketAcl(
@@ -369,8 +1007,8 @@ StatusOr<ListBucketAclResponse> RetryClient::ListBucketAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListBucketAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::ListBucketAcl, request, __func__);
 }
 
 StatusOr<BucketAccessControl> RetryClient::GetBucketAcl(
@@ -378,8 +1016,8 @@ StatusOr<BucketAccessControl> RetryClient::GetBucketAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetBucketAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::GetBucketAcl, request, __func__);
 }
 
 StatusOr<BucketAccessControl> RetryClient::CreateBucketAcl(
@@ -387,8 +1025,8 @@ StatusOr<BucketAccessControl> RetryClient::CreateBucketAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateBucketAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::CreateBucketAcl, request, __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteBucketAcl(
@@ -396,8 +1034,8 @@ StatusOr<EmptyResponse> RetryClient::DeleteBucketAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteBucketAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::DeleteBucketAcl, request, __func__);
 }
 
 StatusOr<ListObjectAclResponse> RetryClient::ListObjectAcl(
@@ -405,8 +1043,8 @@ StatusOr<ListObjectAclResponse> RetryClient::ListObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::ListObjectAcl, request, __func__);
 }
 
 StatusOr<BucketAccessControl> RetryClient::UpdateBucketAcl(
@@ -414,8 +1052,8 @@ StatusOr<BucketAccessControl> RetryClient::UpdateBucketAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateBucketAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::UpdateBucketAcl, request, __func__);
 }
 
 StatusOr<BucketAccessControl> RetryClient::PatchBucketAcl(
@@ -423,8 +1061,8 @@ StatusOr<BucketAccessControl> RetryClient::PatchBucketAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::PatchBucketAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::PatchBucketAcl, request, __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::CreateObjectAcl(
@@ -432,8 +1070,8 @@ StatusOr<ObjectAccessControl> RetryClient::CreateObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::CreateObjectAcl, request, __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteObjectAcl(
@@ -441,8 +1079,8 @@ StatusOr<EmptyResponse> RetryClient::DeleteObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::DeleteObjectAcl, request, __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::GetObjectAcl(
@@ -450,8 +1088,8 @@ StatusOr<ObjectAccessControl> RetryClient::GetObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::GetObjectAcl, request, __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::UpdateObjectAcl(
@@ -459,8 +1097,8 @@ StatusOr<ObjectAccessControl> RetryClient::UpdateObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::UpdateObjectAcl, request, __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::PatchObjectAcl(
@@ -468,8 +1106,8 @@ StatusOr<ObjectAccessControl> RetryClient::PatchObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::PatchObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::PatchObjectAcl, request, __func__);
 }
 
 StatusOr<ListDefaultObjectAclResponse> RetryClient::ListDefaultObjectAcl(
@@ -477,8 +1115,9 @@ StatusOr<ListDefaultObjectAclResponse> RetryClient::ListDefaultObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListDefaultObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::ListDefaultObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::CreateDefaultObjectAcl(
@@ -486,8 +1125,9 @@ StatusOr<ObjectAccessControl> RetryClient::CreateDefaultObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateDefaultObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::CreateDefaultObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteDefaultObjectAcl(
@@ -495,8 +1135,9 @@ StatusOr<EmptyResponse> RetryClient::DeleteDefaultObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteDefaultObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::DeleteDefaultObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::GetDefaultObjectAcl(
@@ -504,8 +1145,8 @@ StatusOr<ObjectAccessControl> RetryClient::GetDefaultObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetDefaultObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::GetDefaultObjectAcl, request, __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::UpdateDefaultObjectAcl(
@@ -513,8 +1154,9 @@ StatusOr<ObjectAccessControl> RetryClient::UpdateDefaultObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateDefaultObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::UpdateDefaultObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ObjectAccessControl> RetryClient::PatchDefaultObjectAcl(
@@ -522,8 +1164,9 @@ StatusOr<ObjectAccessControl> RetryClient::PatchDefaultObjectAcl(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::PatchDefaultObjectAcl, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::PatchDefaultObjectAcl, request,
+                  __func__);
 }
 
 StatusOr<ServiceAccount> RetryClient::GetServiceAccount(
@@ -531,8 +1174,8 @@ StatusOr<ServiceAccount> RetryClient::GetServiceAccount(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetServiceAccount, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::GetServiceAccount, request, __func__);
 }
 
 StatusOr<ListHmacKeysResponse> RetryClient::ListHmacKeys(
@@ -540,8 +1183,8 @@ StatusOr<ListHmacKeysResponse> RetryClient::ListHmacKeys(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListHmacKeys, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::ListHmacKeys, request, __func__);
 }
 
 StatusOr<CreateHmacKeyResponse> RetryClient::CreateHmacKey(
@@ -549,8 +1192,8 @@ StatusOr<CreateHmacKeyResponse> RetryClient::CreateHmacKey(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateHmacKey, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::CreateHmacKey, request, __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteHmacKey(
@@ -558,8 +1201,8 @@ StatusOr<EmptyResponse> RetryClient::DeleteHmacKey(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteHmacKey, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::DeleteHmacKey, request, __func__);
 }
 
 StatusOr<HmacKeyMetadata> RetryClient::GetHmacKey(
@@ -567,8 +1210,8 @@ StatusOr<HmacKeyMetadata> RetryClient::GetHmacKey(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetHmacKey, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::GetHmacKey, request, __func__);
 }
 
 StatusOr<HmacKeyMetadata> RetryClient::UpdateHmacKey(
@@ -576,8 +1219,8 @@ StatusOr<HmacKeyMetadata> RetryClient::UpdateHmacKey(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::UpdateHmacKey, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::UpdateHmacKey, request, __func__);
 }
 
 StatusOr<SignBlobResponse> RetryClient::SignBlob(
@@ -585,8 +1228,8 @@ StatusOr<SignBlobResponse> RetryClient::SignBlob(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::SignBlob, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::SignBlob, request, __func__);
 }
 
 StatusOr<ListNotificationsResponse> RetryClient::ListNotifications(
@@ -594,8 +1237,8 @@ StatusOr<ListNotificationsResponse> RetryClient::ListNotifications(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::ListNotifications, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::ListNotifications, request, __func__);
 }
 
 StatusOr<NotificationMetadata> RetryClient::CreateNotification(
@@ -603,8 +1246,8 @@ StatusOr<NotificationMetadata> RetryClient::CreateNotification(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::CreateNotification, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::CreateNotification, request, __func__);
 }
 
 StatusOr<NotificationMetadata> RetryClient::GetNotification(
@@ -612,8 +1255,8 @@ StatusOr<NotificationMetadata> RetryClient::GetNotification(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::GetNotification, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::GetNotification, request, __func__);
 }
 
 StatusOr<EmptyResponse> RetryClient::DeleteNotification(
@@ -621,8 +1264,50 @@ StatusOr<EmptyResponse> RetryClient::DeleteNotification(
   auto retry_policy = retry_policy_prototype_->clone();
   auto backoff_policy = backoff_policy_prototype_->clone();
   auto is_idempotent = idempotency_policy_->IsIdempotent(request);
-  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, *client_,
-                  &RawClient::DeleteNotification, request, __func__);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::DeleteNotification, request, __func__);
+}
+
+StatusOr<BatchResponse> RetryClient::ExecuteBatch(BatchRequest const& request) {
+  // Only failures of the batch as a whole are retried, the sub-requests that
+  // fail are reported to the caller. The batch is idempotent only if all the
+  // sub-requests are.
+  auto retry_policy = retry_policy_prototype_->clone();
+  auto backoff_policy = backoff_policy_prototype_->clone();
+  auto is_idempotent = request.IsIdempotent(*idempotency_policy_);
+  return MakeCall(*retry_policy, *backoff_policy, is_idempotent, throttle_,
+                  *client_, &RawClient::ExecuteBatch, request, __func__);
+}
+
+future<StatusOr<ObjectMetadata>> RetryClient::AsyncInsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  auto is_idempotent = idempotency_policy_->IsIdempotent(request);
+  return MakeAsyncCall(retry_policy_prototype_->clone(),
+                       backoff_policy_prototype_->clone(), is_idempotent,
+                       throttle_, client_, &RawClient::AsyncInsertObjectMedia,
+                       request, __func__);
+}
+
+future<StatusOr<ObjectMetadata>> RetryClient::AsyncGetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  auto is_idempotent = idempotency_policy_->IsIdempotent(request);
+  return MakeAsyncCall(retry_policy_prototype_->clone(),
+                       backoff_policy_prototype_->clone(), is_idempotent,
+                       throttle_, client_, &RawClient::AsyncGetObjectMetadata,
+                       request, __func__);
+}
+
+future<StatusOr<std::string>> RetryClient::AsyncReadObject(
+    ReadObjectRangeRequest const& request) {
+  auto is_idempotent = idempotency_policy_->IsIdempotent(request);
+  return MakeAsyncCall(retry_policy_prototype_->clone(),
+                       backoff_policy_prototype_->clone(), is_idempotent,
+                       throttle_, client_, &RawClient::AsyncReadObject,
+                       request, __func__);
+}
+
+future<void> RetryClient::AsyncSleep(std::chrono::milliseconds duration) {
+  return client_->AsyncSleep(duration);
 }
 
 }  // namespace internal
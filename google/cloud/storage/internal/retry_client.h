@@ -15,6 +15,7 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_RETRY_CLIENT_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_RETRY_CLIENT_H
 
+#include "google/cloud/storage/hedging_policy.h"
 #include "google/cloud/storage/idempotency_policy.h"
 #include "google/cloud/storage/internal/raw_client.h"
 #include "google/cloud/storage/internal/resumable_upload_session.h"
@@ -26,6 +27,12 @@ namespace cloud {
 namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
+/// The policies limiting the retries across all the calls of a `RetryClient`.
+struct RetryThrottle {
+  std::shared_ptr<RetryBudget> budget;
+  std::shared_ptr<CircuitBreakerPolicy> circuit_breaker;
+};
+
 /**
  * Decorates a `RawClient` to retry each operation.
  */
@@ -159,6 +166,16 @@ class RetryClient : public RawClient,
   StatusOr<EmptyResponse> DeleteNotification(
       DeleteNotificationRequest const&) override;
 
+  StatusOr<BatchResponse> ExecuteBatch(BatchRequest const& request) override;
+
+  future<StatusOr<ObjectMetadata>> AsyncInsertObjectMedia(
+      InsertObjectMediaRequest const& request) override;
+  future<StatusOr<ObjectMetadata>> AsyncGetObjectMetadata(
+      GetObjectMetadataRequest const& request) override;
+  future<StatusOr<std::string>> AsyncReadObject(
+      ReadObjectRangeRequest const& request) override;
+  future<void> AsyncSleep(std::chrono::milliseconds duration) override;
+
   std::shared_ptr<RawClient> client() const { return client_; }
 
  private:
@@ -174,6 +191,18 @@ class RetryClient : public RawClient,
     idempotency_policy_ = policy.clone();
   }
 
+  void Apply(HedgingPolicy const& policy) {
+    hedging_policy_ = std::make_shared<HedgingPolicy>(policy);
+  }
+
+  void Apply(RetryBudget const& budget) {
+    throttle_.budget = std::make_shared<RetryBudget>(budget);
+  }
+
+  void Apply(CircuitBreakerPolicy const& policy) {
+    throttle_.circuit_breaker = std::make_shared<CircuitBreakerPolicy>(policy);
+  }
+
   void ApplyPolicies() {}
 
   template <typename P, typename... Policies>
@@ -186,6 +215,8 @@ class RetryClient : public RawClient,
   std::shared_ptr<RetryPolicy const> retry_policy_prototype_;
   std::shared_ptr<BackoffPolicy const> backoff_policy_prototype_;
   std::shared_ptr<IdempotencyPolicy const> idempotency_policy_;
+  std::shared_ptr<HedgingPolicy> hedging_policy_;
+  RetryThrottle throttle_;
 };
 
 }  // namespace internal
@@ -15,8 +15,12 @@
 #include "google/cloud/storage/internal/retry_client.h"
 #include "google/cloud/storage/testing/canonical_errors.h"
 #include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
 #include "google/cloud/testing_util/chrono_literals.h"
 #include <gmock/gmock.h>
+#include <future>
+#include <stdexcept>
+#include <thread>
 
 namespace google {
 namespace cloud {
@@ -30,6 +34,7 @@ using ::google::cloud::storage::testing::canonical_errors::PermanentError;
 using ::google::cloud::storage::testing::canonical_errors::TransientError;
 using ::testing::_;
 using ::testing::HasSubstr;
+using ::testing::Invoke;
 using ::testing::Return;
 
 class RetryClientTest : public ::testing::Test {
@@ -104,6 +109,458 @@ TEST_F(RetryClientTest, ExpiredRetryPolicy) {
               HasSubstr("Retry policy exhausted before first attempt"));
 }
 
+/// @test Verify that asynchronous operations are retried, with async backoff.
+TEST_F(RetryClientTest, AsyncTransientErrorHandling) {
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock),
+                     LimitedErrorCountRetryPolicy(3),
+                     // Make the tests faster.
+                     ExponentialBackoffPolicy(1_us, 2_us, 2));
+
+  EXPECT_CALL(*mock, AsyncGetObjectMetadata(_))
+      .WillOnce(Invoke([](GetObjectMetadataRequest const&) {
+        return make_ready_future(StatusOr<ObjectMetadata>(TransientError()));
+      }))
+      .WillOnce(Invoke([](GetObjectMetadataRequest const&) {
+        return make_ready_future(StatusOr<ObjectMetadata>(TransientError()));
+      }))
+      .WillOnce(Invoke([](GetObjectMetadataRequest const&) {
+        return make_ready_future(make_status_or(ObjectMetadata{}));
+      }));
+  EXPECT_CALL(*mock, AsyncSleep(_))
+      .Times(2)
+      .WillRepeatedly(
+          Invoke([](std::chrono::milliseconds) {
+            return make_ready_future();
+          }));
+
+  auto result = client
+                    .AsyncGetObjectMetadata(
+                        GetObjectMetadataRequest("test-bucket", "test-object"))
+                    .get();
+  EXPECT_STATUS_OK(result);
+}
+
+/// @test Verify that async non-idempotent operations return on the first error.
+TEST_F(RetryClientTest, AsyncNonIdempotentErrorHandling) {
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock),
+                     LimitedErrorCountRetryPolicy(3), StrictIdempotencyPolicy(),
+                     // Make the tests faster.
+                     ExponentialBackoffPolicy(1_us, 2_us, 2));
+
+  EXPECT_CALL(*mock, AsyncInsertObjectMedia(_))
+      .WillOnce(Invoke([](InsertObjectMediaRequest const&) {
+        return make_ready_future(StatusOr<ObjectMetadata>(TransientError()));
+      }));
+  EXPECT_CALL(*mock, AsyncSleep(_)).Times(0);
+
+  auto result = client
+                    .AsyncInsertObjectMedia(InsertObjectMediaRequest(
+                        "test-bucket", "test-object", "contents"))
+                    .get();
+  ASSERT_FALSE(result);
+  EXPECT_EQ(TransientError().code(), result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("non-idempotent"));
+}
+
+/// @test Verify that the async retry loop stops on permanent errors.
+TEST_F(RetryClientTest, AsyncPermanentErrorHandling) {
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock),
+                     LimitedErrorCountRetryPolicy(3),
+                     // Make the tests faster.
+                     ExponentialBackoffPolicy(1_us, 2_us, 2));
+
+  EXPECT_CALL(*mock, AsyncReadObject(_))
+      .WillOnce(Invoke([](ReadObjectRangeRequest const&) {
+        return make_ready_future(StatusOr<std::string>(TransientError()));
+      }))
+      .WillOnce(Invoke([](ReadObjectRangeRequest const&) {
+        return make_ready_future(StatusOr<std::string>(PermanentError()));
+      }));
+  EXPECT_CALL(*mock, AsyncSleep(_))
+      .WillOnce(
+          Invoke([](std::chrono::milliseconds) {
+            return make_ready_future();
+          }));
+
+  auto result =
+      client
+          .AsyncReadObject(ReadObjectRangeRequest("test-bucket", "test-object"))
+          .get();
+  ASSERT_FALSE(result);
+  EXPECT_EQ(PermanentError().code(), result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("Permanent error"));
+}
+
+/// @test Verify that slow idempotent requests are hedged.
+TEST_F(RetryClientTest, HedgedRequest) {
+  HedgingPolicy hedging(95.0, std::chrono::milliseconds(1), 1.0);
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock),
+                     LimitedErrorCountRetryPolicy(3),
+                     ExponentialBackoffPolicy(1_us, 2_us, 2), hedging);
+
+  bool cancelled = false;
+  promise<StatusOr<ObjectMetadata>> slow([&cancelled] { cancelled = true; });
+  EXPECT_CALL(*mock, AsyncGetObjectMetadata(_))
+      .WillOnce(Invoke([&](GetObjectMetadataRequest const&) {
+        return slow.get_future();
+      }))
+      .WillOnce(Invoke([](GetObjectMetadataRequest const&) {
+        return make_ready_future(
+            ObjectMetadataParser::FromString(R"""({"name": "fast"})"""));
+      }));
+  // The hedge delay expires before the first attempt completes.
+  EXPECT_CALL(*mock, AsyncSleep(std::chrono::milliseconds(1)))
+      .WillOnce(Invoke([](std::chrono::milliseconds) {
+        return make_ready_future();
+      }));
+
+  auto result = client.GetObjectMetadata(
+      GetObjectMetadataRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("fast", result->name());
+  EXPECT_EQ(1, hedging.stats().requests);
+  EXPECT_EQ(1, hedging.stats().hedges_sent);
+  EXPECT_EQ(1, hedging.stats().hedges_won);
+  EXPECT_TRUE(cancelled);
+
+  // The result of the losing attempt is discarded.
+  slow.set_value(StatusOr<ObjectMetadata>(Status(StatusCode::kCancelled, "")));
+  EXPECT_EQ(1, hedging.stats().hedges_won);
+}
+
+/// @test Verify that fast requests are not hedged.
+TEST_F(RetryClientTest, HedgingNotNeeded) {
+  HedgingPolicy hedging(95.0, std::chrono::milliseconds(1), 1.0);
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock),
+                     LimitedErrorCountRetryPolicy(3),
+                     ExponentialBackoffPolicy(1_us, 2_us, 2), hedging);
+
+  EXPECT_CALL(*mock, AsyncGetObjectMetadata(_))
+      .WillOnce(Invoke([](GetObjectMetadataRequest const&) {
+        return make_ready_future(
+            ObjectMetadataParser::FromString(R"""({"name": "fast"})"""));
+      }));
+  promise<void> timer;
+  EXPECT_CALL(*mock, AsyncSleep(_))
+      .WillOnce(Invoke([&](std::chrono::milliseconds) {
+        return timer.get_future();
+      }));
+
+  auto const use_count = mock.use_count();
+  auto result = client.GetObjectMetadata(
+      GetObjectMetadataRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("fast", result->name());
+  // The pending timer does not keep the request, or the client, alive.
+  EXPECT_EQ(use_count, mock.use_count());
+
+  // The hedge delay expires after the request completed.
+  timer.set_value();
+  EXPECT_EQ(1, hedging.stats().requests);
+  EXPECT_EQ(0, hedging.stats().hedges_sent);
+  EXPECT_EQ(0, hedging.stats().hedges_over_budget);
+}
+
+/// @test Verify that requests are not hedged once the budget is exhausted.
+TEST_F(RetryClientTest, HedgingOverBudget) {
+  HedgingPolicy hedging(95.0, std::chrono::milliseconds(1), 0.0);
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock),
+                     LimitedErrorCountRetryPolicy(3),
+                     ExponentialBackoffPolicy(1_us, 2_us, 2), hedging);
+
+  promise<StatusOr<ObjectMetadata>> slow;
+  EXPECT_CALL(*mock, AsyncGetObjectMetadata(_))
+      .WillOnce(Invoke([&](GetObjectMetadataRequest const&) {
+        return slow.get_future();
+      }));
+  promise<void> timer;
+  EXPECT_CALL(*mock, AsyncSleep(_))
+      .WillOnce(Invoke([&](std::chrono::milliseconds) {
+        return timer.get_future();
+      }));
+
+  // Expire the hedge delay, and complete the request only after the client
+  // decided not to hedge it.
+  std::thread completer([&] {
+    timer.set_value();
+    while (hedging.stats().hedges_over_budget == 0) {
+      std::this_thread::yield();
+    }
+    slow.set_value(ObjectMetadataParser::FromString(R"""({"name": "slow"})"""));
+  });
+  auto result = client.GetObjectMetadata(
+      GetObjectMetadataRequest("test-bucket", "test-object"));
+  completer.join();
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("slow", result->name());
+  EXPECT_EQ(0, hedging.stats().hedges_sent);
+  EXPECT_EQ(1, hedging.stats().hedges_over_budget);
+}
+
+/// @test Verify that a slow first read of a download is hedged.
+TEST_F(RetryClientTest, HedgedReadObject) {
+  HedgingPolicy hedging(95.0, std::chrono::milliseconds(1), 1.0);
+  auto client = std::make_shared<RetryClient>(
+      std::shared_ptr<internal::RawClient>(mock),
+      LimitedErrorCountRetryPolicy(3), ExponentialBackoffPolicy(1_us, 2_us, 2),
+      hedging);
+
+  // The original download blocks until it is cancelled.
+  auto cancelled = std::make_shared<std::promise<void>>();
+  EXPECT_CALL(*mock, ReadObject(_))
+      .WillOnce(Invoke([cancelled](ReadObjectRangeRequest const&) {
+        std::unique_ptr<testing::MockObjectReadSource> source(
+            new testing::MockObjectReadSource);
+        EXPECT_CALL(*source, Read(_, _))
+            .WillOnce(Invoke([cancelled](char*, std::size_t)
+                                 -> StatusOr<ReadSourceResult> {
+              cancelled->get_future().wait();
+              return Status(StatusCode::kCancelled, "cancelled");
+            }));
+        EXPECT_CALL(*source, Cancel()).WillOnce(Invoke([cancelled] {
+          cancelled->set_value();
+        }));
+        return std::unique_ptr<ObjectReadSource>(std::move(source));
+      }))
+      .WillOnce(Invoke([](ReadObjectRangeRequest const&) {
+        std::unique_ptr<testing::MockObjectReadSource> source(
+            new testing::MockObjectReadSource);
+        EXPECT_CALL(*source, Read(_, _))
+            .WillOnce(Invoke([](char* buf, std::size_t n) {
+              std::string const contents = "fast";
+              EXPECT_LE(contents.size(), n);
+              contents.copy(buf, contents.size());
+              return ReadSourceResult{contents.size(),
+                                      HttpResponse{100, "", {}}};
+            }))
+            .WillOnce(Return(ReadSourceResult{0, HttpResponse{200, "", {}}}));
+        return std::unique_ptr<ObjectReadSource>(std::move(source));
+      }));
+  // The hedge delay expires before the first read completes.
+  EXPECT_CALL(*mock, AsyncSleep(std::chrono::milliseconds(1)))
+      .WillOnce(Invoke([](std::chrono::milliseconds) {
+        return make_ready_future();
+      }));
+
+  auto source =
+      client->ReadObject(ReadObjectRangeRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(source);
+  char buffer[16];
+  auto result = (*source)->Read(buffer, sizeof(buffer));
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("fast", std::string(buffer, result->bytes_received));
+  EXPECT_EQ(1, hedging.stats().requests);
+  EXPECT_EQ(1, hedging.stats().hedges_sent);
+  EXPECT_EQ(1, hedging.stats().hedges_won);
+
+  // The rest of the download uses the duplicate.
+  result = (*source)->Read(buffer, sizeof(buffer));
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ(200, result->response.status_code);
+}
+
+/// @test Verify that the duplicate download is cancelled if it loses.
+TEST_F(RetryClientTest, HedgedReadObjectLoses) {
+  HedgingPolicy hedging(95.0, std::chrono::milliseconds(1), 1.0);
+  auto client = std::make_shared<RetryClient>(
+      std::shared_ptr<internal::RawClient>(mock),
+      LimitedErrorCountRetryPolicy(3), ExponentialBackoffPolicy(1_us, 2_us, 2),
+      hedging);
+
+  // The original download completes once the duplicate is reading, which
+  // blocks until it is cancelled.
+  auto hedge_started = std::make_shared<std::promise<void>>();
+  auto cancelled = std::make_shared<std::promise<void>>();
+  EXPECT_CALL(*mock, ReadObject(_))
+      .WillOnce(Invoke([hedge_started](ReadObjectRangeRequest const&) {
+        std::unique_ptr<testing::MockObjectReadSource> source(
+            new testing::MockObjectReadSource);
+        EXPECT_CALL(*source, Read(_, _))
+            .WillOnce(Invoke([hedge_started](char*, std::size_t) {
+              hedge_started->get_future().wait();
+              return ReadSourceResult{0, HttpResponse{200, "", {}}};
+            }));
+        return std::unique_ptr<ObjectReadSource>(std::move(source));
+      }))
+      .WillOnce(Invoke([hedge_started,
+                        cancelled](ReadObjectRangeRequest const&) {
+        std::unique_ptr<testing::MockObjectReadSource> source(
+            new testing::MockObjectReadSource);
+        EXPECT_CALL(*source, Read(_, _))
+            .WillOnce(Invoke([hedge_started, cancelled](char*, std::size_t)
+                                 -> StatusOr<ReadSourceResult> {
+              hedge_started->set_value();
+              cancelled->get_future().wait();
+              return Status(StatusCode::kCancelled, "cancelled");
+            }));
+        EXPECT_CALL(*source, Cancel()).WillOnce(Invoke([cancelled] {
+          cancelled->set_value();
+        }));
+        return std::unique_ptr<ObjectReadSource>(std::move(source));
+      }));
+  EXPECT_CALL(*mock, AsyncSleep(std::chrono::milliseconds(1)))
+      .WillOnce(Invoke([](std::chrono::milliseconds) {
+        return make_ready_future();
+      }));
+
+  auto source =
+      client->ReadObject(ReadObjectRangeRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(source);
+  char buffer[16];
+  auto result = (*source)->Read(buffer, sizeof(buffer));
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ(200, result->response.status_code);
+  EXPECT_EQ(1, hedging.stats().hedges_sent);
+  EXPECT_EQ(0, hedging.stats().hedges_won);
+}
+
+/// @test Verify that fast downloads are not hedged.
+TEST_F(RetryClientTest, HedgedReadObjectNotNeeded) {
+  HedgingPolicy hedging(95.0, std::chrono::milliseconds(1), 1.0);
+  auto client = std::make_shared<RetryClient>(
+      std::shared_ptr<internal::RawClient>(mock),
+      LimitedErrorCountRetryPolicy(3), ExponentialBackoffPolicy(1_us, 2_us, 2),
+      hedging);
+
+  EXPECT_CALL(*mock, ReadObject(_))
+      .WillOnce(Invoke([](ReadObjectRangeRequest const&) {
+        std::unique_ptr<testing::MockObjectReadSource> source(
+            new testing::MockObjectReadSource);
+        EXPECT_CALL(*source, Read(_, _))
+            .WillOnce(Return(ReadSourceResult{0, HttpResponse{200, "", {}}}));
+        return std::unique_ptr<ObjectReadSource>(std::move(source));
+      }));
+  promise<void> timer;
+  EXPECT_CALL(*mock, AsyncSleep(_))
+      .WillOnce(Invoke([&](std::chrono::milliseconds) {
+        return timer.get_future();
+      }));
+
+  auto source =
+      client->ReadObject(ReadObjectRangeRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(source);
+  char buffer[16];
+  ASSERT_STATUS_OK((*source)->Read(buffer, sizeof(buffer)));
+
+  // The hedge delay expires after the first read completed.
+  timer.set_value();
+  EXPECT_EQ(1, hedging.stats().requests);
+  EXPECT_EQ(0, hedging.stats().hedges_sent);
+}
+
+/// @test Verify that retries stop once the retry budget is exhausted.
+TEST_F(RetryClientTest, RetryBudgetExhausted) {
+  RetryBudget budget(1.0, 0.5);
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock),
+                     LimitedErrorCountRetryPolicy(5),
+                     ExponentialBackoffPolicy(1_us, 2_us, 2), budget);
+
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .Times(2)
+      .WillRepeatedly(Return(StatusOr<ObjectMetadata>(TransientError())));
+
+  auto result = client.GetObjectMetadata(
+      GetObjectMetadataRequest("test-bucket", "test-object"));
+  ASSERT_FALSE(result);
+  EXPECT_EQ(TransientError().code(), result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("Retry budget exhausted"));
+  EXPECT_EQ(1, budget.stats().retries_allowed);
+  EXPECT_EQ(1, budget.stats().retries_rejected);
+}
+
+/// @test Verify that requests fail fast once the circuit breaker opens.
+TEST_F(RetryClientTest, CircuitBreakerOpen) {
+  CircuitBreakerPolicy breaker(1.0, 2, std::chrono::hours(1));
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock),
+                     LimitedErrorCountRetryPolicy(5),
+                     ExponentialBackoffPolicy(1_us, 2_us, 2), breaker);
+
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .Times(2)
+      .WillRepeatedly(Return(StatusOr<ObjectMetadata>(TransientError())));
+
+  auto result = client.GetObjectMetadata(
+      GetObjectMetadataRequest("test-bucket", "test-object"));
+  ASSERT_FALSE(result);
+  EXPECT_EQ(StatusCode::kUnavailable, result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("Circuit breaker open"));
+  EXPECT_EQ(CircuitBreakerState::kOpen, breaker.state("test-bucket"));
+
+  // Requests for other buckets are not affected.
+  EXPECT_CALL(*mock, GetBucketMetadata(_))
+      .WillOnce(Return(StatusOr<BucketMetadata>(PermanentError())));
+  auto bucket = client.GetBucketMetadata(
+      GetBucketMetadataRequest("other-bucket"));
+  EXPECT_EQ(PermanentError().code(), bucket.status().code());
+  EXPECT_EQ(CircuitBreakerState::kClosed, breaker.state("other-bucket"));
+}
+
+/// @test Verify that creating a download does not complete a probe.
+TEST_F(RetryClientTest, CircuitBreakerReadObjectProbe) {
+  CircuitBreakerPolicy breaker(1.0, 1, std::chrono::milliseconds(0));
+  auto client = std::make_shared<RetryClient>(
+      std::shared_ptr<internal::RawClient>(mock),
+      LimitedErrorCountRetryPolicy(5), ExponentialBackoffPolicy(1_us, 2_us, 2),
+      breaker);
+  breaker.OnFailure("test-bucket");
+  ASSERT_EQ(1, breaker.stats().times_opened);
+
+  EXPECT_CALL(*mock, ReadObject(_))
+      .WillOnce(Invoke([](ReadObjectRangeRequest const&) {
+        return std::unique_ptr<ObjectReadSource>(
+            new testing::MockObjectReadSource);
+      }))
+      .WillOnce(Invoke([](ReadObjectRangeRequest const&) {
+        std::unique_ptr<testing::MockObjectReadSource> source(
+            new testing::MockObjectReadSource);
+        EXPECT_CALL(*source, Read(_, _))
+            .WillOnce(Return(ReadSourceResult{0, HttpResponse{200, "", {}}}));
+        return std::unique_ptr<ObjectReadSource>(std::move(source));
+      }));
+
+  // A download closed before reading anything does not test the service.
+  {
+    auto source = client->ReadObject(
+        ReadObjectRangeRequest("test-bucket", "test-object"));
+    ASSERT_STATUS_OK(source);
+    EXPECT_FALSE(breaker.AllowRequest("test-bucket"));
+  }
+  EXPECT_EQ(2, breaker.stats().times_opened);
+
+  auto source =
+      client->ReadObject(ReadObjectRangeRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(source);
+  EXPECT_EQ(CircuitBreakerState::kHalfOpen, breaker.state("test-bucket"));
+  char buffer[16];
+  ASSERT_STATUS_OK((*source)->Read(buffer, sizeof(buffer)));
+  EXPECT_EQ(CircuitBreakerState::kClosed, breaker.state("test-bucket"));
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that a probe raising an exception opens the circuit again.
+TEST_F(RetryClientTest, CircuitBreakerProbeThrows) {
+  CircuitBreakerPolicy breaker(1.0, 1, std::chrono::milliseconds(0));
+  RetryClient client(std::shared_ptr<internal::RawClient>(mock),
+                     LimitedErrorCountRetryPolicy(5),
+                     ExponentialBackoffPolicy(1_us, 2_us, 2), breaker);
+  breaker.OnFailure("test-bucket");
+  ASSERT_EQ(1, breaker.stats().times_opened);
+
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Invoke([](GetObjectMetadataRequest const&)
+                           -> StatusOr<ObjectMetadata> {
+        throw std::runtime_error("uh-oh");
+      }));
+
+  EXPECT_THROW(client.GetObjectMetadata(
+                   GetObjectMetadataRequest("test-bucket", "test-object")),
+               std::runtime_error);
+  EXPECT_EQ(2, breaker.stats().times_opened);
+  // The circuit is not stuck half-open, another probe is allowed.
+  EXPECT_TRUE(breaker.AllowRequest("test-bucket"));
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
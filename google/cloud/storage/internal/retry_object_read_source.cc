@@ -90,6 +90,7 @@ StatusOr<ReadSourceResult> RetryObjectReadSource::Read(char* buf,
     // stalled. The current child might no longer be usable, so we will try to
     // create a new one and replace it. Should that fail, the retry policy would
     // already be exhausted, so we should fail this operation too.
+    previous_copy_counters_ += child_->copy_counters();
     child_.reset();
 
     if (has_testbench_instructions) {
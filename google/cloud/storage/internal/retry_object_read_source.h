@@ -46,6 +46,13 @@ class RetryObjectReadSource : public ObjectReadSource {
   bool IsOpen() const override { return child_ && child_->IsOpen(); }
   StatusOr<HttpResponse> Close() override { return child_->Close(); }
   StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override;
+  ReadCopyCounters copy_counters() const override {
+    auto counters = previous_copy_counters_;
+    if (child_) {
+      counters += child_->copy_counters();
+    }
+    return counters;
+  }
 
  private:
   std::shared_ptr<RetryClient> client_;
@@ -56,6 +63,8 @@ class RetryObjectReadSource : public ObjectReadSource {
   std::unique_ptr<BackoffPolicy const> backoff_policy_prototype_;
   OffsetDirection offset_direction_;
   std::int64_t current_offset_;
+  // The counters for any children discarded after a failure.
+  ReadCopyCounters previous_copy_counters_;
 };
 
 }  // namespace internal
@@ -138,6 +138,11 @@ void V4SignUrlRequest::AddMissingRequiredHeaders() {
 std::string V4SignUrlRequest::CanonicalQueryString(
     std::string const& client_id) const {
   CurlHandle curl;
+  return CanonicalQueryString(client_id, curl);
+}
+
+std::string V4SignUrlRequest::CanonicalQueryString(std::string const& client_id,
+                                                   CurlHandle& curl) const {
   // Query parameters.
   auto parameters = AllQueryParameters(client_id);
   return QueryStringFromParameters(curl, parameters);
@@ -145,36 +150,59 @@ std::string V4SignUrlRequest::CanonicalQueryString(
 
 std::string V4SignUrlRequest::CanonicalRequest(
     std::string const& client_id) const {
-  std::ostringstream os;
-
-  os << verb() << "\n";
   CurlHandle curl;
-  os << '/' << bucket_name();
+  std::string result;
+  AppendCanonicalRequest(client_id, curl, result);
+  return result;
+}
+
+void V4SignUrlRequest::AppendCanonicalRequest(std::string const& client_id,
+                                              CurlHandle& curl,
+                                              std::string& buffer) const {
+  buffer += verb();
+  buffer += '\n';
+  buffer += '/';
+  buffer += bucket_name();
   for (auto& part : ObjectNameParts()) {
-    os << '/' << curl.MakeEscapedString(part).get();
+    buffer += '/';
+    buffer += curl.MakeEscapedString(part).get();
   }
   if (!sub_resource().empty()) {
-    os << '?' << curl.MakeEscapedString(sub_resource()).get();
+    buffer += '?';
+    buffer += curl.MakeEscapedString(sub_resource()).get();
   }
-  os << "\n";
+  buffer += '\n';
 
   // Query parameters.
   auto parameters = AllQueryParameters(client_id);
-  os << QueryStringFromParameters(curl, parameters) << "\n";
+  buffer += QueryStringFromParameters(curl, parameters);
+  buffer += '\n';
 
   // Headers
   for (auto&& kv : common_request_.extension_headers()) {
-    os << kv.first << ":" << TrimHeaderValue(kv.second) << "\n";
+    buffer += kv.first;
+    buffer += ':';
+    buffer += TrimHeaderValue(kv.second);
+    buffer += '\n';
   }
-  os << "\n" << SignedHeaders() << "\n" << PayloadHashValue();
-
-  return std::move(os).str();
+  buffer += '\n';
+  buffer += SignedHeaders();
+  buffer += '\n';
+  buffer += PayloadHashValue();
 }
 
 std::string V4SignUrlRequest::StringToSign(std::string const& client_id) const {
+  CurlHandle curl;
+  std::string buffer;
+  return StringToSign(client_id, curl, buffer);
+}
+
+std::string V4SignUrlRequest::StringToSign(std::string const& client_id,
+                                           CurlHandle& curl,
+                                           std::string& buffer) const {
   return "GOOG4-RSA-SHA256\n" +
          google::cloud::internal::FormatV4SignedUrlTimestamp(timestamp_) +
-         "\n" + Scope() + "\n" + CanonicalRequestHash(client_id);
+         "\n" + Scope() + "\n" + CanonicalRequestHash(client_id, curl, buffer);
 }
 
 std::chrono::system_clock::time_point V4SignUrlRequest::DefaultTimestamp() {
@@ -186,8 +214,10 @@ std::chrono::seconds V4SignUrlRequest::DefaultExpires() {
 }
 
 std::string V4SignUrlRequest::CanonicalRequestHash(
-    std::string const& client_id) const {
-  return HexEncode(Sha256Hash(CanonicalRequest(client_id)));
+    std::string const& client_id, CurlHandle& curl, std::string& buffer) const {
+  buffer.clear();
+  AppendCanonicalRequest(client_id, curl, buffer);
+  return HexEncode(Sha256Hash(buffer));
 }
 
 std::string V4SignUrlRequest::Scope() const {
@@ -209,7 +239,6 @@ V4SignUrlRequest::CanonicalQueryParameters(std::string const& client_id) const {
 
 std::multimap<std::string, std::string> V4SignUrlRequest::AllQueryParameters(
     std::string const& client_id) const {
-  CurlHandle curl;
   // Query parameters.
   auto parameters = common_request_.query_parameters();
   auto canonical_parameters = CanonicalQueryParameters(client_id);
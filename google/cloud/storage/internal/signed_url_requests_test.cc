@@ -15,6 +15,7 @@
 #include "google/cloud/storage/internal/signed_url_requests.h"
 #include "google/cloud/internal/format_time_point.h"
 #include "google/cloud/internal/parse_rfc3339.h"
+#include "google/cloud/storage/internal/curl_handle.h"
 #include <gmock/gmock.h>
 
 namespace google {
@@ -439,6 +440,30 @@ UNSIGNED-PAYLOAD)""";
   EXPECT_THAT(os.str(), HasSubstr("/test-bucket/test-object/path/to/object"));
 }
 
+/// @test Verify reusing the handle and buffer produces the same results.
+TEST(V4SignedUrlRequests, StringToSignReuseBuffers) {
+  V4SignUrlRequest request("GET", "test-bucket", "");
+  std::string const date = "2019-02-01T09:00:00Z";
+  request.set_multiple_options(
+      SignedUrlTimestamp(google::cloud::internal::ParseRfc3339(date)),
+      SignedUrlDuration(std::chrono::seconds(10)),
+      AddExtensionHeader("Content-Type", "application/octet-stream"));
+  request.AddMissingRequiredHeaders();
+
+  CurlHandle curl;
+  std::string buffer;
+  for (std::string name : {"test-object", "path/to/object_?foo=&bar", ""}) {
+    SCOPED_TRACE("Testing with name=" + name);
+    request.set_object_name(name);
+    EXPECT_EQ(name, request.object_name());
+    EXPECT_EQ(request.StringToSign("fake-client-id"),
+              request.StringToSign("fake-client-id", curl, buffer));
+    EXPECT_EQ(request.CanonicalRequest("fake-client-id"), buffer);
+    EXPECT_EQ(request.CanonicalQueryString("fake-client-id"),
+              request.CanonicalQueryString("fake-client-id", curl));
+  }
+}
+
 TEST(DefaultCtorsWork, Trivial) {
   EXPECT_FALSE(ExpirationTime().has_value());
   EXPECT_FALSE(AddExtensionHeaderOption().has_value());
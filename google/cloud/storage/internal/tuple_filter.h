@@ -19,6 +19,7 @@
 #include "google/cloud/internal/invoke_result.h"
 #include "google/cloud/internal/tuple.h"
 #include "google/cloud/internal/utility.h"
+#include "google/cloud/optional.h"
 #include "google/cloud/storage/version.h"
 #include <tuple>
 #include <type_traits>
@@ -167,6 +168,31 @@ struct NotAmong {
                 std::is_same<typename std::decay<T>::type, Types>...>::value>;
 };
 
+/**
+ * Return an empty option if Tuple contains an element of type T, otherwise
+ *     return the value of the first element of type T
+ */
+template <typename T, typename Tuple, typename Enable = void>
+struct ExtractFirstOccurenceOfTypeImpl {
+  optional<T> operator()(Tuple const&) { return optional<T>(); }
+};
+
+template <typename T, typename... Options>
+struct ExtractFirstOccurenceOfTypeImpl<
+    T, std::tuple<Options...>,
+    typename std::enable_if<
+        Among<typename std::decay<Options>::type...>::template TPred<
+            typename std::decay<T>::type>::value>::type> {
+  optional<T> operator()(std::tuple<Options...> const& tuple) {
+    return std::get<0>(StaticTupleFilter<Among<T>::template TPred>(tuple));
+  }
+};
+
+template <typename T, typename Tuple>
+optional<T> ExtractFirstOccurenceOfType(Tuple const& tuple) {
+  return ExtractFirstOccurenceOfTypeImpl<T, Tuple>()(tuple);
+}
+
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
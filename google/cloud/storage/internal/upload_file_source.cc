@@ -0,0 +1,162 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/upload_file_source.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif  // _WIN32
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+Status FileError(StatusCode code, char const* where, char const* what,
+                 std::string const& file_name) {
+  auto const error = errno;
+  std::ostringstream os;
+  os << where << "(" << file_name << "): " << what
+     << " failed, error=" << ::strerror(error) << " [" << error << "]";
+  return Status(code, std::move(os).str());
+}
+
+void CloseFile(int fd) {
+#ifdef _WIN32
+  (void)::_close(fd);
+#else
+  (void)::close(fd);
+#endif  // _WIN32
+}
+}  // namespace
+
+StatusOr<std::unique_ptr<UploadFileSource>> UploadFileSource::Open(
+    std::string file_name) {
+#ifdef _WIN32
+  auto const fd = ::_open(file_name.c_str(), _O_RDONLY | _O_BINARY);
+#else
+  auto const fd = ::open(file_name.c_str(), O_RDONLY);
+#endif  // _WIN32
+  if (fd == -1) {
+    return FileError(StatusCode::kNotFound, __func__, "open()", file_name);
+  }
+  // Use the descriptor, and not the name, to get the size. The file may be
+  // replaced after it is opened.
+#ifdef _WIN32
+  struct _stat64 info;
+  auto const result = ::_fstat64(fd, &info);
+#else
+  struct stat info;
+  auto const result = ::fstat(fd, &info);
+#endif  // _WIN32
+  if (result != 0) {
+    auto status =
+        FileError(StatusCode::kUnknown, __func__, "fstat()", file_name);
+    CloseFile(fd);
+    return status;
+  }
+  auto const size = static_cast<std::uint64_t>(info.st_size);
+  return std::unique_ptr<UploadFileSource>(
+      new UploadFileSource(std::move(file_name), fd, size));
+}
+
+UploadFileSource::~UploadFileSource() { CloseFile(fd_); }
+
+StatusOr<std::size_t> UploadFileSource::ReadAt(std::uint64_t offset,
+                                               char* buffer,
+                                               std::size_t size) {
+  std::size_t count = 0;
+#ifdef _WIN32
+  if (::_lseeki64(fd_, static_cast<__int64>(offset), SEEK_SET) == -1) {
+    return FileError(StatusCode::kUnknown, __func__, "_lseeki64()",
+                     file_name_);
+  }
+  while (count != size) {
+    auto n = ::_read(fd_, buffer + count,
+                     static_cast<unsigned int>(size - count));
+    if (n < 0) {
+      return FileError(StatusCode::kUnknown, __func__, "_read()", file_name_);
+    }
+    if (n == 0) {
+      break;
+    }
+    count += static_cast<std::size_t>(n);
+  }
+#else
+  while (count != size) {
+    auto n = ::pread(fd_, buffer + count, size - count,
+                     static_cast<off_t>(offset + count));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return FileError(StatusCode::kUnknown, __func__, "pread()", file_name_);
+    }
+    if (n == 0) {
+      break;
+    }
+    count += static_cast<std::size_t>(n);
+  }
+#endif  // _WIN32
+  // Only the data past `observed_` is new, the reads before it come from
+  // libcurl rewinding the upload.
+  if (observer_ && offset <= observed_ && offset + count > observed_) {
+    auto const skip = static_cast<std::size_t>(observed_ - offset);
+    auto status = observer_(buffer + skip, count - skip);
+    if (!status.ok()) {
+      return status;
+    }
+    observed_ = offset + count;
+  }
+  return count;
+}
+
+void BlockSearch::Update(char const* data, std::size_t size) {
+  if (found_ || needle_.empty()) {
+    return;
+  }
+  auto const keep = needle_.size() - 1;
+  // First search for matches that start in the previous blocks and end in
+  // this one, then for matches fully contained in this block.
+  auto straddle = tail_;
+  straddle.append(data, (std::min)(size, keep));
+  if (straddle.find(needle_) != std::string::npos ||
+      std::search(data, data + size, needle_.begin(), needle_.end()) !=
+          data + size) {
+    found_ = true;
+    return;
+  }
+  if (size >= keep) {
+    tail_.assign(data + size - keep, keep);
+  } else if (straddle.size() > keep) {
+    tail_ = straddle.substr(straddle.size() - keep);
+  } else {
+    tail_ = std::move(straddle);
+  }
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,123 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_FILE_SOURCE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_FILE_SOURCE_H
+
+#include "google/cloud/status_or.h"
+#include "google/cloud/storage/version.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/**
+ * Reads the contents of a file uploaded by `Client::UploadFile()`.
+ *
+ * The size is obtained from the open file descriptor, so it always refers to
+ * the same file as the data. Reads are positional, the upload can restart
+ * from any offset (e.g. when libcurl needs to resend the request).
+ */
+class UploadFileSource {
+ public:
+  /// Opens @p file_name, returns `kNotFound` if the file cannot be opened.
+  static StatusOr<std::unique_ptr<UploadFileSource>> Open(
+      std::string file_name);
+
+  ~UploadFileSource();
+
+  UploadFileSource(UploadFileSource const&) = delete;
+  UploadFileSource& operator=(UploadFileSource const&) = delete;
+
+  std::string const& file_name() const { return file_name_; }
+
+  /// The size of the file when it was opened.
+  std::uint64_t size() const { return size_; }
+
+  /**
+   * Reads up to @p size bytes starting at @p offset.
+   *
+   * @return the number of bytes read, which is smaller than @p size only if
+   *     the end of the file is reached.
+   */
+  StatusOr<std::size_t> ReadAt(std::uint64_t offset, char* buffer,
+                               std::size_t size);
+
+  /// Called with the data read from the file, see `set_observer()`.
+  using Observer = std::function<Status(char const*, std::size_t)>;
+
+  /**
+   * Calls @p observer with the data returned by `ReadAt()`.
+   *
+   * Each byte is observed only the first time it is read, in order, so the
+   * observer sees the file contents exactly once even if libcurl rewinds the
+   * upload. This is used to compute the hashes and to check the multipart
+   * boundary while the file is uploaded. An error from @p observer is returned
+   * by `ReadAt()`. Setting a new observer restarts from the beginning of the
+   * file.
+   */
+  void set_observer(Observer observer) {
+    observer_ = std::move(observer);
+    observed_ = 0;
+  }
+
+ private:
+  UploadFileSource(std::string file_name, int fd, std::uint64_t size)
+      : file_name_(std::move(file_name)), fd_(fd), size_(size) {}
+
+  std::string file_name_;
+  int fd_;
+  std::uint64_t size_;
+  Observer observer_;
+  std::uint64_t observed_ = 0;
+};
+
+/**
+ * Searches for a string in data received as a sequence of blocks.
+ *
+ * Multipart uploads need a boundary that does not appear in the object
+ * contents. For files this is checked while the file is uploaded, without
+ * loading the file in memory.
+ */
+class BlockSearch {
+ public:
+  explicit BlockSearch(std::string needle) : needle_(std::move(needle)) {}
+
+  /// Searches the next block, the search stops once the string is found.
+  void Update(char const* data, std::size_t size);
+
+  /// Returns true if the string appears in the blocks seen so far.
+  bool found() const { return found_; }
+
+ private:
+  std::string needle_;
+  std::string tail_;
+  bool found_ = false;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_FILE_SOURCE_H
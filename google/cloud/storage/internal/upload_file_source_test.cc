@@ -0,0 +1,145 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/upload_file_source.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <fstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(UploadFileSourceTest, OpenMissing) {
+  auto file = UploadFileSource::Open("/not-a-directory/not-a-file");
+  ASSERT_FALSE(file);
+  EXPECT_EQ(StatusCode::kNotFound, file.status().code());
+  EXPECT_THAT(file.status().message(),
+              HasSubstr("/not-a-directory/not-a-file"));
+}
+
+TEST(UploadFileSourceTest, ReadAt) {
+  testing::TempFile temp_file("0123456789");
+  auto file = UploadFileSource::Open(temp_file.name());
+  ASSERT_STATUS_OK(file);
+  EXPECT_EQ(temp_file.name(), (*file)->file_name());
+  EXPECT_EQ(10, (*file)->size());
+
+  char buffer[16];
+  auto n = (*file)->ReadAt(3, buffer, 4);
+  ASSERT_STATUS_OK(n);
+  EXPECT_EQ("3456", std::string(buffer, *n));
+
+  // Reading past the end returns the available bytes.
+  n = (*file)->ReadAt(8, buffer, sizeof(buffer));
+  ASSERT_STATUS_OK(n);
+  EXPECT_EQ("89", std::string(buffer, *n));
+  n = (*file)->ReadAt(10, buffer, sizeof(buffer));
+  ASSERT_STATUS_OK(n);
+  EXPECT_EQ(0, *n);
+
+  // Positional reads can go back to any offset.
+  n = (*file)->ReadAt(0, buffer, 2);
+  ASSERT_STATUS_OK(n);
+  EXPECT_EQ("01", std::string(buffer, *n));
+}
+
+TEST(UploadFileSourceTest, SizeFromOpenFile) {
+  testing::TempFile temp_file("0123456789");
+  auto file = UploadFileSource::Open(temp_file.name());
+  ASSERT_STATUS_OK(file);
+  // Changes to the file after it is opened do not change the size.
+  std::ofstream(temp_file.name(), std::ios::binary | std::ios::app) << "abc";
+  EXPECT_EQ(10, (*file)->size());
+}
+
+TEST(UploadFileSourceTest, ObserverSeesDataOnce) {
+  testing::TempFile temp_file("0123456789");
+  auto file = UploadFileSource::Open(temp_file.name());
+  ASSERT_STATUS_OK(file);
+  std::string observed;
+  (*file)->set_observer([&observed](char const* data, std::size_t size) {
+    observed.append(data, size);
+    return Status();
+  });
+  char buffer[8];
+  ASSERT_STATUS_OK((*file)->ReadAt(0, buffer, 4));
+  // Rewinding, as libcurl does to resend the upload, only observes the data
+  // not seen before.
+  ASSERT_STATUS_OK((*file)->ReadAt(0, buffer, 6));
+  ASSERT_STATUS_OK((*file)->ReadAt(6, buffer, 8));
+  EXPECT_EQ("0123456789", observed);
+}
+
+TEST(UploadFileSourceTest, ObserverError) {
+  testing::TempFile temp_file("0123456789");
+  auto file = UploadFileSource::Open(temp_file.name());
+  ASSERT_STATUS_OK(file);
+  (*file)->set_observer([](char const*, std::size_t) {
+    return Status(StatusCode::kAborted, "test-message");
+  });
+  char buffer[4];
+  auto n = (*file)->ReadAt(0, buffer, sizeof(buffer));
+  ASSERT_FALSE(n);
+  EXPECT_EQ(StatusCode::kAborted, n.status().code());
+  EXPECT_EQ("test-message", n.status().message());
+}
+
+TEST(BlockSearchTest, NotFound) {
+  BlockSearch search("abcd");
+  search.Update("xxabc", 5);
+  search.Update("xbcdx", 5);
+  search.Update("", 0);
+  EXPECT_FALSE(search.found());
+}
+
+TEST(BlockSearchTest, FoundInBlock) {
+  BlockSearch search("abcd");
+  search.Update("xxxxx", 5);
+  search.Update("xabcdx", 6);
+  EXPECT_TRUE(search.found());
+}
+
+TEST(BlockSearchTest, FoundAcrossBlocks) {
+  BlockSearch search("abcd");
+  search.Update("xxxab", 5);
+  EXPECT_FALSE(search.found());
+  search.Update("cdxxx", 5);
+  EXPECT_TRUE(search.found());
+}
+
+TEST(BlockSearchTest, FoundAcrossSmallBlocks) {
+  std::string const text = "xxxabcdxxx";
+  for (std::size_t size = 1; size != 5; ++size) {
+    BlockSearch search("abcd");
+    for (std::size_t offset = 0; offset < text.size(); offset += size) {
+      search.Update(text.data() + offset,
+                    (std::min)(size, text.size() - offset));
+    }
+    EXPECT_TRUE(search.found()) << "size=" << size;
+  }
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
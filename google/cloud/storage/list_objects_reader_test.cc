@@ -18,6 +18,8 @@
 #include "google/cloud/storage/testing/mock_client.h"
 #include "google/cloud/testing_util/assert_ok.h"
 #include <gmock/gmock.h>
+#include <condition_variable>
+#include <mutex>
 
 namespace google {
 namespace cloud {
@@ -157,6 +159,71 @@ TEST(ListObjectsReaderTest, PermanentFailure) {
   EXPECT_THAT(actual, ContainerEq(expected));
 }
 
+TEST(ListObjectsReaderTest, Prefetch) {
+  int const page_count = 3;
+  std::vector<ObjectMetadata> expected;
+  for (int i = 0; i != 2 * page_count; ++i) {
+    expected.emplace_back(CreateElement(i));
+  }
+
+  std::mutex mu;
+  std::condition_variable cv;
+  std::vector<std::string> tokens;
+  auto loader = [&](ListObjectsRequest const& r) {
+    std::unique_lock<std::mutex> lk(mu);
+    auto const i = static_cast<int>(tokens.size());
+    tokens.push_back(r.page_token());
+    lk.unlock();
+    cv.notify_all();
+    ListObjectsResponse response;
+    if (i != page_count - 1) {
+      response.next_page_token = "page-" + std::to_string(i);
+    }
+    response.items.emplace_back(CreateElement(2 * i));
+    response.items.emplace_back(CreateElement(2 * i + 1));
+    return make_status_or(std::move(response));
+  };
+
+  ListObjectsReader reader(ListObjectsRequest("foo-bar-baz"), loader, true);
+  auto it = reader.begin();
+  {
+    // The second page is requested before the first one is consumed.
+    std::unique_lock<std::mutex> lk(mu);
+    cv.wait(lk, [&] { return tokens.size() == 2; });
+  }
+  std::vector<ObjectMetadata> actual;
+  for (; it != reader.end(); ++it) {
+    ASSERT_STATUS_OK(*it);
+    actual.emplace_back(**it);
+  }
+  EXPECT_THAT(actual, ContainerEq(expected));
+  EXPECT_THAT(tokens, ::testing::ElementsAre("", "page-0", "page-1"));
+}
+
+TEST(ListObjectsReaderTest, PrefetchPermanentFailure) {
+  auto mock = std::make_shared<MockClient>();
+  EXPECT_CALL(*mock, ListObjects(_))
+      .WillOnce(Invoke([](ListObjectsRequest const&) {
+        ListObjectsResponse response;
+        response.next_page_token = "page-0";
+        response.items.emplace_back(CreateElement(0));
+        return make_status_or(std::move(response));
+      }))
+      .WillOnce(Invoke([](ListObjectsRequest const& r) {
+        EXPECT_EQ("page-0", r.page_token());
+        return StatusOr<ListObjectsResponse>(PermanentError());
+      }));
+
+  ListObjectsReader reader(
+      ListObjectsRequest("test-bucket"),
+      [mock](ListObjectsRequest const& r) { return mock->ListObjects(r); },
+      true);
+  std::vector<StatusOr<ObjectMetadata>> actual(reader.begin(), reader.end());
+  ASSERT_EQ(2, actual.size());
+  EXPECT_STATUS_OK(actual[0]);
+  EXPECT_EQ(PermanentError().code(), actual[1].status().code());
+}
+
 TEST(ListObjectsReaderTest, IteratorCompare) {
   // Create a synthetic list of ObjectMetadata elements, each request will
   // return 2 of them.
@@ -0,0 +1,54 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_METADATA_CACHE_COUNTERS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_METADATA_CACHE_COUNTERS_H
+
+#include "google/cloud/storage/version.h"
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * The counters for the client-side metadata cache, used for monitoring.
+ *
+ * @see `Client::metadata_cache_counters()`
+ */
+struct MetadataCacheCounters {
+  /// The number of requests served from the cache.
+  std::uint64_t hits = 0;
+  /// The number of requests sent to the service.
+  std::uint64_t misses = 0;
+  /// The number of requests that waited for an identical in-flight request.
+  std::uint64_t coalesced = 0;
+  /// The number of times a group of entries was invalidated.
+  std::uint64_t invalidations = 0;
+
+  MetadataCacheCounters& operator+=(MetadataCacheCounters const& rhs) {
+    hits += rhs.hits;
+    misses += rhs.misses;
+    coalesced += rhs.coalesced;
+    invalidations += rhs.invalidations;
+    return *this;
+  }
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_METADATA_CACHE_COUNTERS_H
@@ -23,7 +23,6 @@
 #include "google/cloud/storage/oauth2/refreshing_credentials_wrapper.h"
 #include "google/cloud/storage/version.h"
 #include <iostream>
-#include <mutex>
 
 namespace google {
 namespace cloud {
@@ -93,7 +92,6 @@ class AuthorizedUserCredentials : public Credentials {
   }
 
   StatusOr<std::string> AuthorizationHeader() override {
-    std::unique_lock<std::mutex> lock(mu_);
     return refreshing_creds_.AuthorizationHeader(clock_.now(),
                                                  [this] { return Refresh(); });
   }
@@ -113,7 +111,7 @@ class AuthorizedUserCredentials : public Credentials {
   ClockType clock_;
   typename HttpRequestBuilderType::RequestType request_;
   std::string payload_;
-  mutable std::mutex mu_;
+  // Must be the last member, the destructor waits for any background refresh.
   RefreshingCredentialsWrapper refreshing_creds_;
 };
 
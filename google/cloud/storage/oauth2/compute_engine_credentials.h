@@ -84,9 +84,10 @@ class ComputeEngineCredentials : public Credentials {
       : clock_(), service_account_email_(service_account_email) {}
 
   StatusOr<std::string> AuthorizationHeader() override {
-    std::unique_lock<std::mutex> lock(mu_);
-    return refreshing_creds_.AuthorizationHeader(clock_.now(),
-                                                 [this] { return Refresh(); });
+    return refreshing_creds_.AuthorizationHeader(clock_.now(), [this] {
+      std::unique_lock<std::mutex> lock(mu_);
+      return Refresh();
+    });
   }
 
   std::string AccountEmail() const override {
@@ -195,9 +196,10 @@ class ComputeEngineCredentials : public Credentials {
 
   ClockType clock_;
   mutable std::mutex mu_;
-  RefreshingCredentialsWrapper refreshing_creds_;
   mutable std::set<std::string> scopes_;
   mutable std::string service_account_email_;
+  // Must be the last member, the destructor waits for any background refresh.
+  RefreshingCredentialsWrapper refreshing_creds_;
 };
 
 }  // namespace oauth2
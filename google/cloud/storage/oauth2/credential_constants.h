@@ -50,12 +50,35 @@ constexpr std::chrono::seconds GoogleOAuthAccessTokenExpirationSlack() {
   return std::chrono::seconds(500);
 }
 
+/**
+ * Returns the fraction of the time an access token is valid after which it is
+ * refreshed in the background.
+ *
+ * A token is valid until `GoogleOAuthAccessTokenExpirationSlack()` before it
+ * expires.
+ *
+ * Refreshing before the token expires keeps the (slow) requests to the token
+ * endpoint off the critical path of the requests that use the token.
+ */
+constexpr double GoogleOAuthAccessTokenRefreshFraction() { return 0.75; }
+
+/// How long to wait before retrying a failed background token refresh.
+constexpr std::chrono::seconds GoogleOAuthAccessTokenRefreshRetryDelay() {
+  return std::chrono::seconds(30);
+}
+
 /// The endpoint to fetch an OAuth 2.0 access token from.
 inline char const* GoogleOAuthRefreshEndpoint() {
   static constexpr char kEndpoint[] = "https://oauth2.googleapis.com/token";
   return kEndpoint;
 }
 
+/// The audience for self-signed JWTs used to access Google Cloud Storage.
+inline char const* GoogleOAuthSelfSignedJwtStorageAudience() {
+  static constexpr char kAudience[] = "https://storage.googleapis.com/";
+  return kAudience;
+}
+
 /// String representing the "cloud-platform" OAuth 2.0 scope.
 inline char const* GoogleOAuthScopeCloudPlatform() {
   static constexpr char kScope[] =
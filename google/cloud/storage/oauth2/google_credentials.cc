@@ -318,6 +318,18 @@ CreateServiceAccountCredentialsFromJsonContents(
       std::make_shared<ServiceAccountCredentials<>>(*info));
 }
 
+StatusOr<std::shared_ptr<Credentials>>
+CreateSelfSignedServiceAccountCredentialsFromJsonContents(
+    std::string const& contents, std::string audience) {
+  auto info = ParseServiceAccountCredentials(contents, "memory");
+  if (!info) {
+    return StatusOr<std::shared_ptr<Credentials>>(info.status());
+  }
+  info->self_signed_jwt_audience = std::move(audience);
+  return StatusOr<std::shared_ptr<Credentials>>(
+      std::make_shared<ServiceAccountCredentials<>>(*info));
+}
+
 std::shared_ptr<Credentials> CreateComputeEngineCredentials() {
   return std::make_shared<ComputeEngineCredentials<>>();
 }
@@ -16,6 +16,7 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OAUTH2_GOOGLE_CREDENTIALS_H
 
 #include "google/cloud/optional.h"
+#include "google/cloud/storage/oauth2/credential_constants.h"
 #include "google/cloud/storage/oauth2/credentials.h"
 #include "google/cloud/storage/version.h"
 #include <memory>
@@ -256,6 +257,27 @@ CreateServiceAccountCredentialsFromJsonContents(
     google::cloud::optional<std::set<std::string>> scopes,
     google::cloud::optional<std::string> subject);
 
+/**
+ * Creates a ServiceAccountCredentials with self-signed JWTs from a JSON string.
+ *
+ * These credentials never contact the Google Authorization Service: the access
+ * token is a JWT signed with the service account key, with @p audience as its
+ * "aud" claim. The token is cached and re-signed shortly before it expires.
+ *
+ * @param contents the string containing the JSON contents of a service account
+ *     credentials file.
+ * @param audience the service receiving the requests. If omitted, the Google
+ *     Cloud Storage endpoint, defined by
+ *     `GoogleOAuthSelfSignedJwtStorageAudience()`, is used.
+ *
+ * @see https://developers.google.com/identity/protocols/OAuth2ServiceAccount
+ *     for more information about JWT authorization without OAuth.
+ */
+StatusOr<std::shared_ptr<Credentials>>
+CreateSelfSignedServiceAccountCredentialsFromJsonContents(
+    std::string const& contents,
+    std::string audience = GoogleOAuthSelfSignedJwtStorageAudience());
+
 /// Creates a ComputeEngineCredentials for the VM's default service account.
 std::shared_ptr<Credentials> CreateComputeEngineCredentials();
 
@@ -14,6 +14,7 @@
 
 #include "google/cloud/storage/oauth2/refreshing_credentials_wrapper.h"
 #include "google/cloud/storage/oauth2/credential_constants.h"
+#include <algorithm>
 
 namespace google {
 namespace cloud {
@@ -21,15 +22,64 @@ namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace oauth2 {
 
+RefreshingCredentialsWrapper::~RefreshingCredentialsWrapper() {
+  std::lock_guard<std::mutex> lk(thread_mu_);
+  if (refresh_thread_.joinable()) {
+    refresh_thread_.join();
+  }
+}
+
 bool RefreshingCredentialsWrapper::IsExpired(
     std::chrono::system_clock::time_point now) const {
-  return now > (temporary_token.expiration_time -
+  auto current = std::atomic_load(&current_);
+  return !current ||
+         now > (current->expiration_time -
                 GoogleOAuthAccessTokenExpirationSlack());
 }
 
 bool RefreshingCredentialsWrapper::IsValid(
     std::chrono::system_clock::time_point now) const {
-  return !temporary_token.token.empty() && !IsExpired(now);
+  auto current = std::atomic_load(&current_);
+  return current && IsValid(*current, now);
+}
+
+bool RefreshingCredentialsWrapper::IsValid(
+    Snapshot const& s, std::chrono::system_clock::time_point now) {
+  return !s.token.empty() &&
+         now <= (s.expiration_time - GoogleOAuthAccessTokenExpirationSlack());
+}
+
+std::string RefreshingCredentialsWrapper::Publish(
+    std::chrono::system_clock::time_point now, TemporaryToken token) const {
+  // Refresh after a fraction of the time the token is valid. Using the full
+  // lifetime would place the refresh past the point where the token is no
+  // longer valid for short-lived tokens, and they would never be refreshed in
+  // the background.
+  auto const valid_for = (std::max)(
+      std::chrono::system_clock::duration::zero(),
+      token.expiration_time - GoogleOAuthAccessTokenExpirationSlack() - now);
+  auto const refresh_time =
+      now + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                valid_for * GoogleOAuthAccessTokenRefreshFraction());
+  auto snapshot = std::make_shared<Snapshot const>(
+      Snapshot{std::move(token.token), token.expiration_time, refresh_time});
+  std::atomic_store(&current_, snapshot);
+  return snapshot->token;
+}
+
+void RefreshingCredentialsWrapper::Postpone(
+    std::chrono::system_clock::time_point now) const {
+  auto current = std::atomic_load(&current_);
+  if (!current) {
+    return;
+  }
+  // The token is never used past its actual expiration time.
+  auto const refresh_time =
+      (std::min)(now + GoogleOAuthAccessTokenRefreshRetryDelay(),
+                 current->expiration_time);
+  auto snapshot = std::make_shared<Snapshot const>(
+      Snapshot{current->token, current->expiration_time, refresh_time});
+  std::atomic_store(&current_, std::move(snapshot));
 }
 
 }  // namespace oauth2
@@ -17,9 +17,14 @@
 
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
+#include "google/cloud/storage/oauth2/credential_constants.h"
 #include "google/cloud/storage/version.h"
+#include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 
 namespace google {
@@ -29,6 +34,24 @@ inline namespace STORAGE_CLIENT_NS {
 namespace oauth2 {
 /**
  * Wrapper for refreshable parts of a Credentials object.
+ *
+ * The current token is published as an immutable snapshot, callers never wait
+ * for a refresh while the token is fresh. Once a token is past
+ * `GoogleOAuthAccessTokenRefreshFraction()` of the time it remains valid (its
+ * lifetime minus `GoogleOAuthAccessTokenExpirationSlack()`), the first caller
+ * to notice starts a refresh in a background thread, and all callers keep
+ * using the current token until the new one is available. Callers only block
+ * when there is no valid token, in which case a single refresh is performed
+ * on behalf of all of them.
+ *
+ * If a refresh fails while the current token has not actually expired, the
+ * current token is still returned (it is only stale, as defined by
+ * `GoogleOAuthAccessTokenExpirationSlack()`).
+ *
+ * The functor passed to `AuthorizationHeader()` may be called from the
+ * background thread. The destructor waits for any background refresh, so
+ * classes using this wrapper should declare it after any member used by the
+ * functor.
  */
 class RefreshingCredentialsWrapper {
  public:
@@ -37,18 +60,40 @@ class RefreshingCredentialsWrapper {
     std::chrono::system_clock::time_point expiration_time;
   };
 
+  RefreshingCredentialsWrapper() = default;
+  ~RefreshingCredentialsWrapper();
+
+  RefreshingCredentialsWrapper(RefreshingCredentialsWrapper const&) = delete;
+  RefreshingCredentialsWrapper& operator=(RefreshingCredentialsWrapper const&) =
+      delete;
+
   template <typename RefreshFunctor>
   StatusOr<std::string> AuthorizationHeader(
       std::chrono::system_clock::time_point now,
       RefreshFunctor refresh_fn) const {
-    if (IsValid(now)) {
-      return temporary_token.token;
+    auto current = std::atomic_load(&current_);
+    if (current && now < current->refresh_time) {
+      return current->token;
+    }
+    if (current && IsValid(*current, now)) {
+      StartBackgroundRefresh(now, std::move(refresh_fn));
+      return current->token;
     }
 
+    std::unique_lock<std::mutex> lk(refresh_mu_);
+    // Another thread may have refreshed (or postponed the refresh of) the token
+    // while this one was blocked.
+    current = std::atomic_load(&current_);
+    if (current && (now < current->refresh_time || IsValid(*current, now))) {
+      return current->token;
+    }
     StatusOr<TemporaryToken> new_token = refresh_fn();
     if (new_token) {
-      temporary_token = *std::move(new_token);
-      return temporary_token.token;
+      return Publish(now, *std::move(new_token));
+    }
+    if (current && now < current->expiration_time) {
+      Postpone(now);
+      return current->token;
     }
     return new_token.status();
   }
@@ -75,7 +120,64 @@ class RefreshingCredentialsWrapper {
   bool IsValid(std::chrono::system_clock::time_point now) const;
 
  private:
-  mutable TemporaryToken temporary_token;
+  struct Snapshot {
+    std::string token;
+    std::chrono::system_clock::time_point expiration_time;
+    /// When to start a background refresh for this token.
+    std::chrono::system_clock::time_point refresh_time;
+  };
+
+  static bool IsValid(Snapshot const& s,
+                      std::chrono::system_clock::time_point now);
+
+  /// Publishes @p token as the current token, returns the token string.
+  std::string Publish(std::chrono::system_clock::time_point now,
+                      TemporaryToken token) const;
+
+  /// Delays the next refresh after a failure, keeping the current token.
+  void Postpone(std::chrono::system_clock::time_point now) const;
+
+  template <typename RefreshFunctor>
+  void StartBackgroundRefresh(std::chrono::system_clock::time_point now,
+                              RefreshFunctor refresh_fn) const {
+    bool expected = false;
+    if (!refresh_pending_.compare_exchange_strong(expected, true)) {
+      return;
+    }
+    // Only the thread that set `refresh_pending_` can get here, and the
+    // previous background refresh (if any) has completed. `refresh_pending_`
+    // may be cleared before this thread stores the new `std::thread`, the lock
+    // keeps the next refresh from joining it concurrently.
+    std::lock_guard<std::mutex> lk(thread_mu_);
+    if (refresh_thread_.joinable()) {
+      refresh_thread_.join();
+    }
+    auto const start = std::chrono::steady_clock::now();
+    refresh_thread_ = std::thread([this, now, start, refresh_fn]() mutable {
+      {
+        std::unique_lock<std::mutex> lk(refresh_mu_);
+        StatusOr<TemporaryToken> new_token = refresh_fn();
+        // The refresh may take a while, the token lifetime starts when it is
+        // received.
+        auto const elapsed = std::chrono::steady_clock::now() - start;
+        auto const received =
+            now + std::chrono::duration_cast<
+                      std::chrono::system_clock::duration>(elapsed);
+        if (new_token) {
+          Publish(received, *std::move(new_token));
+        } else {
+          Postpone(received);
+        }
+      }
+      refresh_pending_.store(false);
+    });
+  }
+
+  mutable std::shared_ptr<Snapshot const> current_;  // accessed atomically
+  mutable std::mutex refresh_mu_;
+  mutable std::atomic<bool> refresh_pending_{false};
+  mutable std::mutex thread_mu_;
+  mutable std::thread refresh_thread_;  // GUARDED_BY(thread_mu_)
 };
 
 }  // namespace oauth2
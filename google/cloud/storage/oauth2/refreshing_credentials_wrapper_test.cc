@@ -0,0 +1,204 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/oauth2/refreshing_credentials_wrapper.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace oauth2 {
+namespace {
+
+using ::std::chrono::seconds;
+using TemporaryToken = RefreshingCredentialsWrapper::TemporaryToken;
+
+auto const kStart = std::chrono::system_clock::time_point{} + seconds(100000);
+
+StatusOr<TemporaryToken> MakeToken(std::string token,
+                                   std::chrono::system_clock::time_point now) {
+  return TemporaryToken{std::move(token), now + seconds(3600)};
+}
+
+/// Wait until the background refresh publishes @p expected.
+bool WaitForToken(RefreshingCredentialsWrapper const& tested,
+                  std::chrono::system_clock::time_point now,
+                  std::string const& expected) {
+  for (int i = 0; i != 1000; ++i) {
+    auto header = tested.AuthorizationHeader(now, [] {
+      return StatusOr<TemporaryToken>(Status(StatusCode::kUnavailable, "x"));
+    });
+    if (header && *header == expected) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+/// @test Verify that fresh tokens are returned without a refresh.
+TEST(RefreshingCredentialsWrapperTest, RefreshOnlyWhenNeeded) {
+  RefreshingCredentialsWrapper tested;
+  int count = 0;
+  auto refresh = [&count] {
+    ++count;
+    return MakeToken("token-" + std::to_string(count), kStart);
+  };
+
+  auto header = tested.AuthorizationHeader(kStart, refresh);
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("token-1", *header);
+  EXPECT_TRUE(tested.IsValid(kStart));
+
+  header = tested.AuthorizationHeader(kStart + seconds(1800), refresh);
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("token-1", *header);
+  EXPECT_EQ(1, count);
+}
+
+/// @test Verify that tokens are refreshed in the background before expiring.
+TEST(RefreshingCredentialsWrapperTest, BackgroundRefresh) {
+  RefreshingCredentialsWrapper tested;
+  auto header = tested.AuthorizationHeader(
+      kStart, [] { return MakeToken("token-1", kStart); });
+  ASSERT_STATUS_OK(header);
+
+  // Past 75% of the time the token is valid, the current token is returned
+  // while a single background refresh fetches a new one.
+  auto const now = kStart + seconds(2800);
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  int count = 0;
+  auto refresh = [&count, released, now] {
+    ++count;
+    released.wait();
+    return MakeToken("token-2", now);
+  };
+  for (int i = 0; i != 3; ++i) {
+    header = tested.AuthorizationHeader(now, refresh);
+    ASSERT_STATUS_OK(header);
+    EXPECT_EQ("token-1", *header);
+  }
+  release.set_value();
+  EXPECT_TRUE(WaitForToken(tested, now, "token-2"));
+  EXPECT_EQ(1, count);
+}
+
+/// @test Verify that short-lived tokens are also refreshed in the background.
+TEST(RefreshingCredentialsWrapperTest, BackgroundRefreshShortLived) {
+  RefreshingCredentialsWrapper tested;
+  auto short_lived = [](std::string token,
+                        std::chrono::system_clock::time_point now) {
+    return StatusOr<TemporaryToken>(
+        TemporaryToken{std::move(token), now + seconds(1000)});
+  };
+  auto header = tested.AuthorizationHeader(
+      kStart, [&] { return short_lived("token-1", kStart); });
+  ASSERT_STATUS_OK(header);
+
+  // The token is valid for 500s, the refresh starts after 375s.
+  auto const now = kStart + seconds(400);
+  EXPECT_TRUE(tested.IsValid(now));
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  auto refresh = [&] {
+    released.wait();
+    return short_lived("token-2", now);
+  };
+  header = tested.AuthorizationHeader(now, refresh);
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("token-1", *header);
+  release.set_value();
+  EXPECT_TRUE(WaitForToken(tested, now, "token-2"));
+}
+
+/// @test Verify that consecutive background refreshes work.
+TEST(RefreshingCredentialsWrapperTest, RepeatedBackgroundRefresh) {
+  RefreshingCredentialsWrapper tested;
+  auto now = kStart;
+  auto header = tested.AuthorizationHeader(
+      now, [now] { return MakeToken("token-0", now); });
+  ASSERT_STATUS_OK(header);
+  for (int i = 1; i != 10; ++i) {
+    now += seconds(2800);
+    auto const expected = "token-" + std::to_string(i);
+    std::vector<std::thread> callers;
+    for (int j = 0; j != 4; ++j) {
+      callers.emplace_back([&tested, now, expected] {
+        auto h = tested.AuthorizationHeader(
+            now, [now, expected] { return MakeToken(expected, now); });
+        EXPECT_STATUS_OK(h);
+      });
+    }
+    for (auto& t : callers) {
+      t.join();
+    }
+    EXPECT_TRUE(WaitForToken(tested, now, expected));
+  }
+}
+
+/// @test Verify that stale tokens are used if the refresh fails.
+TEST(RefreshingCredentialsWrapperTest, StaleWhileRevalidate) {
+  RefreshingCredentialsWrapper tested;
+  auto header = tested.AuthorizationHeader(
+      kStart, [] { return MakeToken("token-1", kStart); });
+  ASSERT_STATUS_OK(header);
+
+  int count = 0;
+  auto failure = [&count] {
+    ++count;
+    return StatusOr<TemporaryToken>(Status(StatusCode::kUnavailable, "try"));
+  };
+
+  // The token is no longer valid, but has not expired, it is returned and the
+  // next refresh is delayed.
+  auto const stale = kStart + seconds(3300);
+  EXPECT_FALSE(tested.IsValid(stale));
+  header = tested.AuthorizationHeader(stale, failure);
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("token-1", *header);
+  header = tested.AuthorizationHeader(stale + seconds(1), failure);
+  ASSERT_STATUS_OK(header);
+  EXPECT_EQ("token-1", *header);
+  EXPECT_EQ(1, count);
+
+  // Once expired the token is never used.
+  header = tested.AuthorizationHeader(kStart + seconds(3700), failure);
+  ASSERT_FALSE(header);
+  EXPECT_EQ(StatusCode::kUnavailable, header.status().code());
+  EXPECT_EQ(2, count);
+}
+
+/// @test Verify that a failed refresh without a token reports the error.
+TEST(RefreshingCredentialsWrapperTest, InitialRefreshFailure) {
+  RefreshingCredentialsWrapper tested;
+  auto header = tested.AuthorizationHeader(kStart, [] {
+    return StatusOr<TemporaryToken>(Status(StatusCode::kPermissionDenied, ""));
+  });
+  ASSERT_FALSE(header);
+  EXPECT_EQ(StatusCode::kPermissionDenied, header.status().code());
+  EXPECT_TRUE(tested.IsExpired(kStart));
+}
+
+}  // namespace
+}  // namespace oauth2
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -73,7 +73,8 @@ StatusOr<ServiceAccountCredentialsInfo> ParseServiceAccountCredentials(
       // the default value.
       credentials.value(token_uri_key, default_token_uri),
       /*scopes*/ {},
-      /*subject*/ {}};
+      /*subject*/ {},
+      /*self_signed_jwt_audience*/ {}};
 }
 
 StatusOr<ServiceAccountCredentialsInfo> ParseServiceAccountP12File(
@@ -179,7 +180,8 @@ StatusOr<ServiceAccountCredentialsInfo> ParseServiceAccountP12File(
                                        std::move(private_key),
                                        default_token_uri,
                                        /*scopes*/ {},
-                                       /*subject*/ {}};
+                                       /*subject*/ {},
+                                       /*self_signed_jwt_audience*/ {}};
 }
 
 std::pair<std::string, std::string> AssertionComponentsFromInfo(
@@ -245,6 +247,48 @@ std::string CreateServiceAccountRefreshPayload(
   return payload;
 }
 
+std::pair<std::string, std::string> SelfSignedJwtComponentsFromInfo(
+    ServiceAccountCredentialsInfo const& info, std::string const& audience,
+    std::chrono::system_clock::time_point now) {
+  storage::internal::nl::json header = {
+      {"alg", "RS256"}, {"kid", info.private_key_id}, {"typ", "JWT"}};
+
+  auto expiration = now + GoogleOAuthAccessTokenLifetime();
+  auto now_from_epoch =
+      static_cast<long>(std::chrono::system_clock::to_time_t(now));
+  auto expiration_from_epoch =
+      static_cast<long>(std::chrono::system_clock::to_time_t(expiration));
+  storage::internal::nl::json payload = {{"iss", info.client_email},
+                                         {"sub", info.client_email},
+                                         {"aud", audience},
+                                         {"iat", now_from_epoch},
+                                         {"exp", expiration_from_epoch}};
+  // Self-signed JWTs use space-delimited scopes. Without an explicit set of
+  // scopes the token is valid for any API in `audience`.
+  if (info.scopes && !info.scopes->empty()) {
+    std::string scope_str;
+    char const* sep = "";
+    for (auto const& scope : *info.scopes) {
+      scope_str += sep + scope;
+      sep = " ";
+    }
+    payload["scope"] = std::move(scope_str);
+  }
+
+  return std::make_pair(header.dump(), payload.dump());
+}
+
+RefreshingCredentialsWrapper::TemporaryToken CreateSelfSignedJwtToken(
+    ServiceAccountCredentialsInfo const& info, std::string const& audience,
+    std::chrono::system_clock::time_point now) {
+  auto components = SelfSignedJwtComponentsFromInfo(info, audience, now);
+  std::string header = "Authorization: Bearer ";
+  header += MakeJWTAssertion(components.first, components.second,
+                             info.private_key);
+  return RefreshingCredentialsWrapper::TemporaryToken{
+      std::move(header), now + GoogleOAuthAccessTokenLifetime()};
+}
+
 StatusOr<RefreshingCredentialsWrapper::TemporaryToken>
 ParseServiceAccountRefreshResponse(
     storage::internal::HttpResponse const& response,
@@ -15,6 +15,7 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OAUTH2_SERVICE_ACCOUNT_CREDENTIALS_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_OAUTH2_SERVICE_ACCOUNT_CREDENTIALS_H
 
+#include "google/cloud/internal/make_unique.h"
 #include "google/cloud/optional.h"
 #include "google/cloud/storage/internal/curl_request_builder.h"
 #include "google/cloud/storage/internal/openssl_util.h"
@@ -26,6 +27,7 @@
 #include <condition_variable>
 #include <ctime>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <set>
 
@@ -44,6 +46,9 @@ struct ServiceAccountCredentialsInfo {
   google::cloud::optional<std::set<std::string>> scopes;
   // See https://developers.google.com/identity/protocols/OAuth2ServiceAccount.
   google::cloud::optional<std::string> subject;
+  // If set, use a locally signed JWT with this audience as the access token,
+  // instead of exchanging a JWT assertion at `token_uri`.
+  google::cloud::optional<std::string> self_signed_jwt_audience;
 };
 
 /// Parses the contents of a JSON keyfile into a ServiceAccountCredentialsInfo.
@@ -100,6 +105,27 @@ std::string CreateServiceAccountRefreshPayload(
     ServiceAccountCredentialsInfo const& info, std::string const& grant_type,
     std::chrono::system_clock::time_point now);
 
+/**
+ * Splits a ServiceAccountCredentialsInfo into header and payload components
+ * and uses the current time to make a self-signed JWT for @p audience.
+ *
+ * Unlike the assertions sent to the token endpoint, the resulting JWT is used
+ * directly as the bearer token in requests to @p audience. If `info.scopes` is
+ * set the JWT is restricted to those scopes.
+ *
+ * @see https://developers.google.com/identity/protocols/OAuth2ServiceAccount
+ *     for more information about JWT authorization without OAuth.
+ */
+std::pair<std::string, std::string> SelfSignedJwtComponentsFromInfo(
+    ServiceAccountCredentialsInfo const& info, std::string const& audience,
+    std::chrono::system_clock::time_point now);
+
+/// Uses a ServiceAccountCredentialsInfo and the current time to create a
+/// TemporaryToken holding a self-signed JWT for @p audience.
+RefreshingCredentialsWrapper::TemporaryToken CreateSelfSignedJwtToken(
+    ServiceAccountCredentialsInfo const& info, std::string const& audience,
+    std::chrono::system_clock::time_point now);
+
 /**
  * Wrapper class for Google OAuth 2.0 service account credentials.
  *
@@ -112,7 +138,14 @@ std::string CreateServiceAccountRefreshPayload(
  * can be obtained by calling the AuthorizationHeader() method; if the current
  * access token is invalid or nearing expiration, this will class will first
  * obtain a new access token before returning the Authorization header string.
-
+ *
+ * If `self_signed_jwt_audience` is set in the ServiceAccountCredentialsInfo,
+ * the access token is a JWT signed locally with the service account key, and
+ * no requests are made to the Google Authorization Service. The `scopes`, if
+ * any, are included in the `scope` claim of the JWT. This mode is not used
+ * when a `subject` is set, the Google Authorization Service is required to
+ * impersonate other accounts.
+ *
  * @see https://developers.google.com/identity/protocols/OAuth2ServiceAccount
  * for an overview of using service accounts with Google's OAuth 2.0 system.
  *
@@ -132,6 +165,9 @@ class ServiceAccountCredentials : public Credentials {
  public:
   explicit ServiceAccountCredentials(ServiceAccountCredentialsInfo info)
       : info_(std::move(info)), clock_() {
+    if (UseSelfSignedJwt()) {
+      return;
+    }
     HttpRequestBuilderType request_builder(
         info_.token_uri, storage::internal::GetDefaultCurlHandleFactory());
     request_builder.AddHeader(
@@ -148,7 +184,6 @@ class ServiceAccountCredentials : public Credentials {
   }
 
   StatusOr<std::string> AuthorizationHeader() override {
-    std::unique_lock<std::mutex> lock(mu_);
     return refreshing_creds_.AuthorizationHeader(clock_.now(),
                                                  [this] { return Refresh(); });
   }
@@ -173,15 +208,29 @@ class ServiceAccountCredentials : public Credentials {
                     "The current_credentials cannot sign blobs for " +
                         signing_account.value());
     }
-    return internal::SignStringWithPem(blob, info_.private_key,
-                                       JwtSigningAlgorithms::RS256);
+    // Parsing the private key is more expensive than signing a blob, do it
+    // only once.
+    std::call_once(signer_once_, [this] {
+      signer_ = google::cloud::internal::make_unique<internal::PemSigner>(
+          info_.private_key, JwtSigningAlgorithms::RS256);
+    });
+    return signer_->Sign(blob);
   }
 
   std::string AccountEmail() const override { return info_.client_email; }
   std::string KeyId() const override { return info_.private_key_id; }
 
  private:
+  bool UseSelfSignedJwt() const {
+    return info_.self_signed_jwt_audience.has_value() &&
+           !info_.subject.has_value();
+  }
+
   StatusOr<RefreshingCredentialsWrapper::TemporaryToken> Refresh() {
+    if (UseSelfSignedJwt()) {
+      return CreateSelfSignedJwtToken(info_, *info_.self_signed_jwt_audience,
+                                      clock_.now());
+    }
     auto payload =
         CreateServiceAccountRefreshPayload(info_, grant_type_, clock_.now());
 
@@ -199,9 +248,11 @@ class ServiceAccountCredentials : public Credentials {
   typename HttpRequestBuilderType::RequestType request_;
   std::string grant_type_;
   ServiceAccountCredentialsInfo info_;
-  mutable std::mutex mu_;
-  RefreshingCredentialsWrapper refreshing_creds_;
   ClockType clock_;
+  mutable std::once_flag signer_once_;
+  mutable std::unique_ptr<internal::PemSigner> signer_;
+  // Must be the last member, the destructor waits for any background refresh.
+  RefreshingCredentialsWrapper refreshing_creds_;
 };
 
 }  // namespace oauth2
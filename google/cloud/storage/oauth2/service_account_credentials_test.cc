@@ -560,6 +560,84 @@ TEST_F(ServiceAccountCredentialsTest, ClientId) {
   EXPECT_EQ("a1a111aa1111a11a11a11aa111a111a1a1111111", credentials.KeyId());
 }
 
+/// @test Verify the components of a self-signed JWT.
+TEST_F(ServiceAccountCredentialsTest, SelfSignedJwtComponentsFromInfo) {
+  auto info = ParseServiceAccountCredentials(kJsonKeyfileContents, "test");
+  ASSERT_STATUS_OK(info);
+  auto const clock_value_1 = 10000;
+  FakeClock::now_value = clock_value_1;
+  auto components = SelfSignedJwtComponentsFromInfo(
+      *info, GoogleOAuthSelfSignedJwtStorageAudience(), FakeClock::now());
+
+  auto header = internal::nl::json::parse(components.first);
+  EXPECT_EQ("RS256", header.value("alg", ""));
+  EXPECT_EQ("JWT", header.value("typ", ""));
+  EXPECT_EQ(info->private_key_id, header.value("kid", ""));
+
+  auto payload = internal::nl::json::parse(components.second);
+  EXPECT_EQ(clock_value_1, payload.value("iat", 0));
+  EXPECT_EQ(clock_value_1 + 3600, payload.value("exp", 0));
+  EXPECT_EQ(info->client_email, payload.value("iss", ""));
+  EXPECT_EQ(info->client_email, payload.value("sub", ""));
+  EXPECT_EQ("https://storage.googleapis.com/", payload.value("aud", ""));
+  EXPECT_EQ(0, payload.count("scope"));
+}
+
+/// @test Verify the scopes are included in self-signed JWTs.
+TEST_F(ServiceAccountCredentialsTest, SelfSignedJwtComponentsWithScopes) {
+  auto info = ParseServiceAccountCredentials(kJsonKeyfileContents, "test");
+  ASSERT_STATUS_OK(info);
+  info->scopes = std::set<std::string>{"https://www.googleapis.com/auth/a",
+                                       "https://www.googleapis.com/auth/b"};
+  auto components = SelfSignedJwtComponentsFromInfo(
+      *info, GoogleOAuthSelfSignedJwtStorageAudience(), FakeClock::now());
+
+  auto payload = internal::nl::json::parse(components.second);
+  EXPECT_EQ("https://storage.googleapis.com/", payload.value("aud", ""));
+  EXPECT_EQ(
+      "https://www.googleapis.com/auth/a https://www.googleapis.com/auth/b",
+      payload.value("scope", ""));
+}
+
+/// @test Verify self-signed JWT credentials never contact the token endpoint.
+TEST_F(ServiceAccountCredentialsTest, SelfSignedJwt) {
+  auto mock_builder = MockHttpRequestBuilder::mock;
+  EXPECT_CALL(*mock_builder, Constructor(_)).Times(0);
+  EXPECT_CALL(*mock_builder, BuildRequest()).Times(0);
+
+  auto info = ParseServiceAccountCredentials(kJsonKeyfileContents, "test");
+  ASSERT_STATUS_OK(info);
+  info->self_signed_jwt_audience = GoogleOAuthSelfSignedJwtStorageAudience();
+  ServiceAccountCredentials<MockHttpRequestBuilder, FakeClock> credentials(
+      *info);
+
+  auto header = credentials.AuthorizationHeader();
+  ASSERT_STATUS_OK(header);
+  std::string const prefix = "Authorization: Bearer ";
+  ASSERT_THAT(*header, StartsWith(prefix));
+
+  auto components = SelfSignedJwtComponentsFromInfo(
+      *info, GoogleOAuthSelfSignedJwtStorageAudience(), FakeClock::now());
+  EXPECT_EQ(prefix + MakeJWTAssertion(components.first, components.second,
+                                      info->private_key),
+            *header);
+
+  // The token is cached until it is close to expiring.
+  FakeClock::now_value += 60;
+  EXPECT_EQ(*header, credentials.AuthorizationHeader().value());
+
+  FakeClock::now_value += 3600;
+  auto refreshed = credentials.AuthorizationHeader();
+  ASSERT_STATUS_OK(refreshed);
+  EXPECT_NE(*header, *refreshed);
+  auto encoded_payload = refreshed->substr(prefix.size());
+  encoded_payload = encoded_payload.substr(encoded_payload.find('.') + 1);
+  encoded_payload = encoded_payload.substr(0, encoded_payload.find('.'));
+  auto decoded = internal::UrlsafeBase64Decode(encoded_payload);
+  auto payload = internal::nl::json::parse(decoded.begin(), decoded.end());
+  EXPECT_EQ(FakeClock::now_value, payload.value("iat", 0));
+}
+
 // This is a base64-encoded p12 key-file. The service account was deleted
 // after creating the key-file, so the key was effectively invalidated, but
 // the format is correct, so we can use it to verify that p12 key-files can be
@@ -55,6 +55,15 @@ void ObjectReadStream::Close() {
   }
 }
 
+StatusOr<std::size_t> ObjectReadStream::ReadInto(char* buffer,
+                                                std::size_t size) {
+  if (!buf_) {
+    return Status(StatusCode::kFailedPrecondition,
+                  "ReadInto() called on a stream without a download");
+  }
+  return buf_->ReadDirect(buffer, size);
+}
+
 ObjectWriteStream::ObjectWriteStream(
     std::unique_ptr<internal::ObjectWriteStreambuf> buf)
     : std::basic_ostream<char>(nullptr), buf_(std::move(buf)) {
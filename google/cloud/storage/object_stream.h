@@ -17,6 +17,7 @@
 
 #include "google/cloud/storage/internal/object_streambuf.h"
 #include "google/cloud/storage/object_metadata.h"
+#include "google/cloud/storage/read_copy_counters.h"
 #include "google/cloud/storage/version.h"
 #include <ios>
 #include <iostream>
@@ -103,6 +104,38 @@ class ObjectReadStream : public std::basic_istream<char> {
    */
   void Close();
 
+  /**
+   * Reads up to @p size bytes directly into @p buffer.
+   *
+   * This is an alternative to `read()` for applications that manage their own
+   * buffers. The data is copied from the HTTP library straight into
+   * @p buffer, bypassing the `std::streambuf` get area. Any data already
+   * buffered by the stream (for example, because the application used
+   * `get()` or `peek()`) is returned first.
+   *
+   * Errors, including checksum mismatches detected at the end of the
+   * download, are reported via the return value (and `status()`), this
+   * function does not modify the stream state flags nor raise exceptions.
+   *
+   * A successful call may return fewer bytes than requested, including 0
+   * bytes, even if the download is not complete. For example, when @p size
+   * is 0, or when the service sent only headers. The download is complete
+   * once `IsOpen()` returns `false` and this function returns 0.
+   *
+   * @return the number of bytes read, or the error.
+   */
+  StatusOr<std::size_t> ReadInto(char* buffer, std::size_t size);
+
+  /**
+   * The number of bytes received and copied while downloading the object.
+   *
+   * Intended for benchmarks and tests, the average number of memory copies per
+   * byte is `1 + bytes_staged / bytes_delivered`.
+   */
+  ReadCopyCounters copy_counters() const {
+    return buf_ ? buf_->copy_counters() : ReadCopyCounters{};
+  }
+
   //@{
   /**
    * Report any download errors.
@@ -355,6 +388,17 @@ class ObjectWriteStream : public std::basic_ostream<char> {
    */
   Status last_status() const { return buf_->last_status(); }
 
+  /**
+   * Returns the size of the next chunk uploaded by this stream.
+   *
+   * This is `ClientOptions::upload_buffer_size()` rounded up to a multiple of
+   * 256 KiB, unless the stream adapts its chunk size to the network
+   * performance.
+   *
+   * @see `ClientOptions::set_enable_adaptive_upload_buffer_size()`
+   */
+  std::size_t upload_chunk_size() const { return buf_->upload_chunk_size(); }
+
  private:
   /**
    * Closes the underlying object write stream.
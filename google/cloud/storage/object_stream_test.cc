@@ -81,6 +81,18 @@ TEST(ObjectStream, ReadMoveAssignment) {
   EXPECT_NE(nullptr, copy.rdbuf());
 }
 
+TEST(ObjectStream, ReadInto) {
+  ObjectReadStream reader = CreateReader();
+  char buffer[16];
+  auto read = reader.ReadInto(buffer, sizeof(buffer));
+  EXPECT_EQ(StatusCode::kNotFound, read.status().code());
+  EXPECT_EQ(0, reader.copy_counters().bytes_delivered);
+
+  ObjectReadStream empty;
+  read = empty.ReadInto(buffer, sizeof(buffer));
+  EXPECT_EQ(StatusCode::kFailedPrecondition, read.status().code());
+}
+
 TEST(ObjectStream, WriteMoveConstructor) {
   ObjectWriteStream writer = CreateWriter();
   EXPECT_EQ(StatusCode::kNotFound, writer.metadata().status().code());
@@ -20,6 +20,9 @@
 #include "google/cloud/storage/testing/retry_tests.h"
 #include "google/cloud/testing_util/assert_ok.h"
 #include <gmock/gmock.h>
+#include <mutex>
+#include <set>
+#include <thread>
 
 namespace google {
 namespace cloud {
@@ -88,6 +91,31 @@ TEST_F(ObjectTest, InsertObjectMedia) {
   EXPECT_EQ(expected, *actual);
 }
 
+TEST_F(ObjectTest, InsertObjectMediaView) {
+  std::string text = R"""({
+      "name": "test-bucket-name/test-object-name/1"
+})""";
+  auto expected =
+      storage::internal::ObjectMetadataParser::FromString(text).value();
+  std::string const contents = "test object contents";
+
+  EXPECT_CALL(*mock, InsertObjectMedia(_))
+      .WillOnce(Invoke([&](internal::InsertObjectMediaRequest const& request) {
+        EXPECT_EQ("test-bucket-name", request.bucket_name());
+        EXPECT_EQ("test-object-name", request.object_name());
+        EXPECT_TRUE(request.has_contents_view());
+        EXPECT_EQ(contents.data(), request.contents_view().data());
+        EXPECT_EQ(contents.size(), request.contents_view().size());
+        return make_status_or(expected);
+      }));
+
+  auto actual = client->InsertObject("test-bucket-name", "test-object-name",
+                                     contents.data(), contents.size(),
+                                     IfGenerationMatch(0));
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+}
+
 TEST_F(ObjectTest, InsertObjectMediaTooManyFailures) {
   testing::TooManyFailuresStatusTest<ObjectMetadata>(
       mock, EXPECT_CALL(*mock, InsertObjectMedia(_)),
@@ -424,6 +452,89 @@ TEST_F(ObjectTest, ReadObjectPermanentFailure) {
   EXPECT_THAT(status.message(), HasSubstr("ReadObject"));
 }
 
+TEST_F(ObjectTest, AsyncInsertObject) {
+  auto expected = internal::ObjectMetadataParser::FromString(R"""({
+      "name": "test-object-name", "bucket": "test-bucket-name"
+})""").value();
+
+  EXPECT_CALL(*mock, AsyncInsertObjectMedia(_))
+      .WillOnce(Invoke(
+          [&expected](internal::InsertObjectMediaRequest const& request) {
+            EXPECT_EQ("test-bucket-name", request.bucket_name());
+            EXPECT_EQ("test-object-name", request.object_name());
+            EXPECT_EQ("test object contents", request.contents());
+            EXPECT_EQ(0, request.GetOption<IfGenerationMatch>().value());
+            return make_ready_future(make_status_or(expected));
+          }));
+
+  auto actual = client
+                    ->AsyncInsertObject("test-bucket-name", "test-object-name",
+                                        "test object contents",
+                                        IfGenerationMatch(0))
+                    .get();
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+}
+
+TEST_F(ObjectTest, AsyncGetObjectMetadata) {
+  auto expected = internal::ObjectMetadataParser::FromString(R"""({
+      "name": "test-object-name", "bucket": "test-bucket-name"
+})""").value();
+
+  EXPECT_CALL(*mock, AsyncGetObjectMetadata(_))
+      .WillOnce(Invoke([](internal::GetObjectMetadataRequest const&) {
+        return make_ready_future(StatusOr<ObjectMetadata>(TransientError()));
+      }))
+      .WillOnce(
+          Invoke([&expected](internal::GetObjectMetadataRequest const& r) {
+            EXPECT_EQ("test-bucket-name", r.bucket_name());
+            EXPECT_EQ("test-object-name", r.object_name());
+            return make_ready_future(make_status_or(expected));
+          }));
+  EXPECT_CALL(*mock, AsyncSleep(_))
+      .WillOnce(Invoke([](ms) { return make_ready_future(); }));
+
+  auto actual =
+      client->AsyncGetObjectMetadata("test-bucket-name", "test-object-name")
+          .get();
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+}
+
+TEST_F(ObjectTest, AsyncReadObject) {
+  EXPECT_CALL(*mock, AsyncReadObject(_))
+      .WillOnce(Invoke([](internal::ReadObjectRangeRequest const& r) {
+        EXPECT_EQ("test-bucket-name", r.bucket_name());
+        EXPECT_EQ("test-object-name", r.object_name());
+        EXPECT_EQ(1024, r.GetOption<ReadRange>().value().begin);
+        return make_ready_future(make_status_or(std::string("contents")));
+      }));
+
+  auto size = client
+                  ->AsyncReadObject("test-bucket-name", "test-object-name",
+                                    ReadRange(1024, 2048))
+                  .then([](future<StatusOr<std::string>> f) {
+                    auto contents = f.get();
+                    return contents ? contents->size() : 0;
+                  })
+                  .get();
+  EXPECT_EQ(8, size);
+}
+
+TEST_F(ObjectTest, AsyncReadObjectPermanentFailure) {
+  EXPECT_CALL(*mock, AsyncReadObject(_))
+      .WillOnce(Invoke([](internal::ReadObjectRangeRequest const&) {
+        return make_ready_future(StatusOr<std::string>(PermanentError()));
+      }));
+
+  auto actual =
+      client->AsyncReadObject("test-bucket-name", "test-object-name").get();
+  ASSERT_FALSE(actual);
+  EXPECT_EQ(PermanentError().code(), actual.status().code());
+  EXPECT_THAT(actual.status().message(), HasSubstr("Permanent error"));
+  EXPECT_THAT(actual.status().message(), HasSubstr("AsyncReadObject"));
+}
+
 ObjectMetadata CreateObject(int index) {
   std::string id = "object-" + std::to_string(index);
   std::string name = id;
@@ -573,6 +684,169 @@ TEST_F(ObjectTest, DeleteByPrefixDeleteFailure) {
   EXPECT_EQ(StatusCode::kPermissionDenied, status.code());
 }
 
+TEST_F(ObjectTest, ParallelDeleteByPrefix) {
+  EXPECT_CALL(*mock, ListObjects(_))
+      .WillOnce(Invoke([](internal::ListObjectsRequest const& req)
+                           -> StatusOr<internal::ListObjectsResponse> {
+        EXPECT_EQ("test-bucket", req.bucket_name());
+        std::ostringstream os;
+        os << req;
+        EXPECT_THAT(os.str(), HasSubstr("userProject=project-to-bill"));
+        EXPECT_THAT(os.str(), HasSubstr("prefix=object-"));
+
+        internal::ListObjectsResponse response;
+        response.next_page_token = "page-2";
+        response.items.emplace_back(CreateObject(1));
+        response.items.emplace_back(CreateObject(2));
+        response.items.emplace_back(CreateObject(3));
+        return response;
+      }))
+      .WillOnce(Invoke([](internal::ListObjectsRequest const& req)
+                           -> StatusOr<internal::ListObjectsResponse> {
+        EXPECT_EQ("page-2", req.page_token());
+
+        internal::ListObjectsResponse response;
+        response.items.emplace_back(CreateObject(4));
+        response.items.emplace_back(CreateObject(5));
+        return response;
+      }));
+  std::mutex mu;
+  std::set<std::string> deleted;
+  EXPECT_CALL(*mock, DeleteObject(_))
+      .Times(5)
+      .WillRepeatedly(Invoke([&](internal::DeleteObjectRequest const& r) {
+        EXPECT_EQ("test-bucket", r.bucket_name());
+        EXPECT_TRUE(r.HasOption<IfGenerationMatch>());
+        std::lock_guard<std::mutex> lk(mu);
+        deleted.insert(r.object_name());
+        return make_status_or(internal::EmptyResponse{});
+      }));
+
+  auto result = ParallelDeleteByPrefix(*client, "test-bucket", "object-", 3,
+                                       false, Versions(),
+                                       UserProject("project-to-bill"));
+  EXPECT_TRUE(result.ok());
+  EXPECT_EQ(5, result.deleted_count);
+  EXPECT_EQ((std::set<std::string>{"object-1", "object-2", "object-3",
+                                   "object-4", "object-5"}),
+            deleted);
+}
+
+TEST_F(ObjectTest, ParallelDeleteByPrefixCollectsFailures) {
+  EXPECT_CALL(*mock, ListObjects(_))
+      .WillOnce(Invoke([](internal::ListObjectsRequest const&)
+                           -> StatusOr<internal::ListObjectsResponse> {
+        internal::ListObjectsResponse response;
+        response.items.emplace_back(CreateObject(1));
+        response.items.emplace_back(CreateObject(2));
+        response.items.emplace_back(CreateObject(3));
+        return response;
+      }));
+  EXPECT_CALL(*mock, DeleteObject(_))
+      .Times(3)
+      .WillRepeatedly(Invoke([](internal::DeleteObjectRequest const& r) {
+        if (r.object_name() == "object-2") {
+          return StatusOr<internal::EmptyResponse>(PermanentError());
+        }
+        return make_status_or(internal::EmptyResponse{});
+      }));
+
+  auto result =
+      ParallelDeleteByPrefix(*client, "test-bucket", "object-", 2, false);
+  EXPECT_FALSE(result.ok());
+  EXPECT_STATUS_OK(result.list_status);
+  EXPECT_EQ(2, result.deleted_count);
+  ASSERT_EQ(1, result.failures.size());
+  EXPECT_EQ("object-2", result.failures[0].object_name);
+  EXPECT_EQ(PermanentError().code(), result.failures[0].status.code());
+}
+
+TEST_F(ObjectTest, ParallelDeleteByPrefixListFailure) {
+  EXPECT_CALL(*mock, ListObjects(_))
+      .WillOnce(Invoke([](internal::ListObjectsRequest const&)
+                           -> StatusOr<internal::ListObjectsResponse> {
+        internal::ListObjectsResponse response;
+        response.next_page_token = "page-2";
+        response.items.emplace_back(CreateObject(1));
+        response.items.emplace_back(CreateObject(2));
+        return response;
+      }))
+      .WillOnce(Return(StatusOr<internal::ListObjectsResponse>(
+          Status(StatusCode::kPermissionDenied, ""))));
+  EXPECT_CALL(*mock, DeleteObject(_))
+      .Times(2)
+      .WillRepeatedly(Return(make_status_or(internal::EmptyResponse{})));
+
+  auto result =
+      ParallelDeleteByPrefix(*client, "test-bucket", "object-", 4, false);
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(StatusCode::kPermissionDenied, result.list_status.code());
+  EXPECT_EQ(2, result.deleted_count);
+  EXPECT_TRUE(result.failures.empty());
+}
+
+TEST_F(ObjectTest, ParallelDeleteByPrefixBatch) {
+  EXPECT_CALL(*mock, ListObjects(_))
+      .WillOnce(Invoke([](internal::ListObjectsRequest const&)
+                           -> StatusOr<internal::ListObjectsResponse> {
+        internal::ListObjectsResponse response;
+        for (int i = 0; i != 150; ++i) {
+          response.items.emplace_back(CreateObject(i));
+        }
+        return response;
+      }));
+  std::mutex mu;
+  std::multiset<std::size_t> sizes;
+  EXPECT_CALL(*mock, ExecuteBatch(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](internal::BatchRequest const& r) {
+        {
+          std::lock_guard<std::mutex> lk(mu);
+          sizes.insert(r.size());
+        }
+        internal::BatchResponse response;
+        for (std::size_t i = 0; i != r.size(); ++i) {
+          // Fail the first deletion in each batch.
+          response.responses.emplace_back(internal::HttpResponse{
+              i == 0 ? 412 : 204, "", {}});
+        }
+        return make_status_or(std::move(response));
+      }));
+  EXPECT_CALL(*mock, DeleteObject(_)).Times(0);
+
+  auto result =
+      ParallelDeleteByPrefix(*client, "test-bucket", "object-", 2, true);
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(148, result.deleted_count);
+  EXPECT_EQ(2, result.failures.size());
+  EXPECT_EQ((std::multiset<std::size_t>{50, 100}), sizes);
+}
+
+TEST_F(ObjectTest, ParallelDeleteByPrefixBatchUnavailable) {
+  EXPECT_CALL(*mock, ListObjects(_))
+      .WillOnce(Invoke([](internal::ListObjectsRequest const&)
+                           -> StatusOr<internal::ListObjectsResponse> {
+        internal::ListObjectsResponse response;
+        for (int i = 0; i != 250; ++i) {
+          response.items.emplace_back(CreateObject(i));
+        }
+        return response;
+      }));
+  // Once the batch endpoint is known to be unavailable all the groups are
+  // deleted one object at a time.
+  EXPECT_CALL(*mock, ExecuteBatch(_))
+      .WillOnce(Return(StatusOr<internal::BatchResponse>(
+          Status(StatusCode::kNotFound, "no batch endpoint"))));
+  EXPECT_CALL(*mock, DeleteObject(_))
+      .Times(250)
+      .WillRepeatedly(Return(make_status_or(internal::EmptyResponse{})));
+
+  auto result =
+      ParallelDeleteByPrefix(*client, "test-bucket", "object-", 1, true);
+  EXPECT_TRUE(result.ok());
+  EXPECT_EQ(250, result.deleted_count);
+}
+
 TEST_F(ObjectTest, ComposeManyNone) {
   auto mock = std::make_shared<testing::MockClient>();
   auto const mock_options = ClientOptions(oauth2::CreateAnonymousCredentials());
@@ -786,12 +1060,84 @@ TEST_F(ObjectTest, ComposeManyThreeLayers) {
     return ComposeSourceObject{std::to_string(i++), 42, {}};
   });
 
-  auto res =
-      ComposeMany(client, "test-bucket", sources, "prefix", "dest", false);
+  // The expectations above depend on the order of the compositions.
+  auto res = ComposeMany(client, "test-bucket", sources, "prefix", "dest",
+                         false, MaxParallelCompositions(1));
   EXPECT_STATUS_OK(res);
   EXPECT_EQ("dest", res->name());
 }
 
+TEST_F(ObjectTest, ComposeManyParallelLevels) {
+  auto mock = std::make_shared<testing::MockClient>();
+  auto const mock_options = ClientOptions(oauth2::CreateAnonymousCredentials());
+  EXPECT_CALL(*mock, client_options()).WillRepeatedly(ReturnRef(mock_options));
+
+  // 32 * 32 + 1 sources require three levels: 33 compositions create the first
+  // level of temporary objects, 2 more create the second level, and the last
+  // one creates the destination.
+  std::mutex mu;
+  std::size_t running = 0;
+  std::size_t max_running = 0;
+  std::vector<std::string> composed;
+  EXPECT_CALL(*mock, ComposeObject(_))
+      .Times(36)
+      .WillRepeatedly(Invoke([&](internal::ComposeObjectRequest const& req)
+                                 -> StatusOr<ObjectMetadata> {
+        {
+          std::lock_guard<std::mutex> lk(mu);
+          max_running = std::max(max_running, ++running);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        std::lock_guard<std::mutex> lk(mu);
+        --running;
+        composed.push_back(req.object_name());
+        return MockObject(req.bucket_name(), req.object_name(), 42);
+      }));
+  EXPECT_CALL(*mock, InsertObjectMedia(_))
+      .WillOnce(
+          Return(make_status_or(MockObject("test-bucket", "prefix", 42))));
+  std::vector<std::string> deleted;
+  EXPECT_CALL(*mock, DeleteObject(_))
+      .Times(36)
+      .WillRepeatedly(Invoke([&](internal::DeleteObjectRequest const& r) {
+        EXPECT_EQ(42, r.GetOption<IfGenerationMatch>().value());
+        std::lock_guard<std::mutex> lk(mu);
+        deleted.push_back(r.object_name());
+        return make_status_or(internal::EmptyResponse{});
+      }));
+
+  Client client(mock);
+
+  std::vector<ComposeSourceObject> sources;
+  std::size_t i = 0;
+  std::generate_n(std::back_inserter(sources), 32 * 32 + 1, [&i] {
+    return ComposeSourceObject{std::to_string(i++), 42, {}};
+  });
+
+  auto res = ComposeMany(client, "test-bucket", sources, "prefix", "dest",
+                         false, MaxParallelCompositions(4));
+  ASSERT_STATUS_OK(res);
+  EXPECT_EQ("dest", res->name());
+  EXPECT_LT(1, max_running);
+  EXPECT_GE(4, max_running);
+  ASSERT_EQ(36, composed.size());
+  EXPECT_EQ("dest", composed.back());
+
+  // The second level objects and the lock are deleted last, in that order.
+  ASSERT_EQ(36, deleted.size());
+  EXPECT_EQ("prefix.compose-tmp-34", deleted[33]);
+  EXPECT_EQ("prefix.compose-tmp-33", deleted[34]);
+  EXPECT_EQ("prefix", deleted[35]);
+  std::sort(deleted.begin(), deleted.begin() + 33);
+  std::vector<std::string> expected;
+  for (int n = 0; n != 33; ++n) {
+    expected.push_back("prefix.compose-tmp-" + std::to_string(n));
+  }
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(expected, std::vector<std::string>(deleted.begin(),
+                                               deleted.begin() + 33));
+}
+
 TEST_F(ObjectTest, ComposeManyComposeFails) {
   auto mock = std::make_shared<testing::MockClient>();
   auto const mock_options = ClientOptions(oauth2::CreateAnonymousCredentials());
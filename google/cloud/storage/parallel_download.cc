@@ -0,0 +1,234 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/parallel_download.h"
+#include "google/cloud/internal/big_endian.h"
+#include "google/cloud/storage/internal/crc32c_combine.h"
+#include "google/cloud/storage/internal/openssl_util.h"
+#include <crc32c/crc32c.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif  // _WIN32
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+Status FileError(char const* where, char const* what,
+                 std::string const& file_name) {
+  auto const error = errno;
+  std::ostringstream os;
+  os << where << "(" << file_name << "): " << what
+     << " failed, error=" << ::strerror(error) << " [" << error << "]";
+  return Status(StatusCode::kUnknown, std::move(os).str());
+}
+
+/**
+ * Write to a file at arbitrary offsets.
+ *
+ * Each slice opens its own `SliceFile`, writing at different offsets via
+ * independent file descriptors requires no coordination between the threads.
+ */
+class SliceFile {
+ public:
+  SliceFile(std::string const& file_name, bool truncate)
+      : file_name_(file_name) {
+#ifdef _WIN32
+    int flags = _O_WRONLY | _O_BINARY;
+    if (truncate) {
+      flags |= _O_CREAT | _O_TRUNC;
+    }
+    fd_ = ::_open(file_name.c_str(), flags, _S_IREAD | _S_IWRITE);
+#else
+    int flags = O_WRONLY;
+    if (truncate) {
+      flags |= O_CREAT | O_TRUNC;
+    }
+    fd_ = ::open(file_name.c_str(), flags, S_IRUSR | S_IWUSR | S_IRGRP);
+#endif  // _WIN32
+  }
+
+  ~SliceFile() { (void)Close(); }
+
+  SliceFile(SliceFile const&) = delete;
+  SliceFile& operator=(SliceFile const&) = delete;
+
+  bool IsOpen() const { return fd_ != -1; }
+
+  Status WriteAt(std::uintmax_t offset, char const* data, std::size_t size) {
+#ifdef _WIN32
+    if (::_lseeki64(fd_, static_cast<__int64>(offset), SEEK_SET) == -1) {
+      return FileError(__func__, "_lseeki64()", file_name_);
+    }
+    while (size != 0) {
+      auto n = ::_write(fd_, data, static_cast<unsigned int>(size));
+      if (n < 0) {
+        return FileError(__func__, "_write()", file_name_);
+      }
+      data += n;
+      size -= static_cast<std::size_t>(n);
+    }
+#else
+    while (size != 0) {
+      auto n = ::pwrite(fd_, data, size, static_cast<off_t>(offset));
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return FileError(__func__, "pwrite()", file_name_);
+      }
+      data += n;
+      size -= static_cast<std::size_t>(n);
+      offset += static_cast<std::uintmax_t>(n);
+    }
+#endif  // _WIN32
+    return Status();
+  }
+
+  Status Close() {
+    if (fd_ == -1) {
+      return Status();
+    }
+#ifdef _WIN32
+    auto result = ::_close(fd_);
+#else
+    auto result = ::close(fd_);
+#endif  // _WIN32
+    fd_ = -1;
+    if (result != 0) {
+      return FileError(__func__, "close()", file_name_);
+    }
+    return Status();
+  }
+
+ private:
+  std::string file_name_;
+  int fd_;
+};
+}  // namespace
+
+Status CreateParallelDownloadFile(std::string const& file_name) {
+  SliceFile file(file_name, /*truncate=*/true);
+  if (!file.IsOpen()) {
+    return FileError(__func__, "open()", file_name);
+  }
+  return file.Close();
+}
+
+StatusOr<std::uint32_t> ParallelDownloadSlice(ObjectReadStream& stream,
+                                              std::string const& file_name,
+                                              std::uintmax_t offset,
+                                              std::uintmax_t size,
+                                              std::size_t buffer_size,
+                                              bool compute_crc32c) {
+  if (!stream.status().ok()) {
+    return stream.status();
+  }
+  SliceFile file(file_name, /*truncate=*/false);
+  if (!file.IsOpen()) {
+    return FileError(__func__, "open()", file_name);
+  }
+
+  std::uint32_t crc32c = 0;
+  std::uintmax_t received = 0;
+  std::vector<char> buffer(buffer_size);
+  while (true) {
+    // Use ReadInto() to copy the data straight into `buffer`, bypassing the
+    // stream's own buffer.
+    auto n = stream.ReadInto(buffer.data(), buffer.size());
+    if (!n) {
+      return std::move(n).status();
+    }
+    if (*n == 0) {
+      // A read can return no data before the download is complete, for
+      // example, if the service only sent headers.
+      if (!stream.IsOpen()) {
+        break;
+      }
+      continue;
+    }
+    auto status = file.WriteAt(offset + received, buffer.data(), *n);
+    if (!status.ok()) {
+      return status;
+    }
+    if (compute_crc32c) {
+      crc32c = crc32c::Extend(
+          crc32c, reinterpret_cast<std::uint8_t const*>(buffer.data()), *n);
+    }
+    received += *n;
+  }
+  if (received != size) {
+    std::ostringstream os;
+    os << __func__ << "(" << file_name << "): expected " << size
+       << " bytes for the slice at offset " << offset << ", but received "
+       << received;
+    return Status(StatusCode::kDataLoss, std::move(os).str());
+  }
+  auto status = file.Close();
+  if (!status.ok()) {
+    return status;
+  }
+  return crc32c;
+}
+
+Status FinishParallelDownload(
+    ObjectMetadata const& metadata,
+    std::vector<std::uintmax_t> const& split_points,
+    std::vector<StatusOr<std::uint32_t>> const& slice_results,
+    bool validate_crc32c) {
+  for (auto const& r : slice_results) {
+    if (!r) {
+      return r.status();
+    }
+  }
+  if (!validate_crc32c || metadata.crc32c().empty()) {
+    return Status();
+  }
+
+  std::uint32_t crc32c = 0;
+  std::uintmax_t offset = 0;
+  for (std::size_t i = 0; i != slice_results.size(); ++i) {
+    auto const slice_size = split_points[i] - offset;
+    crc32c = Crc32cCombine(crc32c, *slice_results[i], slice_size);
+    offset = split_points[i];
+  }
+  auto computed =
+      Base64Encode(google::cloud::internal::EncodeBigEndian(crc32c));
+  if (computed == metadata.crc32c()) {
+    return Status();
+  }
+  std::string msg;
+  msg += __func__;
+  msg += "(): mismatched hashes in download";
+  msg += ", expected=";
+  msg += computed;
+  msg += ", received=";
+  msg += metadata.crc32c();
+  return Status(StatusCode::kDataLoss, std::move(msg));
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
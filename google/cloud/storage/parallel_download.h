@@ -0,0 +1,190 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_PARALLEL_DOWNLOAD_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_PARALLEL_DOWNLOAD_H
+
+#include "google/cloud/internal/tuple.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/internal/tuple_filter.h"
+#include "google/cloud/storage/object_stream.h"
+#include "google/cloud/storage/parallel_upload.h"
+#include "google/cloud/storage/version.h"
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/**
+ * Create (or truncate) the destination file for `ParallelDownloadFile`.
+ *
+ * The slices are written into this file by `ParallelDownloadSlice()`, each
+ * using its own file descriptor.
+ */
+Status CreateParallelDownloadFile(std::string const& file_name);
+
+/**
+ * Download a slice of an object into an existing file.
+ *
+ * Reads all the data from @p stream, which should be a download of the
+ * `[offset, offset + size)` range of the object, and writes it at @p offset in
+ * @p file_name, without changing the rest of the file.
+ *
+ * @return the CRC32C checksum of the slice, or `0` if @p compute_crc32c is
+ *     false.
+ */
+StatusOr<std::uint32_t> ParallelDownloadSlice(ObjectReadStream& stream,
+                                              std::string const& file_name,
+                                              std::uintmax_t offset,
+                                              std::uintmax_t size,
+                                              std::size_t buffer_size,
+                                              bool compute_crc32c);
+
+/**
+ * Combine the results of the slices in a `ParallelDownloadFile` operation.
+ *
+ * Returns the first error (if any) in @p slice_results. Otherwise, if
+ * @p validate_crc32c is true, combines the checksums of the slices and compares
+ * the result against the checksum in @p metadata.
+ *
+ * @param metadata the metadata of the downloaded object.
+ * @param split_points the end offset of each slice.
+ * @param slice_results the result of `ParallelDownloadSlice()` for each slice.
+ * @param validate_crc32c if false, skip the checksum validation.
+ */
+Status FinishParallelDownload(
+    ObjectMetadata const& metadata,
+    std::vector<std::uintmax_t> const& split_points,
+    std::vector<StatusOr<std::uint32_t>> const& slice_results,
+    bool validate_crc32c);
+
+}  // namespace internal
+
+/**
+ * Perform a parallel download of a given object into a file.
+ *
+ * The object is split into slices, each downloaded via a separate (ranged)
+ * `ReadObject()` call running in its own thread, and written directly at its
+ * offset in the destination file. You can affect how many slices will be
+ * created by using the `MaxStreams` and `MinStreamSize` options.
+ *
+ * All the slices are pinned to the generation of the object found when the
+ * download starts. Interrupted slices are resumed using the client's retry
+ * policies, just like any other `ReadObject()` call. Unless disabled via
+ * `DisableCrc32cChecksum`, the CRC32C checksum of the object is validated by
+ * combining the checksums of the slices, without reading the file again.
+ *
+ * @note On failure the destination file may contain partial data.
+ *
+ * @param client the client on which to perform the operation.
+ * @param bucket_name the name of the bucket that contains the object.
+ * @param object_name the name of the object to be downloaded.
+ * @param file_name the name of the destination file that will have the object
+ *     media.
+ * @param options a list of optional query parameters and/or request headers.
+ *     Valid types for this operation include `DisableCrc32cChecksum`,
+ *     `EncryptionKey`, `Generation`, `IfGenerationMatch`,
+ *     `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+ *     `IfMetagenerationNotMatch`, `MaxStreams`, `MinStreamSize`, and
+ *     `UserProject`.
+ *
+ * @par Idempotency
+ * This is a read-only operation and is always idempotent.
+ */
+template <typename... Options>
+Status ParallelDownloadFile(Client client, std::string bucket_name,
+                            std::string object_name, std::string file_name,
+                            Options&&... options) {
+  auto metadata = google::cloud::internal::apply(
+      internal::GetObjectMetadataApplyHelper{client, bucket_name, object_name},
+      internal::StaticTupleFilter<
+          internal::Among<Generation, IfGenerationMatch, IfGenerationNotMatch,
+                          IfMetagenerationMatch, IfMetagenerationNotMatch,
+                          UserProject>::TPred>(std::tie(options...)));
+  if (!metadata) {
+    return std::move(metadata).status();
+  }
+
+  auto status = internal::CreateParallelDownloadFile(file_name);
+  if (!status.ok()) {
+    return status;
+  }
+
+  auto const disable_crc32c =
+      internal::ExtractFirstOccurenceOfType<DisableCrc32cChecksum>(
+          std::tie(options...));
+  bool const validate_crc32c = !disable_crc32c ||
+                               !disable_crc32c->has_value() ||
+                               !disable_crc32c->value();
+  auto split_points = internal::ComputeParallelFileUploadSplitPoints(
+      metadata->size(), std::tie(options...));
+  split_points.emplace_back(metadata->size());
+
+  // The preconditions were already checked, each slice only needs to read the
+  // same generation.
+  auto read_options = std::tuple_cat(
+      std::make_tuple(Generation(metadata->generation())),
+      internal::StaticTupleFilter<
+          internal::Among<EncryptionKey, UserProject>::TPred>(
+          std::tie(options...)));
+  auto const buffer_size =
+      client.raw_client()->client_options().download_buffer_size();
+
+  std::vector<StatusOr<std::uint32_t>> slice_results(split_points.size());
+  std::vector<std::thread> threads;
+  threads.reserve(split_points.size());
+  std::uintmax_t offset = 0;
+  for (std::size_t i = 0; i != split_points.size(); ++i) {
+    auto const slice_end = split_points[i];
+    if (slice_end == offset) {
+      // Empty objects produce a single, empty, slice. There is nothing to
+      // download, and `ReadRange` cannot represent an empty range.
+      slice_results[i] = std::uint32_t{0};
+      continue;
+    }
+    threads.emplace_back([&, i, offset, slice_end] {
+      auto stream = google::cloud::internal::apply(
+          internal::ReadObjectApplyHelper{client, bucket_name, object_name},
+          std::tuple_cat(
+              std::make_tuple(ReadRange(static_cast<std::int64_t>(offset),
+                                        static_cast<std::int64_t>(slice_end))),
+              read_options));
+      slice_results[i] = internal::ParallelDownloadSlice(
+          stream, file_name, offset, slice_end - offset, buffer_size,
+          validate_crc32c);
+    });
+    offset = slice_end;
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return internal::FinishParallelDownload(*metadata, split_points,
+                                          slice_results, validate_crc32c);
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_PARALLEL_DOWNLOAD_H
@@ -0,0 +1,268 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/parallel_download.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
+#include "google/cloud/storage/retry_policy.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+std::string const kBucketName = "test-bucket";
+std::string const kObjectName = "test-object";
+std::int64_t const kGeneration = 123;
+
+ObjectMetadata MockObject(std::string const& contents,
+                          std::string const& crc32c) {
+  auto metadata = internal::ObjectMetadataParser::FromJson(internal::nl::json{
+      {"bucket", kBucketName},
+      {"name", kObjectName},
+      {"generation", kGeneration},
+      {"size", contents.size()},
+      {"crc32c", crc32c}});
+  EXPECT_STATUS_OK(metadata);
+  return *metadata;
+}
+
+std::string ReadFile(std::string const& file_name) {
+  std::ifstream is(file_name, std::ios::binary);
+  return std::string{std::istreambuf_iterator<char>{is}, {}};
+}
+
+class ParallelDownloadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    raw_client_mock = std::make_shared<testing::MockClient>();
+    client_options.SetDownloadBufferSize(4);
+    EXPECT_CALL(*raw_client_mock, client_options())
+        .WillRepeatedly(ReturnRef(client_options));
+    client.reset(new Client{
+        std::shared_ptr<internal::RawClient>(raw_client_mock),
+        LimitedErrorCountRetryPolicy(2),
+        ExponentialBackoffPolicy(std::chrono::milliseconds(1),
+                                 std::chrono::milliseconds(1), 2.0)});
+  }
+  void TearDown() override {
+    client.reset();
+    raw_client_mock.reset();
+  }
+
+  /**
+   * Serve the ranges requested via `ReadObject()` from @p contents.
+   *
+   * If @p empty_reads is true every other `Read()` returns no data, as if the
+   * service only sent headers.
+   */
+  void ExpectReadRanges(std::string const& contents, bool empty_reads = false) {
+    EXPECT_CALL(*raw_client_mock, ReadObject(_))
+        .WillRepeatedly(
+            Invoke([contents, empty_reads](
+                       internal::ReadObjectRangeRequest const& r) {
+              EXPECT_EQ(kBucketName, r.bucket_name());
+              EXPECT_EQ(kObjectName, r.object_name());
+              EXPECT_TRUE(r.HasOption<Generation>());
+              EXPECT_EQ(kGeneration, r.GetOption<Generation>().value());
+              EXPECT_TRUE(r.HasOption<ReadRange>());
+              auto const range = r.GetOption<ReadRange>().value();
+              auto slice = std::make_shared<std::string>(contents.substr(
+                  static_cast<std::size_t>(range.begin),
+                  static_cast<std::size_t>(range.end - range.begin)));
+              auto source = google::cloud::internal::make_unique<
+                  testing::MockObjectReadSource>();
+              // Like the real sources, the source closes once the download
+              // completes.
+              auto closed = std::make_shared<bool>(false);
+              EXPECT_CALL(*source, IsOpen()).WillRepeatedly(Invoke([closed] {
+                return !*closed;
+              }));
+              auto calls = std::make_shared<int>(0);
+              EXPECT_CALL(*source, Read(_, _))
+                  .WillRepeatedly(Invoke([slice, empty_reads, closed, calls](
+                                             char* buf, std::size_t n) {
+                    if (empty_reads && !slice->empty() && ++*calls % 2 == 1) {
+                      return internal::ReadSourceResult{
+                          0, internal::HttpResponse{100, "", {}}};
+                    }
+                    n = (std::min)(n, slice->size());
+                    std::memcpy(buf, slice->data(), n);
+                    slice->erase(0, n);
+                    *closed = n == 0;
+                    return internal::ReadSourceResult{
+                        n, internal::HttpResponse{n == 0 ? 200 : 100, "", {}}};
+                  }));
+              EXPECT_CALL(*source, Close())
+                  .WillRepeatedly(
+                      Return(internal::HttpResponse{200, "", {}}));
+              return StatusOr<std::unique_ptr<internal::ObjectReadSource>>(
+                  std::move(source));
+            }));
+  }
+
+  std::shared_ptr<testing::MockClient> raw_client_mock;
+  std::unique_ptr<Client> client;
+  ClientOptions client_options =
+      ClientOptions(oauth2::CreateAnonymousCredentials());
+};
+
+TEST_F(ParallelDownloadTest, Success) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  EXPECT_CALL(*raw_client_mock, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(
+          MockObject(contents, ComputeCrc32cChecksum(contents)))));
+  ExpectReadRanges(contents);
+
+  testing::TempFile temp_file("some previous contents of the file, longer");
+  auto status =
+      ParallelDownloadFile(*client, kBucketName, kObjectName, temp_file.name(),
+                           MaxStreams(5), MinStreamSize(4));
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+}
+
+TEST_F(ParallelDownloadTest, EmptyReadsBeforeEnd) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  EXPECT_CALL(*raw_client_mock, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(
+          MockObject(contents, ComputeCrc32cChecksum(contents)))));
+  ExpectReadRanges(contents, /*empty_reads=*/true);
+
+  testing::TempFile temp_file("");
+  auto status =
+      ParallelDownloadFile(*client, kBucketName, kObjectName, temp_file.name(),
+                           MaxStreams(3), MinStreamSize(4));
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+}
+
+TEST_F(ParallelDownloadTest, SingleSlice) {
+  std::string const contents = "0123456789";
+  EXPECT_CALL(*raw_client_mock, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(
+          MockObject(contents, ComputeCrc32cChecksum(contents)))));
+  ExpectReadRanges(contents);
+
+  testing::TempFile temp_file("");
+  auto status = ParallelDownloadFile(*client, kBucketName, kObjectName,
+                                     temp_file.name(), MaxStreams(1));
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+}
+
+TEST_F(ParallelDownloadTest, EmptyObject) {
+  std::string const contents;
+  EXPECT_CALL(*raw_client_mock, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(
+          MockObject(contents, ComputeCrc32cChecksum(contents)))));
+  EXPECT_CALL(*raw_client_mock, ReadObject(_)).Times(0);
+
+  testing::TempFile temp_file("not empty");
+  auto status = ParallelDownloadFile(*client, kBucketName, kObjectName,
+                                     temp_file.name());
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+}
+
+TEST_F(ParallelDownloadTest, ChecksumMismatch) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  EXPECT_CALL(*raw_client_mock, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(
+          MockObject(contents, ComputeCrc32cChecksum("something else")))));
+  ExpectReadRanges(contents);
+
+  testing::TempFile temp_file("");
+  auto status =
+      ParallelDownloadFile(*client, kBucketName, kObjectName, temp_file.name(),
+                           MaxStreams(5), MinStreamSize(4));
+  EXPECT_EQ(StatusCode::kDataLoss, status.code());
+}
+
+TEST_F(ParallelDownloadTest, ChecksumDisabled) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  EXPECT_CALL(*raw_client_mock, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(
+          MockObject(contents, ComputeCrc32cChecksum("something else")))));
+  ExpectReadRanges(contents);
+
+  testing::TempFile temp_file("");
+  auto status = ParallelDownloadFile(
+      *client, kBucketName, kObjectName, temp_file.name(), MaxStreams(5),
+      MinStreamSize(4), DisableCrc32cChecksum(true));
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(contents, ReadFile(temp_file.name()));
+}
+
+TEST_F(ParallelDownloadTest, MetadataFailure) {
+  EXPECT_CALL(*raw_client_mock, GetObjectMetadata(_))
+      .WillOnce(Return(StatusOr<ObjectMetadata>(PermanentError())));
+  EXPECT_CALL(*raw_client_mock, ReadObject(_)).Times(0);
+
+  testing::TempFile temp_file("");
+  auto status = ParallelDownloadFile(*client, kBucketName, kObjectName,
+                                     temp_file.name());
+  EXPECT_EQ(PermanentError().code(), status.code());
+}
+
+TEST_F(ParallelDownloadTest, SliceFailure) {
+  std::string const contents = "The quick brown fox jumps over the lazy dog";
+  EXPECT_CALL(*raw_client_mock, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(
+          MockObject(contents, ComputeCrc32cChecksum(contents)))));
+  EXPECT_CALL(*raw_client_mock, ReadObject(_))
+      .WillRepeatedly(Invoke([](internal::ReadObjectRangeRequest const&) {
+        return StatusOr<std::unique_ptr<internal::ObjectReadSource>>(
+            PermanentError());
+      }));
+
+  testing::TempFile temp_file("");
+  auto status =
+      ParallelDownloadFile(*client, kBucketName, kObjectName, temp_file.name(),
+                           MaxStreams(3), MinStreamSize(16));
+  EXPECT_EQ(PermanentError().code(), status.code());
+}
+
+TEST_F(ParallelDownloadTest, CannotCreateFile) {
+  std::string const contents = "0123456789";
+  EXPECT_CALL(*raw_client_mock, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(
+          MockObject(contents, ComputeCrc32cChecksum(contents)))));
+  EXPECT_CALL(*raw_client_mock, ReadObject(_)).Times(0);
+
+  auto status = ParallelDownloadFile(*client, kBucketName, kObjectName,
+                                     "/not-a-directory/not-a-file");
+  EXPECT_FALSE(status.ok());
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -13,6 +13,10 @@
 // limitations under the License.
 
 #include "google/cloud/storage/parallel_upload.h"
+#include "google/cloud/internal/big_endian.h"
+#include "google/cloud/storage/internal/crc32c_combine.h"
+#include "google/cloud/storage/internal/openssl_util.h"
+#include <crc32c/crc32c.h>
 
 namespace google {
 namespace cloud {
@@ -26,9 +30,11 @@ class ParallelObjectWriteStreambuf : public ObjectWriteStreambuf {
       std::shared_ptr<ParallelUploadStateImpl> state, std::size_t stream_idx,
       std::unique_ptr<ResumableUploadSession> upload_session,
       std::size_t max_buffer_size,
-      std::unique_ptr<HashValidator> hash_validator)
+      std::unique_ptr<HashValidator> hash_validator,
+      std::shared_ptr<BufferPool> buffer_pool)
       : ObjectWriteStreambuf(std::move(upload_session), max_buffer_size,
-                             std::move(hash_validator)),
+                             std::move(hash_validator), {},
+                             std::move(buffer_pool)),
         state_(std::move(state)),
         stream_idx_(stream_idx) {}
 
@@ -79,14 +85,16 @@ StatusOr<ObjectWriteStream> ParallelUploadStateImpl::CreateStream(
   auto idx = streams_.size();
   ++num_unfinished_streams_;
   streams_.emplace_back(
-      StreamInfo{request.object_name(), (*session)->session_id(), {}, false});
+      StreamInfo{request.object_name(), (*session)->session_id(), {}, false,
+                 {}, 0});
   assert(idx < streams_.size());
   lk.unlock();
   return ObjectWriteStream(
       google::cloud::internal::make_unique<ParallelObjectWriteStreambuf>(
           shared_from_this(), idx, *std::move(session),
           raw_client.client_options().upload_buffer_size(),
-          CreateHashValidator(request)));
+          CreateHashValidator(request),
+          raw_client.client_options().buffer_pool()));
 }
 
 std::string ParallelUploadPersistentState::ToString() const {
@@ -252,6 +260,10 @@ void ParallelUploadStateImpl::AllStreamsFinished(
     lk.lock();
     if (res) {
       deleter_->Enable(true);
+      auto status = ValidateCrc32c(*res);
+      if (!status.ok()) {
+        res = std::move(status);
+      }
     }
     res_ = std::move(res);
   }
@@ -309,6 +321,46 @@ void ParallelUploadStateImpl::StreamDestroyed(std::size_t stream_idx) {
   }
 }
 
+void ParallelUploadStateImpl::SetStreamCrc32c(std::size_t stream_idx,
+                                              std::uint32_t crc32c,
+                                              std::uint64_t size) {
+  std::unique_lock<std::mutex> lk(mu_);
+  assert(stream_idx < streams_.size());
+  streams_[stream_idx].crc32c = crc32c;
+  streams_[stream_idx].size = size;
+}
+
+Status ParallelUploadStateImpl::ValidateCrc32c(
+    ObjectMetadata const& composed) const {
+  if (composed.crc32c().empty()) {
+    return Status();
+  }
+  // The streams are composed in order, so the checksum of the composed object
+  // is the combination of the checksums of each stream.
+  std::uint32_t crc32c = 0;
+  for (auto const& stream : streams_) {
+    if (!stream.crc32c.has_value()) {
+      // Nothing to validate against, the application wrote to this stream
+      // directly.
+      return Status();
+    }
+    crc32c = Crc32cCombine(crc32c, *stream.crc32c, stream.size);
+  }
+  auto computed =
+      Base64Encode(google::cloud::internal::EncodeBigEndian(crc32c));
+  if (computed == composed.crc32c()) {
+    return Status();
+  }
+  std::string msg;
+  msg += __func__;
+  msg += "(): mismatched hashes in upload";
+  msg += ", expected=";
+  msg += computed;
+  msg += ", received=";
+  msg += composed.crc32c();
+  return Status(StatusCode::kDataLoss, std::move(msg));
+}
+
 future<StatusOr<ObjectMetadata>> ParallelUploadStateImpl::WaitForCompletion()
     const {
   std::unique_lock<std::mutex> lk(mu_);
@@ -388,6 +440,27 @@ Status ParallelUploadFileShard::Upload() {
   if (!istream.good()) {
     return fail(StatusCode::kNotFound, "cannot open upload file source");
   }
+  std::uintmax_t const shard_size = already_uploaded + left_to_upload_;
+  std::uint32_t crc32c = 0;
+  auto update_crc32c = [&crc32c, &buf](std::size_t n) {
+    crc32c = crc32c::Extend(
+        crc32c, reinterpret_cast<std::uint8_t const*>(buf.get()), n);
+  };
+  if (compute_crc32c_ && already_uploaded > 0) {
+    // The data uploaded before this upload was resumed is part of the shard's
+    // checksum, reading it from the file is cheaper than downloading it.
+    istream.seekg(offset_in_file_ - already_uploaded);
+    for (auto left = already_uploaded; left > 0;) {
+      std::size_t const to_read =
+          std::min<std::uintmax_t>(left, upload_buffer_size_);
+      istream.read(buf.get(), to_read);
+      if (!istream.good()) {
+        return fail(StatusCode::kInternal, "cannot read from file source");
+      }
+      update_crc32c(to_read);
+      left -= to_read;
+    }
+  }
   istream.seekg(offset_in_file_);
   if (!istream.good()) {
     return fail(StatusCode::kInternal, "file changed size during upload?");
@@ -399,6 +472,9 @@ Status ParallelUploadFileShard::Upload() {
     if (!istream.good()) {
       return fail(StatusCode::kInternal, "cannot read from file source");
     }
+    if (compute_crc32c_) {
+      update_crc32c(to_copy);
+    }
     ostream_.write(buf.get(), to_copy);
     if (!ostream_.good()) {
       return Status(StatusCode::kInternal,
@@ -407,6 +483,9 @@ Status ParallelUploadFileShard::Upload() {
     }
     left_to_upload_ -= to_copy;
   }
+  if (compute_crc32c_) {
+    state_->SetStreamCrc32c(stream_idx_, crc32c, shard_size);
+  }
   ostream_.Close();
   if (ostream_.metadata()) {
     return Status();
@@ -38,7 +38,7 @@ namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 /**
  * A parameter type indicating the maximum number of streams to
- * `ParallelUploadFile`.
+ * `ParallelUploadFile` or `ParallelDownloadFile`.
  */
 class MaxStreams {
  public:
@@ -50,11 +50,13 @@ class MaxStreams {
 };
 
 /**
- * A parameter type indicating the minimum stream size to `ParallelUploadFile`.
+ * A parameter type indicating the minimum stream size to `ParallelUploadFile`
+ * or `ParallelDownloadFile`.
  *
  * If `ParallelUploadFile`, receives this option it will attempt to make sure
  * that every shard is at least this long. This might not apply to the last
  * shard because it will be the remainder of the division of the file.
+ * `ParallelDownloadFile` applies the same rules to the slices of the object.
  */
 class MinStreamSize {
  public:
@@ -69,31 +71,6 @@ namespace internal {
 
 class ParallelUploadFileShard;
 
-/**
- * Return an empty option if Tuple contains an element of type T, otherwise
- *     return the value of the first element of type T
- */
-template <typename T, typename Tuple, typename Enable = void>
-struct ExtractFirstOccurenceOfTypeImpl {
-  optional<T> operator()(Tuple const&) { return optional<T>(); }
-};
-
-template <typename T, typename... Options>
-struct ExtractFirstOccurenceOfTypeImpl<
-    T, std::tuple<Options...>,
-    typename std::enable_if<
-        Among<typename std::decay<Options>::type...>::template TPred<
-            typename std::decay<T>::type>::value>::type> {
-  optional<T> operator()(std::tuple<Options...> const& tuple) {
-    return std::get<0>(StaticTupleFilter<Among<T>::template TPred>(tuple));
-  }
-};
-
-template <typename T, typename Tuple>
-optional<T> ExtractFirstOccurenceOfType(Tuple const& tuple) {
-  return ExtractFirstOccurenceOfTypeImpl<T, Tuple>()(tuple);
-}
-
 /**
  * An option for `PrepareParallelUpload` to associate opaque data with upload.
  *
@@ -167,6 +144,16 @@ class ParallelUploadStateImpl
 
   void StreamDestroyed(std::size_t stream_idx);
 
+  /**
+   * Record the CRC32C checksum and size of the data written to a stream.
+   *
+   * If the checksum is known for all the streams, the checksum of the composed
+   * object is validated against them. Must be called before the stream is
+   * closed.
+   */
+  void SetStreamCrc32c(std::size_t stream_idx, std::uint32_t crc32c,
+                       std::uint64_t size);
+
   future<StatusOr<ObjectMetadata>> WaitForCompletion() const;
 
   Status EagerCleanup();
@@ -213,8 +200,12 @@ class ParallelUploadStateImpl
     std::string resumable_session_id;
     optional<ComposeSourceObject> composition_arg;
     bool finished;
+    optional<std::uint32_t> crc32c;
+    std::uint64_t size;
   };
 
+  Status ValidateCrc32c(ObjectMetadata const& composed) const;
+
   mutable std::mutex mu_;
   // Promises made via `WaitForCompletion()`
   mutable std::vector<promise<StatusOr<ObjectMetadata>>> res_promises_;
@@ -352,24 +343,28 @@ class ParallelUploadFileShard {
 
  private:
   ParallelUploadFileShard(std::shared_ptr<ParallelUploadStateImpl> state,
-                          ObjectWriteStream ostream, std::string file_name,
-                          std::uintmax_t offset_in_file,
+                          std::size_t stream_idx, ObjectWriteStream ostream,
+                          std::string file_name, std::uintmax_t offset_in_file,
                           std::uintmax_t bytes_to_upload,
-                          std::size_t upload_buffer_size)
+                          std::size_t upload_buffer_size, bool compute_crc32c)
       : state_(std::move(state)),
+        stream_idx_(stream_idx),
         ostream_(std::move(ostream)),
         file_name_(std::move(file_name)),
         offset_in_file_(offset_in_file),
         left_to_upload_(bytes_to_upload),
         upload_buffer_size_(upload_buffer_size),
+        compute_crc32c_(compute_crc32c),
         resumable_session_id_(state_->resumable_session_id()) {}
 
   std::shared_ptr<ParallelUploadStateImpl> state_;
+  std::size_t stream_idx_;
   ObjectWriteStream ostream_;
   std::string file_name_;
   std::uintmax_t offset_in_file_;
   std::uintmax_t left_to_upload_;
   std::size_t upload_buffer_size_;
+  bool compute_crc32c_;
   std::string resumable_session_id_;
 
   template <typename... Options>
@@ -1104,6 +1099,14 @@ StatusOr<std::vector<ParallelUploadFileShard>> CreateUploadShards(
   auto upload_buffer_size =
       client.raw_client()->client_options().upload_buffer_size();
 
+  // Each shard computes the CRC32C checksum of its data, which is used to
+  // validate the composed object, unless the application disabled it.
+  auto const disable_crc32c =
+      ExtractFirstOccurenceOfType<DisableCrc32cChecksum>(std::tie(options...));
+  bool const compute_crc32c = !disable_crc32c ||
+                              !disable_crc32c->has_value() ||
+                              !disable_crc32c->value();
+
   file_split_points.emplace_back(file_size);
   assert(file_split_points.size() == state->shards().size());
   std::vector<ParallelUploadFileShard> res;
@@ -1111,8 +1114,10 @@ StatusOr<std::vector<ParallelUploadFileShard>> CreateUploadShards(
   std::size_t shard_idx = 0;
   for (auto shard_end : file_split_points) {
     res.emplace_back(ParallelUploadFileShard(
-        state->impl_, std::move(state->shards()[shard_idx++]), file_name,
-        offset, shard_end - offset, upload_buffer_size));
+        state->impl_, shard_idx, std::move(state->shards()[shard_idx]),
+        file_name, offset, shard_end - offset, upload_buffer_size,
+        compute_crc32c));
+    ++shard_idx;
     offset = shard_end;
   }
 #if !defined(__clang__) && \
@@ -1133,6 +1138,11 @@ StatusOr<std::vector<ParallelUploadFileShard>> CreateUploadShards(
  * You can affect how many shards will be created by using the `MaxStreams` and
  * `MinStreamSize` options.
  *
+ * Each shard computes the CRC32C checksum of its data while uploading. The
+ * checksum of the destination object is validated against the combination of
+ * these checksums, and any mismatch is reported as `StatusCode::kDataLoss`.
+ * Use `DisableCrc32cChecksum(true)` to skip this validation.
+ *
  * @param client the client on which to perform the operation.
  * @param file_name the path to the file to be uploaded
  * @param bucket_name the name of the bucket that will contain the object.
@@ -1142,9 +1152,10 @@ StatusOr<std::vector<ParallelUploadFileShard>> CreateUploadShards(
  *     objects as not fatal.
  * @param options a list of optional query parameters and/or request headers.
  *     Valid types for this operation include `DestinationPredefinedAcl`,
- *     `EncryptionKey`, `IfGenerationMatch`, `IfMetagenerationMatch`,
- *     `KmsKeyName`, `MaxStreams, `MinStreamSize`, `QuotaUser`, `UserIp`,
- *     `UserProject`, `WithObjectMetadata`, `UseResumableUploadSession`.
+ *     `DisableCrc32cChecksum`, `EncryptionKey`, `IfGenerationMatch`,
+ *     `IfMetagenerationMatch`, `KmsKeyName`, `MaxStreams, `MinStreamSize`,
+ *     `QuotaUser`, `UserIp`, `UserProject`, `WithObjectMetadata`,
+ *     `UseResumableUploadSession`.
  *
  * @return the metadata of the object created by the upload.
  *
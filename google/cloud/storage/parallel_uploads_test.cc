@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "google/cloud/storage/hashing_options.h"
 #include "google/cloud/storage/oauth2/google_credentials.h"
 #include "google/cloud/storage/parallel_upload.h"
 #include "google/cloud/storage/retry_policy.h"
@@ -63,12 +64,13 @@ std::string ObjectId(std::string const& bucket, std::string const& object,
   return bucket + "/" + object + "/" + std::to_string(generation);
 }
 
-ObjectMetadata MockObject(std::string const& object_name, int generation) {
+ObjectMetadata MockObject(std::string const& object_name, int generation,
+                          std::string const& crc32c = "d1e2f3") {
   auto metadata = internal::ObjectMetadataParser::FromJson(internal::nl::json{
       {"contentDisposition", "a-disposition"},
       {"contentLanguage", "a-language"},
       {"contentType", "application/octet-stream"},
-      {"crc32c", "d1e2f3"},
+      {"crc32c", crc32c},
       {"etag", "XYZ="},
       {"kind", "storage#object"},
       {"md5Hash", "xa1b2c3=="},
@@ -586,7 +588,9 @@ TEST_F(ParallelUploadTest, FileSuccessWithMaxStreamsNotReached) {
           {{kPrefix + ".upload_shard_0", 111},
            {kPrefix + ".upload_shard_1", 222},
            {kPrefix + ".upload_shard_2", 333}},
-          kDestObjectName, MockObject(kDestObjectName, kDestGeneration))));
+          kDestObjectName,
+          MockObject(kDestObjectName, kDestGeneration,
+                     ComputeCrc32cChecksum("abc")))));
 
   ExpectedDeletions deletions({{{kPrefix + ".upload_shard_0", 111}, Status()},
                                {{kPrefix + ".upload_shard_1", 222}, Status()},
@@ -640,7 +644,9 @@ TEST_F(ParallelUploadTest, FileSuccessWithMaxStreamsReached) {
       .WillOnce(Invoke(create_composition_check(
           {{kPrefix + ".upload_shard_0", 111},
            {kPrefix + ".upload_shard_1", 222}},
-          kDestObjectName, MockObject(kDestObjectName, kDestGeneration))));
+          kDestObjectName,
+          MockObject(kDestObjectName, kDestGeneration,
+                     ComputeCrc32cChecksum("abc")))));
 
   ExpectedDeletions deletions({{{kPrefix + ".upload_shard_0", 111}, Status()},
                                {{kPrefix + ".upload_shard_1", 222}, Status()}});
@@ -688,7 +694,8 @@ TEST_F(ParallelUploadTest, FileSuccessWithEmptyFile) {
   EXPECT_CALL(*raw_client_mock, ComposeObject(_))
       .WillOnce(Invoke(create_composition_check(
           {{kPrefix + ".upload_shard_0", 111}}, kDestObjectName,
-          MockObject(kDestObjectName, kDestGeneration))));
+          MockObject(kDestObjectName, kDestGeneration,
+                     ComputeCrc32cChecksum("")))));
 
   ExpectedDeletions deletions({{{kPrefix + ".upload_shard_0", 111}, Status()}});
   EXPECT_CALL(*raw_client_mock, DeleteObject(_))
@@ -912,7 +919,9 @@ TEST_F(ParallelUploadTest, FileSuccessBasic) {
           {{kPrefix + ".upload_shard_0", 111},
            {kPrefix + ".upload_shard_1", 222},
            {kPrefix + ".upload_shard_2", 333}},
-          kDestObjectName, MockObject(kDestObjectName, kDestGeneration))));
+          kDestObjectName,
+          MockObject(kDestObjectName, kDestGeneration,
+                     ComputeCrc32cChecksum("abc")))));
 
   ExpectedDeletions deletions({{{kPrefix + ".upload_shard_0", 111}, Status()},
                                {{kPrefix + ".upload_shard_1", 222}, Status()},
@@ -939,6 +948,97 @@ TEST_F(ParallelUploadTest, FileSuccessBasic) {
   EXPECT_EQ(kBucketName, res->bucket());
 }
 
+TEST_F(ParallelUploadTest, FileCrc32cMismatch) {
+  // The expectations need to be reversed.
+  ExpectCreateSession(kPrefix + ".upload_shard_2", 333, "c");
+  ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "b");
+  ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "a");
+
+  testing::TempFile temp_file("abc");
+
+  EXPECT_CALL(*raw_client_mock, InsertObjectMedia(_))
+      .WillOnce(Invoke(expect_new_object(kPrefix, kUploadMarkerGeneration)))
+      .WillOnce(Invoke(expect_new_object(kPrefix + ".compose_many",
+                                         kComposeMarkerGeneration)));
+  // The checksum in the composed object does not match the data.
+  EXPECT_CALL(*raw_client_mock, ComposeObject(_))
+      .WillOnce(Invoke(create_composition_check(
+          {{kPrefix + ".upload_shard_0", 111},
+           {kPrefix + ".upload_shard_1", 222},
+           {kPrefix + ".upload_shard_2", 333}},
+          kDestObjectName, MockObject(kDestObjectName, kDestGeneration))));
+
+  ExpectedDeletions deletions({{{kPrefix + ".upload_shard_0", 111}, Status()},
+                               {{kPrefix + ".upload_shard_1", 222}, Status()},
+                               {{kPrefix + ".upload_shard_2", 333}, Status()}});
+  EXPECT_CALL(*raw_client_mock, DeleteObject(_))
+      .WillOnce(Invoke(
+          expect_deletion(kPrefix + ".compose_many", kComposeMarkerGeneration)))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke(expect_deletion(kPrefix, kUploadMarkerGeneration)));
+
+  auto res =
+      ParallelUploadFile(*client, temp_file.name(), kBucketName,
+                         kDestObjectName, kPrefix, false, MinStreamSize(1));
+  ASSERT_FALSE(res);
+  EXPECT_EQ(StatusCode::kDataLoss, res.status().code());
+  EXPECT_THAT(res.status().message(), HasSubstr("mismatched hashes"));
+  EXPECT_THAT(res.status().message(),
+              HasSubstr("expected=" + ComputeCrc32cChecksum("abc")));
+}
+
+TEST_F(ParallelUploadTest, FileCrc32cDisabled) {
+  // The expectations need to be reversed.
+  ExpectCreateSession(kPrefix + ".upload_shard_2", 333, "c");
+  ExpectCreateSession(kPrefix + ".upload_shard_1", 222, "b");
+  ExpectCreateSession(kPrefix + ".upload_shard_0", 111, "a");
+
+  testing::TempFile temp_file("abc");
+
+  EXPECT_CALL(*raw_client_mock, InsertObjectMedia(_))
+      .WillOnce(Invoke(expect_new_object(kPrefix, kUploadMarkerGeneration)))
+      .WillOnce(Invoke(expect_new_object(kPrefix + ".compose_many",
+                                         kComposeMarkerGeneration)));
+  // The checksum in the composed object does not match the data.
+  EXPECT_CALL(*raw_client_mock, ComposeObject(_))
+      .WillOnce(Invoke(create_composition_check(
+          {{kPrefix + ".upload_shard_0", 111},
+           {kPrefix + ".upload_shard_1", 222},
+           {kPrefix + ".upload_shard_2", 333}},
+          kDestObjectName, MockObject(kDestObjectName, kDestGeneration))));
+
+  ExpectedDeletions deletions({{{kPrefix + ".upload_shard_0", 111}, Status()},
+                               {{kPrefix + ".upload_shard_1", 222}, Status()},
+                               {{kPrefix + ".upload_shard_2", 333}, Status()}});
+  EXPECT_CALL(*raw_client_mock, DeleteObject(_))
+      .WillOnce(Invoke(
+          expect_deletion(kPrefix + ".compose_many", kComposeMarkerGeneration)))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke([&deletions](internal::DeleteObjectRequest const& r) {
+        return deletions(r);
+      }))
+      .WillOnce(Invoke(expect_deletion(kPrefix, kUploadMarkerGeneration)));
+
+  auto res = ParallelUploadFile(*client, temp_file.name(), kBucketName,
+                                kDestObjectName, kPrefix, false,
+                                MinStreamSize(1), DisableCrc32cChecksum(true));
+  EXPECT_STATUS_OK(res);
+  EXPECT_EQ(kDestObjectName, res->name());
+}
+
 TEST_F(ParallelUploadTest, UploadNonExistentFile) {
   auto res =
       ParallelUploadFile(*client, "nonexistent", kBucketName, kDestObjectName,
@@ -958,7 +1058,8 @@ TEST_F(ParallelUploadTest, CleanupFailureIsIgnored) {
   EXPECT_CALL(*raw_client_mock, ComposeObject(_))
       .WillOnce(Invoke(create_composition_check(
           {{kPrefix + ".upload_shard_0", 111}}, kDestObjectName,
-          MockObject(kDestObjectName, kDestGeneration))));
+          MockObject(kDestObjectName, kDestGeneration,
+                     ComputeCrc32cChecksum("abc")))));
 
   ExpectedDeletions deletions(
       {{{kPrefix + ".upload_shard_0", 111}, PermanentError()}});
@@ -987,7 +1088,8 @@ TEST_F(ParallelUploadTest, CleanupFailureIsNotIgnored) {
   EXPECT_CALL(*raw_client_mock, ComposeObject(_))
       .WillOnce(Invoke(create_composition_check(
           {{kPrefix + ".upload_shard_0", 111}}, kDestObjectName,
-          MockObject(kDestObjectName, kDestGeneration))));
+          MockObject(kDestObjectName, kDestGeneration,
+                     ComputeCrc32cChecksum("abc")))));
 
   ExpectedDeletions deletions(
       {{{kPrefix + ".upload_shard_0", 111}, PermanentError()}});
@@ -1707,7 +1809,9 @@ TEST_F(ParallelUploadTest, ResumableUploadFileShards) {
           {{kPrefix + ".upload_shard_0", 111},
            {kPrefix + ".upload_shard_1", 222},
            {kPrefix + ".upload_shard_2", 333}},
-          kDestObjectName, MockObject(kDestObjectName, kDestGeneration))));
+          kDestObjectName,
+          MockObject(kDestObjectName, kDestGeneration,
+                     ComputeCrc32cChecksum("abc")))));
 
   ExpectedDeletions deletions({{{kPrefix + ".upload_shard_0", 111}, Status()},
                                {{kPrefix + ".upload_shard_1", 222}, Status()},
@@ -1821,7 +1925,9 @@ TEST_F(ParallelUploadTest, SuspendUploadFileResume) {
           {{kPrefix + ".upload_shard_0", 111},
            {kPrefix + ".upload_shard_1", 222},
            {kPrefix + ".upload_shard_2", 333}},
-          kDestObjectName, MockObject(kDestObjectName, kDestGeneration))));
+          kDestObjectName,
+          MockObject(kDestObjectName, kDestGeneration,
+                     ComputeCrc32cChecksum("abcdefghi")))));
   EXPECT_CALL(*raw_client_mock, ReadObject(_))
       .WillOnce(Invoke(create_state_read_expectation(
           kPersistentStateName, kPersistentStateGeneration, state_json)));
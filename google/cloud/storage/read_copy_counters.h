@@ -0,0 +1,55 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_READ_COPY_COUNTERS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_READ_COPY_COUNTERS_H
+
+#include "google/cloud/storage/version.h"
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * Count the memory copies performed to deliver the data in a download.
+ *
+ * libcurl receives the data into its own buffers, so every byte is copied at
+ * least once on its way to the application. Some bytes must be copied again,
+ * because they are staged in intermediate buffers. For example, when libcurl
+ * delivers more data than the application requested, or when the data is read
+ * using the `std::streambuf` get area (e.g. via `operator>>` or `get()`).
+ *
+ * The average number of copies per byte is
+ * `1 + bytes_staged / bytes_delivered`.
+ */
+struct ReadCopyCounters {
+  /// The number of bytes delivered to the caller.
+  std::uint64_t bytes_delivered = 0;
+  /// The number of bytes copied into, or out of, intermediate buffers.
+  std::uint64_t bytes_staged = 0;
+
+  ReadCopyCounters& operator+=(ReadCopyCounters const& rhs) {
+    bytes_delivered += rhs.bytes_delivered;
+    bytes_staged += rhs.bytes_staged;
+    return *this;
+  }
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_READ_COPY_COUNTERS_H
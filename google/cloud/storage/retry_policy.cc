@@ -0,0 +1,210 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/retry_policy.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+struct RetryBudget::State {
+  State(double m, double r)
+      : max_tokens(std::max(m, 0.0)),
+        token_ratio(std::max(r, 0.0)),
+        stats{max_tokens, 0, 0} {}
+
+  double const max_tokens;
+  double const token_ratio;
+
+  mutable std::mutex mu;
+  RetryBudgetStats stats;
+};
+
+RetryBudget::RetryBudget(double max_tokens, double token_ratio)
+    : state_(std::make_shared<State>(max_tokens, token_ratio)) {}
+
+RetryBudgetStats RetryBudget::stats() const {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  return state_->stats;
+}
+
+bool RetryBudget::OnRetry() {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  auto& stats = state_->stats;
+  if (stats.tokens < 1.0) {
+    ++stats.retries_rejected;
+    return false;
+  }
+  stats.tokens -= 1.0;
+  ++stats.retries_allowed;
+  return true;
+}
+
+void RetryBudget::OnSuccess() {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  auto& stats = state_->stats;
+  stats.tokens =
+      std::min(state_->max_tokens, stats.tokens + state_->token_ratio);
+}
+
+namespace {
+/// The state of a single circuit in a `CircuitBreakerPolicy`.
+struct Circuit {
+  CircuitBreakerState state = CircuitBreakerState::kClosed;
+  std::chrono::steady_clock::time_point open_until;
+  // The outcome of the most recent attempts, `true` for failures.
+  std::vector<bool> window;
+  std::size_t next = 0;
+  int failures = 0;
+};
+}  // namespace
+
+struct CircuitBreakerPolicy::State {
+  State(double t, int w, std::chrono::milliseconds d)
+      : failure_rate_threshold(std::min(std::max(t, 0.0), 1.0)),
+        window_size(static_cast<std::size_t>(std::max(w, 1))),
+        open_duration(d) {}
+
+  void Record(Circuit& circuit, bool failed) {
+    if (circuit.window.size() < window_size) {
+      circuit.window.push_back(failed);
+    } else {
+      if (circuit.window[circuit.next]) {
+        --circuit.failures;
+      }
+      circuit.window[circuit.next] = failed;
+      circuit.next = (circuit.next + 1) % window_size;
+    }
+    if (failed) {
+      ++circuit.failures;
+    }
+  }
+
+  void Open(Circuit& circuit) {
+    circuit.state = CircuitBreakerState::kOpen;
+    circuit.open_until = std::chrono::steady_clock::now() + open_duration;
+    circuit.window.clear();
+    circuit.next = 0;
+    circuit.failures = 0;
+    ++stats.times_opened;
+  }
+
+  double const failure_rate_threshold;
+  std::size_t const window_size;
+  std::chrono::milliseconds const open_duration;
+
+  mutable std::mutex mu;
+  std::map<std::string, Circuit> circuits;
+  CircuitBreakerStats stats{0, 0};
+};
+
+CircuitBreakerPolicy::CircuitBreakerPolicy(
+    double failure_rate_threshold, int window_size,
+    std::chrono::milliseconds open_duration)
+    : state_(std::make_shared<State>(failure_rate_threshold, window_size,
+                                     open_duration)) {}
+
+CircuitBreakerState CircuitBreakerPolicy::state(std::string const& key) const {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  auto loc = state_->circuits.find(key);
+  if (loc == state_->circuits.end()) {
+    return CircuitBreakerState::kClosed;
+  }
+  auto const& circuit = loc->second;
+  if (circuit.state == CircuitBreakerState::kOpen &&
+      std::chrono::steady_clock::now() >= circuit.open_until) {
+    return CircuitBreakerState::kHalfOpen;
+  }
+  return circuit.state;
+}
+
+CircuitBreakerStats CircuitBreakerPolicy::stats() const {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  return state_->stats;
+}
+
+bool CircuitBreakerPolicy::AllowRequest(std::string const& key) {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  auto& circuit = state_->circuits[key];
+  switch (circuit.state) {
+    case CircuitBreakerState::kClosed:
+      return true;
+    case CircuitBreakerState::kOpen:
+      if (std::chrono::steady_clock::now() >= circuit.open_until) {
+        // This request is the probe, any other requests are rejected until
+        // it completes.
+        circuit.state = CircuitBreakerState::kHalfOpen;
+        return true;
+      }
+      break;
+    case CircuitBreakerState::kHalfOpen:
+      break;
+  }
+  ++state_->stats.requests_rejected;
+  return false;
+}
+
+void CircuitBreakerPolicy::OnSuccess(std::string const& key) {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  auto& circuit = state_->circuits[key];
+  switch (circuit.state) {
+    case CircuitBreakerState::kClosed:
+      state_->Record(circuit, false);
+      break;
+    case CircuitBreakerState::kHalfOpen:
+      circuit.state = CircuitBreakerState::kClosed;
+      break;
+    case CircuitBreakerState::kOpen:
+      // A request started before the circuit opened, ignore it.
+      break;
+  }
+}
+
+void CircuitBreakerPolicy::OnFailure(std::string const& key) {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  auto& circuit = state_->circuits[key];
+  switch (circuit.state) {
+    case CircuitBreakerState::kClosed:
+      state_->Record(circuit, true);
+      if (circuit.window.size() == state_->window_size &&
+          circuit.failures >= state_->failure_rate_threshold *
+                                  static_cast<double>(state_->window_size)) {
+        state_->Open(circuit);
+      }
+      break;
+    case CircuitBreakerState::kHalfOpen:
+      state_->Open(circuit);
+      break;
+    case CircuitBreakerState::kOpen:
+      break;
+  }
+}
+
+void CircuitBreakerPolicy::OnAbandoned(std::string const& key) {
+  std::lock_guard<std::mutex> lk(state_->mu);
+  auto& circuit = state_->circuits[key];
+  if (circuit.state == CircuitBreakerState::kHalfOpen) {
+    // The probe did not test the service, send another after `open_duration`.
+    state_->Open(circuit);
+  }
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -19,6 +19,10 @@
 #include "google/cloud/internal/retry_policy.h"
 #include "google/cloud/status.h"
 #include "google/cloud/storage/version.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
 
 namespace google {
 namespace cloud {
@@ -56,6 +60,163 @@ using BackoffPolicy = google::cloud::internal::BackoffPolicy;
 using ExponentialBackoffPolicy =
     google::cloud::internal::ExponentialBackoffPolicy;
 
+/// The state of a `RetryBudget`, for monitoring.
+struct RetryBudgetStats {
+  /// The number of tokens currently available.
+  double tokens;
+  /// The number of retries allowed by the budget.
+  std::int64_t retries_allowed;
+  /// The number of retries rejected because the budget was exhausted.
+  std::int64_t retries_rejected;
+};
+
+/**
+ * Limits the number of retries across all the requests in a process.
+ *
+ * The `RetryPolicy` limits the retries of a single request. During an outage
+ * many requests fail at the same time, and retrying all of them can amplify
+ * the load on the service. A `RetryBudget` is a token bucket shared by all the
+ * requests using it: each retry consumes one token, and each successful
+ * request refills `token_ratio` tokens, up to `max_tokens`. Once the budget is
+ * exhausted failed requests return their last error instead of retrying.
+ *
+ * Copies of a `RetryBudget` share the same tokens and counters. To share a
+ * budget across several `Client` objects pass copies of the same budget to
+ * each one.
+ *
+ * @par Example
+ * @code
+ * namespace gcs = google::cloud::storage;
+ * // Allow bursts of 100 retries, and about 1 retry for every 10 successes.
+ * gcs::RetryBudget budget(100.0, 0.1);
+ * gcs::Client client(gcs::ClientOptions::CreateDefaultClientOptions().value(),
+ *                    budget);
+ * @endcode
+ */
+class RetryBudget {
+ public:
+  /**
+   * Creates a new retry budget, initially full.
+   *
+   * @param max_tokens the maximum number of tokens in the bucket.
+   * @param token_ratio the number of tokens refilled by each successful
+   *     request.
+   */
+  RetryBudget(double max_tokens, double token_ratio);
+
+  /// Returns a snapshot of the current state.
+  RetryBudgetStats stats() const;
+
+  //@{
+  /**
+   * @name Used by the client library to implement the budget.
+   *
+   * Applications should have no need to call these functions.
+   */
+  /// Returns true, and consumes a token, if a retry is allowed.
+  bool OnRetry();
+
+  /// Refills the budget after a successful request.
+  void OnSuccess();
+  //@}
+
+ private:
+  struct State;
+  std::shared_ptr<State> state_;
+};
+
+/// The states of a circuit breaker.
+enum class CircuitBreakerState {
+  /// Requests are sent normally.
+  kClosed,
+  /// Requests fail immediately, without contacting the service.
+  kOpen,
+  /// A single probe request is sent to test if the service has recovered.
+  kHalfOpen,
+};
+
+/// The counters maintained by a `CircuitBreakerPolicy`, for monitoring.
+struct CircuitBreakerStats {
+  /// The number of times a circuit changed to the `kOpen` state.
+  std::int64_t times_opened;
+  /// The number of requests that failed immediately.
+  std::int64_t requests_rejected;
+};
+
+/**
+ * Fails requests immediately while a bucket is returning too many errors.
+ *
+ * The policy keeps a separate circuit for each bucket, requests that do not
+ * refer to a bucket share a single circuit for the service endpoint. Each
+ * circuit remembers the outcome of the last `window_size` attempts. Only
+ * transient errors, those the `RetryPolicy` would retry, count as failures.
+ * Once the window is full and the fraction of failures reaches
+ * `failure_rate_threshold` the circuit opens: requests for that bucket fail
+ * with `StatusCode::kUnavailable` without contacting the service. After
+ * `open_duration` a single probe request is allowed, if it succeeds the
+ * circuit closes, otherwise it stays open for another `open_duration`.
+ *
+ * Copies of a `CircuitBreakerPolicy` share the same circuits and counters.
+ *
+ * @par Example
+ * @code
+ * namespace gcs = google::cloud::storage;
+ * // Stop sending requests for 5 seconds when half of the last 20 fail.
+ * gcs::CircuitBreakerPolicy breaker(0.5, 20, std::chrono::seconds(5));
+ * gcs::Client client(gcs::ClientOptions::CreateDefaultClientOptions().value(),
+ *                    breaker);
+ * @endcode
+ */
+class CircuitBreakerPolicy {
+ public:
+  /**
+   * Creates a new circuit breaker policy.
+   *
+   * @param failure_rate_threshold open the circuit when this fraction of the
+   *     attempts in the window fail, for example `0.5`.
+   * @param window_size the number of recent attempts examined.
+   * @param open_duration how long the circuit stays open before sending a
+   *     probe request.
+   */
+  CircuitBreakerPolicy(double failure_rate_threshold, int window_size,
+                       std::chrono::milliseconds open_duration);
+
+  /// Returns the state of the circuit for @p key, usually a bucket name.
+  CircuitBreakerState state(std::string const& key) const;
+
+  /// Returns a snapshot of the counters.
+  CircuitBreakerStats stats() const;
+
+  //@{
+  /**
+   * @name Used by the client library to implement the circuit breaker.
+   *
+   * Applications should have no need to call these functions.
+   */
+  /// Returns true if an attempt for @p key can be sent.
+  bool AllowRequest(std::string const& key);
+
+  /// Records an attempt for @p key that reached the service.
+  void OnSuccess(std::string const& key);
+
+  /// Records an attempt for @p key that failed with a transient error.
+  void OnFailure(std::string const& key);
+
+  /**
+   * Records an attempt for @p key that ended without an outcome.
+   *
+   * For example, the attempt raised an exception, or a download was closed
+   * before any data was read. If the attempt was the probe the circuit opens
+   * again, otherwise the attempt is ignored.
+   */
+  void OnAbandoned(std::string const& key);
+  //@}
+
+ private:
+  struct State;
+  std::shared_ptr<State> state_;
+};
+
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
 }  // namespace cloud
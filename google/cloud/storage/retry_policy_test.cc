@@ -52,6 +52,106 @@ TEST(RetryPolicyTest, PermanentFailure) {
       AsStatus(HttpResponse{503, "service unavailable", {}})));
 }
 
+TEST(RetryPolicyTest, RetryBudget) {
+  RetryBudget budget(2.0, 0.5);
+  EXPECT_EQ(2.0, budget.stats().tokens);
+  EXPECT_TRUE(budget.OnRetry());
+  EXPECT_TRUE(budget.OnRetry());
+  EXPECT_FALSE(budget.OnRetry());
+  budget.OnSuccess();
+  EXPECT_FALSE(budget.OnRetry());
+  budget.OnSuccess();
+  EXPECT_TRUE(budget.OnRetry());
+
+  auto stats = budget.stats();
+  EXPECT_EQ(0.0, stats.tokens);
+  EXPECT_EQ(3, stats.retries_allowed);
+  EXPECT_EQ(2, stats.retries_rejected);
+}
+
+TEST(RetryPolicyTest, RetryBudgetIsCapped) {
+  RetryBudget budget(1.0, 0.5);
+  for (int i = 0; i != 10; ++i) {
+    budget.OnSuccess();
+  }
+  EXPECT_EQ(1.0, budget.stats().tokens);
+}
+
+TEST(RetryPolicyTest, RetryBudgetCopiesShareState) {
+  RetryBudget budget(1.0, 0.5);
+  RetryBudget copy = budget;
+  EXPECT_TRUE(copy.OnRetry());
+  EXPECT_FALSE(budget.OnRetry());
+}
+
+TEST(RetryPolicyTest, CircuitBreakerOpens) {
+  CircuitBreakerPolicy breaker(0.5, 4, std::chrono::hours(1));
+  EXPECT_EQ(CircuitBreakerState::kClosed, breaker.state("b1"));
+  breaker.OnSuccess("b1");
+  breaker.OnFailure("b1");
+  breaker.OnSuccess("b1");
+  EXPECT_EQ(CircuitBreakerState::kClosed, breaker.state("b1"));
+  breaker.OnFailure("b1");
+  EXPECT_EQ(CircuitBreakerState::kOpen, breaker.state("b1"));
+  EXPECT_FALSE(breaker.AllowRequest("b1"));
+
+  // Other circuits are not affected.
+  EXPECT_EQ(CircuitBreakerState::kClosed, breaker.state("b2"));
+  EXPECT_TRUE(breaker.AllowRequest("b2"));
+
+  auto stats = breaker.stats();
+  EXPECT_EQ(1, stats.times_opened);
+  EXPECT_EQ(1, stats.requests_rejected);
+}
+
+TEST(RetryPolicyTest, CircuitBreakerWindow) {
+  CircuitBreakerPolicy breaker(0.5, 4, std::chrono::hours(1));
+  // Old failures drop out of the window.
+  breaker.OnFailure("b1");
+  for (int i = 0; i != 10; ++i) {
+    breaker.OnSuccess("b1");
+  }
+  breaker.OnFailure("b1");
+  EXPECT_EQ(CircuitBreakerState::kClosed, breaker.state("b1"));
+  breaker.OnFailure("b1");
+  EXPECT_EQ(CircuitBreakerState::kOpen, breaker.state("b1"));
+}
+
+TEST(RetryPolicyTest, CircuitBreakerProbe) {
+  CircuitBreakerPolicy breaker(1.0, 1, std::chrono::milliseconds(0));
+  breaker.OnFailure("b1");
+  EXPECT_EQ(CircuitBreakerState::kHalfOpen, breaker.state("b1"));
+
+  // Only one probe is allowed, and its failure opens the circuit again.
+  EXPECT_TRUE(breaker.AllowRequest("b1"));
+  EXPECT_FALSE(breaker.AllowRequest("b1"));
+  breaker.OnFailure("b1");
+  EXPECT_EQ(2, breaker.stats().times_opened);
+
+  // A successful probe closes the circuit.
+  EXPECT_TRUE(breaker.AllowRequest("b1"));
+  breaker.OnSuccess("b1");
+  EXPECT_EQ(CircuitBreakerState::kClosed, breaker.state("b1"));
+  EXPECT_TRUE(breaker.AllowRequest("b1"));
+}
+
+TEST(RetryPolicyTest, CircuitBreakerAbandonedProbe) {
+  CircuitBreakerPolicy breaker(1.0, 1, std::chrono::milliseconds(0));
+  breaker.OnFailure("b1");
+
+  // A probe without an outcome opens the circuit again.
+  EXPECT_TRUE(breaker.AllowRequest("b1"));
+  breaker.OnAbandoned("b1");
+  EXPECT_EQ(2, breaker.stats().times_opened);
+  EXPECT_TRUE(breaker.AllowRequest("b1"));
+
+  // Other abandoned attempts are ignored.
+  breaker.OnSuccess("b1");
+  breaker.OnAbandoned("b1");
+  EXPECT_EQ(CircuitBreakerState::kClosed, breaker.state("b1"));
+  EXPECT_EQ(2, breaker.stats().times_opened);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
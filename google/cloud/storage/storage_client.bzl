@@ -17,23 +17,33 @@
 """Automatically generated source lists for storage_client - DO NOT EDIT."""
 
 storage_client_hdrs = [
+    "batch.h",
+    "block_cache_counters.h",
     "bucket_access_control.h",
     "bucket_metadata.h",
+    "buffer_pool.h",
     "client.h",
     "client_options.h",
     "download_options.h",
     "hashing_options.h",
+    "hedging_policy.h",
     "hmac_key_metadata.h",
     "iam_policy.h",
     "idempotency_policy.h",
     "internal/access_control_common.h",
+    "internal/adaptive_chunk_size.h",
+    "internal/batch_request.h",
     "internal/binary_data_as_debug_string.h",
+    "internal/block_cache_client.h",
     "internal/bucket_acl_requests.h",
     "internal/bucket_requests.h",
     "internal/common_metadata.h",
     "internal/complex_option.h",
     "internal/compute_engine_util.h",
+    "internal/const_buffer.h",
+    "internal/crc32c_combine.h",
     "internal/curl_client.h",
+    "internal/curl_download_reactor.h",
     "internal/curl_download_request.h",
     "internal/curl_handle.h",
     "internal/curl_handle_factory.h",
@@ -52,17 +62,24 @@ storage_client_hdrs = [
     "internal/http_response.h",
     "internal/logging_client.h",
     "internal/logging_resumable_upload_session.h",
+    "internal/metadata_cache.h",
+    "internal/metadata_cache_client.h",
     "internal/metadata_parser.h",
     "internal/nljson.h",
     "internal/notification_requests.h",
     "internal/object_acl_requests.h",
+    "internal/object_block_cache.h",
+    "internal/object_metadata_sax_parser.h",
     "internal/object_read_source.h",
     "internal/object_requests.h",
     "internal/object_streambuf.h",
     "internal/openssl_util.h",
+    "internal/parallel_list_objects.h",
     "internal/parameter_pack_validation.h",
     "internal/patch_builder.h",
+    "internal/pipelined_resumable_upload_session.h",
     "internal/policy_document_request.h",
+    "internal/prefetch_object_read_source.h",
     "internal/range_from_pagination.h",
     "internal/raw_client.h",
     "internal/raw_client_wrapper_utils.h",
@@ -75,10 +92,12 @@ storage_client_hdrs = [
     "internal/sign_blob_requests.h",
     "internal/signed_url_requests.h",
     "internal/tuple_filter.h",
+    "internal/upload_file_source.h",
     "lifecycle_rule.h",
     "list_buckets_reader.h",
     "list_hmac_keys_reader.h",
     "list_objects_reader.h",
+    "metadata_cache_counters.h",
     "notification_event_type.h",
     "notification_metadata.h",
     "notification_payload_format.h",
@@ -96,8 +115,10 @@ storage_client_hdrs = [
     "object_rewriter.h",
     "object_stream.h",
     "override_default_project.h",
+    "parallel_download.h",
     "parallel_upload.h",
     "policy_document.h",
+    "read_copy_counters.h",
     "retry_policy.h",
     "service_account.h",
     "signed_url_options.h",
@@ -110,20 +131,29 @@ storage_client_hdrs = [
 ]
 
 storage_client_srcs = [
+    "batch.cc",
     "bucket_access_control.cc",
     "bucket_metadata.cc",
+    "buffer_pool.cc",
     "client.cc",
     "client_options.cc",
     "hashing_options.cc",
+    "hedging_policy.cc",
     "hmac_key_metadata.cc",
     "iam_policy.cc",
     "idempotency_policy.cc",
     "internal/access_control_common.cc",
+    "internal/adaptive_chunk_size.cc",
+    "internal/batch_request.cc",
     "internal/binary_data_as_debug_string.cc",
+    "internal/block_cache_client.cc",
     "internal/bucket_acl_requests.cc",
     "internal/bucket_requests.cc",
     "internal/compute_engine_util.cc",
+    "internal/const_buffer.cc",
+    "internal/crc32c_combine.cc",
     "internal/curl_client.cc",
+    "internal/curl_download_reactor.cc",
     "internal/curl_download_request.cc",
     "internal/curl_handle.cc",
     "internal/curl_handle_factory.cc",
@@ -139,13 +169,19 @@ storage_client_srcs = [
     "internal/http_response.cc",
     "internal/logging_client.cc",
     "internal/logging_resumable_upload_session.cc",
+    "internal/metadata_cache_client.cc",
     "internal/metadata_parser.cc",
     "internal/notification_requests.cc",
     "internal/object_acl_requests.cc",
+    "internal/object_block_cache.cc",
+    "internal/object_metadata_sax_parser.cc",
     "internal/object_requests.cc",
     "internal/object_streambuf.cc",
     "internal/openssl_util.cc",
+    "internal/parallel_list_objects.cc",
+    "internal/pipelined_resumable_upload_session.cc",
     "internal/policy_document_request.cc",
+    "internal/prefetch_object_read_source.cc",
     "internal/resumable_upload_session.cc",
     "internal/retry_client.cc",
     "internal/retry_object_read_source.cc",
@@ -154,6 +190,7 @@ storage_client_srcs = [
     "internal/sha256_hash.cc",
     "internal/sign_blob_requests.cc",
     "internal/signed_url_requests.cc",
+    "internal/upload_file_source.cc",
     "lifecycle_rule.cc",
     "list_buckets_reader.cc",
     "list_hmac_keys_reader.cc",
@@ -171,8 +208,10 @@ storage_client_srcs = [
     "object_metadata.cc",
     "object_rewriter.cc",
     "object_stream.cc",
+    "parallel_download.cc",
     "parallel_upload.cc",
     "policy_document.cc",
+    "retry_policy.cc",
     "service_account.cc",
     "version.cc",
     "well_known_headers.cc",
@@ -188,6 +188,81 @@ TEST_F(ClientOptionsTest, SetMaximumDownloadStall) {
   EXPECT_EQ(60, client_options.download_stall_timeout().count());
 }
 
+TEST_F(ClientOptionsTest, SetDownloadReactorThreadCount) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_EQ(0, client_options.download_reactor_thread_count());
+  client_options.set_download_reactor_thread_count(2);
+  EXPECT_EQ(2, client_options.download_reactor_thread_count());
+}
+
+TEST_F(ClientOptionsTest, SetDownloadPrefetchDepth) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_EQ(0, client_options.download_prefetch_depth());
+  client_options.set_download_prefetch_depth(4);
+  EXPECT_EQ(4, client_options.download_prefetch_depth());
+}
+
+TEST_F(ClientOptionsTest, SetUploadPipelineDepth) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_EQ(0, client_options.upload_pipeline_depth());
+  client_options.set_upload_pipeline_depth(2);
+  EXPECT_EQ(2, client_options.upload_pipeline_depth());
+}
+
+TEST_F(ClientOptionsTest, SetAdaptiveUploadBufferSize) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_FALSE(client_options.enable_adaptive_upload_buffer_size());
+  EXPECT_EQ(256 * 1024, client_options.minimum_upload_buffer_size());
+  EXPECT_EQ(64 * 1024 * 1024, client_options.maximum_upload_buffer_size());
+  client_options.set_enable_adaptive_upload_buffer_size(true)
+      .set_minimum_upload_buffer_size(1024 * 1024)
+      .set_maximum_upload_buffer_size(8 * 1024 * 1024);
+  EXPECT_TRUE(client_options.enable_adaptive_upload_buffer_size());
+  EXPECT_EQ(1024 * 1024, client_options.minimum_upload_buffer_size());
+  EXPECT_EQ(8 * 1024 * 1024, client_options.maximum_upload_buffer_size());
+}
+
+TEST_F(ClientOptionsTest, SetBufferPool) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_EQ(nullptr, client_options.buffer_pool());
+  auto pool = std::make_shared<BufferPool>(1024 * 1024);
+  client_options.set_buffer_pool(pool);
+  EXPECT_EQ(pool, client_options.buffer_pool());
+}
+
+TEST_F(ClientOptionsTest, SetBlockCache) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_EQ(0, client_options.block_cache_size());
+  EXPECT_EQ(1024 * 1024, client_options.block_cache_block_size());
+  EXPECT_TRUE(client_options.block_cache_spill_directory().empty());
+  EXPECT_EQ(0, client_options.block_cache_spill_size());
+  client_options.set_block_cache_size(64 * 1024 * 1024)
+      .set_block_cache_block_size(256 * 1024)
+      .set_block_cache_spill_directory("/tmp/cache")
+      .set_block_cache_spill_size(1024 * 1024 * 1024);
+  EXPECT_EQ(64 * 1024 * 1024, client_options.block_cache_size());
+  EXPECT_EQ(256 * 1024, client_options.block_cache_block_size());
+  EXPECT_EQ("/tmp/cache", client_options.block_cache_spill_directory());
+  EXPECT_EQ(1024 * 1024 * 1024, client_options.block_cache_spill_size());
+}
+
+TEST_F(ClientOptionsTest, SetMetadataCache) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_EQ(0, client_options.metadata_cache_ttl().count());
+  EXPECT_EQ(10000, client_options.metadata_cache_max_entries());
+  client_options.set_metadata_cache_ttl(std::chrono::milliseconds(500))
+      .set_metadata_cache_max_entries(100);
+  EXPECT_EQ(500, client_options.metadata_cache_ttl().count());
+  EXPECT_EQ(100, client_options.metadata_cache_max_entries());
+}
+
+TEST_F(ClientOptionsTest, SetEnableListPrefetch) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_FALSE(client_options.enable_list_prefetch());
+  client_options.set_enable_list_prefetch(true);
+  EXPECT_TRUE(client_options.enable_list_prefetch());
+}
+
 }  // namespace
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
@@ -18,6 +18,7 @@
 
 storage_client_testing_hdrs = [
     "testing/canonical_errors.h",
+    "testing/loopback_http_server.h",
     "testing/mock_client.h",
     "testing/mock_fake_clock.h",
     "testing/mock_http_request.h",
@@ -28,6 +29,7 @@ storage_client_testing_hdrs = [
 ]
 
 storage_client_testing_srcs = [
+    "testing/loopback_http_server.cc",
     "testing/mock_http_request.cc",
     "testing/random_names.cc",
     "testing/storage_integration_test.cc",
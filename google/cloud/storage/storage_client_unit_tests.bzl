@@ -20,6 +20,8 @@ storage_client_unit_tests = [
     "bucket_access_control_test.cc",
     "bucket_metadata_test.cc",
     "bucket_test.cc",
+    "buffer_pool_test.cc",
+    "client_batch_test.cc",
     "client_bucket_acl_test.cc",
     "client_default_object_acl_test.cc",
     "client_notifications_test.cc",
@@ -31,14 +33,21 @@ storage_client_unit_tests = [
     "client_test.cc",
     "client_write_object_test.cc",
     "hashing_options_test.cc",
+    "hedging_policy_test.cc",
     "hmac_key_metadata_test.cc",
     "idempotency_policy_test.cc",
     "internal/access_control_common_test.cc",
+    "internal/adaptive_chunk_size_test.cc",
+    "internal/batch_request_test.cc",
     "internal/binary_data_as_debug_string_test.cc",
+    "internal/block_cache_client_test.cc",
     "internal/bucket_acl_requests_test.cc",
     "internal/bucket_requests_test.cc",
     "internal/compute_engine_util_test.cc",
+    "internal/const_buffer_test.cc",
+    "internal/crc32c_combine_test.cc",
     "internal/curl_client_test.cc",
+    "internal/curl_download_reactor_test.cc",
     "internal/curl_handle_test.cc",
     "internal/curl_resumable_upload_session_test.cc",
     "internal/curl_wrappers_disable_sigpipe_handler_test.cc",
@@ -54,17 +63,24 @@ storage_client_unit_tests = [
     "internal/http_response_test.cc",
     "internal/logging_client_test.cc",
     "internal/logging_resumable_upload_session_test.cc",
+    "internal/metadata_cache_client_test.cc",
+    "internal/metadata_cache_test.cc",
     "internal/metadata_parser_test.cc",
     "internal/nljson_use_after_third_party_test.cc",
     "internal/nljson_use_third_party_test.cc",
     "internal/notification_requests_test.cc",
     "internal/object_acl_requests_test.cc",
+    "internal/object_block_cache_test.cc",
+    "internal/object_metadata_sax_parser_test.cc",
     "internal/object_requests_test.cc",
     "internal/object_streambuf_test.cc",
     "internal/openssl_util_test.cc",
+    "internal/parallel_list_objects_test.cc",
     "internal/parameter_pack_validation_test.cc",
     "internal/patch_builder_test.cc",
+    "internal/pipelined_resumable_upload_session_test.cc",
     "internal/policy_document_request_test.cc",
+    "internal/prefetch_object_read_source_test.cc",
     "internal/resumable_upload_session_test.cc",
     "internal/retry_client_test.cc",
     "internal/retry_object_read_source_test.cc",
@@ -74,6 +90,7 @@ storage_client_unit_tests = [
     "internal/sign_blob_requests_test.cc",
     "internal/signed_url_requests_test.cc",
     "internal/tuple_filter_test.cc",
+    "internal/upload_file_source_test.cc",
     "lifecycle_rule_test.cc",
     "list_buckets_reader_test.cc",
     "list_hmac_keys_reader_test.cc",
@@ -84,11 +101,13 @@ storage_client_unit_tests = [
     "oauth2/compute_engine_credentials_test.cc",
     "oauth2/google_application_default_credentials_file_test.cc",
     "oauth2/google_credentials_test.cc",
+    "oauth2/refreshing_credentials_wrapper_test.cc",
     "oauth2/service_account_credentials_test.cc",
     "object_access_control_test.cc",
     "object_metadata_test.cc",
     "object_stream_test.cc",
     "object_test.cc",
+    "parallel_download_test.cc",
     "parallel_uploads_test.cc",
     "policy_document_test.cc",
     "retry_policy_test.cc",
@@ -28,6 +28,7 @@ import re
 import testbench_utils
 import time
 import sys
+import uuid
 from werkzeug import serving
 from werkzeug.middleware.dispatcher import DispatcherMiddleware
 
@@ -374,16 +375,29 @@ def objects_list(bucket_name):
     versions_parameter = flask.request.args.get('versions')
     all_versions = (versions_parameter is not None
                     and bool(versions_parameter))
+    prefix = flask.request.args.get('prefix', '')
+    delimiter = flask.request.args.get('delimiter', '')
+    prefixes = set()
     for name, o in testbench_utils.all_objects():
-        if name.find(bucket_name + '/o') != 0:
+        if name.find(bucket_name + '/o/') != 0:
             continue
         if o.get_latest() is None:
             continue
+        object_name = name[len(bucket_name + '/o/'):]
+        if not object_name.startswith(prefix):
+            continue
+        if delimiter != '':
+            index = object_name.find(delimiter, len(prefix))
+            if index != -1:
+                prefixes.add(object_name[:index + len(delimiter)])
+                continue
         if all_versions:
             for object_version in o.revisions.values():
                 result['items'].append(object_version.metadata)
         else:
             result['items'].append(o.get_latest().metadata)
+    if len(prefixes) != 0:
+        result['prefixes'] = sorted(prefixes)
     return testbench_utils.filtered_response(flask.request, result)
 
 
@@ -848,6 +862,77 @@ def xmlapi_put_object(bucket_name, object_name):
     return response
 
 
+# Define the WSGI application to handle batch requests.
+BATCH_HANDLER_PATH = '/batch'
+batch = flask.Flask(__name__)
+batch.debug = True
+
+
+@batch.errorhandler(error_response.ErrorResponse)
+def batch_error(error):
+    return error.as_response()
+
+
+@batch.route(GCS_HANDLER_PATH, methods=['POST'])
+def batch_execute():
+    """Implement the JSON API batch endpoint.
+
+    Each part in the `multipart/mixed` request contains an embedded HTTP
+    request. The embedded requests are dispatched to the `gcs` application, and
+    their responses are returned in a `multipart/mixed` response.
+    """
+    content_type = flask.request.headers.get('content-type', '')
+    if not content_type.startswith('multipart/mixed'):
+        raise error_response.ErrorResponse(
+            'Missing or invalid content-type header in batch request')
+    _, _, boundary = content_type.partition('boundary=')
+    boundary = boundary.split(';')[0].strip().strip('"')
+    if boundary == '':
+        raise error_response.ErrorResponse(
+            'Missing boundary in content-type header in batch request')
+    marker = b'--' + boundary.encode('utf-8')
+    body = testbench_utils.extract_media(flask.request)
+
+    client = gcs.test_client()
+    response_boundary = 'batch_' + uuid.uuid4().hex
+    response_marker = b'--' + response_boundary.encode('utf-8')
+    payload = b''
+    # parts[0] is the (typically empty) preamble, the last part starts with
+    # `--`, and is the epilogue.
+    for part in body.split(marker)[1:]:
+        if part.startswith(b'--'):
+            break
+        if part.startswith(b'\r\n'):
+            part = part[2:]
+        if part.endswith(b'\r\n'):
+            part = part[:-2]
+        part_headers, embedded = testbench_utils.parse_part(part)
+        request_line, _, embedded = embedded.partition(b'\r\n')
+        method, path, _ = request_line.decode('utf-8').split(' ', 2)
+        if path.startswith(GCS_HANDLER_PATH):
+            path = path[len(GCS_HANDLER_PATH):]
+        headers, data = testbench_utils.parse_part(embedded)
+        response = client.open(path, method=method, headers=headers, data=data)
+
+        payload += response_marker + b'\r\n'
+        payload += b'Content-Type: application/http\r\n'
+        content_id = part_headers.get('Content-ID')
+        if content_id is not None:
+            content_id = content_id.replace('<', '<response-', 1)
+            payload += b'Content-ID: ' + content_id.encode('utf-8') + b'\r\n'
+        payload += b'\r\n'
+        payload += b'HTTP/1.1 ' + response.status.encode('utf-8') + b'\r\n'
+        for key, value in response.headers.items():
+            payload += ('%s: %s\r\n' % (key, value)).encode('utf-8')
+        payload += b'\r\n' + response.get_data() + b'\r\n'
+    payload += response_marker + b'--\r\n'
+
+    result = flask.make_response(payload)
+    result.headers['Content-Type'] = (
+        'multipart/mixed; boundary=%s' % response_boundary)
+    return result
+
+
 # Define the WSGI application to handle HMAC key requests
 (PROJECTS_HANDLER_PATH, projects_app) = gcs_project.get_projects_app()
 
@@ -861,6 +946,7 @@ application = DispatcherMiddleware(
         UPLOAD_HANDLER_PATH: upload,
         DOWNLOAD_HANDLER_PATH: download,
         XMLAPI_HANDLER_PATH: xmlapi,
+        BATCH_HANDLER_PATH: batch,
         PROJECTS_HANDLER_PATH: projects_app,
         IAM_HANDLER_PATH: iam_app,
     })
@@ -0,0 +1,220 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/testing/loopback_http_server.h"
+#ifndef _WIN32
+#include <gmock/gmock.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace storage {
+namespace testing {
+namespace {
+std::string ToLower(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(),
+                 [](char c) { return static_cast<char>(std::tolower(c)); });
+  return s;
+}
+
+std::string Trim(std::string const& s) {
+  auto const b = s.find_first_not_of(" \t");
+  if (b == std::string::npos) {
+    return {};
+  }
+  return s.substr(b, s.find_last_not_of(" \t") - b + 1);
+}
+
+bool WriteAll(int fd, std::string const& data) {
+  std::size_t offset = 0;
+  while (offset != data.size()) {
+    auto n = ::send(fd, data.data() + offset, data.size() - offset,
+                    MSG_NOSIGNAL);
+    if (n <= 0) {
+      return false;
+    }
+    offset += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+/// Reads more data from @p fd into @p buffer, returns false on EOF or errors.
+bool ReadMore(int fd, std::string& buffer) {
+  char data[16 * 1024];
+  auto n = ::recv(fd, data, sizeof(data), 0);
+  if (n <= 0) {
+    return false;
+  }
+  buffer.append(data, static_cast<std::size_t>(n));
+  return true;
+}
+}  // namespace
+
+LoopbackHttpServer::LoopbackHttpServer(Handler handler)
+    : handler_(std::move(handler)), fd_(::socket(AF_INET, SOCK_STREAM, 0)) {
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = 0;
+  socklen_t length = sizeof(address);
+  if (::bind(fd_, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+      ::listen(fd_, 16) != 0 ||
+      ::getsockname(fd_, reinterpret_cast<sockaddr*>(&address), &length) !=
+          0) {
+    ADD_FAILURE() << "cannot create loopback server";
+    return;
+  }
+  port_ = ntohs(address.sin_port);
+  acceptor_ = std::thread([this] { AcceptLoop(); });
+}
+
+LoopbackHttpServer::~LoopbackHttpServer() {
+  // Unblock the threads waiting in accept() and recv().
+  ::shutdown(fd_, SHUT_RDWR);
+  if (acceptor_.joinable()) {
+    acceptor_.join();
+  }
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    for (auto c : connections_) {
+      ::shutdown(c, SHUT_RDWR);
+    }
+  }
+  for (auto& w : workers_) {
+    w.join();
+  }
+  ::close(fd_);
+}
+
+std::string LoopbackHttpServer::endpoint() const {
+  return "http://127.0.0.1:" + std::to_string(port_);
+}
+
+std::vector<LoopbackHttpRequest> LoopbackHttpServer::requests() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return requests_;
+}
+
+int LoopbackHttpServer::connection_count() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return connection_count_;
+}
+
+void LoopbackHttpServer::AcceptLoop() {
+  while (true) {
+    int connection = ::accept(fd_, nullptr, nullptr);
+    if (connection < 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lk(mu_);
+    ++connection_count_;
+    connections_.push_back(connection);
+    workers_.emplace_back([this, connection] { Serve(connection); });
+  }
+}
+
+void LoopbackHttpServer::Close(int connection) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    connections_.erase(
+        std::find(connections_.begin(), connections_.end(), connection));
+  }
+  ::close(connection);
+}
+
+void LoopbackHttpServer::Serve(int connection) {
+  std::string buffer;
+  while (true) {
+    auto end_of_headers = buffer.find("\r\n\r\n");
+    while (end_of_headers == std::string::npos) {
+      if (!ReadMore(connection, buffer)) {
+        Close(connection);
+        return;
+      }
+      end_of_headers = buffer.find("\r\n\r\n");
+    }
+    LoopbackHttpRequest request;
+    auto const head = buffer.substr(0, end_of_headers + 2);
+    buffer.erase(0, end_of_headers + 4);
+    auto eol = head.find("\r\n");
+    request.request_line = head.substr(0, eol);
+    for (auto pos = eol + 2; pos < head.size(); pos = eol + 2) {
+      eol = head.find("\r\n", pos);
+      auto const line = head.substr(pos, eol - pos);
+      auto const colon = line.find(':');
+      if (colon == std::string::npos) {
+        continue;
+      }
+      request.headers.emplace(ToLower(line.substr(0, colon)),
+                              Trim(line.substr(colon + 1)));
+    }
+
+    auto expect = request.headers.find("expect");
+    if (expect != request.headers.end() &&
+        ToLower(expect->second) == "100-continue") {
+      if (!WriteAll(connection, "HTTP/1.1 100 Continue\r\n\r\n")) {
+        Close(connection);
+        return;
+      }
+    }
+    std::size_t content_length = 0;
+    auto length = request.headers.find("content-length");
+    if (length != request.headers.end()) {
+      content_length = std::strtoul(length->second.c_str(), nullptr, 10);
+    }
+    while (buffer.size() < content_length) {
+      if (!ReadMore(connection, buffer)) {
+        Close(connection);
+        return;
+      }
+    }
+    request.body = buffer.substr(0, content_length);
+    buffer.erase(0, content_length);
+
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      requests_.push_back(request);
+    }
+    auto const response = handler_(request);
+    if (response.drop_connection) {
+      Close(connection);
+      return;
+    }
+    auto payload = "HTTP/1.1 " + std::to_string(response.status_code) +
+                   " Loopback\r\n"
+                   "Content-Type: application/json\r\n";
+    for (auto const& kv : response.headers) {
+      payload += kv.first + ": " + kv.second + "\r\n";
+    }
+    payload += "Content-Length: " + std::to_string(response.payload.size()) +
+               "\r\n\r\n" + response.payload;
+    if (!WriteAll(connection, payload)) {
+      Close(connection);
+      return;
+    }
+  }
+}
+
+}  // namespace testing
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+#endif  // _WIN32
@@ -0,0 +1,99 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_TESTING_LOOPBACK_HTTP_SERVER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_TESTING_LOOPBACK_HTTP_SERVER_H
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+namespace testing {
+
+/// A HTTP request received by `LoopbackHttpServer`.
+struct LoopbackHttpRequest {
+  /// The request line, e.g. "PUT /bucket/object HTTP/1.1".
+  std::string request_line;
+  /// The headers, the names are converted to lowercase.
+  std::multimap<std::string, std::string> headers;
+  std::string body;
+};
+
+/// The response sent by `LoopbackHttpServer`.
+struct LoopbackHttpResponse {
+  int status_code = 200;
+  /// Additional headers, e.g. "x-goog-hash".
+  std::multimap<std::string, std::string> headers;
+  std::string payload;
+  /// If true, close the connection instead of sending a response.
+  bool drop_connection = false;
+};
+
+/**
+ * A minimal HTTP/1.1 server listening on the loopback interface.
+ *
+ * Used to verify the requests created by the libcurl-based classes, including
+ * how they recover when a kept-alive connection is closed by the server. It
+ * supports `Expect: 100-continue`, and requests with a `Content-Length`
+ * header. It is only available on POSIX platforms.
+ */
+class LoopbackHttpServer {
+ public:
+  /// Called for each request, from the thread serving the connection.
+  using Handler =
+      std::function<LoopbackHttpResponse(LoopbackHttpRequest const&)>;
+
+  explicit LoopbackHttpServer(Handler handler);
+  ~LoopbackHttpServer();
+
+  LoopbackHttpServer(LoopbackHttpServer const&) = delete;
+  LoopbackHttpServer& operator=(LoopbackHttpServer const&) = delete;
+
+  /// The URL for the server, e.g. "http://127.0.0.1:12345".
+  std::string endpoint() const;
+
+  /// The requests received so far.
+  std::vector<LoopbackHttpRequest> requests() const;
+
+  /// The number of connections accepted so far.
+  int connection_count() const;
+
+ private:
+  void AcceptLoop();
+  void Serve(int connection);
+  void Close(int connection);
+
+  Handler handler_;
+  int fd_;
+  int port_ = 0;
+  mutable std::mutex mu_;
+  std::vector<LoopbackHttpRequest> requests_;
+  int connection_count_ = 0;
+  std::vector<int> connections_;
+  std::vector<std::thread> workers_;
+  std::thread acceptor_;
+};
+
+}  // namespace testing
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_TESTING_LOOPBACK_HTTP_SERVER_H
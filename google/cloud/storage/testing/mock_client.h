@@ -159,6 +159,17 @@ class MockClient : public google::cloud::storage::internal::RawClient {
   MOCK_METHOD1(DeleteNotification,
                StatusOr<internal::EmptyResponse>(
                    internal::DeleteNotificationRequest const&));
+  MOCK_METHOD1(ExecuteBatch, StatusOr<internal::BatchResponse>(
+                                 internal::BatchRequest const&));
+  MOCK_METHOD1(AsyncInsertObjectMedia,
+               future<StatusOr<ObjectMetadata>>(
+                   internal::InsertObjectMediaRequest const&));
+  MOCK_METHOD1(AsyncGetObjectMetadata,
+               future<StatusOr<ObjectMetadata>>(
+                   internal::GetObjectMetadataRequest const&));
+  MOCK_METHOD1(AsyncReadObject, future<StatusOr<std::string>>(
+                                    internal::ReadObjectRangeRequest const&));
+  MOCK_METHOD1(AsyncSleep, future<void>(std::chrono::milliseconds));
   MOCK_METHOD1(
       AuthorizationHeader,
       StatusOr<std::string>(
@@ -187,6 +198,7 @@ class MockObjectReadSource : public internal::ObjectReadSource {
   MOCK_METHOD0(Close, StatusOr<internal::HttpResponse>());
   MOCK_METHOD2(Read,
                StatusOr<internal::ReadSourceResult>(char* buf, std::size_t n));
+  MOCK_METHOD0(Cancel, void());
 };
 
 class MockStreambuf : public internal::ObjectWriteStreambuf {
@@ -18,6 +18,7 @@
 #include "google/cloud/testing_util/assert_ok.h"
 #include <gmock/gmock.h>
 #include <cstdlib>
+#include <thread>
 #include <vector>
 
 namespace google {
@@ -78,6 +79,83 @@ TEST(CurlDownloadRequestTest, SimpleStream) {
   EXPECT_EQ(kDownloadedLines, count);
 }
 
+TEST(CurlDownloadRequestTest, ReactorStreams) {
+  // Run several downloads concurrently, all of them driven by a single
+  // reactor, and consume them from a single thread.
+  constexpr int kDownloadedLines = 100;
+  constexpr int kDownloadCount = 8;
+  auto reactor = std::make_shared<CurlDownloadReactor>();
+
+  std::vector<std::unique_ptr<CurlDownloadRequest>> downloads;
+  for (int i = 0; i != kDownloadCount; ++i) {
+    storage::internal::CurlRequestBuilder request(
+        HttpBinEndpoint() + "/stream/" + std::to_string(kDownloadedLines),
+        storage::internal::GetDefaultCurlHandleFactory());
+    request.SetDownloadReactor(reactor);
+    downloads.emplace_back(new CurlDownloadRequest(
+        request.BuildDownloadRequest(std::string{})));
+  }
+
+  std::vector<std::iterator_traits<std::string::iterator>::difference_type>
+      counts(kDownloadCount);
+  std::vector<bool> done(kDownloadCount);
+  char buffer[16 * 1024];
+  for (int remaining = kDownloadCount; remaining != 0;) {
+    for (int i = 0; i != kDownloadCount; ++i) {
+      if (done[i]) continue;
+      auto result = downloads[i]->Read(buffer, sizeof(buffer));
+      ASSERT_STATUS_OK(result);
+      ASSERT_LE(result->bytes_received, sizeof(buffer));
+      counts[i] += std::count(buffer, buffer + result->bytes_received, '\n');
+      if (result->response.status_code == 100) continue;
+      EXPECT_EQ(200, result->response.status_code);
+      done[i] = true;
+      --remaining;
+    }
+  }
+  for (auto c : counts) {
+    EXPECT_EQ(kDownloadedLines, c);
+  }
+  downloads.clear();
+  EXPECT_EQ(0, reactor->active_handles());
+}
+
+TEST(CurlDownloadRequestTest, ReactorCloseEarly) {
+  auto reactor = std::make_shared<CurlDownloadReactor>();
+  storage::internal::CurlRequestBuilder request(
+      HttpBinEndpoint() + "/stream/100",
+      storage::internal::GetDefaultCurlHandleFactory());
+  request.SetDownloadReactor(reactor);
+  auto download = request.BuildDownloadRequest(std::string{});
+
+  char buffer[128];
+  auto result = download.Read(buffer, sizeof(buffer));
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ(100, result->response.status_code);
+  auto response = download.Close();
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(200, response->status_code);
+}
+
+TEST(CurlDownloadRequestTest, ReactorCancel) {
+  auto reactor = std::make_shared<CurlDownloadReactor>();
+  storage::internal::CurlRequestBuilder request(
+      HttpBinEndpoint() + "/delay/10",
+      storage::internal::GetDefaultCurlHandleFactory());
+  request.SetDownloadReactor(reactor);
+  auto download = request.BuildDownloadRequest(std::string{});
+
+  // The server delays the response, the read blocks until it is cancelled.
+  char buffer[128];
+  StatusOr<ReadSourceResult> result;
+  std::thread reader([&] { result = download.Read(buffer, sizeof(buffer)); });
+  download.Cancel();
+  reader.join();
+  EXPECT_EQ(StatusCode::kCancelled, result.status().code());
+  EXPECT_FALSE(download.IsOpen());
+  EXPECT_EQ(0, reactor->active_handles());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
@@ -370,6 +370,21 @@ class MockLogBackend : public google::cloud::LogBackend {
   MOCK_METHOD1(ProcessWithOwnership, void(google::cloud::LogRecord));
 };
 
+/// @test Verify that cancelling an asynchronous request stops the transfer.
+TEST(CurlRequestTest, AsyncCancel) {
+  auto reactor = std::make_shared<CurlDownloadReactor>();
+  storage::internal::CurlRequestBuilder request(
+      HttpBinEndpoint() + "/delay/10",
+      storage::internal::GetDefaultCurlHandleFactory());
+
+  auto pending =
+      request.BuildRequest().MakeRequestAsync(*reactor, std::string{});
+  EXPECT_TRUE(pending.cancel());
+  auto response = pending.get();
+  EXPECT_EQ(StatusCode::kCancelled, response.status().code());
+  EXPECT_EQ(0, reactor->active_handles());
+}
+
 /// @test Verify that CurlRequest logs when requested.
 TEST(CurlRequestTest, Logging) {
   // Prepare the Log subsystem to receive mock calls: